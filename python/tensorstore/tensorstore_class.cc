@@ -820,6 +820,44 @@ Group:
 )",
       py::arg("fix_resizable_bounds") = false);
 
+  cls.def(
+      "prefetch",
+      [](Self& self) -> PythonFutureWrapper<void> {
+        return PythonFutureWrapper<void>(tensorstore::Prefetch(self.value),
+                                         self.reference_manager());
+      },
+      R"(
+Loads the data into the cache, without returning it.
+
+This is a hint that the data will be read soon.  Chunks are loaded only to the
+extent permitted by the ``total_bytes_limit`` of the
+:json:schema:`Context.cache_pool`; the returned future becomes ready once they
+have been loaded.
+
+Example:
+
+  >>> store = await ts.open(
+  ...     {
+  ...         'driver': 'zarr',
+  ...         'kvstore': {
+  ...             'driver': 'memory'
+  ...         },
+  ...         'context': {
+  ...             'cache_pool': {
+  ...                 'total_bytes_limit': 100000000
+  ...             }
+  ...         }
+  ...     },
+  ...     dtype=ts.uint32,
+  ...     shape=[1000, 2000],
+  ...     chunk_layout=ts.ChunkLayout(read_chunk_shape=[100, 200]),
+  ...     create=True)
+  >>> await store[100:200, 200:400].prefetch()
+
+Group:
+  I/O
+)");
+
   cls.def(
       "astype",
       [](Self& self, DataTypeLike target_dtype) {
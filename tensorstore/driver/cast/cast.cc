@@ -208,10 +208,25 @@ class CastDriver
             AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver)
       override;
 
+  void ReadUncached(OpenTransactionPtr transaction,
+                    IndexTransform<> transform,
+                    AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>>
+                        receiver) override;
+
   void Write(OpenTransactionPtr transaction, IndexTransform<> transform,
              AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>>
                  receiver) override;
 
+  void WriteUncached(OpenTransactionPtr transaction,
+                     IndexTransform<> transform,
+                     AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>>
+                         receiver) override;
+
+  Future<const void> Prefetch(OpenTransactionPtr transaction,
+                              IndexTransform<> transform) override {
+    return base_driver_->Prefetch(std::move(transaction), std::move(transform));
+  }
+
   Future<IndexTransform<>> ResolveBounds(
       OpenTransactionPtr transaction, IndexTransform<> transform,
       ResolveBoundsOptions options) override {
@@ -323,6 +338,15 @@ void CastDriver::Read(
                          IntrusivePtr<CastDriver>(this), std::move(receiver)});
 }
 
+void CastDriver::ReadUncached(
+    OpenTransactionPtr transaction, IndexTransform<> transform,
+    AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver) {
+  base_driver_->ReadUncached(
+      std::move(transaction), std::move(transform),
+      ChunkReceiverAdapter<ReadChunk, ReadChunkImpl>{
+          IntrusivePtr<CastDriver>(this), std::move(receiver)});
+}
+
 void CastDriver::Write(
     OpenTransactionPtr transaction, IndexTransform<> transform,
     AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver) {
@@ -331,6 +355,15 @@ void CastDriver::Write(
                           IntrusivePtr<CastDriver>(this), std::move(receiver)});
 }
 
+void CastDriver::WriteUncached(
+    OpenTransactionPtr transaction, IndexTransform<> transform,
+    AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver) {
+  base_driver_->WriteUncached(
+      std::move(transaction), std::move(transform),
+      ChunkReceiverAdapter<WriteChunk, WriteChunkImpl>{
+          IntrusivePtr<CastDriver>(this), std::move(receiver)});
+}
+
 const internal::DriverRegistration<CastDriverSpec> driver_registration;
 
 }  // namespace
@@ -147,12 +147,29 @@ void Driver::Read(internal::OpenTransactionPtr transaction,
                        absl::UnimplementedError("Reading not supported"));
 }
 
+void Driver::ReadUncached(internal::OpenTransactionPtr transaction,
+                          IndexTransform<> transform,
+                          ReadChunkReceiver receiver) {
+  Read(std::move(transaction), std::move(transform), std::move(receiver));
+}
+
+Future<const void> Driver::Prefetch(internal::OpenTransactionPtr transaction,
+                                    IndexTransform<> transform) {
+  return MakeReadyFuture();
+}
+
 void Driver::Write(internal::OpenTransactionPtr transaction,
                    IndexTransform<> transform, WriteChunkReceiver receiver) {
   execution::set_error(FlowSingleReceiver{std::move(receiver)},
                        absl::UnimplementedError("Writing not supported"));
 }
 
+void Driver::WriteUncached(internal::OpenTransactionPtr transaction,
+                           IndexTransform<> transform,
+                           WriteChunkReceiver receiver) {
+  Write(std::move(transaction), std::move(transform), std::move(receiver));
+}
+
 Future<IndexTransform<>> Driver::Resize(OpenTransactionPtr transaction,
                                         IndexTransform<> transform,
                                         span<const Index> inclusive_min,
@@ -177,6 +177,30 @@ class Driver : public AtomicReferenceCount<Driver> {
   virtual void Read(internal::OpenTransactionPtr transaction,
                     IndexTransform<> transform, ReadChunkReceiver receiver);
 
+  /// Same as `Read`, except that data not already cached is read without
+  /// being added to the cache, as specified by `ReadCacheMode::bypass`.
+  ///
+  /// The default implementation simply calls `Read`.
+  virtual void ReadUncached(internal::OpenTransactionPtr transaction,
+                            IndexTransform<> transform,
+                            ReadChunkReceiver receiver);
+
+  /// Asynchronously loads the data corresponding to the output range of
+  /// `transform` into the cache, without returning it, in order to reduce the
+  /// latency of a subsequent `Read`.
+  ///
+  /// This is only a hint: the data may be evicted again before it is read, and
+  /// drivers without a cache may ignore the request entirely.
+  ///
+  /// The default implementation does nothing and returns a ready future.
+  ///
+  /// \pre The output range of `transform` must be a subset of the output range
+  ///     of a transform returned from a prior call to `ResolveBounds`,
+  ///     `Resize`, or the transform returned when the driver was opened.
+  /// \returns A future that becomes ready once the data has been loaded.
+  virtual Future<const void> Prefetch(internal::OpenTransactionPtr transaction,
+                                      IndexTransform<> transform);
+
   using WriteChunkReceiver =
       AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>>;
 
@@ -199,6 +223,15 @@ class Driver : public AtomicReferenceCount<Driver> {
   virtual void Write(internal::OpenTransactionPtr transaction,
                      IndexTransform<> transform, WriteChunkReceiver receiver);
 
+  /// Same as `Write`, except that chunks that are entirely overwritten may be
+  /// encoded and written directly to the underlying storage, without being
+  /// added to the cache, as specified by `WriteCacheMode::bypass`.
+  ///
+  /// The default implementation simply calls `Write`.
+  virtual void WriteUncached(internal::OpenTransactionPtr transaction,
+                             IndexTransform<> transform,
+                             WriteChunkReceiver receiver);
+
   /// Resolves implicit bounds of `transform`.
   ///
   /// Typically `ResolveBounds` is called before reading with a transform
@@ -14,6 +14,12 @@
 
 #include "tensorstore/driver/kvs_backed_chunk_driver.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
 #include "absl/container/fixed_array.h"
 #include "absl/status/status.h"
 #include "tensorstore/driver/kvs_backed_chunk_driver_impl.h"
@@ -22,11 +28,13 @@
 #include "tensorstore/internal/cache/cache_pool_resource.h"
 #include "tensorstore/internal/cache_key/cache_key.h"
 #include "tensorstore/internal/data_copy_concurrency_resource.h"
+#include "tensorstore/internal/data_type_endian_conversion.h"
 #include "tensorstore/internal/json_binding/staleness_bound.h"
 #include "tensorstore/internal/logging.h"
 #include "tensorstore/internal/path.h"
 #include "tensorstore/internal/unowned_to_shared.h"
 #include "tensorstore/tensorstore.h"
+#include "tensorstore/util/executor.h"
 #include "tensorstore/util/iterate_over_index_range.h"
 #include "tensorstore/util/quote_string.h"
 
@@ -97,6 +105,199 @@ Result<CodecSpec> DataCache::GetCodec(const void* metadata,
   return CodecSpec{};
 }
 
+std::optional<DataCache::UncompressedChunkLayout>
+DataCache::GetUncompressedChunkLayout(const void* metadata,
+                                      std::size_t component_index) {
+  return std::nullopt;
+}
+
+absl::Status DataCache::ValidateUncompressedChunkHeader(
+    const void* metadata, std::string_view header) {
+  return absl::OkStatus();
+}
+
+namespace {
+
+/// Returns `array` translated from a zero origin to `origin`.
+SharedOffsetArray<const void> TranslateToOrigin(
+    SharedArrayView<const void> array, span<const Index> origin) {
+  StridedLayout<dynamic_rank, offset_origin> layout(origin, array.shape(),
+                                                    array.byte_strides());
+  return {AddByteOffset(std::move(array.element_pointer()),
+                        -layout.origin_byte_offset()),
+          std::move(layout)};
+}
+
+/// Returns the range of bytes of a chunk encoded with `layout` that contains
+/// the sub-region `box` of the component array, relative to the cell origin.
+ByteRange GetEncodedByteRange(
+    const DataCache::UncompressedChunkLayout& layout, BoxView<> box) {
+  Index inclusive_min = layout.byte_offset;
+  Index inclusive_max = layout.byte_offset;
+  for (DimensionIndex i = 0; i < box.rank(); ++i) {
+    const Index a = layout.byte_strides[i] * box.origin()[i];
+    const Index b = layout.byte_strides[i] * (box[i].inclusive_max());
+    inclusive_min += std::min(a, b);
+    inclusive_max += std::max(a, b);
+  }
+  return {static_cast<std::uint64_t>(inclusive_min),
+          static_cast<std::uint64_t>(inclusive_max + layout.dtype.size())};
+}
+
+/// Fallback for `DataCache::ReadPartialCell` that reads the entire cell into
+/// the cache.
+void ReadEntireCell(Promise<SharedOffsetArray<const void>> promise,
+                    internal::PinnedCacheEntry<DataCache> entry,
+                    std::size_t component_index, absl::Time staleness) {
+  auto read_future = entry->Read(staleness);
+  LinkValue(
+      [entry = std::move(entry), component_index](
+          Promise<SharedOffsetArray<const void>> promise,
+          ReadyFuture<const void> future) {
+        auto& grid = GetOwningCache(*entry).grid();
+        const auto& component_spec = grid.components[component_index];
+        absl::FixedArray<Index, internal::kNumInlinedDims> origin(
+            component_spec.rank());
+        grid.GetComponentOrigin(component_index, entry->cell_indices(),
+                                origin);
+        auto array = internal::ChunkCache::GetReadComponent(
+            internal::AsyncCache::ReadLock<internal::ChunkCache::ReadData>(
+                *entry)
+                .data(),
+            component_index);
+        if (!array.valid()) array = component_spec.fill_value;
+        promise.SetResult(TranslateToOrigin(std::move(array), origin));
+      },
+      std::move(promise), std::move(read_future));
+}
+
+}  // namespace
+
+Future<SharedOffsetArray<const void>> DataCache::ReadPartialCell(
+    internal::ChunkCache::Entry& base_entry, std::size_t component_index,
+    IndexTransformView<> chunk_transform, absl::Time staleness) {
+  auto& entry = static_cast<Entry&>(base_entry);
+  auto layout =
+      GetUncompressedChunkLayout(initial_metadata_.get(), component_index);
+  if (!layout) return {};
+  {
+    // The partially-read data is not cached.  If there is existing cached
+    // data or a retained encoded value, revalidating it by reading the entire
+    // chunk is likely to be cheaper, and avoids discarding it.
+    AsyncCache::ReadLock<void> lock(entry);
+    if (lock.stamp().time != absl::InfinitePast() ||
+        !StorageGeneration::IsUnknown(lock.stamp().generation) ||
+        entry.GetEncodedValueSize() != 0) {
+      return {};
+    }
+  }
+  if (spill_store() && !cache_identifier().empty()) return {};
+
+  // Compute the bounding box, relative to the cell origin, of the portion of
+  // the cell that is accessed.
+  const auto& component_spec = grid().components[component_index];
+  const DimensionIndex rank = component_spec.rank();
+  Box<dynamic_rank(internal::kNumInlinedDims)> bounds(rank);
+  if (!GetOutputRange(chunk_transform, bounds).ok()) return {};
+  absl::FixedArray<Index, internal::kNumInlinedDims> cell_origin(rank);
+  grid().GetComponentOrigin(component_index, entry.cell_indices(),
+                            cell_origin);
+  for (DimensionIndex i = 0; i < rank; ++i) {
+    const Index inclusive_min =
+        std::max(bounds.origin()[i], cell_origin[i]) - cell_origin[i];
+    const Index exclusive_max =
+        std::min(bounds[i].exclusive_max(),
+                 cell_origin[i] + component_spec.shape()[i]) -
+        cell_origin[i];
+    if (inclusive_min >= exclusive_max) return {};
+    bounds[i] = IndexInterval::UncheckedHalfOpen(inclusive_min, exclusive_max);
+  }
+
+  // Read the entire chunk instead if a large fraction of it is needed anyway.
+  const ByteRange byte_range = GetEncodedByteRange(*layout, bounds);
+  if (byte_range.size() * 2 >
+      GetEncodedByteRange(*layout, BoxView<>(component_spec.shape())).size()) {
+    return {};
+  }
+
+  kvstore::ReadOptions options;
+  options.staleness_bound = staleness;
+  options.byte_range = byte_range;
+  const std::string key = entry.GetKeyValueStoreKey();
+  auto data_future = kvstore_driver()->Read(key, options);
+  auto header_future = data_future;
+  if (layout->header_size > 0) {
+    options.byte_range = OptionalByteRangeRequest(0, layout->header_size);
+    header_future = kvstore_driver()->Read(key, std::move(options));
+  }
+  auto pair = PromiseFuturePair<SharedOffsetArray<const void>>::Make();
+  Link(WithExecutor(
+           executor(),
+           [self = internal::CachePtr<DataCache>(this),
+            entry = internal::PinnedCacheEntry<DataCache>(&entry),
+            component_index, staleness, layout = std::move(*layout),
+            bounds = std::move(bounds), byte_range](
+               Promise<SharedOffsetArray<const void>> promise,
+               ReadyFuture<kvstore::ReadResult> data_future,
+               ReadyFuture<kvstore::ReadResult> header_future) mutable {
+             // Any error, or a chunk that was modified concurrently or cannot
+             // be decoded partially, is handled by reading the entire chunk
+             // normally.
+             if (!data_future.result().ok() ||
+                 !header_future.result().ok()) {
+               ReadEntireCell(std::move(promise), std::move(entry),
+                              component_index, staleness);
+               return;
+             }
+             auto data = data_future.value();
+             auto header = header_future.value();
+             auto& grid = self->grid();
+             const auto& component_spec = grid.components[component_index];
+             const DimensionIndex rank = component_spec.rank();
+             absl::FixedArray<Index, internal::kNumInlinedDims> origin(rank);
+             grid.GetComponentOrigin(component_index, entry->cell_indices(),
+                                     origin);
+             if (data.state == kvstore::ReadResult::kMissing &&
+                 header.state == kvstore::ReadResult::kMissing) {
+               promise.SetResult(
+                   TranslateToOrigin(component_spec.fill_value, origin));
+               return;
+             }
+             if (!data.has_value() || !header.has_value() ||
+                 data.stamp.generation != header.stamp.generation ||
+                 data.value.size() != byte_range.size() ||
+                 (layout.header_size > 0 &&
+                  !self->ValidateUncompressedChunkHeader(
+                           self->initial_metadata_.get(),
+                           header.value.Flatten())
+                       .ok())) {
+               ReadEntireCell(std::move(promise), std::move(entry),
+                              component_index, staleness);
+               return;
+             }
+             auto flat_data = data.value.Flatten();
+             Index offset = layout.byte_offset - byte_range.inclusive_min;
+             for (DimensionIndex i = 0; i < rank; ++i) {
+               offset += layout.byte_strides[i] * bounds.origin()[i];
+               origin[i] += bounds.origin()[i];
+             }
+             ArrayView<const void> source_array(
+                 ElementPointer<const void>(
+                     static_cast<const void*>(flat_data.data() + offset),
+                     layout.dtype),
+                 StridedLayoutView<>(bounds.shape(), layout.byte_strides));
+             auto decoded_array = AllocateArray(bounds.shape(), c_order,
+                                                default_init, layout.dtype);
+             internal::DecodeArray(source_array, layout.endianness,
+                                   decoded_array);
+             promise.SetResult(
+                 TranslateToOrigin(std::move(decoded_array), origin));
+           }),
+       std::move(pair.promise), std::move(data_future),
+       std::move(header_future));
+  return std::move(pair.future);
+}
+
 namespace {
 
 // Address of this variable is used to signal an invalid metadata value.
@@ -1113,6 +1314,99 @@ void MetadataCache::Entry::DoEncode(std::shared_ptr<const void> data,
   }
 }
 
+Future<SharedOffsetArray<const void>> DataCache::ReadCellUncached(
+    internal::ChunkCache::Entry& base_entry, std::size_t component_index,
+    absl::Time staleness) {
+  auto& entry = static_cast<Entry&>(base_entry);
+  kvstore::ReadOptions options;
+  options.staleness_bound = staleness;
+  auto read_future =
+      kvstore_driver()->Read(entry.GetKeyValueStoreKey(), std::move(options));
+  auto pair = PromiseFuturePair<SharedOffsetArray<const void>>::Make();
+  Link(WithExecutor(
+           executor(),
+           [self = internal::CachePtr<DataCache>(this),
+            entry = internal::PinnedCacheEntry<DataCache>(&entry),
+            component_index](Promise<SharedOffsetArray<const void>> promise,
+                             ReadyFuture<kvstore::ReadResult> future) {
+             if (!future.result().ok()) {
+               promise.SetResult(
+                   entry->AnnotateError(future.status(), /*reading=*/true));
+               return;
+             }
+             const auto& read_result = future.value();
+             auto& grid = self->grid();
+             const auto& component_spec = grid.components[component_index];
+             absl::FixedArray<Index, internal::kNumInlinedDims> origin(
+                 component_spec.rank());
+             grid.GetComponentOrigin(component_index, entry->cell_indices(),
+                                     origin);
+             if (!read_result.has_value()) {
+               promise.SetResult(
+                   TranslateToOrigin(component_spec.fill_value, origin));
+               return;
+             }
+             auto decoded_result =
+                 self->DecodeChunk(self->initial_metadata_.get(),
+                                   entry->cell_indices(), read_result.value);
+             if (!decoded_result.ok()) {
+               promise.SetResult(entry->AnnotateError(
+                   internal::ConvertInvalidArgumentToFailedPrecondition(
+                       std::move(decoded_result).status()),
+                   /*reading=*/true));
+               return;
+             }
+             promise.SetResult(TranslateToOrigin(
+                 std::move((*decoded_result)[component_index]), origin));
+           }),
+       std::move(pair.promise), std::move(read_future));
+  return std::move(pair.future);
+}
+
+Future<const void> DataCache::WriteCellUncached(
+    internal::ChunkCache::Entry& base_entry, SharedArray<const void> array) {
+  auto& entry = static_cast<Entry&>(base_entry);
+  const auto& component_spec = grid().components[0];
+  Future<TimestampedStorageGeneration> write_future;
+  // Size of the encoded chunk, which is charged to the writeback accounting of
+  // the cache pool until the write completes, as for cached writes.
+  size_t encoded_size = 0;
+  if (!component_spec.store_if_equal_to_fill_value &&
+      AreArraysSameValueEqual(array, component_spec.fill_value)) {
+    write_future = kvstore_driver()->Delete(entry.GetKeyValueStoreKey());
+  } else {
+    const SharedArrayView<const void> component_arrays[] = {std::move(array)};
+    auto encoded_result = EncodeChunk(initial_metadata_.get(),
+                                      entry.cell_indices(), component_arrays);
+    if (!encoded_result.ok()) {
+      return entry.AnnotateError(encoded_result.status(), /*reading=*/false);
+    }
+    encoded_size = encoded_result->size();
+    AddUncachedWritebackBytes(encoded_size);
+    write_future = kvstore_driver()->Write(entry.GetKeyValueStoreKey(),
+                                           std::move(*encoded_result));
+  }
+  // Discard any cached copy both now, so that a subsequent read does not
+  // return the old value from the cache, and once the write completes, in
+  // case a concurrent read cached the old value in the meantime.
+  entry.DiscardReadState();
+  return MapFuture(
+      InlineExecutor{},
+      [entry = internal::PinnedCacheEntry<DataCache>(&entry), encoded_size](
+          const Result<TimestampedStorageGeneration>& result)
+          -> Result<void> {
+        if (encoded_size != 0) {
+          GetOwningCache(*entry).ReleaseUncachedWritebackBytes(encoded_size);
+        }
+        entry->DiscardReadState();
+        if (!result.ok()) {
+          return entry->AnnotateError(result.status(), /*reading=*/false);
+        }
+        return absl::OkStatus();
+      },
+      std::move(write_future));
+}
+
 std::string DataCache::Entry::GetKeyValueStoreKey() {
   auto& cache = GetOwningCache(*this);
   return cache.GetChunkStorageKey(cache.initial_metadata_.get(),
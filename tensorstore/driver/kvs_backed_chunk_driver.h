@@ -22,11 +22,14 @@
 /// chunk.
 
 #include <memory>
+#include <optional>
 #include <string_view>
 
 #include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
+#include "tensorstore/array.h"
 #include "tensorstore/box.h"
+#include "tensorstore/data_type.h"
 #include "tensorstore/driver/registry.h"
 #include "tensorstore/index.h"
 #include "tensorstore/index_space/index_transform.h"
@@ -47,6 +50,7 @@
 #include "tensorstore/open_mode.h"
 #include "tensorstore/serialization/absl_time.h"
 #include "tensorstore/spec.h"
+#include "tensorstore/util/endian.h"
 #include "tensorstore/util/future.h"
 #include "tensorstore/util/result.h"
 
@@ -424,6 +428,53 @@ class DataCache
       const void* metadata, span<const Index> chunk_indices,
       span<const SharedArrayView<const void>> component_arrays) = 0;
 
+  /// Layout of a component array within an encoded chunk that is stored
+  /// without compression.
+  struct UncompressedChunkLayout {
+    /// Offset in bytes of the first element of the array within the chunk.
+    Index byte_offset = 0;
+
+    /// Data type and byte order of the encoded elements.
+    DataType dtype;
+    endian endianness = endian::native;
+
+    /// Byte strides of the encoded array, of length equal to the component
+    /// rank.  The shape is equal to `grid.components[i].shape()`.
+    absl::InlinedVector<Index, internal::kNumInlinedDims> byte_strides;
+
+    /// Size in bytes of a header at the start of the chunk that must be
+    /// checked by `ValidateUncompressedChunkHeader`, or `0` if there is no
+    /// header to check.
+    Index header_size = 0;
+  };
+
+  /// Returns the layout of the specified component array within encoded chunks,
+  /// if chunks are stored such that a portion of the array may be decoded from
+  /// a byte range of the chunk.
+  ///
+  /// This enables reads of small portions of a chunk to request just the
+  /// necessary byte range from the kvstore, without reading the chunk into the
+  /// cache.
+  ///
+  /// By default, returns `std::nullopt` to indicate that the entire chunk must
+  /// always be read.
+  ///
+  /// \param metadata Non-null pointer to the metadata of type `Metadata`.
+  /// \param component_index The ChunkCache component index.
+  virtual std::optional<UncompressedChunkLayout> GetUncompressedChunkLayout(
+      const void* metadata, std::size_t component_index);
+
+  /// Validates the header, of length `UncompressedChunkLayout::header_size`, of
+  /// a chunk that is read partially.
+  ///
+  /// If an error is returned, the entire chunk is read and decoded normally
+  /// instead.
+  ///
+  /// \param metadata Non-null pointer to the metadata of type `Metadata`.
+  /// \param header The first `header_size` bytes of the chunk.
+  virtual absl::Status ValidateUncompressedChunkHeader(const void* metadata,
+                                                       std::string_view header);
+
   // The members below are implementation details not relevant to derived class
   // driver implementations.
 
@@ -443,6 +494,23 @@ class DataCache
     return new TransactionNode(static_cast<Entry&>(entry));
   }
 
+  Future<SharedOffsetArray<const void>> ReadPartialCell(
+      internal::ChunkCache::Entry& entry, std::size_t component_index,
+      IndexTransformView<> chunk_transform, absl::Time staleness) override;
+
+  Future<SharedOffsetArray<const void>> ReadCellUncached(
+      internal::ChunkCache::Entry& entry, std::size_t component_index,
+      absl::Time staleness) override;
+
+  bool SupportsWriteCellUncached() override { return true; }
+
+  /// Encodes `array` and writes it to the kvstore unconditionally, or deletes
+  /// the chunk if it equals the fill value (unless
+  /// `store_if_equal_to_fill_value` is set).
+  Future<const void> WriteCellUncached(
+      internal::ChunkCache::Entry& entry,
+      SharedArray<const void> array) override;
+
   /// Returns the kvstore path to include in the spec.
   virtual std::string GetBaseKvstorePath() = 0;
 
@@ -14,9 +14,15 @@
 
 #include "tensorstore/driver/driver.h"
 
+#include <optional>
+#include <string_view>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/fixed_array.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "tensorstore/context.h"
+#include "tensorstore/contiguous_layout.h"
 #include "tensorstore/data_type.h"
 #include "tensorstore/driver/kvs_backed_chunk_driver.h"
 #include "tensorstore/driver/n5/metadata.h"
@@ -29,6 +35,7 @@
 #include "tensorstore/kvstore/kvstore.h"
 #include "tensorstore/tensorstore.h"
 #include "tensorstore/util/constant_vector.h"
+#include "tensorstore/util/endian.h"
 #include "tensorstore/util/future.h"
 
 namespace tensorstore {
@@ -241,6 +248,38 @@ class DataCache : public internal_kvs_backed_chunk_driver::DataCache {
                                     component_arrays[0]);
   }
 
+  std::optional<UncompressedChunkLayout> GetUncompressedChunkLayout(
+      const void* metadata_ptr, std::size_t component_index) override {
+    const auto& metadata = *static_cast<const N5Metadata*>(metadata_ptr);
+    if (metadata.compressor) return std::nullopt;
+    // Chunks are stored in Fortran order following the header.  Chunks at
+    // the upper bound may be stored with a reduced shape, which is detected
+    // by `ValidateUncompressedChunkHeader`.
+    UncompressedChunkLayout layout;
+    layout.header_size = internal_n5::GetChunkHeaderSize(metadata);
+    layout.byte_offset = layout.header_size;
+    layout.dtype = metadata.dtype;
+    layout.endianness = endian::big;
+    layout.byte_strides.resize(metadata.rank);
+    ComputeStrides(fortran_order, metadata.dtype.size(),
+                   metadata.chunk_layout.shape(), layout.byte_strides);
+    return layout;
+  }
+
+  absl::Status ValidateUncompressedChunkHeader(
+      const void* metadata_ptr, std::string_view header) override {
+    const auto& metadata = *static_cast<const N5Metadata*>(metadata_ptr);
+    absl::FixedArray<Index, internal::kNumInlinedDims> shape(metadata.rank);
+    TENSORSTORE_RETURN_IF_ERROR(
+        internal_n5::DecodeChunkHeader(metadata, header, shape));
+    if (!absl::c_equal(shape, metadata.chunk_layout.shape())) {
+      return absl::InvalidArgumentError(
+          StrCat("Received chunk of size ", span<const Index>(shape),
+                 " but expected blockSize of ", metadata.chunk_layout.shape()));
+    }
+    return absl::OkStatus();
+  }
+
   std::string GetChunkStorageKey(const void* metadata,
                                  span<const Index> cell_indices) override {
     // Use "0" for rank 0 as a special case.
@@ -184,22 +184,9 @@ std::size_t GetChunkHeaderSize(const N5Metadata& metadata) {
       sizeof(std::uint32_t) * metadata.rank;  // dimensions
 }
 
-Result<SharedArrayView<const void>> DecodeChunk(const N5Metadata& metadata,
-                                                absl::Cord buffer) {
-  // TODO(jbms): Currently, we do not check that `buffer.size()` is less than
-  // the 2GiB limit, although we do implicitly check that the decoded array data
-  // within the chunk is within the 2GiB limit due to the checks on the block
-  // size.  Determine if this is an important limit.
-  SharedArrayView<const void> array;
-  array.layout() = metadata.chunk_layout;
-  const std::size_t header_size = GetChunkHeaderSize(metadata);
-  if (buffer.size() < header_size) {
-    return absl::InvalidArgumentError(
-        StrCat("Expected header of length ", header_size,
-               ", but chunk has size ", buffer.size()));
-  }
-  auto header_cord = buffer.Subcord(0, header_size);
-  auto header = header_cord.Flatten();
+absl::Status DecodeChunkHeader(const N5Metadata& metadata,
+                               std::string_view header, span<Index> shape) {
+  assert(header.size() == GetChunkHeaderSize(metadata));
   std::uint16_t mode = absl::big_endian::Load16(header.data());
   switch (mode) {
     case 0:  // default
@@ -216,19 +203,38 @@ Result<SharedArrayView<const void>> DecodeChunk(const N5Metadata& metadata,
                                              " dimensions but expected ",
                                              metadata.rank));
   }
-  Array<const void, dynamic_rank(internal::kNumInlinedDims)> encoded_array;
-  encoded_array.layout().set_rank(metadata.rank);
   for (DimensionIndex i = 0; i < num_dims; ++i) {
-    encoded_array.shape()[i] =
-        absl::big_endian::Load32(header.data() + 4 + i * 4);
+    shape[i] = absl::big_endian::Load32(header.data() + 4 + i * 4);
   }
   for (DimensionIndex i = 0; i < num_dims; ++i) {
-    if (encoded_array.shape()[i] > metadata.chunk_layout.shape()[i]) {
+    if (shape[i] > metadata.chunk_layout.shape()[i]) {
       return absl::InvalidArgumentError(StrCat(
-          "Received chunk of size ", encoded_array.shape(),
-          " which exceeds blockSize of ", metadata.chunk_layout.shape()));
+          "Received chunk of size ", shape, " which exceeds blockSize of ",
+          metadata.chunk_layout.shape()));
     }
   }
+  return absl::OkStatus();
+}
+
+Result<SharedArrayView<const void>> DecodeChunk(const N5Metadata& metadata,
+                                                absl::Cord buffer) {
+  // TODO(jbms): Currently, we do not check that `buffer.size()` is less than
+  // the 2GiB limit, although we do implicitly check that the decoded array data
+  // within the chunk is within the 2GiB limit due to the checks on the block
+  // size.  Determine if this is an important limit.
+  SharedArrayView<const void> array;
+  array.layout() = metadata.chunk_layout;
+  const std::size_t header_size = GetChunkHeaderSize(metadata);
+  if (buffer.size() < header_size) {
+    return absl::InvalidArgumentError(
+        StrCat("Expected header of length ", header_size,
+               ", but chunk has size ", buffer.size()));
+  }
+  Array<const void, dynamic_rank(internal::kNumInlinedDims)> encoded_array;
+  encoded_array.layout().set_rank(metadata.rank);
+  TENSORSTORE_RETURN_IF_ERROR(DecodeChunkHeader(
+      metadata, buffer.Subcord(0, header_size).Flatten(),
+      encoded_array.shape()));
   size_t decoded_offset = header_size;
   if (metadata.compressor) {
     // TODO(jbms): Change compressor interface to allow the output size to be
@@ -16,6 +16,7 @@
 #define TENSORSTORE_DRIVER_N5_METADATA_H_
 
 #include <string>
+#include <string_view>
 
 #include "absl/status/status.h"
 #include <nlohmann/json.hpp>
@@ -219,6 +220,19 @@ Result<DimensionUnitsVector> GetEffectiveDimensionUnits(
     const N5Metadata::UnitsAndResolution& units_and_resolution,
     Schema::DimensionUnits schema_units);
 
+/// Returns the size in bytes of the header of an encoded chunk.
+std::size_t GetChunkHeaderSize(const N5Metadata& metadata);
+
+/// Decodes the header of an encoded chunk.
+///
+/// \param header The first `GetChunkHeaderSize(metadata)` bytes of the chunk.
+/// \param shape[out] Array of length `metadata.rank` set to the shape of the
+///     encoded chunk data, which may be less than the `blockSize`.
+/// \error `absl::StatusCode::kInvalidArgument` if the header is invalid or
+///     not supported.
+absl::Status DecodeChunkHeader(const N5Metadata& metadata,
+                               std::string_view header, span<Index> shape);
+
 /// Decodes a chunk.
 ///
 /// The layout of the returned array is only valid as long as `metadata`.
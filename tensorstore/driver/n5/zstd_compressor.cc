@@ -0,0 +1,66 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/// \file
+/// Defines the "zstd" compressor for n5.  Linking in this library
+/// automatically registers it.
+///
+/// The JSON representation is compatible with the n5-zstandard Java library.
+
+#include "tensorstore/internal/compression/zstd_compressor.h"
+
+#include "tensorstore/driver/n5/compressor.h"
+#include "tensorstore/driver/n5/compressor_registry.h"
+#include "tensorstore/internal/compression/zstd.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+
+namespace tensorstore {
+namespace internal_n5 {
+namespace {
+
+struct ZstdCompressor : public internal::ZstdCompressor {
+  /// Number of threads used for encoding by n5-zstandard.  This does not
+  /// affect the encoded format and is only retained for round tripping.
+  int nb_workers = 0;
+};
+
+struct Registration {
+  Registration() {
+    namespace jb = tensorstore::internal_json_binding;
+    RegisterCompressor<ZstdCompressor>(
+        "zstd",
+        jb::Object(
+            jb::Member(
+                "level",
+                jb::Projection(
+                    &ZstdCompressor::level,
+                    jb::DefaultValue<jb::kAlwaysIncludeDefaults>(
+                        [](auto* v) { *v = 3; },
+                        jb::Integer<int>(zstd::kMinLevel, zstd::kMaxLevel)))),
+            jb::Member("useChecksums",
+                       jb::Projection(&ZstdCompressor::use_checksum,
+                                      jb::DefaultValue<jb::kAlwaysIncludeDefaults>(
+                                          [](auto* v) { *v = false; }))),
+            jb::Member("nbWorkers",
+                       jb::Projection(&ZstdCompressor::nb_workers,
+                                      jb::DefaultValue<jb::kAlwaysIncludeDefaults>(
+                                          [](auto* v) { *v = 0; },
+                                          jb::Integer<int>(0))))));
+  }
+} registration;
+
+}  // namespace
+}  // namespace internal_n5
+}  // namespace tensorstore
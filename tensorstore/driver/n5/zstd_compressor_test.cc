@@ -0,0 +1,94 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstdint>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorstore/array.h"
+#include "tensorstore/driver/n5/compressor.h"
+#include "tensorstore/driver/n5/metadata.h"
+#include "tensorstore/internal/json_binding/gtest.h"
+#include "tensorstore/internal/json_gtest.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+using ::tensorstore::Index;
+using ::tensorstore::MakeArray;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::span;
+using ::tensorstore::internal_n5::Compressor;
+using ::tensorstore::internal_n5::DecodeChunk;
+using ::tensorstore::internal_n5::N5Metadata;
+
+TEST(ZstdCompressionTest, Parse) {
+  tensorstore::TestJsonBinderRoundTripJsonOnlyInexact<Compressor>({
+      // Parse without any options.
+      {{{"type", "zstd"}},
+       {{"type", "zstd"},
+        {"level", 3},
+        {"useChecksums", false},
+        {"nbWorkers", 0}}},
+      // Parse with options.
+      {{{"type", "zstd"},
+        {"level", -2},
+        {"useChecksums", true},
+        {"nbWorkers", 4}},
+       {{"type", "zstd"},
+        {"level", -2},
+        {"useChecksums", true},
+        {"nbWorkers", 4}}},
+  });
+
+  // Invalid level option type
+  EXPECT_THAT(Compressor::FromJson({{"type", "zstd"}, {"level", "x"}}),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+
+  // Invalid level option value
+  EXPECT_THAT(Compressor::FromJson({{"type", "zstd"}, {"level", 23}}),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+
+  // Invalid nbWorkers option value
+  EXPECT_THAT(Compressor::FromJson({{"type", "zstd"}, {"nbWorkers", -1}}),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+
+  // Invalid extra option
+  EXPECT_THAT(Compressor::FromJson({{"type", "zstd"}, {"extra", "x"}}),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ZstdCompressionTest, RoundTrip) {
+  for (bool use_checksums : {false, true}) {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto metadata,
+        N5Metadata::FromJson({{"dimensions", {10, 11, 12}},
+                              {"blockSize", {1, 2, 3}},
+                              {"dataType", "uint16"},
+                              {"compression",
+                               {{"type", "zstd"},
+                                {"useChecksums", use_checksums}}}}));
+    auto array = MakeArray<std::uint16_t>({{{1, 3, 5}, {2, 4, 6}}});
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto buffer,
+        EncodeChunk(span<const Index>({0, 0, 0}), metadata, array));
+    EXPECT_EQ(array, DecodeChunk(metadata, buffer));
+  }
+}
+
+}  // namespace
@@ -76,8 +76,9 @@ namespace {
 ///    Otherwise, allocates a new `target` array with a domain given by the
 ///    source bounds.
 ///
-/// 3. Calls `Driver::Read` with a `ReadChunkReceiver` to initiate the actual
-///    read over the resolved `source.transform` bounds.  `ReadChunkReceiver`
+/// 3. Calls `Driver::Read` (or `Driver::ReadUncached`, depending on the
+///    `ReadCacheMode`) with a `ReadChunkReceiver` to initiate the actual read
+///    over the resolved `source.transform` bounds.  `ReadChunkReceiver`
 ///    ensures that the read is canceled if `promise.result_needed()` becomes
 ///    `false`.
 ///
@@ -102,6 +103,7 @@ struct ReadState
   DataTypeConversionLookupResult data_type_conversion;
   TransformedArray<Shared<void>> target;
   DomainAlignmentOptions alignment_options;
+  ReadCacheMode cache_mode;
   ReadProgressFunction read_progress_function;
   Promise<PromiseValue> promise;
   std::atomic<Index> copied_elements{0};
@@ -164,6 +166,24 @@ struct ReadChunkReceiver {
   }
 };
 
+/// Initiates the read on the source driver, according to `state->cache_mode`.
+template <typename PromiseValue>
+void InitiateDriverRead(IntrusivePtr<ReadState<PromiseValue>> state,
+                        IndexTransform<> source_transform) {
+  auto source_driver = std::move(state->source_driver);
+  auto source_transaction = std::move(state->source_transaction);
+  const ReadCacheMode cache_mode = state->cache_mode;
+  ReadChunkReceiver<PromiseValue> receiver{std::move(state)};
+  if (cache_mode == ReadCacheMode::bypass) {
+    source_driver->ReadUncached(std::move(source_transaction),
+                                std::move(source_transform),
+                                std::move(receiver));
+  } else {
+    source_driver->Read(std::move(source_transaction),
+                        std::move(source_transform), std::move(receiver));
+  }
+}
+
 /// Callback used by `DriverRead` to initiate a read into an existing array once
 /// the source transform bounds have been resolved.
 struct DriverReadIntoExistingInitiateOp {
@@ -183,11 +203,7 @@ struct DriverReadIntoExistingInitiateOp {
     state->total_elements = source_transform.domain().num_elements();
 
     // Initiate the read on the driver.
-    auto source_driver = std::move(state->source_driver);
-    auto source_transaction = std::move(state->source_transaction);
-    source_driver->Read(std::move(source_transaction),
-                        std::move(source_transform),
-                        ReadChunkReceiver<void>{std::move(state)});
+    InitiateDriverRead(std::move(state), std::move(source_transform));
   }
 };
 
@@ -210,11 +226,7 @@ struct DriverReadIntoNewInitiateOp {
     state->total_elements = source_transform.input_domain().num_elements();
 
     // Initiate the read on the driver.
-    auto source_driver = std::move(state->source_driver);
-    auto source_transaction = std::move(state->source_transaction);
-    source_driver->Read(
-        std::move(source_transaction), std::move(source_transform),
-        ReadChunkReceiver<SharedOffsetArray<void>>{std::move(state)});
+    InitiateDriverRead(std::move(state), std::move(source_transform));
   }
 };
 
@@ -238,6 +250,7 @@ Future<void> DriverRead(Executor executor, DriverHandle source,
       internal::AcquireOpenTransactionPtrOrError(source.transaction));
   state->target = std::move(target);
   state->alignment_options = options.alignment_options;
+  state->cache_mode = options.cache_mode;
   state->read_progress_function = std::move(options.progress_function);
   auto pair = PromiseFuturePair<void>::Make(MakeResult());
 
@@ -260,7 +273,10 @@ Future<void> DriverRead(DriverHandle source,
   return internal::DriverRead(
       std::move(executor), std::move(source), std::move(target), /*options=*/
       {/*.progress_function=*/std::move(options.progress_function),
-       /*.alignment_options=*/options.alignment_options});
+       /*.alignment_options=*/options.alignment_options,
+       /*.data_type_conversion_flags=*/
+       DataTypeConversionFlags::kSafeAndImplicit,
+       /*.cache_mode=*/options.cache_mode});
 }
 
 Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
@@ -279,6 +295,7 @@ Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
   TENSORSTORE_ASSIGN_OR_RETURN(
       state->source_transaction,
       internal::AcquireOpenTransactionPtrOrError(source.transaction));
+  state->cache_mode = options.cache_mode;
   state->read_progress_function = std::move(options.progress_function);
   auto pair = PromiseFuturePair<SharedOffsetArray<void>>::Make();
 
@@ -303,7 +320,34 @@ Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
   return internal::DriverReadIntoNewArray(
       std::move(executor), std::move(source), dtype, options.layout_order,
       /*options=*/
-      {/*.progress_function=*/std::move(options.progress_function)});
+      {/*.progress_function=*/std::move(options.progress_function),
+       /*.cache_mode=*/options.cache_mode});
+}
+
+Future<void> DriverPrefetch(DriverHandle source) {
+  TENSORSTORE_RETURN_IF_ERROR(
+      internal::ValidateSupportsRead(source.driver.read_write_mode()));
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      auto transaction,
+      internal::AcquireOpenTransactionPtrOrError(source.transaction));
+  auto pair = PromiseFuturePair<void>::Make(MakeResult());
+
+  // Resolve the bounds for `source.transform`.
+  auto transform_future = source.driver->ResolveBounds(
+      transaction, std::move(source.transform), fix_resizable_bounds);
+
+  // Initiate the prefetch once the bounds have been resolved.
+  LinkValue(
+      [driver = std::move(source.driver),
+       transaction = std::move(transaction)](
+          Promise<void> promise,
+          ReadyFuture<IndexTransform<>> transform_future) mutable {
+        LinkError(std::move(promise),
+                  driver->Prefetch(std::move(transaction),
+                                   std::move(transform_future.value())));
+      },
+      std::move(pair.promise), std::move(transform_future));
+  return std::move(pair.future);
 }
 
 absl::Status CopyReadChunk(
@@ -48,6 +48,8 @@ struct DriverReadOptions {
 
   DataTypeConversionFlags data_type_conversion_flags =
       DataTypeConversionFlags::kSafeAndImplicit;
+  /// Specifies whether `Driver::Read` or `Driver::ReadUncached` is used.
+  ReadCacheMode cache_mode = ReadCacheMode::cached;
 };
 
 struct DriverReadIntoNewOptions {
@@ -58,6 +60,9 @@ struct DriverReadIntoNewOptions {
   /// monotonically increasing.  The `total_elements` value does not change
   /// after the first call.
   ReadProgressFunction progress_function;
+
+  /// Specifies whether `Driver::Read` or `Driver::ReadUncached` is used.
+  ReadCacheMode cache_mode = ReadCacheMode::cached;
 };
 
 /// Copies data from a TensorStore driver to an array.
@@ -105,6 +110,14 @@ Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
 Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
     DriverHandle source, ReadIntoNewArrayOptions options);
 
+/// Loads the data of `source` into the cache of its driver, without copying
+/// it, by calling `Driver::Prefetch` once the bounds have been resolved.
+///
+/// \param source Source TensorStore.
+/// \returns A future that becomes ready when the data has been loaded or an
+///     error occurs.
+Future<void> DriverPrefetch(DriverHandle source);
+
 /// Copies `chunk` transformed by `chunk_transform` to `target`.
 absl::Status CopyReadChunk(
     ReadChunk::Impl& chunk, IndexTransform<> chunk_transform,
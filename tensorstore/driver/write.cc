@@ -65,7 +65,8 @@ namespace {
 /// 2. Validates that the resolved target bounds match the normalized bounds of
 ///    the `source` array.
 ///
-/// 3. Calls `Driver::Write` with a `WriteChunkReceiver` to initiate the actual
+/// 3. Calls `Driver::Write` (or `Driver::WriteUncached`, depending on the
+///    `WriteCacheMode`) with a `WriteChunkReceiver` to initiate the actual
 ///    write over the resolved `target_transform` bounds.  `WriteChunkReceiver`
 ///    ensures that the write is canceled when `copy_promise.result_needed()`
 ///    becomes `false`.
@@ -121,6 +122,7 @@ struct WriteState : public internal::AtomicReferenceCount<WriteState> {
   DriverPtr target_driver;
   internal::OpenTransactionPtr target_transaction;
   DomainAlignmentOptions alignment_options;
+  WriteCacheMode cache_mode;
   Promise<void> copy_promise;
   Promise<void> commit_promise;
   IntrusivePtr<CommitState> commit_state{new CommitState};
@@ -249,6 +251,12 @@ struct DriverWriteInitiateOp {
     // Initiate the write on the driver.
     auto target_driver = std::move(state->target_driver);
     auto target_transaction = std::move(state->target_transaction);
+    if (state->cache_mode == WriteCacheMode::bypass) {
+      target_driver->WriteUncached(std::move(target_transaction),
+                                   std::move(target_transform),
+                                   WriteChunkReceiver{std::move(state)});
+      return;
+    }
     target_driver->Write(std::move(target_transaction),
                          std::move(target_transform),
                          WriteChunkReceiver{std::move(state)});
@@ -274,6 +282,7 @@ WriteFutures DriverWrite(Executor executor,
       internal::AcquireOpenTransactionPtrOrError(target.transaction));
   state->source = std::move(source);
   state->alignment_options = options.alignment_options;
+  state->cache_mode = options.cache_mode;
   state->commit_state->write_progress_function =
       std::move(options.progress_function);
   auto copy_pair = PromiseFuturePair<void>::Make(MakeResult());
@@ -305,7 +314,10 @@ WriteFutures DriverWrite(TransformedSharedArray<const void> source,
       std::move(executor), std::move(source), std::move(target),
       /*options=*/
       {/*.progress_function=*/std::move(options.progress_function),
-       /*.alignment_options=*/options.alignment_options});
+       /*.alignment_options=*/options.alignment_options,
+       /*.data_type_conversion_flags=*/
+       DataTypeConversionFlags::kSafeAndImplicit,
+       /*.cache_mode=*/options.cache_mode});
 }
 
 }  // namespace internal
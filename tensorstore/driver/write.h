@@ -40,6 +40,9 @@ struct DriverWriteOptions {
 
   DataTypeConversionFlags data_type_conversion_flags =
       DataTypeConversionFlags::kSafeAndImplicit;
+
+  /// Specifies whether `Driver::Write` or `Driver::WriteUncached` is used.
+  WriteCacheMode cache_mode = WriteCacheMode::cached;
 };
 
 /// Copies data from an array to a TensorStore driver.
@@ -14,6 +14,7 @@
 
 #include "tensorstore/driver/driver.h"
 
+#include <optional>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -425,6 +426,22 @@ class DataCache : public internal_kvs_backed_chunk_driver::DataCache {
         *static_cast<const ZarrMetadata*>(metadata));
   }
 
+  std::optional<UncompressedChunkLayout> GetUncompressedChunkLayout(
+      const void* metadata_ptr, std::size_t component_index) override {
+    const auto& metadata = *static_cast<const ZarrMetadata*>(metadata_ptr);
+    if (metadata.compressor) return std::nullopt;
+    const auto& field = metadata.dtype.fields[component_index];
+    const auto& encoded_chunk_layout =
+        metadata.chunk_layout.fields[component_index].encoded_chunk_layout;
+    UncompressedChunkLayout layout;
+    layout.byte_offset = field.byte_offset;
+    layout.dtype = field.dtype;
+    layout.endianness = field.endian;
+    layout.byte_strides.assign(encoded_chunk_layout.byte_strides().begin(),
+                               encoded_chunk_layout.byte_strides().end());
+    return layout;
+  }
+
   std::string GetBaseKvstorePath() override { return key_prefix_; }
 
  private:
@@ -16,6 +16,7 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/strings/cord.h"
 #include "tensorstore/context.h"
 #include "tensorstore/driver/driver_testutil.h"
 #include "tensorstore/index_space/dim_expression.h"
@@ -29,6 +30,7 @@
 #include "tensorstore/internal/json_binding/json_binding.h"
 #include "tensorstore/internal/json_gtest.h"
 #include "tensorstore/internal/parse_json_matches.h"
+#include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/kvstore.h"
 #include "tensorstore/kvstore/memory/memory_key_value_store.h"
 #include "tensorstore/kvstore/mock_kvstore.h"
@@ -699,6 +701,229 @@ TEST_F(MockKeyValueStoreTest, CreateWithTransactionAlreadyExists) {
                             "Error writing \"prefix/.zarray\""));
 }
 
+// Tests that reading a small portion of an uncompressed chunk only requests
+// the necessary byte range.
+TEST_F(MockKeyValueStoreTest, ReadPartialUncompressedChunk) {
+  ::nlohmann::json json_spec{
+      {"driver", "zarr"},
+      {"kvstore",
+       {
+           {"driver", "mock_key_value_store"},
+           {"path", "prefix/"},
+       }},
+      {"metadata",
+       {
+           {"compressor", nullptr},
+           {"dtype", "<u2"},
+           {"shape", {8, 4}},
+           {"chunks", {4, 4}},
+       }},
+      {"recheck_cached_metadata", false},
+      {"create", true},
+  };
+  auto store_future = tensorstore::Open(json_spec, context);
+  store_future.Force();
+  mock_key_value_store->read_requests.pop()(memory_store);
+  mock_key_value_store->write_requests.pop()(memory_store);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store, store_future.result());
+
+  std::string chunk;
+  for (int i = 0; i < 16; ++i) {
+    chunk += static_cast<char>(i);
+    chunk += '\0';
+  }
+  TENSORSTORE_ASSERT_OK(memory_store->Write("prefix/0.0", absl::Cord(chunk)));
+
+  {
+    auto read_future =
+        tensorstore::Read(store | tensorstore::Dims(0).IndexSlice(1));
+    auto req = mock_key_value_store->read_requests.pop();
+    EXPECT_EQ("prefix/0.0", req.key);
+    EXPECT_EQ(tensorstore::OptionalByteRangeRequest(8, 16),
+              req.options.byte_range);
+    req(memory_store);
+    EXPECT_THAT(read_future.result(),
+                ::testing::Optional(
+                    tensorstore::MakeArray<std::uint16_t>({4, 5, 6, 7})));
+  }
+
+  // Missing chunk is read as the fill value.
+  {
+    auto read_future =
+        tensorstore::Read(store | tensorstore::Dims(0).IndexSlice(6));
+    auto req = mock_key_value_store->read_requests.pop();
+    EXPECT_EQ("prefix/1.0", req.key);
+    EXPECT_EQ(tensorstore::OptionalByteRangeRequest(16, 24),
+              req.options.byte_range);
+    req(memory_store);
+    EXPECT_THAT(read_future.result(),
+                ::testing::Optional(
+                    tensorstore::MakeArray<std::uint16_t>({0, 0, 0, 0})));
+  }
+
+  // Reading most of the chunk reads the entire chunk.
+  {
+    auto read_future = tensorstore::Read(
+        store | tensorstore::Dims(0).HalfOpenInterval(0, 3));
+    auto req = mock_key_value_store->read_requests.pop();
+    EXPECT_EQ("prefix/0.0", req.key);
+    EXPECT_EQ(tensorstore::OptionalByteRangeRequest(), req.options.byte_range);
+    req(memory_store);
+    TENSORSTORE_EXPECT_OK(read_future.result());
+  }
+}
+
+// Tests that `ReadCacheMode::bypass` does not store chunks in the cache, but
+// does use chunks that are already cached.
+TEST_F(MockKeyValueStoreTest, ReadBypassingCache) {
+  ::nlohmann::json json_spec{
+      {"driver", "zarr"},
+      {"kvstore",
+       {
+           {"driver", "mock_key_value_store"},
+           {"path", "prefix/"},
+       }},
+      {"metadata",
+       {
+           {"compressor", nullptr},
+           {"dtype", "<u2"},
+           {"shape", {2, 2}},
+           {"chunks", {2, 2}},
+       }},
+      {"recheck_cached_data", false},
+      {"recheck_cached_metadata", false},
+      {"cache_pool", {{"total_bytes_limit", 1000000}}},
+      {"create", true},
+  };
+  auto store_future = tensorstore::Open(json_spec, context);
+  store_future.Force();
+  mock_key_value_store->read_requests.pop()(memory_store);
+  mock_key_value_store->write_requests.pop()(memory_store);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store, store_future.result());
+  TENSORSTORE_ASSERT_OK(memory_store->Write(
+      "prefix/0.0", absl::Cord(std::string("\x01\0\x02\0\x03\0\x04\0", 8))));
+  auto expected = tensorstore::MakeArray<std::uint16_t>({{1, 2}, {3, 4}});
+
+  auto bypass_options = [] {
+    tensorstore::ReadIntoNewArrayOptions options;
+    options.cache_mode = tensorstore::ReadCacheMode::bypass;
+    return options;
+  };
+  for (int i = 0; i < 2; ++i) {
+    auto read_future = tensorstore::Read(store, bypass_options());
+    auto req = mock_key_value_store->read_requests.pop();
+    EXPECT_EQ("prefix/0.0", req.key);
+    req(memory_store);
+    EXPECT_THAT(read_future.result(), ::testing::Optional(expected));
+  }
+
+  {
+    auto read_future = tensorstore::Read(store);
+    mock_key_value_store->read_requests.pop()(memory_store);
+    EXPECT_THAT(read_future.result(), ::testing::Optional(expected));
+  }
+
+  // The chunk is now cached.
+  EXPECT_THAT(tensorstore::Read(store, bypass_options()).result(),
+              ::testing::Optional(expected));
+  EXPECT_TRUE(mock_key_value_store->read_requests.empty());
+}
+
+TEST_F(MockKeyValueStoreTest, WriteBypassingCache) {
+  ::nlohmann::json json_spec{
+      {"driver", "zarr"},
+      {"kvstore",
+       {
+           {"driver", "mock_key_value_store"},
+           {"path", "prefix/"},
+       }},
+      {"metadata",
+       {
+           {"compressor", nullptr},
+           {"dtype", "<u2"},
+           {"shape", {2, 4}},
+           {"chunks", {2, 2}},
+           {"fill_value", 0},
+       }},
+      {"recheck_cached_data", false},
+      {"recheck_cached_metadata", false},
+      {"cache_pool", {{"total_bytes_limit", 1000000}}},
+      {"create", true},
+  };
+  auto store_future = tensorstore::Open(json_spec, context);
+  store_future.Force();
+  mock_key_value_store->read_requests.pop()(memory_store);
+  mock_key_value_store->write_requests.pop()(memory_store);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store, store_future.result());
+
+  // Cache chunk 0.0 (missing, so equal to the fill value).
+  {
+    auto read_future =
+        tensorstore::Read(store | tensorstore::Dims(1).SizedInterval(0, 2));
+    mock_key_value_store->read_requests.pop()(memory_store);
+    TENSORSTORE_EXPECT_OK(read_future.result());
+  }
+
+  auto bypass_options = [] {
+    tensorstore::WriteOptions options;
+    options.cache_mode = tensorstore::WriteCacheMode::bypass;
+    return options;
+  };
+
+  // Chunk 0.0 is entirely overwritten and written directly, while chunk 0.1
+  // is only partially overwritten and written through the cache.
+  auto write_future = tensorstore::Write(
+      tensorstore::MakeArray<std::uint16_t>({{1, 2, 3}, {4, 5, 6}}),
+      store | tensorstore::Dims(1).SizedInterval(0, 3), bypass_options());
+  write_future.Force();
+  {
+    auto req = mock_key_value_store->write_requests.pop();
+    EXPECT_EQ("prefix/0.0", req.key);
+    EXPECT_TRUE(
+        tensorstore::StorageGeneration::IsUnknown(req.options.if_equal));
+    EXPECT_THAT(req.value,
+                ::testing::Optional(absl::Cord(
+                    std::string("\x01\0\x02\0\x04\0\x05\0", 8))));
+    req(memory_store);
+  }
+  {
+    auto req = mock_key_value_store->read_requests.pop();
+    EXPECT_EQ("prefix/0.1", req.key);
+    req(memory_store);
+  }
+  {
+    auto req = mock_key_value_store->write_requests.pop();
+    EXPECT_EQ("prefix/0.1", req.key);
+    req(memory_store);
+  }
+  TENSORSTORE_EXPECT_OK(write_future.result());
+
+  // The cached copy of chunk 0.0 was discarded.
+  {
+    auto read_future =
+        tensorstore::Read(store | tensorstore::Dims(1).SizedInterval(0, 2));
+    auto req = mock_key_value_store->read_requests.pop();
+    EXPECT_EQ("prefix/0.0", req.key);
+    req(memory_store);
+    EXPECT_THAT(read_future.result(),
+                ::testing::Optional(tensorstore::MakeArray<std::uint16_t>(
+                    {{1, 2}, {4, 5}})));
+  }
+
+  // Overwriting a chunk with the fill value deletes it.
+  write_future = tensorstore::Write(
+      tensorstore::MakeScalarArray<std::uint16_t>(0),
+      store | tensorstore::Dims(1).SizedInterval(0, 2), bypass_options());
+  write_future.Force();
+  {
+    auto req = mock_key_value_store->write_requests.pop();
+    EXPECT_EQ("prefix/0.0", req.key);
+    EXPECT_EQ(std::nullopt, req.value);
+    req(memory_store);
+  }
+  TENSORSTORE_EXPECT_OK(write_future.result());
+}
+
 void TestCreateWriteRead(Context context, ::nlohmann::json json_spec) {
   // Create the store.
   {
@@ -0,0 +1,58 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/// \file
+/// Defines the "zstd" compressor for zarr.  Linking in this library
+/// automatically registers it.
+///
+/// The JSON representation is compatible with the numcodecs `Zstd` codec.
+
+#include "tensorstore/internal/compression/zstd_compressor.h"
+
+#include "tensorstore/driver/zarr/compressor.h"
+#include "tensorstore/driver/zarr/compressor_registry.h"
+#include "tensorstore/internal/compression/zstd.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+
+namespace tensorstore {
+namespace internal_zarr {
+namespace {
+
+struct Registration {
+  Registration() {
+    using internal::ZstdCompressor;
+    namespace jb = tensorstore::internal_json_binding;
+    RegisterCompressor<ZstdCompressor>(
+        "zstd",
+        jb::Object(
+            jb::Member(
+                "level",
+                jb::Projection(
+                    &ZstdCompressor::level,
+                    jb::DefaultValue<jb::kAlwaysIncludeDefaults>(
+                        [](auto* v) { *v = 1; },
+                        jb::Integer<int>(zstd::kMinLevel, zstd::kMaxLevel)))),
+            // Versions of numcodecs prior to 0.11 do not support the
+            // `checksum` member, so it is only included if `true`.
+            jb::Member("checksum",
+                       jb::Projection(&ZstdCompressor::use_checksum,
+                                      jb::DefaultValue<jb::kNeverIncludeDefaults>(
+                                          [](auto* v) { *v = false; })))));
+  }
+} registration;
+
+}  // namespace
+}  // namespace internal_zarr
+}  // namespace tensorstore
@@ -14,6 +14,7 @@
 
 #include "tensorstore/internal/cache/cache.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <memory>
@@ -22,6 +23,7 @@
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <typeindex>
 #include <utility>
 #include <vector>
@@ -30,6 +32,7 @@
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/functional/function_ref.h"
+#include "absl/numeric/bits.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorstore/internal/cache/cache_pool_limits.h"
 #include "tensorstore/internal/integer_overflow.h"
@@ -37,6 +40,8 @@
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/mutex.h"
 #include "tensorstore/util/assert_macros.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
 
 // A CacheEntry owns a strong reference to the Cache that contains it only if
 // its reference count is > 0.
@@ -58,14 +63,60 @@ inline void DebugAssertMutexHeld(absl::Mutex* mutex) {}
 using LruListAccessor =
     internal::intrusive_linked_list::MemberAccessor<LruListNode>;
 
-CachePoolImpl::CachePoolImpl(const CachePool::Limits& limits)
+namespace {
+
+/// Maximum number of shards of a cache pool.
+constexpr size_t kMaxShards = 64;
+
+/// Minimum `total_bytes_limit` per shard.  Pools with a smaller (non-zero)
+/// limit use fewer shards, such that small pools retain an exact LRU eviction
+/// order.
+constexpr size_t kMinShardTotalBytesLimit = 16 * 1024 * 1024;
+
+size_t GetNumShards(const CachePool::Limits& limits) {
+  size_t num_shards = std::min(
+      kMaxShards,
+      absl::bit_ceil(std::max(size_t(1),
+                              size_t(std::thread::hardware_concurrency()))));
+  // A `total_bytes_limit` of 0 means that entries are evicted as soon as they
+  // are no longer in use, which does not depend on the number of shards.
+  if (limits.total_bytes_limit != 0) {
+    while (num_shards > 1 &&
+           limits.total_bytes_limit / num_shards < kMinShardTotalBytesLimit) {
+      num_shards /= 2;
+    }
+  }
+  return num_shards;
+}
+
+}  // namespace
+
+CachePoolShard::CachePoolShard()
+    : total_bytes_(0), queued_for_writeback_bytes_(0), protected_bytes_(0) {
+  Initialize(LruListAccessor{}, &writeback_queue_);
+  Initialize(LruListAccessor{}, &eviction_queue_);
+  Initialize(LruListAccessor{}, &protected_queue_);
+}
+
+CachePoolImpl::CachePoolImpl(
+    const CachePool::Limits& limits,
+    std::shared_ptr<internal::CacheSpillStore> spill_store)
     : limits_(limits),
+      num_shards_(GetNumShards(limits)),
+      shards_(new CachePoolShard[num_shards_]),
       total_bytes_(0),
       queued_for_writeback_bytes_(0),
+      writeback_requested_bytes_(0),
+      has_writeback_capacity_waiters_(false),
+      spill_store_(std::move(spill_store)),
       strong_references_(1),
       weak_references_(1) {
-  Initialize(LruListAccessor{}, &writeback_queue_);
-  Initialize(LruListAccessor{}, &eviction_queue_);
+  shard_limits_.total_bytes_limit = limits.total_bytes_limit / num_shards_;
+  shard_limits_.queued_for_writeback_bytes_limit =
+      limits.queued_for_writeback_bytes_limit / num_shards_;
+  shard_limits_.eviction_policy = limits.eviction_policy;
+  shard_limits_.demote_to_encoded = limits.demote_to_encoded;
+  shard_protected_bytes_limit_ = shard_limits_.total_bytes_limit / 4 * 3;
 }
 
 namespace {
@@ -100,30 +151,132 @@ void UnlinkListNode(LruListNode* node) noexcept {
   Initialize(LruListAccessor{}, node);
 }
 
+/// Returns `true` if `entry` is in the protected queue of its shard.
+bool IsInProtectedQueue(CacheEntryImpl* entry) noexcept {
+  return entry->promoted_ &&
+         entry->queue_state_ == CacheEntryQueueState::clean_and_not_in_use;
+}
+
+/// Removes `entry` from the queue of its shard that it is in, if any.
+///
+/// Must be called before `entry->queue_state_` or `entry->num_bytes_` is
+/// modified.
+void UnlinkEntry(CacheEntryImpl* entry) noexcept {
+  if (IsInProtectedQueue(entry)) {
+    entry->shard_->protected_bytes_ -= entry->num_bytes_;
+  }
+  UnlinkListNode(entry);
+}
+
+size_t GetShardIndex(CachePoolImpl* pool, CachePoolShard* shard) {
+  return shard - pool->shards_.get();
+}
+
+/// Adds `change` (which may wrap around to indicate a decrease) to the total
+/// bytes of `shard` and of `pool`.
+void AddTotalBytes(CachePoolImpl* pool, CachePoolShard* shard,
+                   size_t change) noexcept {
+  DebugAssertMutexHeld(&shard->mutex_);
+  if (change == 0) return;
+  shard->total_bytes_ += change;
+  pool->total_bytes_.fetch_add(change, std::memory_order_relaxed);
+}
+
+/// Adds `change` (which may wrap around to indicate a decrease) to the queued
+/// for writeback bytes of `shard` and of `pool`.
+void AddQueuedForWritebackBytes(CachePoolImpl* pool, CachePoolShard* shard,
+                                size_t change) noexcept {
+  DebugAssertMutexHeld(&shard->mutex_);
+  if (change == 0) return;
+  shard->queued_for_writeback_bytes_ += change;
+  pool->queued_for_writeback_bytes_.fetch_add(change,
+                                              std::memory_order_relaxed);
+}
+
+/// Returns `true` if the total bytes of the entries of `pool` that are
+/// `dirty` or `writeback_requested` exceed a non-zero
+/// `queued_for_writeback_bytes_limit`.
+bool ExceedsWritebackCapacity(CachePoolImpl* pool) {
+  const size_t limit = pool->limits_.queued_for_writeback_bytes_limit;
+  if (limit == 0) return false;
+  return pool->queued_for_writeback_bytes_.load(std::memory_order_relaxed) +
+             pool->writeback_requested_bytes_.load(
+                 std::memory_order_relaxed) >
+         limit;
+}
+
+/// Marks ready the future returned by `Cache::WaitForWritebackCapacity`, if
+/// any, once `ExceedsWritebackCapacity` no longer holds.
+///
+/// Must be called without holding any shard mutex, since callbacks registered
+/// on the future run synchronously.
+void MaybeNotifyWritebackCapacity(CachePoolImpl* pool) {
+  // Pairs with the fence in `Cache::WaitForWritebackCapacity`, to ensure that
+  // either the waiter observes the decrease in bytes, or this observes the
+  // waiter.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!pool->has_writeback_capacity_waiters_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  Promise<void> promise;
+  {
+    absl::MutexLock lock(&pool->writeback_capacity_mutex_);
+    if (ExceedsWritebackCapacity(pool)) return;
+    promise = std::move(pool->writeback_capacity_promise_);
+    pool->has_writeback_capacity_waiters_.store(false,
+                                                std::memory_order_relaxed);
+  }
+  // The future becomes ready (with its initial OK result) when `promise` is
+  // destroyed, with `writeback_capacity_mutex_` released.
+}
+
+void LockAllShards(CachePoolImpl* pool) ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  DebugAssertMutexHeld(&pool->mutex_);
+  for (size_t i = 0; i < pool->num_shards_; ++i) {
+    pool->shards_[i].mutex_.Lock();
+  }
+}
+
+void UnlockAllShards(CachePoolImpl* pool) ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  for (size_t i = pool->num_shards_; i--;) {
+    pool->shards_[i].mutex_.Unlock();
+  }
+}
+
 void UnregisterEntryFromPool(CacheEntryImpl* entry,
                              CachePoolImpl* pool) noexcept {
-  DebugAssertMutexHeld(&pool->mutex_);
-  UnlinkListNode(entry);
-  pool->total_bytes_ -= entry->num_bytes_;
+  auto* shard = entry->shard_;
+  DebugAssertMutexHeld(&shard->mutex_);
+  UnlinkEntry(entry);
+  AddTotalBytes(pool, shard, -entry->num_bytes_);
   if (entry->queue_state_ == CacheEntryQueueState::dirty) {
-    pool->queued_for_writeback_bytes_ -= entry->num_bytes_;
+    AddQueuedForWritebackBytes(pool, shard, -entry->num_bytes_);
+  } else if (entry->queue_state_ ==
+             CacheEntryQueueState::writeback_requested) {
+    pool->writeback_requested_bytes_.fetch_sub(entry->num_bytes_,
+                                               std::memory_order_relaxed);
   }
 }
 
 void EvictEntry(CacheEntryImpl* entry) noexcept ABSL_NO_THREAD_SAFETY_ANALYSIS {
   auto* pool = entry->cache_->pool_;
-  DebugAssertMutexHeld(&pool->mutex_);
+  auto* shard = entry->shard_;
+  DebugAssertMutexHeld(&shard->mutex_);
+  // Hold a reference to `cache` before releasing the mutex to ensure `cache` is
+  // not destroyed.
+  //
+  // The reference must be acquired before `entry` is removed from the
+  // `entries_` table: `StrongPtrTraitsCache::decrement` relies on the fact that
+  // the cache either still contains `entry` or has a non-zero reference count.
+  CachePtr<Cache> cache = AcquireCacheStrongPtr(entry->cache_);
   UnregisterEntryFromPool(entry, pool);
   // Note: If this is being called from `GetCacheEntryInternal` because an
   // exception was thrown while inserting `entry` into
   // `entry->cache_->entries_`, `entry` won't be in `entry->caches_`.
-  auto& entries = entry->cache_->entries_;
+  auto& entries = entry->cache_->entries_[GetShardIndex(pool, shard)];
   entries.erase(entry);
   {
-    // Hold a reference to `cache` before releasing the mutex to ensure `cache`
-    // is not destroyed.
-    CachePtr<Cache> cache = AcquireCacheStrongPtr(entry->cache_);
-    internal::ScopedWriterUnlock unlock(pool->mutex_);
+    internal::ScopedWriterUnlock unlock(shard->mutex_);
     delete Access::StaticCast<CacheEntry>(entry);
     // Remove reference to cache while mutex is unlocked.  This may cause the
     // cache to be destroyed.
@@ -132,57 +285,146 @@ void EvictEntry(CacheEntryImpl* entry) noexcept ABSL_NO_THREAD_SAFETY_ANALYSIS {
 }
 
 void EnsureNotOnCleanList(CacheEntryImpl* entry) noexcept {
-  DebugAssertMutexHeld(&entry->cache_->pool_->mutex_);
+  DebugAssertMutexHeld(&entry->shard_->mutex_);
   if (entry->queue_state_ == CacheEntryQueueState::clean_and_not_in_use) {
-    UnlinkListNode(entry);
+    UnlinkEntry(entry);
     entry->queue_state_ = CacheEntryQueueState::clean_and_in_use;
+    // The entry is being accessed again after having been released.
+    entry->promoted_ = true;
+    entry->demoted_ = false;
   }
 }
 
-void AddToEvictionQueue(CachePoolImpl* pool, CacheEntryImpl* entry) noexcept {
-  DebugAssertMutexHeld(&pool->mutex_);
-  auto* eviction_queue = &pool->eviction_queue_;
-  InsertBefore(LruListAccessor{}, eviction_queue, entry);
+void AddToEvictionQueue(CachePoolImpl* pool, CachePoolShard* shard,
+                        CacheEntryImpl* entry) noexcept {
+  DebugAssertMutexHeld(&shard->mutex_);
+  if (pool->shard_limits_.eviction_policy != CacheEvictionPolicy::two_queue ||
+      !entry->promoted_) {
+    entry->promoted_ = false;
+    auto* eviction_queue = &shard->eviction_queue_;
+    InsertBefore(LruListAccessor{}, eviction_queue, entry);
+    return;
+  }
+  InsertBefore(LruListAccessor{}, &shard->protected_queue_, entry);
+  shard->protected_bytes_ += entry->num_bytes_;
+  // Demote the least recently used protected entries to the back of the
+  // probationary queue, where they are retained unless the probationary queue
+  // is otherwise exhausted.
+  auto* queue = &shard->protected_queue_;
+  while (shard->protected_bytes_ > pool->shard_protected_bytes_limit_ &&
+         queue->next != queue) {
+    auto* demoted_entry = static_cast<CacheEntryImpl*>(queue->next);
+    UnlinkEntry(demoted_entry);
+    demoted_entry->promoted_ = false;
+    InsertBefore(LruListAccessor{}, &shard->eviction_queue_, demoted_entry);
+  }
 }
 
-void AddToWritebackQueue(CachePoolImpl* pool, CacheEntryImpl* entry) noexcept {
-  DebugAssertMutexHeld(&pool->mutex_);
-  auto* queue = &pool->writeback_queue_;
+void AddToWritebackQueue(CachePoolShard* shard,
+                         CacheEntryImpl* entry) noexcept {
+  DebugAssertMutexHeld(&shard->mutex_);
+  auto* queue = &shard->writeback_queue_;
   InsertBefore(LruListAccessor{}, queue, entry);
 }
 
-void MaybeEvictEntries(CachePoolImpl* pool) noexcept {
-  DebugAssertMutexHeld(&pool->mutex_);
-  while (pool->total_bytes_ > pool->limits_.total_bytes_limit) {
-    auto* queue = &pool->eviction_queue_;
+/// Calls `CacheEntry::DoDemote` on `entry`, which must be at the front of one
+/// of the eviction queues of its shard, with the shard mutex unlocked.  If
+/// demoted, `entry` is moved to the back of the probationary queue, and
+/// otherwise it is evicted.
+void DemoteEntry(CachePoolImpl* pool, CacheEntryImpl* entry) noexcept
+    ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  auto* shard = entry->shard_;
+  DebugAssertMutexHeld(&shard->mutex_);
+  // Pin `entry` while the mutex is unlocked, as if it had been acquired by
+  // `GetCacheEntryInternal`.  The strong reference to the cache is owned by
+  // `entry` while its reference count is non-zero.
+  CachePtr<Cache> cache = AcquireCacheStrongPtr(entry->cache_);
+  entry->reference_count_.fetch_add(1, std::memory_order_acq_rel);
+  UnlinkEntry(entry);
+  entry->queue_state_ = CacheEntryQueueState::clean_and_in_use;
+  entry->promoted_ = false;
+  entry->demoted_ = true;
+  bool demoted;
+  {
+    internal::ScopedWriterUnlock unlock(shard->mutex_);
+    demoted = Access::StaticCast<CacheEntry>(entry)->DoDemote();
+  }
+  if (entry->reference_count_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    // `entry` was acquired concurrently, and the strong reference to the cache
+    // is released along with the last reference to `entry`.
+    cache.release();
+    return;
+  }
+  if (entry->queue_state_ == CacheEntryQueueState::clean_and_in_use) {
+    entry->queue_state_ = CacheEntryQueueState::clean_and_not_in_use;
+    if (demoted && !entry->evict_when_not_in_use_) {
+      AddToEvictionQueue(pool, shard, entry);
+    } else {
+      EvictEntry(entry);
+    }
+  }
+  {
+    internal::ScopedWriterUnlock unlock(shard->mutex_);
+    cache.reset();
+  }
+}
+
+/// Evicts entries of `shard` in LRU order while the pool as a whole exceeds
+/// `total_bytes_limit`.
+///
+/// A shard is not limited to its share of `total_bytes_limit`: it may use the
+/// capacity left unused by the other shards, such that keys that hash
+/// unevenly across shards do not cause premature eviction.  Only entries of
+/// `shard` are evicted, which also ensures that unevictable bytes (of in-use or
+/// dirty entries) in one shard are compensated for by evicting entries of the
+/// shards that are still being accessed.
+///
+/// Entries in the probationary queue are evicted before entries in the
+/// protected queue.  If `demote_to_encoded` is enabled, an entry is demoted
+/// rather than evicted the first time it is selected.
+void MaybeEvictEntries(CachePoolImpl* pool, CachePoolShard* shard) noexcept {
+  DebugAssertMutexHeld(&shard->mutex_);
+  while (pool->total_bytes_.load(std::memory_order_relaxed) >
+         pool->limits_.total_bytes_limit) {
+    auto* queue = &shard->eviction_queue_;
     if (queue->next == queue) {
-      // Queue empty.
-      break;
+      queue = &shard->protected_queue_;
+      if (queue->next == queue) {
+        // Queues empty.
+        break;
+      }
     }
     auto* entry = static_cast<CacheEntryImpl*>(queue->next);
-    EvictEntry(entry);
+    if (pool->limits_.demote_to_encoded && !entry->demoted_) {
+      DemoteEntry(pool, entry);
+    } else {
+      EvictEntry(entry);
+    }
   }
 }
 
-void InitializeNewEntry(CacheEntryImpl* entry, CacheImpl* cache) noexcept {
+void InitializeNewEntry(CacheEntryImpl* entry, CacheImpl* cache,
+                        CachePoolShard* shard) noexcept {
   auto* pool = cache->pool_;
   entry->cache_ = cache;
+  entry->shard_ = shard;
   entry->reference_count_.store(1, std::memory_order_relaxed);
   entry->num_bytes_ = 0;
   entry->queue_state_ = CacheEntryQueueState::clean_and_in_use;
-  pool->total_bytes_ += entry->num_bytes_;
-  MaybeEvictEntries(pool);
+  AddTotalBytes(pool, shard, entry->num_bytes_);
+  MaybeEvictEntries(pool, shard);
   Initialize(LruListAccessor{}, entry);
 }
 
 void RequestWriteback(CachePoolImpl* pool, CacheEntryImpl* entry) {
-  DebugAssertMutexHeld(&pool->mutex_);
+  auto* shard = entry->shard_;
+  DebugAssertMutexHeld(&shard->mutex_);
   SetStateAndSize(entry, CacheEntryQueueState::writeback_requested,
                   entry->num_bytes_);
   // Acquire a reference to `entry` before releasing the mutex to ensure it
   // remains valid.
   StrongPtrTraitsCacheEntry::increment(Access::StaticCast<CacheEntry>(entry));
-  internal::ScopedWriterUnlock unlock(pool->mutex_);
+  internal::ScopedWriterUnlock unlock(shard->mutex_);
   // Ensure that the reference to `entry` is released while the mutex is not
   // held to avoid deadlock.
   Access::StaticCast<Cache>(entry->cache_)
@@ -190,12 +432,19 @@ void RequestWriteback(CachePoolImpl* pool, CacheEntryImpl* entry) {
           Access::StaticCast<Cache::Entry>(entry), internal::adopt_object_ref));
 }
 
-void MaybeWritebackEntries(CachePoolImpl* pool) {
-  DebugAssertMutexHeld(&pool->mutex_);
-  while (pool->queued_for_writeback_bytes_ >
+/// Requests writeback of dirty entries of `shard` in LRU order, using the same
+/// criteria as `MaybeEvictEntries` applied to
+/// `queued_for_writeback_bytes_limit`.
+void MaybeWritebackEntries(CachePoolImpl* pool, CachePoolShard* shard) {
+  DebugAssertMutexHeld(&shard->mutex_);
+  while (pool->queued_for_writeback_bytes_.load(std::memory_order_relaxed) >
          pool->limits_.queued_for_writeback_bytes_limit) {
-    auto* queue = &pool->writeback_queue_;
-    assert(queue->next != queue);
+    auto* queue = &shard->writeback_queue_;
+    if (queue->next == queue) {
+      // Remaining dirty entries are in other shards.
+      assert(pool->num_shards_ != 1);
+      break;
+    }
     auto* entry = static_cast<CacheEntryImpl*>(queue->next);
     RequestWriteback(pool, entry);
   }
@@ -204,7 +453,8 @@ void MaybeWritebackEntries(CachePoolImpl* pool) {
 void SetStateAndSize(CacheEntryImpl* entry, CacheEntryQueueState state,
                      size_t num_bytes) noexcept {
   CachePoolImpl* pool = entry->cache_->pool_;
-  DebugAssertMutexHeld(&pool->mutex_);
+  CachePoolShard* shard = entry->shard_;
+  DebugAssertMutexHeld(&shard->mutex_);
   const CacheEntryQueueState old_state = entry->queue_state_;
   const size_t old_num_bytes = entry->num_bytes_;
   if (state == old_state && num_bytes == old_num_bytes) {
@@ -212,32 +462,40 @@ void SetStateAndSize(CacheEntryImpl* entry, CacheEntryQueueState state,
     return;
   }
   // Relies on unsigned overflow to do the right thing.
-  pool->total_bytes_ += (num_bytes - old_num_bytes);
+  AddTotalBytes(pool, shard, num_bytes - old_num_bytes);
 
   if (old_state == CacheEntryQueueState::dirty) {
-    pool->queued_for_writeback_bytes_ -= old_num_bytes;
+    AddQueuedForWritebackBytes(pool, shard, -old_num_bytes);
+  } else if (old_state == CacheEntryQueueState::writeback_requested) {
+    pool->writeback_requested_bytes_.fetch_sub(old_num_bytes,
+                                               std::memory_order_relaxed);
   }
 
-  UnlinkListNode(entry);
+  UnlinkEntry(entry);
   entry->queue_state_ = state;
   entry->num_bytes_ = num_bytes;
 
   if (state == CacheEntryQueueState::clean_and_not_in_use) {
-    AddToEvictionQueue(pool, entry);
+    AddToEvictionQueue(pool, shard, entry);
     if (entry->evict_when_not_in_use_) {
       EvictEntry(entry);
     }
   } else if (state == CacheEntryQueueState::dirty) {
-    AddToWritebackQueue(pool, entry);
-    pool->queued_for_writeback_bytes_ += num_bytes;
-    MaybeWritebackEntries(pool);
+    AddToWritebackQueue(shard, entry);
+    AddQueuedForWritebackBytes(pool, shard, num_bytes);
+    MaybeWritebackEntries(pool, shard);
+  } else if (state == CacheEntryQueueState::writeback_requested) {
+    pool->writeback_requested_bytes_.fetch_add(num_bytes,
+                                               std::memory_order_relaxed);
   }
-  MaybeEvictEntries(pool);
+  MaybeEvictEntries(pool, shard);
 }
 
 void DestroyCache(CacheImpl* cache) noexcept {
-  for (CacheEntryImpl* entry : cache->entries_) {
-    delete Access::StaticCast<Cache::Entry>(entry);
+  for (auto& entries : cache->entries_) {
+    for (CacheEntryImpl* entry : entries) {
+      delete Access::StaticCast<Cache::Entry>(entry);
+    }
   }
   delete Access::StaticCast<Cache>(cache);
 }
@@ -277,7 +535,7 @@ void StrongPtrTraitsCacheEntry::decrement(CacheEntry* p) noexcept {
   auto* cache = entry->cache_;
   {
     auto lock = DecrementReferenceCountWithLock(&entry->reference_count_,
-                                                cache->pool_->mutex_);
+                                                entry->shard_->mutex_);
     if (!lock) return;
     if (entry->queue_state_ == CacheEntryQueueState::clean_and_in_use) {
       SetStateAndSize(entry, CacheEntryQueueState::clean_and_not_in_use,
@@ -306,6 +564,7 @@ CachePtr<Cache> GetCacheInternal(
   if (!new_cache) return CachePtr<Cache>();
   auto* cache_impl = Access::StaticCast<CacheImpl>(new_cache.get());
   cache_impl->pool_ = pool;
+  cache_impl->entries_.resize(pool->num_shards_);
   // An empty key indicates not to store the Cache in the map.
   if (cache_key.empty()) {
     new_cache.release();
@@ -325,11 +584,15 @@ CachePtr<Cache> GetCacheInternal(
 PinnedCacheEntry<Cache> GetCacheEntryInternal(internal::Cache* cache,
                                               std::string_view key) {
   auto* cache_impl = Access::StaticCast<CacheImpl>(cache);
+  auto* pool = cache_impl->pool_;
+  const size_t shard_index = pool->GetShardIndex(cache_impl, key);
+  auto* shard = &pool->shards_[shard_index];
+  auto& entries = cache_impl->entries_[shard_index];
   PinnedCacheEntry<Cache> returned_entry;
   {
-    absl::MutexLock lock(&cache_impl->pool_->mutex_);
-    auto it = cache_impl->entries_.find(key);
-    if (it != cache_impl->entries_.end()) {
+    absl::MutexLock lock(&shard->mutex_);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
       auto* entry_impl = *it;
       if (entry_impl->reference_count_.fetch_add(
               1, std::memory_order_acq_rel) == 0) {
@@ -340,6 +603,10 @@ PinnedCacheEntry<Cache> GetCacheEntryInternal(internal::Cache* cache,
         StrongPtrTraitsCache::increment(cache);
         EnsureNotOnCleanList(entry_impl);
       }
+      // The entry may be acquired while `DemoteEntry` has the mutex unlocked,
+      // in which case it is repopulated and must be demoted again, rather
+      // than evicted, when next selected.
+      entry_impl->demoted_ = false;
       // Adopt reference added via `fetch_add` above.
       returned_entry =
           PinnedCacheEntry<Cache>(Access::StaticCast<Cache::Entry>(entry_impl),
@@ -349,7 +616,7 @@ PinnedCacheEntry<Cache> GetCacheEntryInternal(internal::Cache* cache,
       auto* entry_impl =
           Access::StaticCast<CacheEntryImpl>(cache->DoAllocateEntry());
       entry_impl->key_ = std::move(temp_key);      // noexcept
-      InitializeNewEntry(entry_impl, cache_impl);  // noexcept
+      InitializeNewEntry(entry_impl, cache_impl, shard);  // noexcept
       struct EvictEntryDeleter {
         void operator()(CacheEntry* entry) const noexcept {
           EvictEntry(Access::StaticCast<CacheEntryImpl>(entry));
@@ -359,7 +626,7 @@ PinnedCacheEntry<Cache> GetCacheEntryInternal(internal::Cache* cache,
           Access::StaticCast<CacheEntry>(entry_impl));
       // Add to entries table.  This may throw, in which case the entry will be
       // cleaned up by `EvictEntry`.
-      cache_impl->entries_.insert(entry_impl);
+      entries.insert(entry_impl);
       StrongPtrTraitsCache::increment(cache);
       returned_entry =
           PinnedCacheEntry<Cache>(entry.release(), internal::adopt_object_ref);
@@ -388,6 +655,20 @@ void StrongPtrTraitsCache::decrement(Cache* p) noexcept {
   auto lock = DecrementReferenceCountWithLock(&cache->reference_count_,
                                               cache->pool_->mutex_);
   if (!lock) return;
+
+  // Entries of this cache may be evicted concurrently by threads that hold only
+  // the mutex of the corresponding shard.  Lock all shards to access the
+  // `entries_` tables.
+  LockAllShards(pool);
+  if (cache->reference_count_.load(std::memory_order_acquire) != 0) {
+    // `EvictEntry` acquired a new reference to the cache before the shards
+    // were locked.  This function will be called again when that reference is
+    // released.
+    UnlockAllShards(pool);
+    lock.unlock();
+    ReleaseWeakReference(pool);
+    return;
+  }
   const bool owned_by_pool = !cache->cache_identifier_.empty();
 
   if (!owned_by_pool ||
@@ -397,17 +678,22 @@ void StrongPtrTraitsCache::decrement(Cache* p) noexcept {
     }
     // This cache has no identifier, or the CachePool has no strong references
     // currently.  Destroy it and all of its entries.
-    for (CacheEntryImpl* entry : cache->entries_) {
-      UnregisterEntryFromPool(entry, pool);
+    for (auto& entries : cache->entries_) {
+      for (CacheEntryImpl* entry : entries) {
+        UnregisterEntryFromPool(entry, pool);
+      }
     }
 
+    UnlockAllShards(pool);
     lock.unlock();
+    MaybeNotifyWritebackCapacity(pool);
     DestroyCache(cache);
     ReleaseWeakReference(pool);
     return;
   }
 
-  if (cache->entries_.empty()) {
+  if (std::all_of(cache->entries_.begin(), cache->entries_.end(),
+                  [](const auto& entries) { return entries.empty(); })) {
     // The cache contains no entries.  Remove it from the pool's table of
     // caches, and destroy it.
     pool->caches_.erase(cache);
@@ -417,6 +703,7 @@ void StrongPtrTraitsCache::decrement(Cache* p) noexcept {
     // EvictEntry removes the temporary cache reference that it holds).
     cache = nullptr;
   }
+  UnlockAllShards(pool);
   lock.unlock();
   delete cache;
   ReleaseWeakReference(pool);
@@ -465,6 +752,10 @@ namespace internal {
 Cache::Cache() = default;
 Cache::~Cache() = default;
 
+CacheSpillStore* Cache::spill_store() const {
+  return pool_->spill_store_.get();
+}
+
 std::size_t Cache::DoGetSizeInBytes(Cache::Entry* entry) {
   return ((internal_cache::CacheEntryImpl*)entry)->key_.capacity() +
          this->DoGetSizeofEntry();
@@ -474,18 +765,30 @@ CacheEntry::~CacheEntry() = default;
 
 void CacheEntry::DoInitialize() {}
 
+bool CacheEntry::DoDemote() { return false; }
+
 void Cache::Entry::UpdateState(StateUpdate update) {
   if (!update.new_state && !update.new_size) return;
   auto* cache_impl =
       internal_cache::Access::StaticCast<internal_cache::CacheImpl>(cache_);
   auto* pool = cache_impl->pool_;
-  // Acquire `pool->mutex_` and then release `update.lock`.
-  UniqueWriterLock lock(pool->mutex_);
+  auto* shard = shard_;
+  // Acquire `shard->mutex_` and then release `update.lock`.
+  UniqueWriterLock lock(shard->mutex_);
   update.lock = nullptr;
   std::size_t old_num_bytes = num_bytes_;
   std::size_t new_num_bytes = update.new_size.value_or(old_num_bytes);
+  // Set if the bytes pending writeback may decrease, in which case delayed
+  // writes may be able to proceed.
+  const bool pending_writeback =
+      queue_state_ == CacheEntryQueueState::dirty ||
+      queue_state_ == CacheEntryQueueState::writeback_requested;
   if (update.new_state) {
     internal_cache::SetStateAndSize(this, *update.new_state, new_num_bytes);
+    if (pending_writeback) {
+      lock.unlock();
+      internal_cache::MaybeNotifyWritebackCapacity(pool);
+    }
     return;
   }
   // Just update the size, without affecting the queue position.
@@ -495,16 +798,59 @@ void Cache::Entry::UpdateState(StateUpdate update) {
   num_bytes_ = new_num_bytes;
   std::size_t num_bytes_change =
       wrap_on_overflow::Subtract(new_num_bytes, old_num_bytes);
-  pool->total_bytes_ += num_bytes_change;
+  internal_cache::AddTotalBytes(pool, shard, num_bytes_change);
+  if (internal_cache::IsInProtectedQueue(this)) {
+    shard->protected_bytes_ += num_bytes_change;
+  }
   if (queue_state_ == CacheEntryQueueState::dirty) {
-    pool->queued_for_writeback_bytes_ += num_bytes_change;
+    internal_cache::AddQueuedForWritebackBytes(pool, shard, num_bytes_change);
     if (new_num_bytes > old_num_bytes) {
-      internal_cache::MaybeWritebackEntries(pool);
+      internal_cache::MaybeWritebackEntries(pool, shard);
     }
+  } else if (queue_state_ == CacheEntryQueueState::writeback_requested) {
+    pool->writeback_requested_bytes_.fetch_add(num_bytes_change,
+                                               std::memory_order_relaxed);
   }
   if (new_num_bytes > old_num_bytes) {
-    internal_cache::MaybeEvictEntries(pool);
+    internal_cache::MaybeEvictEntries(pool, shard);
+  } else if (pending_writeback) {
+    lock.unlock();
+    internal_cache::MaybeNotifyWritebackCapacity(pool);
+  }
+}
+
+Future<const void> Cache::WaitForWritebackCapacity() {
+  auto* pool = pool_;
+  if (!internal_cache::ExceedsWritebackCapacity(pool)) {
+    return MakeReadyFuture();
   }
+  absl::MutexLock lock(&pool->writeback_capacity_mutex_);
+  pool->has_writeback_capacity_waiters_.store(true, std::memory_order_relaxed);
+  // Pairs with the fence in `MaybeNotifyWritebackCapacity`.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!internal_cache::ExceedsWritebackCapacity(pool)) {
+    return MakeReadyFuture();
+  }
+  auto& promise = pool->writeback_capacity_promise_;
+  if (!promise.null()) {
+    // May be null if all previously-returned futures have been released.
+    if (auto future = promise.future(); !future.null()) return future;
+  }
+  auto pair = PromiseFuturePair<void>::Make(MakeResult());
+  promise = std::move(pair.promise);
+  return std::move(pair.future);
+}
+
+void Cache::AddUncachedWritebackBytes(size_t num_bytes) {
+  pool_->writeback_requested_bytes_.fetch_add(num_bytes,
+                                              std::memory_order_relaxed);
+}
+
+void Cache::ReleaseUncachedWritebackBytes(size_t num_bytes) {
+  auto* pool = pool_;
+  pool->writeback_requested_bytes_.fetch_sub(num_bytes,
+                                             std::memory_order_relaxed);
+  internal_cache::MaybeNotifyWritebackCapacity(pool);
 }
 
 std::ostream& operator<<(std::ostream& os, CacheEntryQueueState state) {
@@ -522,10 +868,14 @@ std::ostream& operator<<(std::ostream& os, CacheEntryQueueState state) {
   }
 }
 
-CachePool::StrongPtr CachePool::Make(const CachePool::Limits& cache_limits) {
+CachePool::StrongPtr CachePool::Make(
+    const CachePool::Limits& cache_limits,
+    std::shared_ptr<CacheSpillStore> spill_store) {
   CachePool::StrongPtr pool;
   internal_cache::Access::StaticCast<internal_cache::CachePoolStrongPtr>(&pool)
-      ->reset(new internal_cache::CachePool(cache_limits), adopt_object_ref);
+      ->reset(
+          new internal_cache::CachePool(cache_limits, std::move(spill_store)),
+          adopt_object_ref);
   return pool;
 }
 
@@ -92,6 +92,7 @@
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/mutex.h"
 #include "tensorstore/internal/poly/poly.h"
+#include "tensorstore/util/future.h"
 
 namespace tensorstore {
 namespace internal {
@@ -189,8 +190,17 @@ class CachePool : private internal_cache::CachePoolImpl {
     friend class internal_cache::Access;
   };
 
+  /// Returns the second-tier store for the encoded values of entries that have
+  /// been evicted, or `nullptr` if this pool does not have one.
+  CacheSpillStore* spill_store() const { return spill_store_.get(); }
+
   /// Returns a handle to a new cache pool with the specified limits.
-  static StrongPtr Make(const Limits& limits);
+  ///
+  /// \param limits Memory limits of the pool.
+  /// \param spill_store Optional second-tier store for the encoded values of
+  ///     entries of caches that support it (such as `KvsBackedCache`).
+  static StrongPtr Make(const Limits& limits,
+                        std::shared_ptr<CacheSpillStore> spill_store = nullptr);
 
  private:
   using internal_cache::CachePoolImpl::CachePoolImpl;
@@ -294,6 +304,21 @@ class CacheEntry : private internal_cache::CacheEntryImpl {
   /// Derived classes may override this method if initialization is required.
   virtual void DoInitialize();
 
+  /// Releases any decoded state of this entry, retaining only a more compact
+  /// encoded representation from which it is restored on the next access.
+  ///
+  /// This is called by the cache pool, if `CachePoolLimits::demote_to_encoded`
+  /// is `true`, in place of evicting an entry that is not in use.  It is called
+  /// without holding any cache pool locks, while the entry is temporarily
+  /// pinned.  Implementations must not block, and should call `UpdateState`
+  /// to reduce the size of the entry.
+  ///
+  /// The default implementation does nothing and returns `false`.
+  ///
+  /// \returns `true` if the entry was demoted, or `false` if the entry should
+  ///     be evicted instead.
+  virtual bool DoDemote();
+
   virtual ~CacheEntry();
 
  private:
@@ -332,6 +357,34 @@ class Cache : private internal_cache::CacheImpl {
   /// pointer to this same cache.
   std::string_view cache_identifier() const { return cache_identifier_; }
 
+  /// Returns the second-tier store of the cache pool that contains this cache,
+  /// or `nullptr` if the pool does not have one.
+  CacheSpillStore* spill_store() const;
+
+  /// Returns the limits of the cache pool that contains this cache.
+  const CachePoolLimits& pool_limits() const { return pool_->limits_; }
+
+  /// Returns a future that becomes ready once the total size of the entries of
+  /// the cache pool that are `dirty` or `writeback_requested` no longer exceeds
+  /// the `queued_for_writeback_bytes_limit`.
+  ///
+  /// Used to delay non-transactional writes while writeback is in progress,
+  /// such that the memory used by modifications remains bounded.  If the limit
+  /// is 0, the returned future is always ready.
+  Future<const void> WaitForWritebackCapacity();
+
+  /// Accounts for `num_bytes` of data that are being written back without
+  /// being stored in a cache entry (e.g. by `ChunkCache::WriteUncached`), in
+  /// the same way as the bytes of entries in the `writeback_requested` state,
+  /// such that they count towards the `queued_for_writeback_bytes_limit`.
+  ///
+  /// Must be balanced by a call to `ReleaseUncachedWritebackBytes` with the
+  /// same `num_bytes` once the write completes.
+  void AddUncachedWritebackBytes(size_t num_bytes);
+
+  /// Releases bytes previously charged by `AddUncachedWritebackBytes`.
+  void ReleaseUncachedWritebackBytes(size_t num_bytes);
+
   /// Allocates a new `entry` to be stored in this cache.
   ///
   /// Usually this method can be defined as:
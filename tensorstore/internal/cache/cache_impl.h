@@ -24,31 +24,37 @@
 #include <string_view>
 #include <typeindex>
 #include <utility>
+#include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/base/optimization.h"
 #include "absl/functional/function_ref.h"
 #include "absl/hash/hash.h"
 #include "tensorstore/internal/cache/cache_pool_limits.h"
 #include "tensorstore/internal/heterogeneous_container.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/mutex.h"
+#include "tensorstore/util/future.h"
 
 namespace tensorstore {
 namespace internal {
 class Cache;
 class CacheEntry;
 class CachePool;
+class CacheSpillStore;
 enum class CacheEntryQueueState : int;
 }  // namespace internal
 namespace internal_cache {
 using internal::Cache;
 using internal::CacheEntry;
 using internal::CachePool;
+using internal::CacheEvictionPolicy;
 using internal::CachePoolLimits;
 
 class Access;
 class CacheImpl;
 class CachePoolImpl;
+class CachePoolShard;
 
 using CacheEntryQueueState = internal::CacheEntryQueueState;
 
@@ -60,10 +66,19 @@ struct LruListNode {
 class CacheEntryImpl : public internal_cache::LruListNode {
  public:
   CacheImpl* cache_;
+  /// Shard of `cache_->pool_` to which this entry is assigned.
+  CachePoolShard* shard_;
   std::string key_;
   size_t num_bytes_;
   CacheEntryQueueState queue_state_;
   bool evict_when_not_in_use_ = false;
+  /// Set if the entry was accessed again after having been released.  When
+  /// using `CacheEvictionPolicy::two_queue`, such entries are added to the
+  /// protected queue rather than the probationary queue when released.
+  bool promoted_ = false;
+  /// Set if the entry was demoted by `CacheEntry::DoDemote` and has not been
+  /// accessed since.  Such entries are evicted rather than demoted again.
+  bool demoted_ = false;
   std::atomic<std::uint32_t> reference_count_;
   // Guards calls to `DoInitializeEntry`.
   absl::once_flag initialized_;
@@ -101,9 +116,14 @@ class CacheImpl {
 
   std::atomic<std::uint32_t> reference_count_;
 
-  internal::HeterogeneousHashSet<CacheEntryImpl*, std::string_view,
-                                 &CacheEntryImpl::key_>
-      entries_;
+  using EntryTable =
+      internal::HeterogeneousHashSet<CacheEntryImpl*, std::string_view,
+                                     &CacheEntryImpl::key_>;
+
+  /// Entries of this cache, partitioned by shard.  `entries_[i]` contains the
+  /// entries assigned to `pool_->shards_[i]`, and is protected by the mutex of
+  /// that shard.
+  std::vector<EntryTable> entries_;
 
   // Key by which a cache may be looked up in a `CachePool`.
   using CacheKey = std::pair<std::type_index, std::string_view>;
@@ -111,27 +131,105 @@ class CacheImpl {
   CacheKey cache_key() const { return {*cache_type_, cache_identifier_}; }
 };
 
-class CachePoolImpl {
+/// Independently-locked partition of the entries of a `CachePoolImpl`.
+///
+/// Each entry is assigned to a shard based on a hash of its cache and key.
+/// Looking up, pinning, and unpinning an entry only locks the mutex of its
+/// shard, such that concurrent accesses to entries in different shards do not
+/// contend.
+class ABSL_CACHELINE_ALIGNED CachePoolShard {
  public:
-  explicit CachePoolImpl(const CachePoolLimits& limits);
-
-  using CacheKey = CacheImpl::CacheKey;
+  CachePoolShard();
 
   /// Protects access to `total_bytes_`, `queued_for_writeback_bytes_`,
-  /// `writeback_queue_`, `eviction_queue_`, `caches_`, and the `entries_` hash
-  /// tables of all caches associated with this pool.
+  /// `protected_bytes_`, `writeback_queue_`, `eviction_queue_`,
+  /// `protected_queue_`, and the `entries_` hash tables corresponding to this
+  /// shard of all caches associated with the pool.
   Mutex mutex_;
-  CachePoolLimits limits_;
   size_t total_bytes_;
   size_t queued_for_writeback_bytes_;
   LruListNode writeback_queue_;
 
   // next points to the front of the queue, which is the first to be evicted.
+  //
+  // When using `CacheEvictionPolicy::two_queue`, this is the probationary
+  // queue.
   LruListNode eviction_queue_;
 
+  // Protected queue used by `CacheEvictionPolicy::two_queue`; always empty
+  // when using `CacheEvictionPolicy::lru`.  Entries are only evicted from this
+  // queue if `eviction_queue_` is empty.
+  LruListNode protected_queue_;
+
+  // Total bytes of the entries in `protected_queue_`.
+  size_t protected_bytes_;
+};
+
+class CachePoolImpl {
+ public:
+  explicit CachePoolImpl(
+      const CachePoolLimits& limits,
+      std::shared_ptr<internal::CacheSpillStore> spill_store);
+
+  using CacheKey = CacheImpl::CacheKey;
+
+  /// Returns the index of the shard to which the entry of `cache` with the
+  /// specified `key` is assigned.
+  size_t GetShardIndex(const CacheImpl* cache, std::string_view key) const {
+    if (num_shards_ == 1) return 0;
+    return absl::HashOf(cache, key) & (num_shards_ - 1);
+  }
+
+  /// Protects access to `caches_`, and serializes the destruction of caches
+  /// with their retrieval from `caches_`.
+  ///
+  /// When both this mutex and shard mutexes are held, this mutex must be
+  /// acquired first, and shard mutexes must be acquired in order of increasing
+  /// index.
+  Mutex mutex_;
+  CachePoolLimits limits_;
+
+  /// Share of `limits_` of each shard, equal to `limits_` divided by
+  /// `num_shards_`.  Eviction and writeback are driven by the pool totals, such
+  /// that a shard may exceed its share; the share only determines
+  /// `shard_protected_bytes_limit_`.
+  CachePoolLimits shard_limits_;
+
+  /// Limit on `CachePoolShard::protected_bytes_` of each shard.
+  size_t shard_protected_bytes_limit_;
+
+  /// Number of shards, always a power of 2.
+  size_t num_shards_;
+  std::unique_ptr<CachePoolShard[]> shards_;
+
+  /// Sum of `total_bytes_` over all shards.
+  std::atomic<size_t> total_bytes_;
+
+  /// Sum of `queued_for_writeback_bytes_` over all shards.
+  std::atomic<size_t> queued_for_writeback_bytes_;
+
+  /// Total bytes of the entries in the `writeback_requested` state.
+  std::atomic<size_t> writeback_requested_bytes_;
+
+  /// Protects `writeback_capacity_promise_`.
+  absl::Mutex writeback_capacity_mutex_;
+
+  /// Promise corresponding to the future returned by
+  /// `Cache::WaitForWritebackCapacity`, or null if there is no such future.
+  Promise<void> writeback_capacity_promise_
+      ABSL_GUARDED_BY(writeback_capacity_mutex_);
+
+  /// Set while `writeback_capacity_promise_` may be non-null, such that it
+  /// need not be checked after every writeback completes.
+  std::atomic<bool> has_writeback_capacity_waiters_;
+
   internal::HeterogeneousHashSet<CacheImpl*, CacheKey, &CacheImpl::cache_key>
       caches_;
 
+  /// Optional second-tier store for the encoded values of entries, used by
+  /// `KvsBackedCache`.
+  std::shared_ptr<internal::CacheSpillStore> spill_store_;
+
   /// Initial strong reference returned when the cache is created.
   std::atomic<std::size_t> strong_references_;
   /// One weak reference is kept until strong_references_ becomes 0.
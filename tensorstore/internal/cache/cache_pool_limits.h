@@ -20,10 +20,42 @@
 namespace tensorstore {
 namespace internal {
 
+/// Policy by which a cache pool selects entries that are not in use for
+/// eviction.
+enum class CacheEvictionPolicy {
+  /// Evicts the least recently used entry.
+  lru,
+
+  /// Segmented LRU variant of the "2Q" policy: entries start out in a
+  /// probationary queue, and are promoted to a protected queue if they are
+  /// accessed again after having been released.  Entries are evicted from the
+  /// probationary queue first, and the protected queue is limited to three
+  /// quarters of the total bytes limit.  A sequential scan over many entries
+  /// that are each accessed only once therefore does not evict the working set
+  /// of repeatedly-accessed entries.
+  two_queue,
+};
+
 /// Memory limit parameters for a cache pool.
 struct CachePoolLimits {
   std::size_t total_bytes_limit = 0;
+
+  /// Writeback of the least recently used `dirty` entries is requested while
+  /// their total size exceeds this limit.  Additionally, if non-zero,
+  /// non-transactional writes are delayed while the total size of the entries
+  /// that are `dirty` or `writeback_requested` exceeds it (see
+  /// `Cache::WaitForWritebackCapacity`).
   std::size_t queued_for_writeback_bytes_limit = 0;
+
+  CacheEvictionPolicy eviction_policy = CacheEvictionPolicy::lru;
+
+  /// If `true`, an entry that is selected for eviction is first demoted to a
+  /// more compact encoded representation (see `CacheEntry::DoDemote`), if
+  /// supported, and only evicted if it is selected again before it is next
+  /// accessed.  The encoded representation retained by an entry for this
+  /// purpose is counted towards `total_bytes_limit` in addition to the decoded
+  /// representation.
+  bool demote_to_encoded = false;
 };
 
 }  // namespace internal
@@ -14,14 +14,24 @@
 
 #include "tensorstore/internal/cache/cache_pool_resource.h"
 
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+
 #include <nlohmann/json.hpp>
 #include "tensorstore/context.h"
 #include "tensorstore/context_resource_provider.h"
 #include "tensorstore/internal/cache/cache.h"
+#include "tensorstore/internal/cache/cache_pool_limits.h"
+#include "tensorstore/internal/cache/cache_spill_store.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_binding/enum.h"
 #include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/internal/json_binding/std_optional.h"
 #include "tensorstore/util/result.h"
+#include "tensorstore/util/status.h"
 
 namespace tensorstore {
 namespace internal {
@@ -29,33 +39,83 @@ namespace {
 
 struct CachePoolResourceTraits
     : public ContextResourceTraits<CachePoolResource> {
-  using Spec = CachePool::Limits;
+  struct Spec {
+    CachePool::Limits limits;
+    std::optional<CacheSpillStoreOptions> spill;
+  };
   using Resource = typename CachePoolResource::Resource;
-  static constexpr Spec Default() { return {}; }
+  static Spec Default() { return {}; }
   static constexpr auto JsonBinder() {
     namespace jb = tensorstore::internal_json_binding;
+    using Limits = CachePool::Limits;
     return jb::Object(
-        jb::Member("total_bytes_limit",
-                   jb::Projection(&Spec::total_bytes_limit,
-                                  jb::DefaultValue([](auto* v) { *v = 0; }))),
+        jb::Projection(
+            &Spec::limits,
+            jb::Sequence(
+                jb::Member("total_bytes_limit",
+                           jb::Projection(&Limits::total_bytes_limit,
+                                          jb::DefaultValue(
+                                              [](auto* v) { *v = 0; }))),
+                jb::Member(
+                    "queued_for_writeback_bytes_limit",
+                    jb::Dependent([](auto is_loading, const auto& options,
+                                     auto* obj, auto* j) {
+                      return jb::Projection(
+                          &Limits::queued_for_writeback_bytes_limit,
+                          jb::DefaultValue(
+                              [obj](auto* v) {
+                                *v = obj->total_bytes_limit / 2;
+                              },
+                              jb::Integer<std::size_t>(
+                                  0, obj->total_bytes_limit)));
+                    })),
+                jb::Member(
+                    "eviction_policy",
+                    jb::Projection(
+                        &Limits::eviction_policy,
+                        jb::DefaultValue(
+                            [](auto* v) { *v = CacheEvictionPolicy::lru; },
+                            jb::Enum<CacheEvictionPolicy, std::string_view>({
+                                {CacheEvictionPolicy::lru, "lru"},
+                                {CacheEvictionPolicy::two_queue, "2q"},
+                            })))),
+                jb::Member("demote_to_encoded",
+                           jb::Projection(&Limits::demote_to_encoded,
+                                          jb::DefaultValue([](auto* v) {
+                                            *v = false;
+                                          }))))),
         jb::Member(
-            "queued_for_writeback_bytes_limit",
-            jb::Dependent(
-                [](auto is_loading, const auto& options, auto* obj, auto* j) {
-                  return jb::Projection(
-                      &Spec::queued_for_writeback_bytes_limit,
-                      jb::DefaultValue(
-                          [obj](auto* v) { *v = obj->total_bytes_limit / 2; },
-                          jb::Integer<std::size_t>(0, obj->total_bytes_limit)));
-                })));
+            "spill",
+            jb::Projection(
+                &Spec::spill,
+                jb::Optional(jb::Object(
+                    jb::Member("path",
+                               jb::Projection(&CacheSpillStoreOptions::path,
+                                              jb::NonEmptyStringBinder)),
+                    jb::Member(
+                        "total_bytes_limit",
+                        jb::Projection(
+                            &CacheSpillStoreOptions::total_bytes_limit,
+                            jb::Integer<std::size_t>(1))))))));
   }
-  static Result<Resource> Create(const Spec& limits,
+  static Result<Resource> Create(const Spec& spec,
                                  ContextResourceCreationContext context) {
-    return CachePool::WeakPtr(CachePool::Make(limits));
+    std::shared_ptr<CacheSpillStore> spill_store;
+    if (spec.spill) {
+      TENSORSTORE_ASSIGN_OR_RETURN(spill_store,
+                                   CacheSpillStore::Open(*spec.spill));
+    }
+    return CachePool::WeakPtr(
+        CachePool::Make(spec.limits, std::move(spill_store)));
   }
 
   static Spec GetSpec(const Resource& pool, const ContextSpecBuilder& builder) {
-    return pool->limits();
+    Spec spec;
+    spec.limits = pool->limits();
+    if (auto* spill_store = pool->spill_store()) {
+      spec.spill = spill_store->options();
+    }
+    return spec;
   }
   static void AcquireStrongReference(const Resource& p) {
     internal_cache::StrongPtrTraitsCachePool::increment(p.get());
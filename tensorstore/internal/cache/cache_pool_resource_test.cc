@@ -19,7 +19,11 @@
 #include <nlohmann/json.hpp>
 #include "tensorstore/context.h"
 #include "tensorstore/internal/cache/cache.h"
+#include "tensorstore/internal/cache/cache_pool_limits.h"
+#include "tensorstore/internal/cache/cache_spill_store.h"
 #include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/json_gtest.h"
+#include "tensorstore/internal/test_util.h"
 #include "tensorstore/util/result.h"
 #include "tensorstore/util/status.h"
 #include "tensorstore/util/status_testutil.h"
@@ -27,7 +31,9 @@
 namespace {
 
 using ::tensorstore::Context;
+using ::tensorstore::MatchesJson;
 using ::tensorstore::MatchesStatus;
+using ::tensorstore::internal::CacheEvictionPolicy;
 using ::tensorstore::internal::CachePoolResource;
 
 TEST(CachePoolResourceTest, Default) {
@@ -73,10 +79,89 @@ TEST(CachePoolResourceTest, BothEqual) {
   EXPECT_EQ(100u, (*cache)->limits().queued_for_writeback_bytes_limit);
 }
 
+TEST(CachePoolResourceTest, EvictionPolicy) {
+  auto resource_spec = Context::Resource<CachePoolResource>::FromJson(
+      {{"total_bytes_limit", 100}, {"eviction_policy", "2q"}});
+  ASSERT_EQ(absl::OkStatus(), GetStatus(resource_spec));
+  auto cache = Context::Default().GetResource(*resource_spec).value();
+  EXPECT_EQ(100u, (*cache)->limits().total_bytes_limit);
+  EXPECT_EQ(CacheEvictionPolicy::two_queue,
+            (*cache)->limits().eviction_policy);
+  EXPECT_THAT(resource_spec->ToJson(),
+              ::testing::Optional(MatchesJson({{"total_bytes_limit", 100},
+                                               {"eviction_policy", "2q"}})));
+}
+
+TEST(CachePoolResourceTest, DefaultEvictionPolicy) {
+  auto resource_spec = Context::Resource<CachePoolResource>::FromJson(
+      {{"total_bytes_limit", 100}});
+  ASSERT_EQ(absl::OkStatus(), GetStatus(resource_spec));
+  auto cache = Context::Default().GetResource(*resource_spec).value();
+  EXPECT_EQ(CacheEvictionPolicy::lru, (*cache)->limits().eviction_policy);
+}
+
+TEST(CachePoolResourceTest, DemoteToEncoded) {
+  auto resource_spec = Context::Resource<CachePoolResource>::FromJson(
+      {{"total_bytes_limit", 100}, {"demote_to_encoded", true}});
+  ASSERT_EQ(absl::OkStatus(), GetStatus(resource_spec));
+  auto cache = Context::Default().GetResource(*resource_spec).value();
+  EXPECT_TRUE((*cache)->limits().demote_to_encoded);
+  EXPECT_THAT(resource_spec->ToJson(),
+              ::testing::Optional(MatchesJson({{"total_bytes_limit", 100},
+                                               {"demote_to_encoded", true}})));
+}
+
+TEST(CachePoolResourceTest, InvalidDemoteToEncoded) {
+  auto resource_spec = Context::Resource<CachePoolResource>::FromJson(
+      {{"total_bytes_limit", 100}, {"demote_to_encoded", "yes"}});
+  EXPECT_THAT(resource_spec, MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(CachePoolResourceTest, InvalidEvictionPolicy) {
+  auto resource_spec = Context::Resource<CachePoolResource>::FromJson(
+      {{"total_bytes_limit", 100}, {"eviction_policy", "mru"}});
+  EXPECT_THAT(resource_spec, MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
 TEST(CachePoolResourceTest, OutOfRange) {
   auto resource_spec = Context::Resource<CachePoolResource>::FromJson(
       {{"total_bytes_limit", 100}, {"queued_for_writeback_bytes_limit", 101}});
   EXPECT_THAT(resource_spec, MatchesStatus(absl::StatusCode::kInvalidArgument));
 }
 
+TEST(CachePoolResourceTest, Spill) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  ::nlohmann::json spill_json{{"path", tempdir.path() + "/spill"},
+                              {"total_bytes_limit", 1000}};
+  auto resource_spec = Context::Resource<CachePoolResource>::FromJson(
+      {{"total_bytes_limit", 100}, {"spill", spill_json}});
+  ASSERT_EQ(absl::OkStatus(), GetStatus(resource_spec));
+  auto cache = Context::Default().GetResource(*resource_spec).value();
+  EXPECT_EQ(100u, (*cache)->limits().total_bytes_limit);
+  auto* spill_store = (*cache)->spill_store();
+  ASSERT_TRUE(spill_store);
+  EXPECT_EQ(tempdir.path() + "/spill", spill_store->options().path);
+  EXPECT_EQ(1000u, spill_store->options().total_bytes_limit);
+  EXPECT_THAT(resource_spec->ToJson(),
+              ::testing::Optional(MatchesJson(
+                  {{"total_bytes_limit", 100}, {"spill", spill_json}})));
+}
+
+TEST(CachePoolResourceTest, NoSpill) {
+  auto resource_spec = Context::Resource<CachePoolResource>::FromJson(
+      {{"total_bytes_limit", 100}});
+  ASSERT_EQ(absl::OkStatus(), GetStatus(resource_spec));
+  auto cache = Context::Default().GetResource(*resource_spec).value();
+  EXPECT_FALSE((*cache)->spill_store());
+}
+
+TEST(CachePoolResourceTest, InvalidSpill) {
+  EXPECT_THAT(Context::Resource<CachePoolResource>::FromJson(
+                  {{"spill", {{"total_bytes_limit", 1000}}}}),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(Context::Resource<CachePoolResource>::FromJson(
+                  {{"spill", {{"path", "/tmp/spill"}}}}),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
 }  // namespace
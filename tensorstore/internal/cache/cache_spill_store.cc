@@ -0,0 +1,258 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/cache/cache_spill_store.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/flat_cord_builder.h"
+#include "tensorstore/internal/intrusive_linked_list.h"
+#include "tensorstore/internal/mutex.h"
+#include "tensorstore/internal/thread_pool.h"
+#include "tensorstore/kvstore/file/file_io_util.h"
+#include "tensorstore/kvstore/file/unique_handle.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/str_cat.h"
+
+// Include these last to reduce impact of macros.
+#include "tensorstore/kvstore/file/posix_file_util.h"
+#include "tensorstore/kvstore/file/windows_file_util.h"
+
+namespace tensorstore {
+namespace internal {
+namespace {
+
+namespace intrusive_lru_list = internal::intrusive_linked_list;
+
+using ::tensorstore::internal_file_util::MakeDirectories;
+using ::tensorstore::internal_file_util::ReadFully;
+using ::tensorstore::internal_file_util::UniqueFileDescriptor;
+using ::tensorstore::internal_file_util::WriteFully;
+
+std::optional<absl::Cord> ReadFile(const std::string& path, size_t size) {
+  UniqueFileDescriptor fd =
+      internal_file_util::OpenExistingFileForReading(path.c_str());
+  if (!fd.valid()) return std::nullopt;
+  internal::FlatCordBuilder buffer(size);
+  if (!ReadFully(fd.get(), path, 0, buffer.data(), buffer.size()).ok()) {
+    return std::nullopt;
+  }
+  return std::move(buffer).Build();
+}
+
+bool WriteFile(const std::string& path, absl::Cord value) {
+  UniqueFileDescriptor fd = internal_file_util::OpenFileForWriting(path);
+  if (!fd.valid()) return false;
+  return WriteFully(fd.get(), path, std::move(value)).ok();
+}
+
+void DeleteFiles(const std::vector<std::string>& paths) {
+  for (const auto& path : paths) {
+    internal_file_util::DeleteFile(path);
+  }
+}
+
+}  // namespace
+
+Result<std::shared_ptr<CacheSpillStore>> CacheSpillStore::Open(
+    CacheSpillStoreOptions options) {
+  if (options.path.empty()) {
+    return absl::InvalidArgumentError("Spill directory must be specified");
+  }
+  TENSORSTORE_RETURN_IF_ERROR(MakeDirectories(options.path));
+  return std::shared_ptr<CacheSpillStore>(
+      new CacheSpillStore(std::move(options)));
+}
+
+CacheSpillStore::CacheSpillStore(CacheSpillStoreOptions options)
+    : options_(std::move(options)), executor_(DetachedThreadPool(1)) {
+  absl::BitGen gen;
+  file_prefix_ = absl::StrFormat("%016x", absl::Uniform<uint64_t>(gen));
+  intrusive_lru_list::Initialize(
+      intrusive_lru_list::MemberAccessor<Record>{}, &lru_list_);
+}
+
+CacheSpillStore::~CacheSpillStore() {
+  std::vector<std::string> files_to_delete;
+  {
+    absl::MutexLock lock(&mutex_);
+    while (!records_.empty()) {
+      RemoveRecord(*records_.begin(), files_to_delete);
+    }
+  }
+  DeleteFiles(files_to_delete);
+}
+
+std::string CacheSpillStore::GetFilePath(std::uint64_t file_id) const {
+  return tensorstore::StrCat(options_.path, "/", file_prefix_, "-", file_id);
+}
+
+void CacheSpillStore::RemoveRecord(Record* record,
+                                   std::vector<std::string>& files_to_delete) {
+  records_.erase(record);
+  intrusive_lru_list::Remove(intrusive_lru_list::MemberAccessor<Record>{},
+                             record);
+  total_bytes_ -= record->size;
+  files_to_delete.push_back(GetFilePath(record->file_id));
+  delete record;
+}
+
+std::optional<CacheSpillStore::ReadResult> CacheSpillStore::Read(
+    std::string_view key) {
+  ReadResult result;
+  std::uint64_t file_id;
+  std::size_t size;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = records_.find(key);
+    if (it == records_.end()) return std::nullopt;
+    Record* record = *it;
+    // Mark as most recently used.
+    intrusive_lru_list::Remove(intrusive_lru_list::MemberAccessor<Record>{},
+                               record);
+    intrusive_lru_list::InsertBefore(
+        intrusive_lru_list::MemberAccessor<Record>{}, &lru_list_, record);
+    result.stamp = record->stamp;
+    file_id = record->file_id;
+    size = record->size;
+  }
+  // Files are never modified once they have been added to `records_`, but may
+  // be deleted concurrently, in which case the read fails.
+  auto value = ReadFile(GetFilePath(file_id), size);
+  if (!value) return std::nullopt;
+  result.value = std::move(*value);
+  return result;
+}
+
+void CacheSpillStore::Write(std::string_view key,
+                            TimestampedStorageGeneration stamp,
+                            absl::Cord value) {
+  const size_t size = value.size();
+  if (size > options_.total_bytes_limit) {
+    Erase(key);
+    return;
+  }
+  std::uint64_t file_id;
+  {
+    absl::MutexLock lock(&mutex_);
+    file_id = next_file_id_++;
+  }
+  std::string path = GetFilePath(file_id);
+  if (!WriteFile(path, std::move(value))) {
+    internal_file_util::DeleteFile(path);
+    Erase(key);
+    return;
+  }
+  std::vector<std::string> files_to_delete;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (auto it = records_.find(key); it != records_.end()) {
+      RemoveRecord(*it, files_to_delete);
+    }
+    auto* record = new Record;
+    record->key = std::string(key);
+    record->file_id = file_id;
+    record->size = size;
+    record->stamp = std::move(stamp);
+    records_.insert(record);
+    intrusive_lru_list::InsertBefore(
+        intrusive_lru_list::MemberAccessor<Record>{}, &lru_list_, record);
+    total_bytes_ += size;
+    while (total_bytes_ > options_.total_bytes_limit) {
+      RemoveRecord(lru_list_.next, files_to_delete);
+    }
+  }
+  DeleteFiles(files_to_delete);
+}
+
+void CacheSpillStore::UpdateTimestamp(std::string_view key,
+                                      const StorageGeneration& generation,
+                                      absl::Time time) {
+  absl::MutexLock lock(&mutex_);
+  auto it = records_.find(key);
+  if (it == records_.end()) return;
+  auto& stamp = (*it)->stamp;
+  if (stamp.generation == generation && stamp.time < time) {
+    stamp.time = time;
+  }
+}
+
+void CacheSpillStore::Erase(std::string_view key) {
+  std::vector<std::string> files_to_delete;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = records_.find(key);
+    if (it == records_.end()) return;
+    RemoveRecord(*it, files_to_delete);
+  }
+  DeleteFiles(files_to_delete);
+}
+
+Future<std::optional<CacheSpillStore::ReadResult>> CacheSpillStore::ReadAsync(
+    std::string key) {
+  auto [promise, future] =
+      PromiseFuturePair<std::optional<ReadResult>>::Make();
+  executor_([self = shared_from_this(), key = std::move(key),
+             promise = std::move(promise)] {
+    promise.SetResult(self->Read(key));
+  });
+  return std::move(future);
+}
+
+void CacheSpillStore::WriteAsync(std::string key,
+                                 TimestampedStorageGeneration stamp,
+                                 absl::Cord value) {
+  executor_([self = shared_from_this(), key = std::move(key),
+             stamp = std::move(stamp), value = std::move(value)]() mutable {
+    self->Write(key, std::move(stamp), std::move(value));
+  });
+}
+
+void CacheSpillStore::UpdateTimestampAsync(std::string key,
+                                           StorageGeneration generation,
+                                           absl::Time time) {
+  executor_([self = shared_from_this(), key = std::move(key),
+             generation = std::move(generation), time] {
+    self->UpdateTimestamp(key, generation, time);
+  });
+}
+
+void CacheSpillStore::EraseAsync(std::string key) {
+  executor_([self = shared_from_this(), key = std::move(key)] {
+    self->Erase(key);
+  });
+}
+
+std::size_t CacheSpillStore::total_bytes() const {
+  absl::MutexLock lock(&mutex_);
+  return total_bytes_;
+}
+
+}  // namespace internal
+}  // namespace tensorstore
@@ -0,0 +1,174 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_INTERNAL_CACHE_CACHE_SPILL_STORE_H_
+#define TENSORSTORE_INTERNAL_CACHE_CACHE_SPILL_STORE_H_
+
+/// \file
+///
+/// Second-tier storage for the encoded representation of cache entries on a
+/// local filesystem.
+///
+/// A `CachePool` may optionally be associated with a `CacheSpillStore`, which
+/// retains the encoded values read by `KvsBackedCache` in files under a local
+/// directory (typically on a local SSD).  When an entry that has been evicted
+/// from memory is read again, the encoded value is revalidated against the
+/// underlying `kvstore::Driver` using `ReadOptions::if_not_equal`, such that
+/// the value only needs to be re-fetched from the (possibly remote) kvstore if
+/// it has actually changed.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/cord.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/heterogeneous_container.h"
+#include "tensorstore/internal/mutex.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal {
+
+/// Parameters of a `CacheSpillStore`.
+struct CacheSpillStoreOptions {
+  /// Local directory in which encoded values are stored.  It is created if it
+  /// does not already exist.
+  std::string path;
+
+  /// Maximum total size in bytes of the encoded values stored.
+  std::size_t total_bytes_limit = 0;
+};
+
+/// Stores encoded values, along with the `TimestampedStorageGeneration` at
+/// which they were read, in individual files under a local directory.
+///
+/// Values are identified by an arbitrary string key, which is normally the
+/// cache identifier combined with the entry key.  The index of stored values is
+/// kept in memory only: files written by a previous process are not reused, and
+/// all files written by this store are deleted when it is destroyed.  If the
+/// total size exceeds `CacheSpillStoreOptions::total_bytes_limit`, the least
+/// recently used values are deleted.
+///
+/// This class is thread-safe.  The synchronous methods perform filesystem
+/// operations on the calling thread, without holding any locks.  The `*Async`
+/// methods, which are used by `KvsBackedCache` to avoid blocking kvstore
+/// completion threads, instead perform them on a dedicated single-threaded
+/// executor, in the order in which they were called.  Errors writing a value
+/// are not reported; the value is simply not retained.
+class CacheSpillStore : public std::enable_shared_from_this<CacheSpillStore> {
+ public:
+  /// Creates the directory specified by `options.path`, if it does not exist,
+  /// and returns a new store.
+  static Result<std::shared_ptr<CacheSpillStore>> Open(
+      CacheSpillStoreOptions options);
+
+  ~CacheSpillStore();
+
+  /// Value previously stored by `Write`.
+  struct ReadResult {
+    TimestampedStorageGeneration stamp;
+    absl::Cord value;
+  };
+
+  /// Returns the value stored for `key`, or `std::nullopt` if there is no
+  /// such value (or it could not be read).
+  std::optional<ReadResult> Read(std::string_view key);
+
+  /// Stores `value` for `key`, replacing any existing value.
+  void Write(std::string_view key, TimestampedStorageGeneration stamp,
+             absl::Cord value);
+
+  /// Updates the timestamp of the value stored for `key` to `time` if it was
+  /// stored with the specified `generation`, after the underlying kvstore
+  /// confirmed that it is still current.
+  void UpdateTimestamp(std::string_view key,
+                       const StorageGeneration& generation, absl::Time time);
+
+  /// Deletes the value stored for `key`, if any.
+  void Erase(std::string_view key);
+
+  /// Equivalent to `Read`, but performed asynchronously after all previously
+  /// submitted asynchronous operations.
+  Future<std::optional<ReadResult>> ReadAsync(std::string key);
+
+  /// Equivalent to `Write`, but performed asynchronously.
+  void WriteAsync(std::string key, TimestampedStorageGeneration stamp,
+                  absl::Cord value);
+
+  /// Equivalent to `UpdateTimestamp`, but performed asynchronously.
+  void UpdateTimestampAsync(std::string key, StorageGeneration generation,
+                            absl::Time time);
+
+  /// Equivalent to `Erase`, but performed asynchronously.
+  void EraseAsync(std::string key);
+
+  const CacheSpillStoreOptions& options() const { return options_; }
+
+  /// Returns the total size in bytes of the stored values.
+  std::size_t total_bytes() const;
+
+ private:
+  struct Record {
+    Record* prev;
+    Record* next;
+    std::string key;
+    std::uint64_t file_id;
+    std::size_t size;
+    TimestampedStorageGeneration stamp;
+  };
+
+  explicit CacheSpillStore(CacheSpillStoreOptions options);
+
+  std::string GetFilePath(std::uint64_t file_id) const;
+
+  /// Removes `record` from `records_` and the LRU list, and deletes it.  The
+  /// path of the file to delete, once `mutex_` is released, is appended to
+  /// `files_to_delete`.
+  void RemoveRecord(Record* record, std::vector<std::string>& files_to_delete)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  CacheSpillStoreOptions options_;
+
+  /// Single-threaded executor used by the `*Async` methods, such that
+  /// operations on the same key are performed in the order they were
+  /// submitted.
+  Executor executor_;
+
+  /// Random prefix of the names of files written by this store, to avoid
+  /// conflicts with other stores that use the same directory.
+  std::string file_prefix_;
+
+  mutable Mutex mutex_;
+  internal::HeterogeneousHashSet<Record*, std::string_view, &Record::key>
+      records_ ABSL_GUARDED_BY(mutex_);
+
+  /// Head of the list of records, ordered from least to most recently used.
+  Record lru_list_ ABSL_GUARDED_BY(mutex_);
+  std::size_t total_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::uint64_t next_file_id_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace internal
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_INTERNAL_CACHE_CACHE_SPILL_STORE_H_
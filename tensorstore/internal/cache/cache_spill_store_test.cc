@@ -0,0 +1,158 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/cache/cache_spill_store.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/cord.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/test_util.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::StorageGeneration;
+using ::tensorstore::TimestampedStorageGeneration;
+using ::tensorstore::internal::CacheSpillStore;
+using ::tensorstore::internal::ScopedTemporaryDirectory;
+
+TimestampedStorageGeneration MakeStamp(std::string_view generation,
+                                       absl::Time time) {
+  return {StorageGeneration{std::string(generation)}, time};
+}
+
+TEST(CacheSpillStoreTest, WriteRead) {
+  ScopedTemporaryDirectory tempdir;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, CacheSpillStore::Open({tempdir.path() + "/a/b", 100}));
+  EXPECT_EQ(std::nullopt, store->Read("x"));
+
+  auto time = absl::Now();
+  store->Write("x", MakeStamp("g1", time), absl::Cord("abc"));
+  EXPECT_EQ(3, store->total_bytes());
+  auto result = store->Read("x");
+  ASSERT_TRUE(result);
+  EXPECT_EQ("abc", result->value);
+  EXPECT_EQ(MakeStamp("g1", time), result->stamp);
+
+  // Replace existing value.
+  store->Write("x", MakeStamp("g2", time), absl::Cord("defg"));
+  EXPECT_EQ(4, store->total_bytes());
+  result = store->Read("x");
+  ASSERT_TRUE(result);
+  EXPECT_EQ("defg", result->value);
+  EXPECT_EQ(MakeStamp("g2", time), result->stamp);
+
+  store->Erase("x");
+  EXPECT_EQ(0, store->total_bytes());
+  EXPECT_EQ(std::nullopt, store->Read("x"));
+}
+
+TEST(CacheSpillStoreTest, AsyncOperationsAreOrdered) {
+  ScopedTemporaryDirectory tempdir;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, CacheSpillStore::Open({tempdir.path(), 100}));
+  auto time = absl::Now();
+  store->WriteAsync("x", MakeStamp("g1", time), absl::Cord("abc"));
+  store->UpdateTimestampAsync("x", StorageGeneration{"g1"},
+                              time + absl::Seconds(1));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto result,
+                                   store->ReadAsync("x").result());
+  ASSERT_TRUE(result);
+  EXPECT_EQ("abc", result->value);
+  EXPECT_EQ(MakeStamp("g1", time + absl::Seconds(1)), result->stamp);
+
+  store->EraseAsync("x");
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(result, store->ReadAsync("x").result());
+  EXPECT_EQ(std::nullopt, result);
+  EXPECT_EQ(0, store->total_bytes());
+}
+
+TEST(CacheSpillStoreTest, UpdateTimestamp) {
+  ScopedTemporaryDirectory tempdir;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, CacheSpillStore::Open({tempdir.path(), 100}));
+  auto time = absl::Now();
+  store->Write("x", MakeStamp("g1", time), absl::Cord("abc"));
+
+  // Generation does not match.
+  store->UpdateTimestamp("x", StorageGeneration{"g2"}, time + absl::Seconds(1));
+  EXPECT_EQ(MakeStamp("g1", time), store->Read("x")->stamp);
+
+  store->UpdateTimestamp("x", StorageGeneration{"g1"}, time + absl::Seconds(2));
+  EXPECT_EQ(MakeStamp("g1", time + absl::Seconds(2)), store->Read("x")->stamp);
+
+  // Timestamp is never decreased.
+  store->UpdateTimestamp("x", StorageGeneration{"g1"}, time);
+  EXPECT_EQ(MakeStamp("g1", time + absl::Seconds(2)), store->Read("x")->stamp);
+}
+
+TEST(CacheSpillStoreTest, EvictsLeastRecentlyUsed) {
+  ScopedTemporaryDirectory tempdir;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, CacheSpillStore::Open({tempdir.path(), 10}));
+  auto stamp = MakeStamp("g", absl::Now());
+  store->Write("a", stamp, absl::Cord("aaaa"));
+  store->Write("b", stamp, absl::Cord("bbbb"));
+  // Mark "a" as most recently used.
+  EXPECT_TRUE(store->Read("a"));
+  store->Write("c", stamp, absl::Cord("cccc"));
+  EXPECT_EQ(8, store->total_bytes());
+  EXPECT_TRUE(store->Read("a"));
+  EXPECT_EQ(std::nullopt, store->Read("b"));
+  EXPECT_TRUE(store->Read("c"));
+
+  // Values larger than the limit are not stored.
+  store->Write("a", stamp, absl::Cord("0123456789a"));
+  EXPECT_EQ(std::nullopt, store->Read("a"));
+  EXPECT_EQ(4, store->total_bytes());
+}
+
+TEST(CacheSpillStoreTest, EmptyPath) {
+  EXPECT_THAT(CacheSpillStore::Open({"", 10}),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+size_t CountFiles(const std::string& directory) {
+  size_t count = 0;
+  TENSORSTORE_CHECK_OK(tensorstore::internal::EnumeratePaths(
+      directory, [&](const std::string& name, bool is_dir) {
+        if (!is_dir) ++count;
+        return absl::OkStatus();
+      }));
+  return count;
+}
+
+TEST(CacheSpillStoreTest, DeletesFilesWhenDestroyed) {
+  ScopedTemporaryDirectory tempdir;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, CacheSpillStore::Open({tempdir.path(), 10}));
+  store->Write("a", MakeStamp("g", absl::Now()), absl::Cord("aaaa"));
+  store->Write("b", MakeStamp("g", absl::Now()), absl::Cord("bbbb"));
+  store->Write("a", MakeStamp("g", absl::Now()), absl::Cord("cccc"));
+  EXPECT_EQ(2, CountFiles(tempdir.path()));
+  store.reset();
+  EXPECT_EQ(0, CountFiles(tempdir.path()));
+}
+
+}  // namespace
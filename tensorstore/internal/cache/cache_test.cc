@@ -14,13 +14,16 @@
 
 #include "tensorstore/internal/cache/cache.h"
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -29,6 +32,7 @@
 #include "tensorstore/internal/concurrent_testutil.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/memory.h"
+#include "tensorstore/util/status_testutil.h"
 #include "tensorstore/util/str_cat.h"
 
 namespace {
@@ -36,6 +40,7 @@ namespace {
 using ::tensorstore::StrCat;
 using ::tensorstore::internal::Cache;
 using ::tensorstore::internal::CacheEntryQueueState;
+using ::tensorstore::internal::CacheEvictionPolicy;
 using ::tensorstore::internal::CachePool;
 using ::tensorstore::internal::CachePtr;
 using ::tensorstore::internal::PinnedCacheEntry;
@@ -54,6 +59,10 @@ using QueueState = tensorstore::internal::CacheEntryQueueState;
 
 constexpr CachePool::Limits kSmallCacheLimits{10000000, 5000000};
 
+// Limits large enough that the pool is partitioned into multiple shards (if
+// more than one CPU is available).
+constexpr CachePool::Limits kLargeCacheLimits{1 << 30, 1 << 29};
+
 CachePoolImpl* GetPoolImpl(const CachePool::StrongPtr& ptr) {
   return Access::StaticCast<CachePoolImpl>(ptr.get());
 }
@@ -145,32 +154,74 @@ class TestCacheWithCachePool : public TestCache {
   CachePool::WeakPtr cache_pool;
 };
 
+// Test cache whose entries support demotion, which reduces their size to 100.
+class DemotableTestCache : public TestCache {
+ public:
+  class Entry : public TestCache::Entry {
+   public:
+    using OwningCache = DemotableTestCache;
+
+    bool DoDemote() override {
+      auto& cache = GetOwningCache(*this);
+      if (cache.demote_callback) cache.demote_callback(key());
+      {
+        absl::MutexLock lock(&cache.mutex);
+        cache.demote_log.emplace_back(key());
+      }
+      UpdateState({{/*.lock=*/{}, /*.new_size=*/100}});
+      return true;
+    }
+  };
+
+  using TestCache::TestCache;
+
+  size_t DoGetSizeofEntry() override { return sizeof(Entry); }
+  Entry* DoAllocateEntry() override { return new Entry; }
+
+  absl::Mutex mutex;
+  // Log of calls to `DoDemote`.  Contains the entry key.
+  std::vector<std::string> demote_log;
+  // Called by `DoDemote`, with the shard mutex unlocked.
+  std::function<void(std::string_view key)> demote_callback;
+};
+
 using EntryIdentifier = std::pair<std::string, void*>;
 
 std::pair<std::string, void*> GetEntryIdentifier(CacheEntryImpl* entry) {
   return {entry->key_, entry};
 }
 
-absl::flat_hash_set<EntryIdentifier> GetEntrySet(LruListNode* head) {
-  absl::flat_hash_set<EntryIdentifier> entries;
+void AddEntriesToSet(LruListNode* head,
+                     absl::flat_hash_set<EntryIdentifier>& entries) {
   for (LruListNode* node = head->next; node != head; node = node->next) {
     entries.emplace(
         GetEntryIdentifier(Access::StaticCast<CacheEntryImpl>(node)));
   }
-  return entries;
 }
 
 // Check the invariants of pool, which should contain the specified caches.
 void AssertInvariants(const CachePool::StrongPtr& pool,
                       absl::flat_hash_set<Cache*> expected_caches) {
   auto* pool_impl = GetPoolImpl(pool);
-  auto eviction_queue_entries = GetEntrySet(&pool_impl->eviction_queue_);
-  auto writeback_queue_entries = GetEntrySet(&pool_impl->writeback_queue_);
+  absl::flat_hash_set<EntryIdentifier> eviction_queue_entries,
+      writeback_queue_entries;
+  size_t shard_total_bytes = 0, shard_pending_writeback_bytes = 0,
+         shard_protected_bytes = 0;
+  for (size_t i = 0; i < pool_impl->num_shards_; ++i) {
+    auto& shard = pool_impl->shards_[i];
+    AddEntriesToSet(&shard.eviction_queue_, eviction_queue_entries);
+    AddEntriesToSet(&shard.protected_queue_, eviction_queue_entries);
+    AddEntriesToSet(&shard.writeback_queue_, writeback_queue_entries);
+    shard_total_bytes += shard.total_bytes_;
+    shard_pending_writeback_bytes += shard.queued_for_writeback_bytes_;
+    shard_protected_bytes += shard.protected_bytes_;
+  }
 
   absl::flat_hash_set<EntryIdentifier> expected_eviction_queue_entries,
       expected_writeback_queue_entries;
 
-  size_t expected_total_bytes = 0, expected_pending_writeback_bytes = 0;
+  size_t expected_total_bytes = 0, expected_pending_writeback_bytes = 0,
+         expected_protected_bytes = 0, expected_writeback_requested_bytes = 0;
 
   // Verify that every cache owned by the pool is in `expected_caches`.
   for (auto* cache : pool_impl->caches_) {
@@ -189,28 +240,45 @@ void AssertInvariants(const CachePool::StrongPtr& pool,
       EXPECT_EQ(cache_impl, *it);
     }
 
-    for (CacheEntryImpl* entry : cache_impl->entries_) {
-      EXPECT_EQ(
-          entry->num_bytes_,
-          cache->DoGetSizeInBytes(Access::StaticCast<Cache::Entry>(entry)));
-      expected_total_bytes += entry->num_bytes_;
-      switch (entry->queue_state_) {
-        case QueueState::clean_and_not_in_use:
-          expected_eviction_queue_entries.emplace(GetEntryIdentifier(entry));
-          break;
-        case QueueState::dirty:
-          expected_writeback_queue_entries.emplace(GetEntryIdentifier(entry));
-          expected_pending_writeback_bytes += entry->num_bytes_;
-          break;
-        default:
-          break;
+    ASSERT_EQ(pool_impl->num_shards_, cache_impl->entries_.size());
+    for (size_t i = 0; i < pool_impl->num_shards_; ++i) {
+      for (CacheEntryImpl* entry : cache_impl->entries_[i]) {
+        EXPECT_EQ(&pool_impl->shards_[i], entry->shard_);
+        EXPECT_EQ(i, pool_impl->GetShardIndex(cache_impl, entry->key_));
+        EXPECT_EQ(
+            entry->num_bytes_,
+            cache->DoGetSizeInBytes(Access::StaticCast<Cache::Entry>(entry)));
+        expected_total_bytes += entry->num_bytes_;
+        switch (entry->queue_state_) {
+          case QueueState::clean_and_not_in_use:
+            expected_eviction_queue_entries.emplace(GetEntryIdentifier(entry));
+            if (entry->promoted_) {
+              expected_protected_bytes += entry->num_bytes_;
+            }
+            break;
+          case QueueState::dirty:
+            expected_writeback_queue_entries.emplace(
+                GetEntryIdentifier(entry));
+            expected_pending_writeback_bytes += entry->num_bytes_;
+            break;
+          case QueueState::writeback_requested:
+            expected_writeback_requested_bytes += entry->num_bytes_;
+            break;
+          default:
+            break;
+        }
       }
     }
   }
 
-  EXPECT_EQ(expected_total_bytes, pool_impl->total_bytes_);
+  EXPECT_EQ(expected_total_bytes, pool_impl->total_bytes_.load());
+  EXPECT_EQ(expected_total_bytes, shard_total_bytes);
   EXPECT_EQ(expected_pending_writeback_bytes,
-            pool_impl->queued_for_writeback_bytes_);
+            pool_impl->queued_for_writeback_bytes_.load());
+  EXPECT_EQ(expected_pending_writeback_bytes, shard_pending_writeback_bytes);
+  EXPECT_EQ(expected_writeback_requested_bytes,
+            pool_impl->writeback_requested_bytes_.load());
+  EXPECT_EQ(expected_protected_bytes, shard_protected_bytes);
 
   EXPECT_EQ(expected_eviction_queue_entries, eviction_queue_entries);
   EXPECT_EQ(expected_writeback_queue_entries, writeback_queue_entries);
@@ -662,6 +730,87 @@ TEST_P(NamedOrAnonymousCacheTest, DelayedWritebackRequested) {
   TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
 }
 
+// Tests that `WaitForWritebackCapacity` waits while the total size of the
+// entries that are dirty or undergoing writeback exceeds
+// `queued_for_writeback_bytes_limit`.
+TEST_P(NamedOrAnonymousCacheTest, WaitForWritebackCapacity) {
+  CachePool::Limits limits;
+  limits.queued_for_writeback_bytes_limit = 500;
+  limits.total_bytes_limit = 2000;
+  auto pool = CachePool::Make(limits);
+  auto test_cache = GetCache(pool);
+  EXPECT_TRUE(test_cache->WaitForWritebackCapacity().ready());
+  {
+    auto entry = GetCacheEntry(test_cache, "a");
+    entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/400},
+                        /*.new_state=*/CacheEntryQueueState::dirty});
+  }
+  EXPECT_TRUE(test_cache->WaitForWritebackCapacity().ready());
+  {
+    // Exceeds the limit, and requests writeback of "a".
+    auto entry = GetCacheEntry(test_cache, "b");
+    entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/400},
+                        /*.new_state=*/CacheEntryQueueState::dirty});
+  }
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
+  ASSERT_EQ(1, log->writeback_requests.size());
+  auto future = test_cache->WaitForWritebackCapacity();
+  EXPECT_FALSE(future.ready());
+  EXPECT_FALSE(test_cache->WaitForWritebackCapacity().ready());
+
+  auto entry = log->writeback_requests.front();
+  log->writeback_requests.pop_front();
+  EXPECT_EQ("a", entry->key());
+  // Decreasing the size while writeback is in progress is not sufficient.
+  entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/200}});
+  EXPECT_FALSE(future.ready());
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
+
+  // Simulate writeback.
+  entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/{}},
+                      /*.new_state=*/CacheEntryQueueState::clean_and_in_use});
+  EXPECT_TRUE(future.ready());
+  TENSORSTORE_EXPECT_OK(future.result());
+  EXPECT_TRUE(test_cache->WaitForWritebackCapacity().ready());
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
+}
+
+// Tests that bytes charged by `AddUncachedWritebackBytes` count towards
+// `queued_for_writeback_bytes_limit` until they are released.
+TEST_P(NamedOrAnonymousCacheTest, UncachedWritebackBytes) {
+  CachePool::Limits limits;
+  limits.queued_for_writeback_bytes_limit = 500;
+  limits.total_bytes_limit = 2000;
+  auto pool = CachePool::Make(limits);
+  auto test_cache = GetCache(pool);
+  test_cache->AddUncachedWritebackBytes(400);
+  EXPECT_TRUE(test_cache->WaitForWritebackCapacity().ready());
+  test_cache->AddUncachedWritebackBytes(200);
+  auto future = test_cache->WaitForWritebackCapacity();
+  EXPECT_FALSE(future.ready());
+  test_cache->ReleaseUncachedWritebackBytes(400);
+  EXPECT_TRUE(future.ready());
+  TENSORSTORE_EXPECT_OK(future.result());
+  test_cache->ReleaseUncachedWritebackBytes(200);
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
+}
+
+// Tests that `WaitForWritebackCapacity` never waits if
+// `queued_for_writeback_bytes_limit` is 0.
+TEST_P(NamedOrAnonymousCacheTest, WaitForWritebackCapacityNoLimit) {
+  auto pool = CachePool::Make(CachePool::Limits{});
+  auto test_cache = GetCache(pool);
+  auto entry = GetCacheEntry(test_cache, "a");
+  entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/400},
+                      /*.new_state=*/CacheEntryQueueState::dirty});
+  ASSERT_EQ(1, log->writeback_requests.size());
+  EXPECT_TRUE(test_cache->WaitForWritebackCapacity().ready());
+  log->writeback_requests.pop_front();
+  entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/{}},
+                      /*.new_state=*/CacheEntryQueueState::clean_and_in_use});
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
+}
+
 // Tests that an entry can be destroyed while dirty.
 TEST(CacheTest, DestroyWhileDirty) {
   auto log = std::make_shared<TestCache::RequestLog>();
@@ -1079,4 +1228,322 @@ TEST(CacheTest, SetEvictWhenNotInUse) {
   EXPECT_THAT(log->entry_destroy_log, ElementsAre(Pair("cache_a", "entry_a")));
 }
 
+// Tests that with the `two_queue` eviction policy, entries accessed only once
+// are evicted before entries that have been accessed repeatedly, even if the
+// latter were accessed less recently.
+TEST(CacheTest, TwoQueueEvictionPolicyScanResistance) {
+  auto log = std::make_shared<TestCache::RequestLog>();
+  CachePool::Limits limits;
+  limits.total_bytes_limit = 4000;
+  limits.eviction_policy = CacheEvictionPolicy::two_queue;
+  auto pool = CachePool::Make(limits);
+  auto cache = GetTestCache(pool.get(), "cache", log);
+  const auto access = [&](std::string key) {
+    auto entry = GetCacheEntry(cache, key);
+    if (entry->data.empty()) {
+      entry->data = key;
+      entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/1000}});
+    }
+  };
+  // Access "hot" twice, which promotes it to the protected queue.
+  access("hot");
+  access("hot");
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  // Scan over entries that are each accessed only once.
+  for (int i = 0; i < 10; ++i) {
+    access(StrCat("scan", i));
+    TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  }
+  EXPECT_EQ(7, log->entry_destroy_log.size());
+  EXPECT_THAT(log->entry_destroy_log,
+              ::testing::Not(::testing::Contains(Pair("cache", "hot"))));
+  EXPECT_EQ("hot", GetCacheEntry(cache, "hot")->data);
+}
+
+// Tests that with the default `lru` eviction policy, a scan evicts entries
+// that have been accessed repeatedly.
+TEST(CacheTest, LruEvictionPolicyScan) {
+  auto log = std::make_shared<TestCache::RequestLog>();
+  CachePool::Limits limits;
+  limits.total_bytes_limit = 4000;
+  auto pool = CachePool::Make(limits);
+  auto cache = GetTestCache(pool.get(), "cache", log);
+  const auto access = [&](std::string key) {
+    auto entry = GetCacheEntry(cache, key);
+    if (entry->data.empty()) {
+      entry->data = key;
+      entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/1000}});
+    }
+  };
+  access("hot");
+  access("hot");
+  for (int i = 0; i < 10; ++i) {
+    access(StrCat("scan", i));
+    TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  }
+  EXPECT_THAT(log->entry_destroy_log, ::testing::Contains(Pair("cache", "hot")));
+}
+
+// Tests that the protected queue of the `two_queue` eviction policy is
+// limited to a fraction of `total_bytes_limit`.
+TEST(CacheTest, TwoQueueEvictionPolicyDemotion) {
+  auto log = std::make_shared<TestCache::RequestLog>();
+  CachePool::Limits limits;
+  limits.total_bytes_limit = 4000;
+  limits.eviction_policy = CacheEvictionPolicy::two_queue;
+  auto pool = CachePool::Make(limits);
+  auto cache = GetTestCache(pool.get(), "cache", log);
+  const auto access = [&](std::string key) {
+    auto entry = GetCacheEntry(cache, key);
+    if (entry->data.empty()) {
+      entry->data = key;
+      entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/1000}});
+    }
+  };
+  // Promote 4 entries; only 3 fit in the protected queue, and the least
+  // recently used one ("a") is demoted to the probationary queue.
+  for (std::string key : {"a", "b", "c", "d"}) {
+    access(key);
+    access(key);
+  }
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  EXPECT_EQ(3000, GetPoolImpl(pool)->shards_[0].protected_bytes_);
+  EXPECT_THAT(log->entry_destroy_log, ElementsAre());
+  // Adding a new entry evicts the demoted entry.
+  access("e");
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  EXPECT_THAT(log->entry_destroy_log, ElementsAre(Pair("cache", "a")));
+}
+
+// Tests that with `demote_to_encoded`, entries are demoted the first time they
+// are selected for eviction, and evicted the second time.
+TEST(CacheTest, DemoteToEncoded) {
+  auto log = std::make_shared<TestCache::RequestLog>();
+  CachePool::Limits limits;
+  limits.total_bytes_limit = 4000;
+  limits.demote_to_encoded = true;
+  auto pool = CachePool::Make(limits);
+  auto cache = GetTestCache<DemotableTestCache>(pool.get(), "cache", log);
+  const auto access = [&](std::string key) {
+    auto entry = GetCacheEntry(cache, key);
+    if (entry->size != 1000) {
+      // Decode (again).
+      entry->data = key;
+      entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/1000}});
+    }
+  };
+  for (std::string key : {"a", "b", "c", "d", "e"}) {
+    access(key);
+    TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  }
+  EXPECT_THAT(cache->demote_log, ElementsAre("a", "b"));
+  EXPECT_THAT(log->entry_destroy_log, ElementsAre());
+  EXPECT_EQ(3200, GetPoolImpl(pool)->total_bytes_.load());
+
+  for (std::string key : {"f", "g", "h"}) {
+    access(key);
+    TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  }
+  EXPECT_THAT(cache->demote_log, ElementsAre("a", "b", "c", "d", "e"));
+  EXPECT_THAT(log->entry_destroy_log,
+              ElementsAre(Pair("cache", "a"), Pair("cache", "b")));
+  EXPECT_EQ(3300, GetPoolImpl(pool)->total_bytes_.load());
+
+  // Accessing a demoted entry allows it to be demoted again.
+  access("c");
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  EXPECT_THAT(cache->demote_log, ElementsAre("a", "b", "c", "d", "e", "f"));
+  EXPECT_EQ(2, log->entry_destroy_log.size());
+}
+
+// Tests that an entry that is acquired concurrently with being demoted, and
+// decoded again, is demoted again rather than evicted when next selected.
+TEST(CacheTest, DemoteToEncodedConcurrentAcquire) {
+  auto log = std::make_shared<TestCache::RequestLog>();
+  CachePool::Limits limits;
+  limits.total_bytes_limit = 4000;
+  limits.demote_to_encoded = true;
+  auto pool = CachePool::Make(limits);
+  auto cache = GetTestCache<DemotableTestCache>(pool.get(), "cache", log);
+  const auto access = [&](std::string key) {
+    auto entry = GetCacheEntry(cache, key);
+    if (entry->size != 1000) {
+      entry->data = key;
+      entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/1000}});
+    }
+  };
+  for (std::string key : {"a", "b", "c", "d"}) {
+    access(key);
+  }
+  PinnedCacheEntry<DemotableTestCache> pinned;
+  bool acquired = false;
+  cache->demote_callback = [&](std::string_view key) {
+    if (key == "a" && !acquired) {
+      acquired = true;
+      pinned = GetCacheEntry(cache, "a");
+    }
+  };
+  access("e");
+  ASSERT_TRUE(acquired);
+  // Decode "a" again, and then release it.
+  pinned->data = "a";
+  pinned->UpdateState({{/*.lock=*/{}, /*.new_size=*/1000}});
+  pinned = {};
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  for (std::string key : {"f", "g", "h", "i", "j", "k", "l", "m"}) {
+    access(key);
+    TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  }
+  EXPECT_EQ(2, std::count(cache->demote_log.begin(), cache->demote_log.end(),
+                          "a"));
+}
+
+// Tests that with `demote_to_encoded`, entries that do not support demotion
+// are evicted.
+TEST(CacheTest, DemoteToEncodedUnsupported) {
+  auto log = std::make_shared<TestCache::RequestLog>();
+  CachePool::Limits limits;
+  limits.total_bytes_limit = 4000;
+  limits.demote_to_encoded = true;
+  auto pool = CachePool::Make(limits);
+  auto cache = GetTestCache(pool.get(), "cache", log);
+  for (std::string key : {"a", "b", "c", "d", "e"}) {
+    auto entry = GetCacheEntry(cache, key);
+    entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/1000}});
+  }
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  EXPECT_THAT(log->entry_destroy_log, ElementsAre(Pair("cache", "a")));
+}
+
+TEST(CacheTest, DemoteToEncodedConcurrentGetReleaseCacheEntry) {
+  CachePool::Limits limits;
+  limits.demote_to_encoded = true;
+  auto pool = CachePool::Make(limits);
+  auto cache = GetTestCache<DemotableTestCache>(pool.get(), "cache");
+  const auto concurrent_op = [&](std::string_view key) {
+    return [&cache, key] {
+      for (int i = 0; i < 10; ++i) {
+        auto entry = GetCacheEntry(cache, key);
+      }
+    };
+  };
+  TestConcurrent(
+      kDefaultIterations,
+      /*initialize=*/[] {},
+      /*finalize=*/
+      [&] {
+        TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+        EXPECT_EQ(1, cache->use_count());
+      },
+      // Concurrent operations:
+      concurrent_op("a"), concurrent_op("b"), concurrent_op("c"),
+      concurrent_op("a"));
+}
+
+// Tests that the total size of a sharded pool does not exceed
+// `total_bytes_limit`.
+TEST(CacheTest, ShardedPoolEvictsToLimit) {
+  auto log = std::make_shared<TestCache::RequestLog>();
+  auto pool = CachePool::Make(kLargeCacheLimits);
+  auto cache = GetTestCache(pool.get(), "cache", log);
+  constexpr size_t kEntrySize = 1 << 20;
+  constexpr size_t kNumEntries = 2048;
+  for (size_t i = 0; i < kNumEntries; ++i) {
+    auto entry = GetCacheEntry(cache, StrCat(i));
+    entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/kEntrySize}});
+  }
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  auto* pool_impl = GetPoolImpl(pool);
+  EXPECT_LE(pool_impl->total_bytes_.load(),
+            kLargeCacheLimits.total_bytes_limit);
+  EXPECT_GE(log->entry_destroy_log.size(),
+            kNumEntries - kLargeCacheLimits.total_bytes_limit / kEntrySize);
+}
+
+// Tests that a shard may use the capacity left unused by the other shards when
+// all keys hash to the same shard.
+TEST(CacheTest, ShardedPoolSkewedKeys) {
+  auto log = std::make_shared<TestCache::RequestLog>();
+  auto pool = CachePool::Make(kLargeCacheLimits);
+  auto cache = GetTestCache(pool.get(), "cache", log);
+  auto* pool_impl = GetPoolImpl(pool);
+  auto* cache_impl = Access::StaticCast<CacheImpl>(cache.get());
+  constexpr size_t kEntrySize = 1 << 20;
+  // Twice the share of a single shard, but within the pool limit.
+  const size_t num_entries =
+      std::min(2 * pool_impl->shard_limits_.total_bytes_limit,
+               kLargeCacheLimits.total_bytes_limit) /
+      kEntrySize;
+  size_t num_written = 0;
+  for (size_t i = 0; num_written < num_entries; ++i) {
+    std::string key = StrCat(i);
+    if (pool_impl->GetShardIndex(cache_impl, key) != 0) continue;
+    auto entry = GetCacheEntry(cache, key);
+    entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/kEntrySize}});
+    ++num_written;
+  }
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  EXPECT_THAT(log->entry_destroy_log, ElementsAre());
+  EXPECT_EQ(num_entries * kEntrySize, pool_impl->shards_[0].total_bytes_);
+
+  // Once the pool limit is exceeded, entries are evicted.
+  for (size_t i = 0; i < kLargeCacheLimits.total_bytes_limit / kEntrySize;
+       ++i) {
+    auto entry = GetCacheEntry(cache, StrCat("x", i));
+    entry->UpdateState({{/*.lock=*/{}, /*.new_size=*/kEntrySize}});
+  }
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+  EXPECT_LE(pool_impl->total_bytes_.load(),
+            kLargeCacheLimits.total_bytes_limit);
+  EXPECT_FALSE(log->entry_destroy_log.empty());
+}
+
+TEST(CacheTest, ShardedPoolConcurrentGetReleaseCacheEntry) {
+  auto pool = CachePool::Make(kLargeCacheLimits);
+  auto cache = GetTestCache(pool.get(), "cache");
+  const auto concurrent_op = [&](std::string_view key) {
+    return [&cache, key] {
+      for (int i = 0; i < 10; ++i) {
+        auto entry = GetCacheEntry(cache, key);
+      }
+    };
+  };
+  TestConcurrent(
+      kDefaultIterations,
+      /*initialize=*/[] {},
+      /*finalize=*/
+      [&] {
+        TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {cache.get()});
+        EXPECT_EQ(1, cache->use_count());
+      },
+      // Concurrent operations:
+      concurrent_op("a"), concurrent_op("b"), concurrent_op("c"),
+      concurrent_op("a"));
+}
+
+// Tests that entries in different shards may be evicted concurrently with the
+// release of the last reference to their cache.
+TEST(CacheTest, ConcurrentReleaseCacheAndEvictEntries) {
+  auto pool = CachePool::Make(CachePool::Limits{});
+  CachePtr<TestCache> cache;
+  PinnedCacheEntry<TestCache> pinned_entries[3];
+  TestConcurrent(
+      kDefaultIterations,
+      /*initialize=*/
+      [&] {
+        cache = GetTestCache(pool.get(), "cache");
+        pinned_entries[0] = GetCacheEntry(cache, "a");
+        pinned_entries[1] = GetCacheEntry(cache, "b");
+        pinned_entries[2] = GetCacheEntry(cache, "c");
+      },
+      /*finalize=*/
+      [&] {
+        TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {});
+        EXPECT_EQ(1, GetPoolImpl(pool)->weak_references_.load());
+      },
+      // Concurrent operations:
+      [&] { pinned_entries[0].reset(); }, [&] { pinned_entries[1].reset(); },
+      [&] { pinned_entries[2].reset(); }, [&] { cache.reset(); });
+}
+
 }  // namespace
@@ -46,6 +46,7 @@
 #include "tensorstore/internal/memory.h"
 #include "tensorstore/internal/mutex.h"
 #include "tensorstore/internal/nditerable.h"
+#include "tensorstore/internal/nditerable_transformed_array.h"
 #include "tensorstore/rank.h"
 #include "tensorstore/staleness_bound.h"
 #include "tensorstore/strided_layout.h"
@@ -54,6 +55,7 @@
 #include "tensorstore/util/execution/any_receiver.h"
 #include "tensorstore/util/execution/execution.h"
 #include "tensorstore/util/execution/sender.h"
+#include "tensorstore/util/executor.h"
 #include "tensorstore/util/extents.h"
 #include "tensorstore/util/future.h"
 #include "tensorstore/util/iterate.h"
@@ -188,6 +190,13 @@ bool IsFullyOverwritten(ChunkCache::TransactionNode& node) {
 ///
 /// 6. Once the cell data has been updated (if necessary), the `ReadChunk`
 ///    constructed previously is sent to the user-specified `receiver`.
+///
+/// Before step 3, `Read` calls `ChunkCache::ReadPartialCell`, which derived
+/// classes may override to read just the requested portion of the cell.  If it
+/// returns a non-null future, a `ReadChunkUncachedImpl` is sent to the receiver
+/// instead once the partial read completes, and the entry is not updated.  The
+/// same applies to `ChunkCache::ReadCellUncached`, which is used by
+/// `ReadUncached` if the cached data does not satisfy the staleness bound.
 struct ReadChunkImpl {
   std::size_t component_index;
   PinnedCacheEntry<ChunkCache> entry;
@@ -215,6 +224,31 @@ struct ReadChunkImpl {
   }
 };
 
+/// TensorStore Driver ReadChunk implementation for data read by
+/// `ChunkCache::ReadPartialCell` or `ChunkCache::ReadCellUncached`, which is
+/// not stored in the cache.
+///
+/// This implements the `tensorstore::internal::ReadChunk::Impl` Poly interface.
+struct ReadChunkUncachedImpl {
+  SharedOffsetArray<const void> array;
+
+  absl::Status operator()(internal::LockCollection& lock_collection) const {
+    return absl::OkStatus();
+  }
+
+  Result<NDIterable::Ptr> operator()(ReadChunk::BeginRead,
+                                     IndexTransform<> chunk_transform,
+                                     Arena* arena) const {
+    return GetTransformedArrayNDIterable(array, chunk_transform, arena);
+  }
+};
+
+/// Returns `true` if the cached data of `entry` satisfies `staleness`.
+bool IsReadStateCurrent(ChunkCache::Entry& entry, absl::Time staleness) {
+  const auto time = AsyncCache::ReadLock<void>(entry).stamp().time;
+  return time != absl::InfinitePast() && time >= staleness;
+}
+
 /// TensorStore Driver ReadChunk implementation for the chunk cache, for the
 /// case of a transactional read.
 ///
@@ -446,6 +480,84 @@ struct WriteChunkImpl {
   }
 };
 
+/// TensorStore Driver WriteChunk implementation for grid cells that are
+/// entirely overwritten by `ChunkCache::WriteUncached`.
+///
+/// This implements the `tensorstore::internal::WriteChunk::Impl` Poly
+/// interface.
+///
+/// Rather than recording the write in a transaction node, `BeginWrite`
+/// allocates a new array for the cell, and `EndWrite` passes it to
+/// `ChunkCache::WriteCellUncached`.  Since the entire cell is overwritten, the
+/// array need not be initialized and no mask is needed.  No locks are required
+/// since the array is not shared.
+struct WriteChunkUncachedImpl {
+  PinnedCacheEntry<ChunkCache> entry;
+  SharedArray<void> array;
+
+  absl::Status operator()(internal::LockCollection& lock_collection) const {
+    return absl::OkStatus();
+  }
+
+  Result<NDIterable::Ptr> operator()(WriteChunk::BeginWrite,
+                                     IndexTransform<> chunk_transform,
+                                     Arena* arena) {
+    const auto& grid = GetOwningCache(*entry).grid();
+    const auto& component_spec = grid.components[0];
+    absl::FixedArray<Index, kNumInlinedDims> origin(component_spec.rank());
+    grid.GetComponentOrigin(0, entry->cell_indices(), origin);
+    array = SharedArray<void>(
+        SharedElementPointer<void>(component_spec.AllocateAndConstructBuffer(),
+                                   component_spec.dtype()),
+        component_spec.write_layout());
+    StridedLayoutView<dynamic_rank, offset_origin> data_layout{
+        origin, component_spec.shape(), component_spec.c_order_byte_strides};
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        chunk_transform,
+        ComposeLayoutAndTransform(data_layout, std::move(chunk_transform)));
+    return GetTransformedArrayNDIterable(
+        {UnownedToShared(AddByteOffset(ElementPointer<void>(array.data(),
+                                                            array.dtype()),
+                                       -data_layout.origin_byte_offset())),
+         std::move(chunk_transform)},
+        arena);
+  }
+
+  WriteChunk::EndWriteResult operator()(WriteChunk::EndWrite,
+                                        IndexTransformView<> chunk_transform,
+                                        NDIterable::IterationLayoutView layout,
+                                        span<const Index> write_end_position,
+                                        Arena* arena) {
+    auto new_array = std::move(array);
+    // If copying stopped early due to an error, the partially-written cell is
+    // discarded.
+    if (write_end_position.front() != layout.iteration_shape.front()) {
+      return {};
+    }
+    return {absl::OkStatus(), GetOwningCache(*entry).WriteCellUncached(
+                                  *entry, std::move(new_array))};
+  }
+};
+
+/// Returns `true` if `chunk_transform` densely covers the entire cell with the
+/// specified `origin`, and the cell is entirely within the component bounds.
+bool IsFullCellWrite(const ChunkGridSpecification::Component& component_spec,
+                     span<const Index> origin,
+                     IndexTransformView<> chunk_transform) {
+  BoxView<> cell_box(origin, component_spec.shape());
+  if (!Contains(component_spec.component_bounds, cell_box)) return false;
+  Box<dynamic_rank(kNumInlinedDims)> output_range(component_spec.rank());
+  auto exact = GetOutputRange(chunk_transform, output_range);
+  return exact.ok() && *exact && output_range == cell_box;
+}
+
+/// Returns `true` if `entry` has non-transactional writes that have not yet
+/// been committed.
+bool HasUncommittedWrites(ChunkCache::Entry& entry) {
+  UniqueWriterLock<AsyncCache::Entry> lock(entry);
+  return entry.num_implicit_transactions_ != 0;
+}
+
 }  // namespace
 
 ChunkCache::ChunkCache(ChunkGridSpecification grid, Executor executor)
@@ -455,6 +567,22 @@ void ChunkCache::Read(
     OpenTransactionPtr transaction, std::size_t component_index,
     IndexTransform<> transform, absl::Time staleness,
     AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver) {
+  ReadImpl(std::move(transaction), component_index, std::move(transform),
+           staleness, /*uncached=*/false, std::move(receiver));
+}
+
+void ChunkCache::ReadUncached(
+    OpenTransactionPtr transaction, std::size_t component_index,
+    IndexTransform<> transform, absl::Time staleness,
+    AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver) {
+  ReadImpl(std::move(transaction), component_index, std::move(transform),
+           staleness, /*uncached=*/true, std::move(receiver));
+}
+
+void ChunkCache::ReadImpl(
+    OpenTransactionPtr transaction, std::size_t component_index,
+    IndexTransform<> transform, absl::Time staleness, bool uncached,
+    AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver) {
   assert(component_index >= 0 && component_index < grid().components.size());
   const auto& component_spec = grid().components[component_index];
   IntrusivePtr<ReadOperationState> state(
@@ -483,6 +611,28 @@ void ChunkCache::Read(
           chunk.impl =
               ReadChunkTransactionImpl{component_index, std::move(node)};
         } else {
+          auto uncached_future = ReadPartialCell(*entry, component_index,
+                                                 chunk.transform, staleness);
+          if (uncached_future.null() && uncached &&
+              !IsReadStateCurrent(*entry, staleness)) {
+            uncached_future =
+                ReadCellUncached(*entry, component_index, staleness);
+          }
+          if (!uncached_future.null()) {
+            LinkValue(
+                [state, transform = std::move(chunk.transform),
+                 cell_transform = IndexTransform<>(cell_transform)](
+                    Promise<void> promise,
+                    ReadyFuture<SharedOffsetArray<const void>> future) mutable {
+                  execution::set_value(
+                      state->shared_receiver->receiver,
+                      ReadChunk{ReadChunkUncachedImpl{future.value()},
+                                std::move(transform)},
+                      std::move(cell_transform));
+                },
+                state->promise, std::move(uncached_future));
+            return absl::OkStatus();
+          }
           read_future = entry->Read(staleness);
           chunk.impl = ReadChunkImpl{component_index, std::move(entry)};
         }
@@ -501,15 +651,105 @@ void ChunkCache::Read(
   }
 }
 
+Future<const void> ChunkCache::Prefetch(OpenTransactionPtr transaction,
+                                        std::size_t component_index,
+                                        IndexTransform<> transform,
+                                        absl::Time staleness) {
+  assert(component_index >= 0 && component_index < grid().components.size());
+  const auto& component_spec = grid().components[component_index];
+  // Estimated size of the read state of each entry.
+  std::size_t chunk_bytes = 0;
+  for (const auto& spec : grid().components) {
+    chunk_bytes += spec.EstimateReadStateSizeInBytes(/*valid=*/true);
+  }
+  const std::size_t bytes_limit = pool_limits().total_bytes_limit;
+  std::size_t prefetched_bytes = 0;
+  bool limit_reached = false;
+  auto pair = PromiseFuturePair<void>::Make(MakeResult());
+  auto status = PartitionIndexTransformOverRegularGrid(
+      component_spec.chunked_to_cell_dimensions, grid().chunk_shape, transform,
+      [&](span<const Index> grid_cell_indices,
+          IndexTransformView<> cell_transform) {
+        if (!pair.promise.result_needed()) {
+          return absl::CancelledError("");
+        }
+        auto entry = GetEntryForCell(grid_cell_indices);
+        // Chunks that are already cached are accounted for by the cache pool,
+        // and are not charged against the limit.
+        if (AsyncCache::ReadLock<void>(*entry).stamp().time ==
+            absl::InfinitePast()) {
+          if (prefetched_bytes + chunk_bytes > bytes_limit) {
+            limit_reached = true;
+            return absl::CancelledError("");
+          }
+          prefetched_bytes += chunk_bytes;
+        }
+        Future<const void> read_future;
+        if (transaction) {
+          TENSORSTORE_ASSIGN_OR_RETURN(auto node,
+                                       GetTransactionNode(*entry, transaction));
+          if (node->IsUnconditional()) return absl::OkStatus();
+          read_future = node->Read(staleness);
+        } else {
+          read_future = entry->Read(staleness);
+        }
+        LinkError(pair.promise, std::move(read_future));
+        return absl::OkStatus();
+      });
+  if (!status.ok() && !limit_reached) {
+    pair.promise.SetResult(std::move(status));
+  }
+  return std::move(pair.future);
+}
+
 void ChunkCache::Write(
     OpenTransactionPtr transaction, std::size_t component_index,
     IndexTransform<> transform,
     AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver) {
+  WriteImpl(std::move(transaction), component_index, std::move(transform),
+            /*uncached=*/false, std::move(receiver));
+}
+
+void ChunkCache::WriteUncached(
+    OpenTransactionPtr transaction, std::size_t component_index,
+    IndexTransform<> transform,
+    AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver) {
+  WriteImpl(std::move(transaction), component_index, std::move(transform),
+            /*uncached=*/true, std::move(receiver));
+}
+
+void ChunkCache::WriteImpl(
+    OpenTransactionPtr transaction, std::size_t component_index,
+    IndexTransform<> transform, bool uncached,
+    AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver) {
   assert(component_index >= 0 && component_index < grid().components.size());
-  // In this implementation, chunks are always available for writing
-  // immediately.  The entire stream of chunks is sent to the receiver before
-  // this function returns.
+  if (!transaction) {
+    // Non-transactional modifications are accounted for by the cache pool.
+    // If too many bytes are already pending writeback, delay the write until
+    // writeback of some of them completes.
+    auto capacity_future = WaitForWritebackCapacity();
+    if (!capacity_future.ready()) {
+      std::move(capacity_future)
+          .ExecuteWhenReady(WithExecutor(
+              executor(),
+              [self = CachePtr<ChunkCache>(this), component_index,
+               transform = std::move(transform), uncached,
+               receiver = std::move(receiver)](
+                  ReadyFuture<const void> future) mutable {
+                self->WriteImpl(/*transaction=*/{}, component_index,
+                                std::move(transform), uncached,
+                                std::move(receiver));
+              }));
+      return;
+    }
+  }
+  // In this implementation, once there is writeback capacity, chunks are
+  // always available for writing immediately.  The entire stream of chunks is
+  // sent to the receiver before this function returns.
   const auto& component_spec = grid().components[component_index];
+  uncached = uncached && !transaction && grid().components.size() == 1 &&
+             SupportsWriteCellUncached();
+  absl::FixedArray<Index, kNumInlinedDims> origin(component_spec.rank());
   std::atomic<bool> cancelled{false};
   execution::set_starting(receiver, [&cancelled] { cancelled = true; });
   absl::Status status = PartitionIndexTransformOverRegularGrid(
@@ -520,6 +760,19 @@ void ChunkCache::Write(
         TENSORSTORE_ASSIGN_OR_RETURN(
             auto cell_to_dest, ComposeTransforms(transform, cell_transform));
         auto entry = GetEntryForCell(grid_cell_indices);
+        if (uncached) {
+          grid().GetComponentOrigin(component_index, grid_cell_indices,
+                                    origin);
+          if (IsFullCellWrite(component_spec, origin, cell_to_dest) &&
+              !HasUncommittedWrites(*entry)) {
+            execution::set_value(
+                receiver,
+                WriteChunk{WriteChunkUncachedImpl{std::move(entry)},
+                           std::move(cell_to_dest)},
+                IndexTransform<>(cell_transform));
+            return absl::OkStatus();
+          }
+        }
         auto transaction_copy = transaction;
         TENSORSTORE_ASSIGN_OR_RETURN(
             auto node, GetTransactionNode(*entry, transaction_copy));
@@ -538,6 +791,24 @@ void ChunkCache::Write(
   execution::set_stopping(receiver);
 }
 
+Future<SharedOffsetArray<const void>> ChunkCache::ReadPartialCell(
+    Entry& entry, std::size_t component_index,
+    IndexTransformView<> chunk_transform, absl::Time staleness) {
+  return {};
+}
+
+Future<SharedOffsetArray<const void>> ChunkCache::ReadCellUncached(
+    Entry& entry, std::size_t component_index, absl::Time staleness) {
+  return {};
+}
+
+bool ChunkCache::SupportsWriteCellUncached() { return false; }
+
+Future<const void> ChunkCache::WriteCellUncached(
+    Entry& entry, SharedArray<const void> array) {
+  return absl::UnimplementedError("Uncached writes not supported");
+}
+
 PinnedCacheEntry<ChunkCache> ChunkCache::GetEntryForCell(
     span<const Index> grid_cell_indices) {
   assert(static_cast<size_t>(grid_cell_indices.size()) ==
@@ -724,6 +995,20 @@ void ChunkCacheDriver::Read(
                data_staleness_bound_.time, std::move(receiver));
 }
 
+void ChunkCacheDriver::ReadUncached(
+    OpenTransactionPtr transaction, IndexTransform<> transform,
+    AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver) {
+  cache_->ReadUncached(std::move(transaction), component_index_,
+                       std::move(transform), data_staleness_bound_.time,
+                       std::move(receiver));
+}
+
+Future<const void> ChunkCacheDriver::Prefetch(OpenTransactionPtr transaction,
+                                              IndexTransform<> transform) {
+  return cache_->Prefetch(std::move(transaction), component_index_,
+                          std::move(transform), data_staleness_bound_.time);
+}
+
 void ChunkCacheDriver::Write(
     OpenTransactionPtr transaction, IndexTransform<> transform,
     AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver) {
@@ -731,6 +1016,13 @@ void ChunkCacheDriver::Write(
                 std::move(receiver));
 }
 
+void ChunkCacheDriver::WriteUncached(
+    OpenTransactionPtr transaction, IndexTransform<> transform,
+    AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver) {
+  cache_->WriteUncached(std::move(transaction), component_index_,
+                        std::move(transform), std::move(receiver));
+}
+
 ChunkCacheDriver::~ChunkCacheDriver() = default;
 
 Result<ChunkLayout> ChunkCacheDriver::GetChunkLayout(
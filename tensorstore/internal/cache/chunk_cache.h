@@ -339,6 +339,37 @@ class ChunkCache : public AsyncCache {
       IndexTransform<> transform, absl::Time staleness,
       AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver);
 
+  /// Same as `Read`, except that without a `transaction`, grid cells for which
+  /// the cached data does not satisfy `staleness` are read using
+  /// `ReadCellUncached`, and are not stored in the cache.
+  ///
+  /// This implements `ReadCacheMode::bypass`.
+  void ReadUncached(
+      internal::OpenTransactionPtr transaction, std::size_t component_index,
+      IndexTransform<> transform, absl::Time staleness,
+      AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver);
+
+  /// Implements the behavior of `Driver::Prefetch` for a given component array.
+  ///
+  /// Requests a read of each grid cell that intersects `transform`, in the
+  /// order in which they are visited by `Read`, without waiting for any of
+  /// them to complete.  To avoid evicting chunks that were prefetched before
+  /// they are used, grid cells that are not already cached are only prefetched
+  /// up to the `total_bytes_limit` of the cache pool; the remaining grid cells
+  /// are skipped.
+  ///
+  /// \param transaction If not null, reads are requested for the transaction
+  ///     nodes of `transaction`.
+  /// \param component_index Component array index in the range
+  ///     `[0, grid().components.size())`.
+  /// \param transform The transform to apply.
+  /// \param staleness Cached data older than `staleness` is re-read.
+  /// \returns A future that becomes ready once all requested reads complete.
+  Future<const void> Prefetch(internal::OpenTransactionPtr transaction,
+                              std::size_t component_index,
+                              IndexTransform<> transform,
+                              absl::Time staleness);
+
   /// Implements the behavior of `Driver::Write` for a given component array.
   ///
   /// Each chunk sent to `receiver` corresponds to a single grid cell.
@@ -346,7 +377,9 @@ class ChunkCache : public AsyncCache {
   /// \param transaction If not null, the modifications will be recorded for
   ///     `transaction`.  If null, fine-grained implicit transactions will be
   ///     used (typically one per chunk, not a single implicit transaction for
-  ///     the entire write).
+  ///     the entire write), and the write is delayed while the cache pool
+  ///     exceeds its `queued_for_writeback_bytes_limit` (see
+  ///     `Cache::WaitForWritebackCapacity`).
   /// \param component_index Component array index in the range
   ///     `[0, grid().components.size())`.
   /// \param transform The transform to apply.
@@ -356,6 +389,18 @@ class ChunkCache : public AsyncCache {
       IndexTransform<> transform,
       AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver);
 
+  /// Same as `Write`, except that without a `transaction`, grid cells that are
+  /// entirely overwritten are written using `WriteCellUncached`, if
+  /// `SupportsWriteCellUncached()` returns `true`, and are not stored in the
+  /// cache.  Cells with uncommitted non-transactional writes are still written
+  /// through the cache, to preserve the order of writes.
+  ///
+  /// This implements `WriteCacheMode::bypass`.
+  void WriteUncached(
+      internal::OpenTransactionPtr transaction, std::size_t component_index,
+      IndexTransform<> transform,
+      AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver);
+
   /// Returns the entry for the specified grid cell.  If it does not already
   /// exist, it will be created.
   PinnedCacheEntry<ChunkCache> GetEntryForCell(
@@ -367,9 +412,78 @@ class ChunkCache : public AsyncCache {
   /// `ChunkGridSpecification`, but derived classes may override.
   virtual Result<ChunkLayout> GetChunkLayout(size_t component_index);
 
+  /// Reads the portion of a component array of a grid cell accessed by
+  /// `chunk_transform` directly from the underlying storage, without reading
+  /// the entire cell into the cache.
+  ///
+  /// This is called by `Read`, without an explicit transaction, for each grid
+  /// cell.  Implementations should return a null future to indicate that the
+  /// entire cell must be read into the cache instead, e.g. if the cached data
+  /// already satisfies the staleness bound.  The default implementation always
+  /// returns a null future.
+  ///
+  /// \param entry The entry for the grid cell.
+  /// \param component_index Component array index in the range
+  ///     `[0, grid().components.size())`.
+  /// \param chunk_transform Transform from the cell domain to the index space
+  ///     of the component array, with a range contained in the cell.
+  /// \param staleness Data older than `staleness` must not be returned.
+  /// \returns A future for an array, in the index space of the component
+  ///     array, that contains the range of `chunk_transform`, or a null future.
+  virtual Future<SharedOffsetArray<const void>> ReadPartialCell(
+      Entry& entry, std::size_t component_index,
+      IndexTransformView<> chunk_transform, absl::Time staleness);
+
+  /// Reads a component array of a grid cell directly from the underlying
+  /// storage, without storing it in the cache.
+  ///
+  /// This is called by `ReadUncached` for each grid cell for which the cached
+  /// data does not satisfy the staleness bound, and `ReadPartialCell` returned
+  /// a null future.  The default implementation returns a null future to
+  /// indicate that the cell must be read into the cache instead.
+  ///
+  /// \param entry The entry for the grid cell.
+  /// \param component_index Component array index in the range
+  ///     `[0, grid().components.size())`.
+  /// \param staleness Data older than `staleness` must not be returned.
+  /// \returns A future for the component array of the cell, in the index space
+  ///     of the component array, or a null future.
+  virtual Future<SharedOffsetArray<const void>> ReadCellUncached(
+      Entry& entry, std::size_t component_index, absl::Time staleness);
+
+  /// Returns `true` if `WriteCellUncached` is supported.  The default
+  /// implementation returns `false`.
+  virtual bool SupportsWriteCellUncached();
+
+  /// Writes the new content of an entirely overwritten grid cell directly to
+  /// the underlying storage, without storing it in the cache.
+  ///
+  /// This is called by `WriteUncached`, only if `SupportsWriteCellUncached()`
+  /// returns `true` and the cache has a single component.  Implementations
+  /// must discard any cached data for `entry`, and should charge the size of
+  /// the data being written using `AddUncachedWritebackBytes` until the write
+  /// completes.  The default implementation returns an error.
+  ///
+  /// \param entry The entry for the grid cell.
+  /// \param array The new content of the component array of the cell, with a
+  ///     shape of `grid().components[0].shape()`.
+  /// \returns A future that becomes ready once the write is durable.
+  virtual Future<const void> WriteCellUncached(Entry& entry,
+                                               SharedArray<const void> array);
+
   const Executor& executor() const { return executor_; }
 
  private:
+  void ReadImpl(
+      internal::OpenTransactionPtr transaction, std::size_t component_index,
+      IndexTransform<> transform, absl::Time staleness, bool uncached,
+      AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver);
+
+  void WriteImpl(
+      internal::OpenTransactionPtr transaction, std::size_t component_index,
+      IndexTransform<> transform, bool uncached,
+      AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver);
+
   ChunkGridSpecification grid_;
   Executor executor_;
 };
@@ -412,11 +526,27 @@ class ChunkCacheDriver : public Driver {
             AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver)
       override;
 
+  /// Simply forwards to `ChunkCache::ReadUncached`.
+  void ReadUncached(
+      OpenTransactionPtr transaction, IndexTransform<> transform,
+      AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver)
+      override;
+
+  /// Simply forwards to `ChunkCache::Prefetch`.
+  Future<const void> Prefetch(OpenTransactionPtr transaction,
+                              IndexTransform<> transform) override;
+
   /// Simply forwards to `ChunkCache::Write`.
   void Write(OpenTransactionPtr transaction, IndexTransform<> transform,
              AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>>
                  receiver) override;
 
+  /// Simply forwards to `ChunkCache::WriteUncached`.
+  void WriteUncached(
+      OpenTransactionPtr transaction, IndexTransform<> transform,
+      AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver)
+      override;
+
   std::size_t component_index() const { return component_index_; }
 
   ChunkCache* cache() const { return cache_.get(); }
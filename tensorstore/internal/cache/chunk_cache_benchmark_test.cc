@@ -12,8 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <new>
 #include <ostream>
@@ -38,6 +40,7 @@
 #include "tensorstore/index_space/transformed_array.h"
 #include "tensorstore/internal/cache/async_cache.h"
 #include "tensorstore/internal/cache/cache.h"
+#include "tensorstore/internal/cache/cache_pool_limits.h"
 #include "tensorstore/internal/cache/chunk_cache.h"
 #include "tensorstore/internal/element_copy_function.h"
 #include "tensorstore/internal/intrusive_ptr.h"
@@ -131,10 +134,14 @@ class BenchmarkCache : public tensorstore::internal::ChunkCache {
  public:
   using Base::Base;
 
+  /// Total number of calls to `Entry::DoRead`, i.e. of cache misses.
+  static inline std::atomic<int64_t> num_reads{0};
+
   class Entry : public Base::Entry {
    public:
     using OwningCache = BenchmarkCache;
     void DoRead(absl::Time staleness_bound) override {
+      num_reads.fetch_add(1, std::memory_order_relaxed);
       GetOwningCache(*this).executor()([this] {
         const auto component_specs = this->component_specs();
         auto read_data = tensorstore::internal::make_shared_for_overwrite<
@@ -305,6 +312,135 @@ void BenchmarkCopy(const BenchmarkConfig& config, ::benchmark::State& state) {
   state.SetBytesProcessed(total_bytes);
 }
 
+/// Shared state for `BenchmarkConcurrentCachedRead`.
+struct ConcurrentReadBenchmarkState {
+  static constexpr Index kChunkSize = 32;
+
+  explicit ConcurrentReadBenchmarkState(int num_chunks) {
+    // The pool is large enough to retain all chunks, such that every read
+    // after the first is a cache hit.
+    pool = CachePool::Make(CachePool::Limits{Index(1) << 30});
+    ChunkGridSpecification grid({ChunkGridSpecification::Component{
+        AllocateArray({kChunkSize, kChunkSize}, tensorstore::c_order,
+                      tensorstore::value_init, tensorstore::dtype_v<int>),
+        Box<>(2), {0, 1}}});
+    cache = pool->GetCache<BenchmarkCache>("", [&] {
+      return std::make_unique<BenchmarkCache>(grid,
+                                              tensorstore::InlineExecutor{});
+    });
+    driver.reset(new TestDriver(cache, 0));
+    for (int i = 0; i < num_chunks; ++i) {
+      auto array = tensorstore::AllocateArray<int>({kChunkSize, kChunkSize});
+      tensorstore::internal::DriverRead(tensorstore::InlineExecutor{},
+                                        {driver, GetTransform(i)}, array,
+                                        {/*.progress_function=*/{}})
+          .result();
+    }
+  }
+
+  /// Returns the transform that selects the `i`th chunk.
+  static IndexTransform<> GetTransform(int i) {
+    return ChainResult(tensorstore::IdentityTransform(2),
+                       tensorstore::AllDims().SizedInterval(
+                           {i * kChunkSize, Index(0)}, {kChunkSize, kChunkSize}))
+        .value();
+  }
+
+  tensorstore::internal::CachePool::StrongPtr pool;
+  tensorstore::internal::CachePtr<BenchmarkCache> cache;
+  tensorstore::internal::DriverPtr driver;
+};
+
+/// Benchmarks concurrent reads from a warm chunk cache, where each thread
+/// repeatedly reads a single (distinct) chunk.  This primarily measures
+/// contention on the cache pool, since every read is a cache hit.
+void BenchmarkConcurrentCachedRead(::benchmark::State& state) {
+  static ConcurrentReadBenchmarkState* shared_state = nullptr;
+  if (state.thread_index() == 0) {
+    shared_state = new ConcurrentReadBenchmarkState(state.threads());
+  }
+  // Note: `benchmark` synchronizes all threads before and after the loop.
+  auto array = tensorstore::AllocateArray<int>(
+      {ConcurrentReadBenchmarkState::kChunkSize,
+       ConcurrentReadBenchmarkState::kChunkSize});
+  auto transform =
+      ConcurrentReadBenchmarkState::GetTransform(state.thread_index());
+  while (state.KeepRunning()) {
+    tensorstore::internal::DriverRead(tensorstore::InlineExecutor{},
+                                      {shared_state->driver, transform}, array,
+                                      {/*.progress_function=*/{}})
+        .result();
+  }
+  state.SetBytesProcessed(state.iterations() * array.num_elements() *
+                          sizeof(int));
+  if (state.thread_index() == 0) {
+    delete shared_state;
+    shared_state = nullptr;
+  }
+}
+
+BENCHMARK(BenchmarkConcurrentCachedRead)->ThreadRange(1, 64)->UseRealTime();
+
+/// Benchmarks the cache hit rate of point reads of a small working set of
+/// chunks, interleaved with a sequential scan over chunks that are each read
+/// only once.  The working set fits in the cache pool, but the reuse distance
+/// including the scanned chunks does not.
+///
+/// The benchmark argument specifies the `CacheEvictionPolicy`.
+void BenchmarkScanAndPointReadHitRate(::benchmark::State& state) {
+  constexpr Index kChunkSize = 32;
+  constexpr Index kNumHotChunks = 128;
+  constexpr Index kScanChunksPerPointRead = 4;
+  CachePool::Limits limits;
+  limits.total_bytes_limit = 1024 * 1024;
+  limits.eviction_policy =
+      static_cast<tensorstore::internal::CacheEvictionPolicy>(state.range(0));
+  auto pool = CachePool::Make(limits);
+  ChunkGridSpecification grid({ChunkGridSpecification::Component{
+      tensorstore::AllocateArray({kChunkSize, kChunkSize}, tensorstore::c_order,
+                                 tensorstore::value_init,
+                                 tensorstore::dtype_v<int>),
+      Box<>(2), {0, 1}}});
+  auto cache = pool->GetCache<BenchmarkCache>("", [&] {
+    return std::make_unique<BenchmarkCache>(grid, tensorstore::InlineExecutor{});
+  });
+  tensorstore::internal::DriverPtr driver;
+  driver.reset(new TestDriver(cache, 0));
+  auto array = tensorstore::AllocateArray<int>({kChunkSize, kChunkSize});
+  const auto read_chunk = [&](Index row, Index col) {
+    auto transform =
+        ChainResult(tensorstore::IdentityTransform(2),
+                    tensorstore::AllDims().SizedInterval(
+                        {row * kChunkSize, col * kChunkSize},
+                        {kChunkSize, kChunkSize}))
+            .value();
+    tensorstore::internal::DriverRead(tensorstore::InlineExecutor{},
+                                      {driver, std::move(transform)}, array,
+                                      {/*.progress_function=*/{}})
+        .result();
+  };
+  Index point_reads = 0, point_misses = 0, scan_position = 0;
+  while (state.KeepRunning()) {
+    // Point read of the working set (row 0).
+    const int64_t reads_before = BenchmarkCache::num_reads.load();
+    read_chunk(0, point_reads % kNumHotChunks);
+    point_misses += BenchmarkCache::num_reads.load() - reads_before;
+    ++point_reads;
+    // Scan (row 1).
+    for (Index i = 0; i < kScanChunksPerPointRead; ++i) {
+      read_chunk(1, scan_position++);
+    }
+  }
+  state.counters["point_hit_rate"] =
+      point_reads ? 1.0 - static_cast<double>(point_misses) / point_reads : 0;
+}
+
+BENCHMARK(BenchmarkScanAndPointReadHitRate)
+    ->ArgName("eviction_policy")
+    ->Arg(static_cast<int>(tensorstore::internal::CacheEvictionPolicy::lru))
+    ->Arg(static_cast<int>(
+        tensorstore::internal::CacheEvictionPolicy::two_queue));
+
 struct RegisterBenchmarks {
   static void Register(const BenchmarkConfig& config) {
     ::benchmark::RegisterBenchmark(
@@ -421,6 +421,120 @@ TEST_F(ChunkCacheTest, ReadSingleComponentOneDimensionalFill) {
   }
 }
 
+// Tests that prefetched chunks are used to satisfy a subsequent read.
+TEST_F(ChunkCacheTest, Prefetch) {
+  // Dimension 0 is chunked with a size of 2.
+  grid = ChunkGridSpecification({ChunkGridSpecification::Component{
+      SharedArray<const void>(MakeArray<int>({1, 2})), Box<>(1)}});
+
+  SetChunk({1}, {MakeArray<int>({5, 6})});
+
+  auto cache = MakeChunkCache();
+
+  {
+    auto prefetch_future = tensorstore::Prefetch(
+        GetTensorStore(cache, absl::InfinitePast()) |
+        tensorstore::Dims(0).TranslateSizedInterval(3, 3));
+    {
+      auto r = mock_store->read_requests.pop();
+      EXPECT_THAT(ParseKey(r.key), ElementsAre(1));
+      r(memory_store);
+    }
+    EXPECT_FALSE(prefetch_future.ready());
+    {
+      auto r = mock_store->read_requests.pop();
+      EXPECT_THAT(ParseKey(r.key), ElementsAre(2));
+      r(memory_store);
+    }
+    TENSORSTORE_EXPECT_OK(prefetch_future.result());
+  }
+
+  // Read is satisfied without issuing any new read requests.
+  {
+    auto read_future =
+        tensorstore::Read(GetTensorStore(cache, absl::InfinitePast()) |
+                          tensorstore::Dims(0).TranslateSizedInterval(3, 3));
+    EXPECT_THAT(read_future.result(),
+                ::testing::Optional(tensorstore::MakeArray({6, 1, 2})));
+  }
+  EXPECT_EQ(0, mock_store->read_requests.size());
+}
+
+// Tests that chunks that would exceed the cache pool size limit are not
+// prefetched.
+TEST_F(ChunkCacheTest, PrefetchExceedsCachePoolLimit) {
+  // Dimension 0 is chunked with a size of 2.
+  grid = ChunkGridSpecification({ChunkGridSpecification::Component{
+      SharedArray<const void>(MakeArray<int>({1, 2})), Box<>(1)}});
+
+  // Limit sufficient for 2 chunks of 2 `int` elements.
+  auto cache = MakeChunkCache(
+      /*cache_identifier=*/{},
+      CachePool::Make(CachePool::Limits{4 * sizeof(int), 4 * sizeof(int)}));
+
+  auto prefetch_future =
+      tensorstore::Prefetch(GetTensorStore(cache, absl::InfinitePast()) |
+                            tensorstore::Dims(0).SizedInterval(0, 6));
+  for (Index i = 0; i < 2; ++i) {
+    auto r = mock_store->read_requests.pop();
+    EXPECT_THAT(ParseKey(r.key), ElementsAre(i));
+    r(memory_store);
+  }
+  TENSORSTORE_EXPECT_OK(prefetch_future.result());
+  EXPECT_EQ(0, mock_store->read_requests.size());
+}
+
+// Tests that chunks that are already cached do not count towards the cache
+// pool size limit.
+TEST_F(ChunkCacheTest, PrefetchSkipsCachedChunks) {
+  // Dimension 0 is chunked with a size of 2.
+  grid = ChunkGridSpecification({ChunkGridSpecification::Component{
+      SharedArray<const void>(MakeArray<int>({1, 2})), Box<>(1)}});
+
+  // Limit sufficient for 2 chunks of 2 `int` elements.
+  auto cache = MakeChunkCache(
+      /*cache_identifier=*/{},
+      CachePool::Make(CachePool::Limits{4 * sizeof(int), 4 * sizeof(int)}));
+
+  // Cache chunk 1.
+  {
+    auto read_future =
+        tensorstore::Read(GetTensorStore(cache, absl::InfinitePast()) |
+                          tensorstore::Dims(0).SizedInterval(2, 2));
+    auto r = mock_store->read_requests.pop();
+    EXPECT_THAT(ParseKey(r.key), ElementsAre(1));
+    r(memory_store);
+    TENSORSTORE_EXPECT_OK(read_future.result());
+  }
+
+  // Chunks 0 and 2 are prefetched, while chunk 1 is already cached.
+  auto prefetch_future =
+      tensorstore::Prefetch(GetTensorStore(cache, absl::InfinitePast()) |
+                            tensorstore::Dims(0).SizedInterval(0, 6));
+  for (Index i : {0, 2}) {
+    auto r = mock_store->read_requests.pop();
+    EXPECT_THAT(ParseKey(r.key), ElementsAre(i));
+    r(memory_store);
+  }
+  TENSORSTORE_EXPECT_OK(prefetch_future.result());
+  EXPECT_EQ(0, mock_store->read_requests.size());
+}
+
+// Tests that prefetching with a zero-size cache pool does nothing.
+TEST_F(ChunkCacheTest, PrefetchZeroSizeCachePool) {
+  // Dimension 0 is chunked with a size of 2.
+  grid = ChunkGridSpecification({ChunkGridSpecification::Component{
+      SharedArray<const void>(MakeArray<int>({1, 2})), Box<>(1)}});
+
+  auto cache = MakeChunkCache(/*cache_identifier=*/{},
+                              CachePool::Make(CachePool::Limits{}));
+  TENSORSTORE_EXPECT_OK(
+      tensorstore::Prefetch(GetTensorStore(cache, absl::InfinitePast()) |
+                            tensorstore::Dims(0).SizedInterval(0, 6))
+          .result());
+  EXPECT_EQ(0, mock_store->read_requests.size());
+}
+
 // Tests cancelling a read request.
 TEST_F(ChunkCacheTest, CancelRead) {
   // Dimension 0 is chunked with a size of 2.
@@ -750,6 +864,46 @@ TEST_F(ChunkCacheTest, WriteSingleComponentOneDimensional) {
   TENSORSTORE_EXPECT_OK(write_future);
 }
 
+// Tests that non-transactional writes are delayed while the bytes pending
+// writeback exceed `queued_for_writeback_bytes_limit`.
+TEST_F(ChunkCacheTest, WriteBackpressure) {
+  // Dimension 0 is chunked with a size of 2.
+  grid = ChunkGridSpecification({ChunkGridSpecification::Component{
+      SharedArray<const void>(MakeArray<int>({1, 2})), Box<>(1)}});
+  // Any dirty entry exceeds the writeback limit.
+  auto cache = MakeChunkCache(
+      /*cache_identifier=*/{},
+      CachePool::Make(CachePool::Limits{10000000, /*queued=*/1}));
+
+  auto write_future1 =
+      tensorstore::Write(MakeArray<int>({3, 4}),
+                         GetTensorStore(cache) |
+                             tensorstore::Dims(0).SizedInterval(0, 2));
+  TENSORSTORE_EXPECT_OK(write_future1.copy_future);
+
+  // Writeback of chunk 0 is requested automatically.
+  auto r = mock_store->write_requests.pop();
+  EXPECT_THAT(ParseKey(r.key), ElementsAre(0));
+
+  // The second write is delayed until writeback of chunk 0 completes.
+  auto write_future2 =
+      tensorstore::Write(MakeArray<int>({5, 6}),
+                         GetTensorStore(cache) |
+                             tensorstore::Dims(0).SizedInterval(2, 2));
+  EXPECT_FALSE(write_future2.copy_future.ready());
+  r(memory_store);
+  TENSORSTORE_EXPECT_OK(write_future1.commit_future);
+  TENSORSTORE_EXPECT_OK(write_future2.copy_future);
+  {
+    auto r = mock_store->write_requests.pop();
+    EXPECT_THAT(ParseKey(r.key), ElementsAre(1));
+    r(memory_store);
+  }
+  TENSORSTORE_EXPECT_OK(write_future2.commit_future);
+  EXPECT_THAT(GetChunk({0}), ElementsAre(MakeArray<int>({3, 4})));
+  EXPECT_THAT(GetChunk({1}), ElementsAre(MakeArray<int>({5, 6})));
+}
+
 // Tests that overwriting a non-present chunk with the fill value results in the
 // chunk remaining deleted.
 TEST_F(ChunkCacheTest, OverwriteMissingWithFillValue) {
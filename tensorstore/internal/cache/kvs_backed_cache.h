@@ -22,6 +22,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 
@@ -29,6 +30,8 @@
 #include "absl/strings/cord.h"
 #include "absl/time/time.h"
 #include "tensorstore/internal/cache/async_cache.h"
+#include "tensorstore/internal/cache/cache_spill_store.h"
+#include "tensorstore/internal/mutex.h"
 #include "tensorstore/kvstore/driver.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/kvstore.h"
@@ -39,6 +42,7 @@
 #include "tensorstore/util/execution/future_sender.h"  // IWYU pragma: keep
 #include "tensorstore/util/future.h"
 #include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
 
 namespace tensorstore {
 namespace internal {
@@ -96,12 +100,88 @@ class KvsBackedCache : public Parent {
       return std::string{this->key()};
     }
 
+    /// Returns the key under which the encoded value of this entry is stored
+    /// in the `CacheSpillStore` of the cache pool.
+    std::string GetSpillStoreKey() {
+      auto& cache = GetOwningCache(*this);
+      return tensorstore::StrCat(cache.cache_identifier(),
+                                 std::string_view("\0", 1), this->key());
+    }
+
+    /// Encoded value from which the read state of an entry was decoded.
+    struct EncodedValue {
+      TimestampedStorageGeneration stamp;
+      absl::Cord value;
+    };
+
+    template <typename EntryOrNode>
+    struct DecodeReceiverImpl {
+      EntryOrNode* self_;
+      TimestampedStorageGeneration stamp_;
+      /// If `true`, `encoded_value_` is retained by the entry such that it may
+      /// later be demoted (only supported if `EntryOrNode` is `Entry`).
+      bool retain_encoded_value_ = false;
+      std::optional<absl::Cord> encoded_value_;
+      void set_error(absl::Status error) {
+        self_->ReadError(
+            GetOwningEntry(*self_).AnnotateError(error,
+                                                 /*reading=*/true));
+      }
+      void set_cancel() { set_error(absl::CancelledError("")); }
+      void set_value(std::shared_ptr<const void> data) {
+        AsyncCache::ReadState read_state;
+        read_state.stamp = std::move(stamp_);
+        read_state.data = std::move(data);
+        if constexpr (std::is_same_v<EntryOrNode, Entry>) {
+          if (retain_encoded_value_) {
+            self_->SetEncodedValue(read_state.stamp, std::move(encoded_value_));
+          }
+        }
+        self_->ReadSuccess(std::move(read_state));
+      }
+    };
+
     template <typename EntryOrNode>
     struct ReadReceiverImpl {
       EntryOrNode* entry_or_node_;
       std::shared_ptr<const void> existing_read_data_;
+      /// If non-null, values read are stored in `spill_store_` under
+      /// `spill_key_`.
+      CacheSpillStore* spill_store_ = nullptr;
+      std::string spill_key_;
+      /// Value retained by a demoted entry or retrieved from `spill_store_`,
+      /// whose generation was specified as `if_not_equal` for the read.
+      std::optional<absl::Cord> encoded_value_;
+      /// If `true`, the encoded value that is decoded is retained by the entry.
+      bool retain_encoded_value_ = false;
+
+      DecodeReceiverImpl<EntryOrNode> MakeDecodeReceiver(
+          TimestampedStorageGeneration stamp,
+          const std::optional<absl::Cord>& value) {
+        DecodeReceiverImpl<EntryOrNode> receiver{entry_or_node_,
+                                                 std::move(stamp)};
+        receiver.retain_encoded_value_ = retain_encoded_value_;
+        if (retain_encoded_value_) receiver.encoded_value_ = value;
+        return receiver;
+      }
+
       void set_value(kvstore::ReadResult read_result) {
         if (read_result.aborted()) {
+          if (encoded_value_) {
+            TENSORSTORE_ASYNC_CACHE_DEBUG_LOG(
+                *entry_or_node_,
+                "Encoded value has not changed, stamp=", read_result.stamp);
+            if (spill_store_) {
+              spill_store_->UpdateTimestampAsync(spill_key_,
+                                                 read_result.stamp.generation,
+                                                 read_result.stamp.time);
+            }
+            auto receiver = MakeDecodeReceiver(std::move(read_result.stamp),
+                                               encoded_value_);
+            GetOwningEntry(*entry_or_node_)
+                .DoDecode(std::move(encoded_value_), std::move(receiver));
+            return;
+          }
           TENSORSTORE_ASYNC_CACHE_DEBUG_LOG(
               *entry_or_node_,
               "Value has not changed, stamp=", read_result.stamp);
@@ -110,28 +190,21 @@ class KvsBackedCache : public Parent {
               std::move(existing_read_data_), std::move(read_result.stamp)});
           return;
         }
+        if (spill_store_) {
+          if (read_result.has_value()) {
+            spill_store_->WriteAsync(spill_key_, read_result.stamp,
+                                     read_result.value);
+          } else {
+            spill_store_->EraseAsync(spill_key_);
+          }
+        }
         TENSORSTORE_ASYNC_CACHE_DEBUG_LOG(*entry_or_node_,
                                           "DoDecode: ", read_result.stamp);
-        struct DecodeReceiverImpl {
-          EntryOrNode* self_;
-          TimestampedStorageGeneration stamp_;
-          void set_error(absl::Status error) {
-            self_->ReadError(
-                GetOwningEntry(*self_).AnnotateError(error,
-                                                     /*reading=*/true));
-          }
-          void set_cancel() { set_error(absl::CancelledError("")); }
-          void set_value(std::shared_ptr<const void> data) {
-            AsyncCache::ReadState read_state;
-            read_state.stamp = std::move(stamp_);
-            read_state.data = std::move(data);
-            self_->ReadSuccess(std::move(read_state));
-          }
-        };
+        auto value = std::move(read_result).optional_value();
+        auto receiver =
+            MakeDecodeReceiver(std::move(read_result.stamp), value);
         GetOwningEntry(*entry_or_node_)
-            .DoDecode(std::move(read_result).optional_value(),
-                      DecodeReceiverImpl{entry_or_node_,
-                                         std::move(read_result.stamp)});
+            .DoDecode(std::move(value), std::move(receiver));
       }
       void set_error(absl::Status error) {
         entry_or_node_->ReadError(GetOwningEntry(*entry_or_node_)
@@ -144,19 +217,87 @@ class KvsBackedCache : public Parent {
     ///
     /// Reads from the `kvstore::Driver` and invokes `DoDecode` with the result.
     ///
+    /// If this entry has been demoted (see `DoDemote`), or the cache pool has a
+    /// `CacheSpillStore` and this entry has not been read since it was
+    /// allocated (e.g. because it was previously evicted), the retained
+    /// encoded value is decoded if it satisfies `staleness_bound`, and
+    /// otherwise revalidated by specifying its generation as `if_not_equal`.
+    ///
     /// If an error occurs, calls `ReadError` directly without invoking
     /// `DoDecode`.
     void DoRead(absl::Time staleness_bound) final {
       kvstore::ReadOptions options;
       options.staleness_bound = staleness_bound;
-      auto read_state = AsyncCache::ReadLock<void>(*this).read_state();
+      AsyncCache::ReadState read_state;
+      std::optional<EncodedValue> encoded;
+      {
+        AsyncCache::ReadLock<void> lock(*this);
+        read_state = lock.read_state();
+        if (StorageGeneration::IsUnknown(read_state.stamp.generation)) {
+          encoded = encoded_value_;
+        }
+      }
       options.if_not_equal = std::move(read_state.stamp.generation);
       auto& cache = GetOwningCache(*this);
+      ReadReceiverImpl<Entry> receiver{this, std::move(read_state.data)};
+      receiver.retain_encoded_value_ = cache.pool_limits().demote_to_encoded;
+      // Entries of caches without an identifier can't be matched with spilled
+      // values after they are evicted, since the cache is destroyed as well.
+      if (auto* spill_store = cache.spill_store();
+          spill_store && !cache.cache_identifier().empty()) {
+        receiver.spill_store_ = spill_store;
+        receiver.spill_key_ = GetSpillStoreKey();
+        if (!encoded && StorageGeneration::IsUnknown(options.if_not_equal)) {
+          // Continue once the spilled value, if any, has been read on the
+          // executor of the spill store, to avoid blocking the calling thread
+          // on filesystem operations.
+          spill_store->ReadAsync(receiver.spill_key_)
+              .ExecuteWhenReady(
+                  [this, options = std::move(options),
+                   receiver = std::move(receiver)](
+                      ReadyFuture<std::optional<CacheSpillStore::ReadResult>>
+                          future) mutable {
+                    std::optional<EncodedValue> encoded;
+                    if (auto& spilled = future.value()) {
+                      encoded.emplace(EncodedValue{std::move(spilled->stamp),
+                                                   std::move(spilled->value)});
+                    }
+                    ReadWithEncodedValue(std::move(options),
+                                         std::move(receiver),
+                                         std::move(encoded));
+                  });
+          return;
+        }
+      }
+      ReadWithEncodedValue(std::move(options), std::move(receiver),
+                           std::move(encoded));
+    }
+
+    /// Completes a read started by `DoRead`.
+    ///
+    /// If `encoded` satisfies `options.staleness_bound`, it is decoded
+    /// directly.  Otherwise, the kvstore is read, specifying the generation of
+    /// `encoded`, if any, as `if_not_equal`.
+    void ReadWithEncodedValue(kvstore::ReadOptions options,
+                              ReadReceiverImpl<Entry> receiver,
+                              std::optional<EncodedValue> encoded) {
+      auto& cache = GetOwningCache(*this);
+      if (encoded) {
+        if (encoded->stamp.time >= options.staleness_bound) {
+          TENSORSTORE_ASYNC_CACHE_DEBUG_LOG(
+              *this, "DoDecode retained value: ", encoded->stamp);
+          auto decode_receiver = receiver.MakeDecodeReceiver(
+              std::move(encoded->stamp), encoded->value);
+          this->DoDecode(std::move(encoded->value),
+                         std::move(decode_receiver));
+          return;
+        }
+        options.if_not_equal = std::move(encoded->stamp.generation);
+        receiver.encoded_value_ = std::move(encoded->value);
+      }
       auto future = cache.kvstore_driver_->Read(this->GetKeyValueStoreKey(),
                                                 std::move(options));
-      execution::submit(
-          std::move(future),
-          ReadReceiverImpl<Entry>{this, std::move(read_state.data)});
+      execution::submit(std::move(future), std::move(receiver));
     }
 
     using DecodeReceiver =
@@ -188,6 +329,81 @@ class KvsBackedCache : public Parent {
       return GetOwningCache(*this).kvstore_driver_->AnnotateError(
           this->GetKeyValueStoreKey(), reading ? "reading" : "writing", error);
     }
+
+    /// Replaces the retained encoded value, which is accounted for in the size
+    /// of this entry.
+    void SetEncodedValue(const TimestampedStorageGeneration& stamp,
+                         std::optional<absl::Cord> value) {
+      UniqueWriterLock<AsyncCache::Entry> lock(*this);
+      const size_t old_size = GetEncodedValueSize();
+      if (value) {
+        encoded_value_.emplace(EncodedValue{stamp, std::move(*value)});
+      } else {
+        encoded_value_.reset();
+      }
+      if (GetEncodedValueSize() != old_size) {
+        this->flags_ |= AsyncCache::Entry::kSizeChanged;
+      }
+    }
+
+    /// Demotes this entry by clearing its read state, such that the next read
+    /// decodes the retained encoded value, after revalidating it if necessary.
+    ///
+    /// The entry is not demoted if it is locked, or if the read state does not
+    /// correspond to the retained encoded value (e.g. after a write).
+    bool DoDemote() override {
+      if (!this->mutex_.TryLock()) return false;
+      UniqueWriterLock<AsyncCache::Entry> lock(*this, std::adopt_lock);
+      auto& request_state = this->read_request_state_;
+      if (!encoded_value_ || !request_state.issued.null() ||
+          !request_state.read_state.data ||
+          request_state.read_state.stamp.generation !=
+              encoded_value_->stamp.generation) {
+        return false;
+      }
+      TENSORSTORE_ASYNC_CACHE_DEBUG_LOG(
+          *this, "DoDemote: ", request_state.read_state.stamp);
+      encoded_value_->stamp = std::move(request_state.read_state.stamp);
+      request_state.read_state = AsyncCache::ReadState{};
+      if (std::exchange(request_state.read_state_size, 0) != 0) {
+        this->flags_ |= AsyncCache::Entry::kSizeChanged;
+      }
+      return true;
+    }
+
+    /// Discards the read state, the retained encoded value, and any value
+    /// stored in the `CacheSpillStore`, after the value in the kvstore was
+    /// replaced without going through this entry.  The next read re-reads the
+    /// value from the kvstore.
+    void DiscardReadState() {
+      auto& cache = GetOwningCache(*this);
+      if (auto* spill_store = cache.spill_store();
+          spill_store && !cache.cache_identifier().empty()) {
+        spill_store->EraseAsync(GetSpillStoreKey());
+      }
+      UniqueWriterLock<AsyncCache::Entry> lock(*this);
+      auto& request_state = this->read_request_state_;
+      request_state.read_state = AsyncCache::ReadState{};
+      const bool size_changed = encoded_value_.has_value() ||
+                                request_state.read_state_size != 0;
+      encoded_value_.reset();
+      request_state.read_state_size = 0;
+      if (size_changed) {
+        this->flags_ |= AsyncCache::Entry::kSizeChanged;
+      }
+    }
+
+    size_t GetEncodedValueSize() const {
+      return encoded_value_ ? encoded_value_->value.size() : 0;
+    }
+
+    // Treat as private:
+
+    /// Encoded value from which the read state was decoded, retained only if
+    /// `CachePoolLimits::demote_to_encoded` is enabled.  While this entry is
+    /// demoted, the read state is unknown and `encoded_value_->stamp` is the
+    /// stamp of the read state prior to demotion.  Protected by `mutex_`.
+    std::optional<EncodedValue> encoded_value_;
   };
 
   class TransactionNode : public Parent::TransactionNode,
@@ -322,6 +538,17 @@ class KvsBackedCache : public Parent {
     }
 
     void KvsWritebackSuccess(TimestampedStorageGeneration new_stamp) override {
+      // Any encoded value retained by the entry or the spill store is now out
+      // of date.
+      auto& entry = GetOwningEntry(*this);
+      auto& cache = GetOwningCache(entry);
+      if (cache.pool_limits().demote_to_encoded) {
+        entry.SetEncodedValue({}, std::nullopt);
+      }
+      if (auto* spill_store = cache.spill_store();
+          spill_store && !cache.cache_identifier().empty()) {
+        spill_store->EraseAsync(entry.GetSpillStoreKey());
+      }
       return this->WritebackSuccess(
           AsyncCache::ReadState{std::move(new_data_), std::move(new_stamp)});
     }
@@ -337,6 +564,15 @@ class KvsBackedCache : public Parent {
     std::shared_ptr<const void> new_data_;
   };
 
+  /// Includes the size of the encoded value retained by the entry, if any,
+  /// which is charged whenever it is present, even while the decoded read
+  /// state is also resident.
+  size_t DoGetFixedSizeInBytes(Cache::Entry* base_entry) override {
+    auto* entry = static_cast<Entry*>(base_entry);
+    return Parent::DoGetFixedSizeInBytes(entry) +
+           entry->GetEncodedValueSize();
+  }
+
   /// Returns the associated `kvstore::Driver`.
   kvstore::Driver* kvstore_driver() { return kvstore_driver_.get(); }
 
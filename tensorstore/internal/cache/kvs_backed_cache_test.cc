@@ -18,6 +18,7 @@
 
 #include "tensorstore/internal/cache/kvs_backed_cache.h"
 
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -26,14 +27,18 @@
 #include <gtest/gtest.h>
 #include "tensorstore/internal/cache/async_cache.h"
 #include "tensorstore/internal/cache/cache.h"
+#include "tensorstore/internal/cache/cache_impl.h"
+#include "tensorstore/internal/cache/cache_spill_store.h"
 #include "tensorstore/internal/cache/kvs_backed_cache_testutil.h"
 #include "tensorstore/internal/global_initializer.h"
+#include "tensorstore/internal/test_util.h"
 #include "tensorstore/kvstore/kvstore.h"
 #include "tensorstore/kvstore/memory/memory_key_value_store.h"
 #include "tensorstore/kvstore/mock_kvstore.h"
 #include "tensorstore/kvstore/test_util.h"
 #include "tensorstore/transaction.h"
 #include "tensorstore/util/status_testutil.h"
+#include "tensorstore/util/str_cat.h"
 
 namespace {
 
@@ -44,10 +49,17 @@ using ::tensorstore::StorageGeneration;
 using ::tensorstore::TimestampedStorageGeneration;
 using ::tensorstore::Transaction;
 using ::tensorstore::internal::CachePool;
+using ::tensorstore::internal::CacheSpillStore;
 using ::tensorstore::internal::KvsBackedTestCache;
 using ::tensorstore::internal::MatchesKvsReadResult;
 using ::tensorstore::internal::MockKeyValueStore;
 using ::tensorstore::internal::OpenTransactionPtr;
+using ::tensorstore::internal_cache::Access;
+using ::tensorstore::internal_cache::CachePoolImpl;
+
+CachePoolImpl* GetPoolImpl(const CachePool::StrongPtr& ptr) {
+  return Access::StaticCast<CachePoolImpl>(ptr.get());
+}
 
 TENSORSTORE_GLOBAL_INITIALIZER {
   using ::tensorstore::internal::KvsBackedCacheBasicTransactionalTestOptions;
@@ -856,4 +868,226 @@ TEST_F(MockStoreTest, MultipleKeyValueStoreAtomicError) {
   }
 }
 
+class SpillStoreTest : public ::testing::Test {
+ protected:
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::shared_ptr<CacheSpillStore> spill_store =
+      CacheSpillStore::Open({tempdir.path(), 1000000}).value();
+  CachePool::StrongPtr pool = CachePool::Make(CachePool::Limits{}, spill_store);
+  MockKeyValueStore::MockPtr mock_store = MockKeyValueStore::Make();
+  kvstore::DriverPtr memory_store = tensorstore::GetMemoryKeyValueStore();
+
+  tensorstore::internal::CachePtr<KvsBackedTestCache> GetCache() {
+    return pool->GetCache<KvsBackedTestCache>("cache", [&] {
+      return std::make_unique<KvsBackedTestCache>(mock_store);
+    });
+  }
+
+  // Reads "a" from an entry that has been evicted from memory, which is
+  // guaranteed by the zero total bytes limit of `pool`.
+  absl::Cord ReadEvicted(StorageGeneration expected_if_not_equal) {
+    auto read_future =
+        GetCacheEntry(GetCache(), "a")->ReadValue({}, absl::Now());
+    auto read_req = mock_store->read_requests.pop();
+    EXPECT_EQ(expected_if_not_equal, read_req.options.if_not_equal);
+    read_req(memory_store);
+    return read_future.value();
+  }
+
+  // Returns the total size of the spilled values, after waiting for the
+  // pending asynchronous operations, which are performed in order.
+  size_t GetSpilledBytes() {
+    spill_store->ReadAsync("").Wait();
+    return spill_store->total_bytes();
+  }
+};
+
+TEST_F(SpillStoreTest, RevalidatesSpilledValue) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp, memory_store->Write("a", absl::Cord("abc")).result());
+  EXPECT_EQ("abc", ReadEvicted(StorageGeneration::Unknown()));
+  EXPECT_EQ(3, GetSpilledBytes());
+
+  // Value has not changed: the spilled value is used.
+  EXPECT_EQ("abc", ReadEvicted(stamp.generation));
+
+  // Value has changed: the new value is read and spilled.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp2, memory_store->Write("a", absl::Cord("defg")).result());
+  EXPECT_EQ("defg", ReadEvicted(stamp.generation));
+  EXPECT_EQ(4, GetSpilledBytes());
+  EXPECT_EQ("defg", ReadEvicted(stamp2.generation));
+}
+
+TEST_F(SpillStoreTest, SpilledValueSatisfiesStalenessBound) {
+  TENSORSTORE_ASSERT_OK(memory_store->Write("a", absl::Cord("abc")).result());
+  auto read_time = absl::Now();
+  EXPECT_EQ("abc", ReadEvicted(StorageGeneration::Unknown()));
+
+  // The spilled value was read after `read_time`, and therefore does not need
+  // to be revalidated.
+  auto read_future = GetCacheEntry(GetCache(), "a")->ReadValue({}, read_time);
+  EXPECT_EQ("abc", read_future.value());
+  EXPECT_TRUE(mock_store->read_requests.empty());
+}
+
+TEST_F(SpillStoreTest, MissingValueIsErased) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp, memory_store->Write("a", absl::Cord("abc")).result());
+  EXPECT_EQ("abc", ReadEvicted(StorageGeneration::Unknown()));
+  TENSORSTORE_ASSERT_OK(memory_store->Delete("a").result());
+  EXPECT_EQ("", ReadEvicted(stamp.generation));
+  EXPECT_EQ(0, GetSpilledBytes());
+}
+
+TEST_F(SpillStoreTest, WritebackErasesSpilledValue) {
+  TENSORSTORE_ASSERT_OK(memory_store->Write("a", absl::Cord("abc")).result());
+  EXPECT_EQ("abc", ReadEvicted(StorageGeneration::Unknown()));
+  EXPECT_EQ(3, GetSpilledBytes());
+  auto transaction = Transaction(tensorstore::isolated);
+  {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto open_transaction,
+        tensorstore::internal::AcquireOpenTransactionPtrOrError(transaction));
+    TENSORSTORE_ASSERT_OK(GetCacheEntry(GetCache(), "a")
+                              ->Modify(open_transaction, true, "xyz"));
+  }
+  transaction.CommitAsync().IgnoreFuture();
+  mock_store->write_requests.pop()(memory_store);
+  TENSORSTORE_ASSERT_OK(transaction.future());
+  EXPECT_EQ(0, GetSpilledBytes());
+}
+
+class DemoteToEncodedTest : public ::testing::Test {
+ protected:
+  static CachePool::Limits GetLimits() {
+    CachePool::Limits limits;
+    limits.total_bytes_limit = 1000000;
+    limits.demote_to_encoded = true;
+    return limits;
+  }
+
+  CachePool::StrongPtr pool = CachePool::Make(GetLimits());
+  MockKeyValueStore::MockPtr mock_store = MockKeyValueStore::Make();
+  kvstore::DriverPtr memory_store = tensorstore::GetMemoryKeyValueStore();
+  tensorstore::internal::CachePtr<KvsBackedTestCache> cache =
+      pool->GetCache<KvsBackedTestCache>("cache", [&] {
+        return std::make_unique<KvsBackedTestCache>(mock_store);
+      });
+  tensorstore::internal::PinnedCacheEntry<KvsBackedTestCache> entry =
+      GetCacheEntry(cache, "a");
+
+  absl::Cord Read(StorageGeneration expected_if_not_equal) {
+    auto read_future = entry->ReadValue({}, absl::Now());
+    auto read_req = mock_store->read_requests.pop();
+    EXPECT_EQ(expected_if_not_equal, read_req.options.if_not_equal);
+    read_req(memory_store);
+    return read_future.value();
+  }
+
+  StorageGeneration GetReadGeneration() {
+    return tensorstore::internal::AsyncCache::ReadLock<void>(*entry)
+        .stamp()
+        .generation;
+  }
+};
+
+TEST_F(DemoteToEncodedTest, RevalidatesDemotedValue) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp, memory_store->Write("a", absl::Cord("abc")).result());
+  const size_t initial_size = cache->DoGetSizeInBytes(entry.get());
+  EXPECT_EQ("abc", Read(StorageGeneration::Unknown()));
+  // The encoded value is accounted for in the size of the entry.
+  EXPECT_EQ(initial_size + 3, cache->DoGetSizeInBytes(entry.get()));
+
+  EXPECT_TRUE(entry->DoDemote());
+  EXPECT_EQ(StorageGeneration::Unknown(), GetReadGeneration());
+  EXPECT_EQ(initial_size + 3, cache->DoGetSizeInBytes(entry.get()));
+
+  // Value has not changed: the demoted value is decoded.
+  EXPECT_EQ("abc", Read(stamp.generation));
+  EXPECT_EQ(stamp.generation, GetReadGeneration());
+  EXPECT_EQ(initial_size + 3, cache->DoGetSizeInBytes(entry.get()));
+
+  // Value has changed: the new value is read and retained.
+  EXPECT_TRUE(entry->DoDemote());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp2, memory_store->Write("a", absl::Cord("defg")).result());
+  EXPECT_EQ("defg", Read(stamp.generation));
+  EXPECT_EQ(initial_size + 4, cache->DoGetSizeInBytes(entry.get()));
+  EXPECT_TRUE(entry->DoDemote());
+  EXPECT_EQ(initial_size + 4, cache->DoGetSizeInBytes(entry.get()));
+  EXPECT_EQ("defg", Read(stamp2.generation));
+}
+
+// Tests that an entry that has not been demoted is charged for both the
+// decoded and the retained encoded value, such that the pool stays within
+// `total_bytes_limit` even if all entries are hot.
+TEST_F(DemoteToEncodedTest, HotEntriesStayWithinLimit) {
+  TENSORSTORE_ASSERT_OK(
+      memory_store->Write("a", absl::Cord(std::string(100, 'x'))).result());
+  const size_t initial_size = cache->DoGetSizeInBytes(entry.get());
+  EXPECT_EQ(std::string(100, 'x'), Read(StorageGeneration::Unknown()));
+  EXPECT_EQ(initial_size + 200, GetPoolImpl(pool)->total_bytes_.load());
+
+  // Each entry is charged `entry_size` bytes, and the limit is large enough
+  // for 4 entries.
+  const size_t entry_size = initial_size + 200;
+  CachePool::Limits limits = GetLimits();
+  limits.total_bytes_limit = 4 * entry_size + entry_size / 2;
+  auto small_pool = CachePool::Make(limits);
+  auto small_cache = small_pool->GetCache<KvsBackedTestCache>("cache", [&] {
+    return std::make_unique<KvsBackedTestCache>(memory_store);
+  });
+  for (int i = 0; i < 10; ++i) {
+    const std::string key = tensorstore::StrCat("k", i);
+    TENSORSTORE_ASSERT_OK(
+        memory_store->Write(key, absl::Cord(std::string(100, 'x'))).result());
+    // Each entry is read twice, such that it is hot when released.
+    for (int j = 0; j < 2; ++j) {
+      auto hot_entry = GetCacheEntry(small_cache, key);
+      TENSORSTORE_ASSERT_OK(hot_entry->ReadValue({}).result());
+    }
+    EXPECT_LE(GetPoolImpl(small_pool)->total_bytes_.load(),
+              limits.total_bytes_limit);
+  }
+}
+
+TEST_F(DemoteToEncodedTest, DemotedValueSatisfiesStalenessBound) {
+  TENSORSTORE_ASSERT_OK(memory_store->Write("a", absl::Cord("abc")).result());
+  auto read_time = absl::Now();
+  EXPECT_EQ("abc", Read(StorageGeneration::Unknown()));
+  EXPECT_TRUE(entry->DoDemote());
+
+  // The demoted value was read after `read_time`, and therefore does not need
+  // to be revalidated.
+  auto read_future = entry->ReadValue({}, read_time);
+  ASSERT_TRUE(read_future.ready());
+  EXPECT_EQ("abc", read_future.value());
+  EXPECT_TRUE(mock_store->read_requests.empty());
+}
+
+TEST_F(DemoteToEncodedTest, MissingValueIsNotDemoted) {
+  EXPECT_EQ("", Read(StorageGeneration::Unknown()));
+  EXPECT_FALSE(entry->DoDemote());
+}
+
+TEST_F(DemoteToEncodedTest, WritebackClearsEncodedValue) {
+  TENSORSTORE_ASSERT_OK(memory_store->Write("a", absl::Cord("abc")).result());
+  const size_t initial_size = cache->DoGetSizeInBytes(entry.get());
+  EXPECT_EQ("abc", Read(StorageGeneration::Unknown()));
+  auto transaction = Transaction(tensorstore::isolated);
+  {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto open_transaction,
+        tensorstore::internal::AcquireOpenTransactionPtrOrError(transaction));
+    TENSORSTORE_ASSERT_OK(entry->Modify(open_transaction, true, "xyz"));
+  }
+  transaction.CommitAsync().IgnoreFuture();
+  mock_store->write_requests.pop()(memory_store);
+  TENSORSTORE_ASSERT_OK(transaction.future());
+  EXPECT_EQ(initial_size, cache->DoGetSizeInBytes(entry.get()));
+  EXPECT_FALSE(entry->DoDemote());
+}
+
 }  // namespace
@@ -81,6 +81,11 @@ void KvsBackedTestCache::Entry::DoEncode(std::shared_ptr<const absl::Cord> data,
   }
 }
 
+size_t KvsBackedTestCache::Entry::ComputeReadDataSizeInBytes(
+    const void* data) {
+  return static_cast<const absl::Cord*>(data)->size();
+}
+
 Result<OpenTransactionNodePtr<KvsBackedTestCache::TransactionNode>>
 KvsBackedTestCache::Entry::Modify(const OpenTransactionPtr& transaction,
                                   bool clear, std::string_view append_value) {
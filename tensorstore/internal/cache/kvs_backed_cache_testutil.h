@@ -110,6 +110,8 @@ class KvsBackedTestCache
 
     void DoEncode(std::shared_ptr<const absl::Cord> data,
                   EncodeReceiver receiver) override;
+
+    size_t ComputeReadDataSizeInBytes(const void* data) override;
   };
 
   class TransactionNode : public Base::TransactionNode {
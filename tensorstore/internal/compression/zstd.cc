@@ -0,0 +1,121 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/compression/zstd.h"
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "tensorstore/util/assert_macros.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
+
+#include <zstd.h>
+
+namespace tensorstore {
+namespace zstd {
+namespace {
+
+constexpr size_t kBufferSize = 16 * 1024;
+
+struct CCtxDeleter {
+  void operator()(ZSTD_CCtx* ctx) const { ZSTD_freeCCtx(ctx); }
+};
+
+struct DCtxDeleter {
+  void operator()(ZSTD_DCtx* ctx) const { ZSTD_freeDCtx(ctx); }
+};
+
+}  // namespace
+
+absl::Status Encode(const absl::Cord& input, absl::Cord* output,
+                    const Options& options) {
+  // Out-of-range levels would otherwise be silently clamped.
+  if (options.level < kMinLevel || options.level > kMaxLevel) {
+    return absl::InvalidArgumentError(
+        tensorstore::StrCat("Invalid zstd compression level: ", options.level));
+  }
+  std::unique_ptr<ZSTD_CCtx, CCtxDeleter> ctx(ZSTD_createCCtx());
+  // Terminate if allocating even the small amount of memory required fails.
+  TENSORSTORE_CHECK(ctx);
+  ZSTD_CCtx_setParameter(ctx.get(), ZSTD_c_compressionLevel, options.level);
+  ZSTD_CCtx_setParameter(ctx.get(), ZSTD_c_checksumFlag,
+                         options.use_checksum ? 1 : 0);
+  // Recording the content size in the frame header is required by some
+  // decoders, e.g. numcodecs, and allows the decoder to allocate the output
+  // buffer up front.
+  ZSTD_CCtx_setPledgedSrcSize(ctx.get(), input.size());
+  char buffer[kBufferSize];
+  // Compresses `in` until it has been consumed entirely (for
+  // `ZSTD_e_continue`) or the frame has been completed (for `ZSTD_e_end`).
+  const auto compress = [&](ZSTD_inBuffer& in, ZSTD_EndDirective mode) {
+    while (true) {
+      ZSTD_outBuffer out{buffer, kBufferSize, 0};
+      const size_t remaining =
+          ZSTD_compressStream2(ctx.get(), &out, &in, mode);
+      // Compression fails only due to invalid parameters, which have already
+      // been validated.
+      TENSORSTORE_CHECK(!ZSTD_isError(remaining));
+      output->Append(std::string_view(buffer, out.pos));
+      if (mode == ZSTD_e_end ? remaining == 0 : in.pos == in.size) return;
+    }
+  };
+  for (std::string_view chunk : input.Chunks()) {
+    ZSTD_inBuffer in{chunk.data(), chunk.size(), 0};
+    compress(in, ZSTD_e_continue);
+  }
+  ZSTD_inBuffer in{nullptr, 0, 0};
+  compress(in, ZSTD_e_end);
+  return absl::OkStatus();
+}
+
+absl::Status Decode(const absl::Cord& input, absl::Cord* output) {
+  std::unique_ptr<ZSTD_DCtx, DCtxDeleter> ctx(ZSTD_createDCtx());
+  TENSORSTORE_CHECK(ctx);
+  char buffer[kBufferSize];
+  // Non-zero until a complete frame has been decoded, and then while within a
+  // subsequent frame.
+  size_t frame_remaining = 1;
+  for (std::string_view chunk : input.Chunks()) {
+    ZSTD_inBuffer in{chunk.data(), chunk.size(), 0};
+    while (in.pos < in.size) {
+      ZSTD_outBuffer out{buffer, kBufferSize, 0};
+      frame_remaining = ZSTD_decompressStream(ctx.get(), &out, &in);
+      if (ZSTD_isError(frame_remaining)) {
+        return absl::InvalidArgumentError(
+            tensorstore::StrCat("Error decoding zstd-compressed data: ",
+                                ZSTD_getErrorName(frame_remaining)));
+      }
+      output->Append(std::string_view(buffer, out.pos));
+    }
+  }
+  // Flush any output that did not fit in the buffer.
+  while (frame_remaining != 0) {
+    ZSTD_inBuffer in{nullptr, 0, 0};
+    ZSTD_outBuffer out{buffer, kBufferSize, 0};
+    frame_remaining = ZSTD_decompressStream(ctx.get(), &out, &in);
+    if (ZSTD_isError(frame_remaining) || out.pos == 0) {
+      return absl::InvalidArgumentError(
+          "Error decoding zstd-compressed data: Truncated input");
+    }
+    output->Append(std::string_view(buffer, out.pos));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace zstd
+}  // namespace tensorstore
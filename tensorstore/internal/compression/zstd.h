@@ -0,0 +1,68 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_INTERNAL_COMPRESSION_ZSTD_H_
+#define TENSORSTORE_INTERNAL_COMPRESSION_ZSTD_H_
+
+/// \file
+/// Convenience interface to the zstd library.
+
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+
+namespace tensorstore {
+namespace zstd {
+
+/// Range of valid compression levels, equal to `ZSTD_minCLevel()` and
+/// `ZSTD_maxCLevel()`.
+constexpr int kMinLevel = -(1 << 17);
+constexpr int kMaxLevel = 22;
+
+struct Options {
+  /// Specifies the compression level, must be in the range
+  /// `[kMinLevel, kMaxLevel]`.  Negative levels are faster but achieve a lower
+  /// compression ratio, while higher levels are slower but achieve a higher
+  /// compression ratio.  The special value `0` indicates the zstd default
+  /// compression level (equal to 3).
+  int level = 0;
+
+  /// Specifies whether to include a checksum of the uncompressed data in the
+  /// frame, which is verified when decoding.
+  bool use_checksum = false;
+};
+
+/// Compresses `input` as a single zstd frame, which records the size of
+/// `input`, and appends the result to `*output`.
+///
+/// \param input Input to encode.
+/// \param output[in,out] Output cord to which compressed data will be appended.
+/// \param options Specifies the compression options.
+/// \error `absl::StatusCode::kInvalidArgument` if `options.level` is invalid.
+absl::Status Encode(const absl::Cord& input, absl::Cord* output,
+                    const Options& options);
+
+/// Decompresses `input`, which may consist of one or more zstd frames, and
+/// appends the result to `*output`.
+///
+/// \param input Input to decode.
+/// \param output[in,out] Output cord to which decompressed data will be
+///     appended.
+/// \returns `absl::Status()` on success.
+/// \error `absl::StatusCode::kInvalidArgument` if `input` is corrupt.
+absl::Status Decode(const absl::Cord& input, absl::Cord* output);
+
+}  // namespace zstd
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_INTERNAL_COMPRESSION_ZSTD_H_
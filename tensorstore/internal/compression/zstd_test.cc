@@ -0,0 +1,184 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/compression/zstd.h"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/cord.h"
+#include "absl/strings/cord_test_helpers.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/status_testutil.h"
+
+#include <zstd.h>
+
+namespace {
+
+using ::tensorstore::MatchesStatus;
+
+namespace zstd = tensorstore::zstd;
+
+class ZstdCompressorTest : public ::testing::TestWithParam<bool> {};
+
+INSTANTIATE_TEST_SUITE_P(ZstdCompressorTestCases, ZstdCompressorTest,
+                         ::testing::Values(false, true));
+
+// Tests that a small input round trips, and that the result is appended to the
+// output string without clearing the existing contents.
+TEST_P(ZstdCompressorTest, SmallRoundtrip) {
+  zstd::Options options{6, /*use_checksum=*/GetParam()};
+  const absl::Cord input("The quick brown fox jumped over the lazy dog.");
+  absl::Cord encode_result("abc"), decode_result("def");
+  TENSORSTORE_ASSERT_OK(zstd::Encode(input, &encode_result, options));
+  ASSERT_GE(encode_result.size(), 3);
+  EXPECT_EQ("abc", encode_result.Subcord(0, 3));
+  TENSORSTORE_ASSERT_OK(zstd::Decode(
+      encode_result.Subcord(3, encode_result.size() - 3), &decode_result));
+  EXPECT_EQ("def" + std::string(input), decode_result);
+}
+
+// Same as above, but with fragmented input.
+TEST_P(ZstdCompressorTest, SmallRoundtripFragmented) {
+  zstd::Options options{6, /*use_checksum=*/GetParam()};
+  const absl::Cord input = absl::MakeFragmentedCord(
+      {"The quick", " brown fox", " jumped over", " ", "the lazy dog."});
+  absl::Cord encode_result("abc"), decode_result("def");
+  TENSORSTORE_ASSERT_OK(zstd::Encode(input, &encode_result, options));
+  ASSERT_GE(encode_result.size(), 3);
+  EXPECT_EQ("abc", encode_result.Subcord(0, 3));
+  std::vector<std::string> encode_result_fragments;
+  for (size_t i = 3; i < encode_result.size(); ++i) {
+    encode_result_fragments.push_back(std::string(encode_result.Subcord(i, 1)));
+  }
+  TENSORSTORE_ASSERT_OK(zstd::Decode(
+      absl::MakeFragmentedCord(encode_result_fragments), &decode_result));
+  EXPECT_EQ("def" + std::string(input), decode_result);
+}
+
+// Tests that round tripping works for with an input that exceeds the 16KiB
+// buffer size.
+TEST_P(ZstdCompressorTest, LargeRoundtrip) {
+  std::string input(100000, '\0');
+  unsigned char x = 0;
+  for (auto& v : input) {
+    v = x;
+    x += 7;
+  }
+  zstd::Options options{6, /*use_checksum=*/GetParam()};
+  absl::Cord encode_result, decode_result;
+  TENSORSTORE_ASSERT_OK(
+      zstd::Encode(absl::Cord(input), &encode_result, options));
+  TENSORSTORE_ASSERT_OK(zstd::Decode(encode_result, &decode_result));
+  EXPECT_EQ(input, decode_result);
+}
+
+// Tests that an empty input round trips.
+TEST_P(ZstdCompressorTest, EmptyRoundtrip) {
+  zstd::Options options{0, /*use_checksum=*/GetParam()};
+  absl::Cord encode_result, decode_result;
+  TENSORSTORE_ASSERT_OK(zstd::Encode(absl::Cord(), &encode_result, options));
+  EXPECT_FALSE(encode_result.empty());
+  TENSORSTORE_ASSERT_OK(zstd::Decode(encode_result, &decode_result));
+  EXPECT_TRUE(decode_result.empty());
+}
+
+// Tests that concatenated frames are decoded.
+TEST(ZstdCompressorTest, MultipleFrames) {
+  absl::Cord encode_result, decode_result;
+  TENSORSTORE_ASSERT_OK(zstd::Encode(absl::Cord("abc"), &encode_result, {}));
+  TENSORSTORE_ASSERT_OK(zstd::Encode(absl::Cord("def"), &encode_result, {}));
+  TENSORSTORE_ASSERT_OK(zstd::Decode(encode_result, &decode_result));
+  EXPECT_EQ("abcdef", decode_result);
+}
+
+// Tests that specifying a level of 19 gives a result that is different from
+// the default level.
+TEST(ZstdCompressorTest, NonDefaultLevel) {
+  zstd::Options options1;
+  zstd::Options options2{19};
+  std::string input;
+  for (int i = 0; i < 1000; ++i) input += std::to_string(i * i % 997);
+  absl::Cord encode_result1, encode_result2;
+  TENSORSTORE_ASSERT_OK(
+      zstd::Encode(absl::Cord(input), &encode_result1, options1));
+  TENSORSTORE_ASSERT_OK(
+      zstd::Encode(absl::Cord(input), &encode_result2, options2));
+  EXPECT_NE(encode_result1, encode_result2);
+  absl::Cord decode_result;
+  TENSORSTORE_ASSERT_OK(zstd::Decode(encode_result2, &decode_result));
+  EXPECT_EQ(input, decode_result);
+}
+
+TEST(ZstdCompressorTest, LevelRange) {
+  EXPECT_EQ(ZSTD_minCLevel(), zstd::kMinLevel);
+  EXPECT_EQ(ZSTD_maxCLevel(), zstd::kMaxLevel);
+}
+
+TEST(ZstdCompressorTest, InvalidLevel) {
+  absl::Cord encode_result;
+  EXPECT_THAT(zstd::Encode(absl::Cord("abc"), &encode_result, {1000}),
+              MatchesStatus(absl::StatusCode::kInvalidArgument,
+                            "Invalid zstd compression level: 1000"));
+}
+
+// Tests that decoding corrupt data gives an error.
+TEST(ZstdCompressorTest, DecodeCorruptData) {
+  zstd::Options options{6, /*use_checksum=*/true};
+  const absl::Cord input("The quick brown fox jumped over the lazy dog.");
+
+  // Test corrupting the header.
+  {
+    absl::Cord encode_result, decode_result;
+    TENSORSTORE_ASSERT_OK(zstd::Encode(input, &encode_result, options));
+    ASSERT_GE(encode_result.size(), 1);
+    std::string corrupted(encode_result);
+    corrupted[0] = 0;
+    EXPECT_THAT(zstd::Decode(absl::Cord(corrupted), &decode_result),
+                MatchesStatus(absl::StatusCode::kInvalidArgument));
+  }
+
+  // Test corrupting the checksum.
+  {
+    absl::Cord encode_result, decode_result;
+    TENSORSTORE_ASSERT_OK(zstd::Encode(input, &encode_result, options));
+    ASSERT_GE(encode_result.size(), 1);
+    std::string corrupted(encode_result);
+    corrupted.back() ^= 1;
+    EXPECT_THAT(zstd::Decode(absl::Cord(corrupted), &decode_result),
+                MatchesStatus(absl::StatusCode::kInvalidArgument));
+  }
+
+  // Test truncating the input.
+  {
+    absl::Cord encode_result, decode_result;
+    TENSORSTORE_ASSERT_OK(zstd::Encode(input, &encode_result, options));
+    ASSERT_GE(encode_result.size(), 1);
+    std::string corrupted(encode_result);
+    corrupted.resize(corrupted.size() - 1);
+    EXPECT_THAT(zstd::Decode(absl::Cord(corrupted), &decode_result),
+                MatchesStatus(absl::StatusCode::kInvalidArgument));
+  }
+
+  // Test empty input.
+  {
+    absl::Cord decode_result;
+    EXPECT_THAT(zstd::Decode(absl::Cord(), &decode_result),
+                MatchesStatus(absl::StatusCode::kInvalidArgument));
+  }
+}
+
+}  // namespace
@@ -16,13 +16,18 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
+#include <atomic>
 #include <clocale>
 #include <cstddef>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <utility>
+#include <vector>
 
+#include "absl/flags/marshalling.h"
 #include "absl/status/status.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
@@ -75,6 +80,22 @@ const CurlConfig& CurlEnvConfig() {
   return *curl_config;
 }
 
+size_t GetDefaultCurlThreads() {
+  // Each event loop is limited to a single core, which is typically saturated
+  // by TLS and header processing at a few Gbit/s.
+  const size_t kDefault = std::clamp(
+      size_t(std::thread::hardware_concurrency()) / 4, size_t(1), size_t(4));
+  auto env = internal::GetEnv("TENSORSTORE_CURL_THREADS");
+  if (!env) {
+    return kDefault;
+  }
+  size_t num_threads;
+  std::string error;
+  return absl::ParseFlag(*env, &num_threads, &error) && num_threads > 0
+             ? num_threads
+             : kDefault;
+}
+
 struct CurlRequestState {
   CurlHandleFactory* factory_;
   CurlPtr handle_;
@@ -122,6 +143,15 @@ struct CurlRequestState {
     TENSORSTORE_CHECK_OK(CurlEasySetopt(handle_.get(), CURLOPT_HEADERFUNCTION,
                                         &CurlRequestState::CurlHeaderCallback));
 
+    // Abort the transfer once the result is no longer needed.
+    TENSORSTORE_CHECK_OK(
+        CurlEasySetopt(handle_.get(), CURLOPT_XFERINFODATA, this));
+    TENSORSTORE_CHECK_OK(
+        CurlEasySetopt(handle_.get(), CURLOPT_XFERINFOFUNCTION,
+                       &CurlRequestState::CurlXferInfoCallback));
+    TENSORSTORE_CHECK_OK(
+        CurlEasySetopt(handle_.get(), CURLOPT_NOPROGRESS, 0L));
+
     TENSORSTORE_CHECK_OK(
         CurlEasySetopt(handle_.get(), CURLOPT_ERRORBUFFER, error_buffer_));
     TENSORSTORE_CHECK_OK(CurlEasySetopt(handle_.get(), CURLOPT_PRIVATE, this));
@@ -146,6 +176,12 @@ struct CurlRequestState {
         CurlEasySetopt(handle_.get(), CURLOPT_HEADERDATA, nullptr));
     TENSORSTORE_CHECK_OK(
         CurlEasySetopt(handle_.get(), CURLOPT_HEADERFUNCTION, nullptr));
+    TENSORSTORE_CHECK_OK(
+        CurlEasySetopt(handle_.get(), CURLOPT_NOPROGRESS, 1L));
+    TENSORSTORE_CHECK_OK(
+        CurlEasySetopt(handle_.get(), CURLOPT_XFERINFODATA, nullptr));
+    TENSORSTORE_CHECK_OK(
+        CurlEasySetopt(handle_.get(), CURLOPT_XFERINFOFUNCTION, nullptr));
     TENSORSTORE_CHECK_OK(
         CurlEasySetopt(handle_.get(), CURLOPT_ERRORBUFFER, nullptr));
 
@@ -299,6 +335,15 @@ struct CurlRequestState {
     return CURL_SEEKFUNC_OK;
   }
 
+  static int CurlXferInfoCallback(void* userdata, curl_off_t dltotal,
+                                  curl_off_t dlnow, curl_off_t ultotal,
+                                  curl_off_t ulnow) {
+    auto* self = static_cast<CurlRequestState*>(userdata);
+    // A non-zero return value aborts the transfer with
+    // CURLE_ABORTED_BY_CALLBACK.
+    return self->promise_.result_needed() ? 0 : 1;
+  }
+
   static std::size_t CurlHeaderCallback(void* contents, std::size_t size,
                                         std::size_t nmemb, void* userdata) {
     auto* self = static_cast<CurlRequestState*>(userdata);
@@ -308,6 +353,8 @@ struct CurlRequestState {
   }
 };
 
+/// Event loop that performs transfers using a single curl_multi handle, and
+/// therefore a single connection cache, on a dedicated thread.
 class MultiTransportImpl {
  public:
   explicit MultiTransportImpl(std::shared_ptr<CurlHandleFactory> factory)
@@ -340,12 +387,18 @@ class MultiTransportImpl {
     return pvt;
   }
 
+  /// Returns the number of requests started but not yet finished.
+  size_t in_flight() const {
+    return in_flight_.load(std::memory_order_relaxed);
+  }
+
   std::shared_ptr<CurlHandleFactory> factory_;
   CurlMulti multi_;
 
   absl::Mutex mutex_;
   std::vector<CURL*> pending_requests_;
   std::atomic<bool> done_{false};
+  std::atomic<size_t> in_flight_{0};
 
   internal::Thread thread_;
 };
@@ -369,6 +422,7 @@ Future<HttpResponse> MultiTransportImpl::StartRequest(
   // Add the handle to the curl_multi state.
   // TODO: Add an ExecuteWhenNotNeeded callback which removes
   // the handle from the pending / active requests set.
+  in_flight_.fetch_add(1, std::memory_order_relaxed);
   {
     absl::MutexLock l(&mutex_);
     pending_requests_.emplace_back(e);
@@ -391,8 +445,12 @@ void MultiTransportImpl::FinishRequest(CURL* e, CURLcode code) {
   }
 
   http_request_completed.Increment();
+  in_flight_.fetch_sub(1, std::memory_order_relaxed);
 
-  if (code != CURLE_OK) {
+  if (code == CURLE_ABORTED_BY_CALLBACK) {
+    // The result is no longer needed; see `CurlXferInfoCallback`.
+    state->promise_.SetResult(absl::CancelledError("HTTP request cancelled"));
+  } else if (code != CURLE_OK) {
     state->promise_.SetResult(state->CurlCodeToStatus(code));
   } else {
     state->response_.status_code = CurlGetResponseCode(e);
@@ -442,13 +500,18 @@ void MultiTransportImpl::Run() {
         curl_easy_getinfo(e, CURLINFO_PRIVATE, &state);
 
         // This future has been cancelled before we even begin.
-        if (!state->promise_.result_needed()) continue;
+        if (!state->promise_.result_needed()) {
+          std::unique_ptr<CurlRequestState> cancelled(state);
+          in_flight_.fetch_sub(1, std::memory_order_relaxed);
+          continue;
+        }
 
         CURLMcode mcode = curl_multi_add_handle(multi_.get(), e);
         if (mcode == CURLM_OK) {
           active_count++;
         } else {
           // This shouldn't happen unless things have really gone pear-shaped.
+          in_flight_.fetch_sub(1, std::memory_order_relaxed);
           state->promise_.SetResult(
               CurlMCodeToStatus(mcode, "in curl_multi_add_handle"));
         }
@@ -480,13 +543,48 @@ void MultiTransportImpl::Run() {
 
 }  // namespace
 
-class CurlTransport::Impl : public MultiTransportImpl {
+/// Distributes requests across multiple event loops.
+class CurlTransport::Impl {
  public:
-  using MultiTransportImpl::MultiTransportImpl;
+  explicit Impl(std::shared_ptr<CurlHandleFactory> factory,
+                size_t num_threads) {
+    loops_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+      loops_.push_back(std::make_unique<MultiTransportImpl>(factory));
+    }
+  }
+
+  Future<HttpResponse> StartRequest(const HttpRequest& request,
+                                    absl::Cord payload,
+                                    absl::Duration request_timeout,
+                                    absl::Duration connect_timeout) {
+    return ChooseLoop().StartRequest(request, std::move(payload),
+                                     request_timeout, connect_timeout);
+  }
+
+ private:
+  /// Returns the event loop with the fewest requests in flight.  Ties are
+  /// broken in round-robin order.
+  MultiTransportImpl& ChooseLoop() {
+    const size_t n = loops_.size();
+    const size_t start = next_loop_.fetch_add(1, std::memory_order_relaxed);
+    MultiTransportImpl* best = nullptr;
+    for (size_t i = 0; i < n; ++i) {
+      auto* loop = loops_[(start + i) % n].get();
+      if (!best || loop->in_flight() < best->in_flight()) best = loop;
+    }
+    return *best;
+  }
+
+  std::vector<std::unique_ptr<MultiTransportImpl>> loops_;
+  std::atomic<size_t> next_loop_{0};
 };
 
-CurlTransport::CurlTransport(std::shared_ptr<CurlHandleFactory> factory)
-    : impl_(std::make_unique<Impl>(std::move(factory))) {}
+CurlTransport::CurlTransport(std::shared_ptr<CurlHandleFactory> factory,
+                             size_t num_threads)
+    : impl_(std::make_unique<Impl>(
+          std::move(factory),
+          num_threads == 0 ? GetDefaultCurlThreads() : num_threads)) {}
 
 CurlTransport::~CurlTransport() = default;
 
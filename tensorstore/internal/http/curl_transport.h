@@ -15,6 +15,8 @@
 #ifndef TENSORSTORE_INTERNAL_HTTP_CURL_TRANSPORT_H_
 #define TENSORSTORE_INTERNAL_HTTP_CURL_TRANSPORT_H_
 
+#include <stddef.h>
+
 #include <memory>
 #include <string_view>
 
@@ -34,9 +36,19 @@ void InitializeCurlHandle(CURL* handle);
 
 /// Implementation of HttpTransport which uses libcurl via the curl_multi
 /// interface.
+///
+/// Requests are distributed across `num_threads` event loops, each of which
+/// runs on its own thread with its own curl_multi handle and connection cache.
 class CurlTransport : public HttpTransport {
  public:
-  explicit CurlTransport(std::shared_ptr<CurlHandleFactory> factory);
+  /// Constructs a transport.
+  ///
+  /// \param factory Factory for curl handles.
+  /// \param num_threads Number of event loop threads.  If `0`, the value of
+  ///     the `TENSORSTORE_CURL_THREADS` environment variable is used, or, if it
+  ///     is not set, a default based on the number of CPUs.
+  explicit CurlTransport(std::shared_ptr<CurlHandleFactory> factory,
+                         size_t num_threads = 0);
 
   ~CurlTransport() override;
 
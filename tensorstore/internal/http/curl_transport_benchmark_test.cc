@@ -0,0 +1,190 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef _WIN32
+#undef UNICODE
+#define WIN32_LEAN_AND_MEAN
+#pragma comment(lib, "ws2_32.lib")
+#endif
+
+/// \file
+/// Measures the download throughput of `CurlTransport` as a function of the
+/// number of event loop threads.
+///
+/// Each iteration issues `kConcurrentRequests` concurrent GET requests to a
+/// local HTTP/1.1 server, which serves each keep-alive connection on its own
+/// thread and responds to every request with `response_size` bytes.
+
+#include <stddef.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include <benchmark/benchmark.h>
+#include "tensorstore/internal/global_initializer.h"
+#include "tensorstore/internal/http/curl_handle.h"
+#include "tensorstore/internal/http/curl_transport.h"
+#include "tensorstore/internal/http/http_request.h"
+#include "tensorstore/internal/http/http_response.h"
+#include "tensorstore/internal/http/http_transport.h"
+#include "tensorstore/internal/http/transport_test_utils.h"
+#include "tensorstore/internal/thread.h"
+#include "tensorstore/util/assert_macros.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace {
+
+using ::tensorstore::Future;
+using ::tensorstore::internal_http::CurlTransport;
+using ::tensorstore::internal_http::GetDefaultCurlHandleFactory;
+using ::tensorstore::internal_http::HttpRequestBuilder;
+using ::tensorstore::internal_http::HttpResponse;
+using ::tensorstore::internal_http::HttpTransport;
+using ::tensorstore::transport_test_utils::CloseSocket;
+using ::tensorstore::transport_test_utils::CreateBoundSocket;
+using ::tensorstore::transport_test_utils::FormatSocketAddress;
+using ::tensorstore::transport_test_utils::kInvalidSocket;
+using ::tensorstore::transport_test_utils::socket_t;
+
+constexpr size_t kConcurrentRequests = 64;
+
+/// Minimal HTTP/1.1 server that responds to every request with a fixed
+/// response.
+class LocalHttpServer {
+ public:
+  explicit LocalHttpServer(size_t response_size)
+      : response_(absl::StrCat("HTTP/1.1 200 OK\r\n"
+                               "Content-Type: application/octet-stream\r\n"
+                               "Connection: Keep-Alive\r\n"
+                               "Content-Length: ",
+                               response_size, "\r\n\r\n",
+                               std::string(response_size, 'x'))),
+        listen_socket_(CreateBoundSocket()) {
+    TENSORSTORE_CHECK(listen_socket_ != kInvalidSocket);
+    hostport_ = FormatSocketAddress(listen_socket_);
+    accept_thread_ =
+        tensorstore::internal::Thread({"accept_thread"}, [this] { Accept(); });
+  }
+
+  ~LocalHttpServer() {
+    done_ = true;
+    // Wakes up the blocked `accept` call.
+    shutdown(listen_socket_, 2);
+    CloseSocket(listen_socket_);
+    accept_thread_.Join();
+    absl::MutexLock lock(&mutex_);
+    for (auto& thread : connection_threads_) thread.Join();
+  }
+
+  const std::string& hostport() const { return hostport_; }
+
+ private:
+  void Accept() {
+    while (!done_) {
+      socket_t client = accept(listen_socket_, nullptr, nullptr);
+      if (client == kInvalidSocket) continue;
+      absl::MutexLock lock(&mutex_);
+      connection_threads_.emplace_back(
+          tensorstore::internal::Thread::Options{"connection_thread"},
+          [this, client] { Serve(client); });
+    }
+  }
+
+  /// Serves requests on `client` until the client closes the connection.
+  void Serve(socket_t client) {
+    std::string buffer;
+    char data[4096];
+    for (;;) {
+      // Requests have no body, so each request ends at an empty line.
+      size_t end;
+      while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+        int n = recv(client, data, static_cast<int>(sizeof(data)), 0);
+        if (n <= 0) {
+          CloseSocket(client);
+          return;
+        }
+        buffer.append(data, n);
+      }
+      buffer.erase(0, end + 4);
+      std::string_view remaining = response_;
+      while (!remaining.empty()) {
+        int n = send(client, remaining.data(),
+                     static_cast<int>(remaining.size()), 0);
+        if (n <= 0) {
+          CloseSocket(client);
+          return;
+        }
+        remaining.remove_prefix(n);
+      }
+    }
+  }
+
+  const std::string response_;
+  socket_t listen_socket_;
+  std::string hostport_;
+  std::atomic<bool> done_{false};
+  tensorstore::internal::Thread accept_thread_;
+  absl::Mutex mutex_;
+  std::vector<tensorstore::internal::Thread> connection_threads_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+void BenchmarkDownload(::benchmark::State& state, size_t num_threads,
+                       size_t response_size) {
+  LocalHttpServer server(response_size);
+  {
+    std::shared_ptr<HttpTransport> transport = std::make_shared<CurlTransport>(
+        GetDefaultCurlHandleFactory(), num_threads);
+    const auto request =
+        HttpRequestBuilder("GET",
+                           absl::StrCat("http://", server.hostport(), "/"))
+            .BuildRequest();
+    std::vector<Future<HttpResponse>> futures(kConcurrentRequests);
+    for (auto s : state) {
+      for (auto& future : futures) {
+        future = transport->IssueRequest(request, absl::Cord());
+      }
+      for (auto& future : futures) {
+        TENSORSTORE_CHECK(future.value().payload.size() == response_size);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kConcurrentRequests);
+  state.SetBytesProcessed(state.iterations() * kConcurrentRequests *
+                          response_size);
+}
+
+TENSORSTORE_GLOBAL_INITIALIZER {
+  for (size_t num_threads : {1, 2, 4, 8}) {
+    for (size_t response_size : {64 * 1024, 4 * 1024 * 1024}) {
+      ::benchmark::RegisterBenchmark(
+          tensorstore::StrCat("Download_threads=", num_threads, "_",
+                              response_size)
+              .c_str(),
+          [=](auto& state) {
+            BenchmarkDownload(state, num_threads, response_size);
+          })
+          ->UseRealTime();
+    }
+  }
+}
+
+}  // namespace
@@ -14,6 +14,8 @@
 
 #include "tensorstore/internal/http/http_request.h"
 
+#include <cassert>
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -25,6 +27,7 @@
 #include "tensorstore/internal/logging.h"
 #include "tensorstore/internal/path.h"
 #include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/util/span.h"
 #include "tensorstore/util/str_cat.h"
 
 namespace tensorstore {
@@ -66,6 +69,7 @@ HttpRequestBuilder& HttpRequestBuilder::EnableAcceptEncoding() {
 }
 
 std::string GetRangeHeader(OptionalByteRangeRequest byte_range) {
+  assert(byte_range.exclusive_max != byte_range.inclusive_min);
   if (byte_range.exclusive_max) {
     return StrCat("Range: bytes=", byte_range.inclusive_min, "-",
                   *byte_range.exclusive_max - 1);
@@ -74,6 +78,20 @@ std::string GetRangeHeader(OptionalByteRangeRequest byte_range) {
   }
 }
 
+std::string GetRangeHeader(span<const OptionalByteRangeRequest> byte_ranges) {
+  assert(!byte_ranges.empty());
+  std::string header = "Range: bytes=";
+  for (ptrdiff_t i = 0; i < byte_ranges.size(); ++i) {
+    const auto& byte_range = byte_ranges[i];
+    assert(byte_range.exclusive_max != byte_range.inclusive_min);
+    absl::StrAppend(&header, i == 0 ? "" : ",", byte_range.inclusive_min, "-");
+    if (byte_range.exclusive_max) {
+      absl::StrAppend(&header, *byte_range.exclusive_max - 1);
+    }
+  }
+  return header;
+}
+
 void AddStalenessBoundCacheControlHeader(HttpRequestBuilder& request_builder,
                                          const absl::Time& staleness_bound) {
   if (staleness_bound != absl::InfinitePast()) {
@@ -23,6 +23,7 @@
 #include "tensorstore/internal/http/http_response.h"
 #include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
 
 namespace tensorstore {
 namespace internal_http {
@@ -83,8 +84,17 @@ class HttpRequestBuilder {
 };
 
 /// Returns an HTTP Range header for requesting the specified byte range.
+///
+/// \dchecks `byte_range` is not empty, since an empty range cannot be
+///     specified in a Range header.
 std::string GetRangeHeader(OptionalByteRangeRequest byte_range);
 
+/// Returns an HTTP Range header for requesting the specified byte ranges, which
+/// a server may satisfy with a ``multipart/byteranges`` response.
+///
+/// \dchecks `byte_ranges` is not empty, and none of `byte_ranges` is empty.
+std::string GetRangeHeader(span<const OptionalByteRangeRequest> byte_ranges);
+
 /// `strptime`-compatible format string for the HTTP date header.
 ///
 /// https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Date
@@ -14,11 +14,16 @@
 
 #include "tensorstore/internal/http/http_request.h"
 
+#include <vector>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "tensorstore/kvstore/byte_range.h"
 
 namespace {
 
+using ::tensorstore::OptionalByteRangeRequest;
+using ::tensorstore::internal_http::GetRangeHeader;
 using ::tensorstore::internal_http::HttpRequestBuilder;
 
 TEST(HttpRequestBuilder, BuildRequest) {
@@ -37,4 +42,14 @@ TEST(HttpRequestBuilder, BuildRequest) {
   EXPECT_THAT(request.headers(), testing::ElementsAre("X-foo: bar"));
 }
 
+TEST(GetRangeHeaderTest, Single) {
+  EXPECT_EQ("Range: bytes=1-4", GetRangeHeader(OptionalByteRangeRequest(1, 5)));
+  EXPECT_EQ("Range: bytes=7-", GetRangeHeader(OptionalByteRangeRequest(7)));
+}
+
+TEST(GetRangeHeaderTest, Multiple) {
+  std::vector<OptionalByteRangeRequest> byte_ranges{{1, 5}, {10, 11}, {20}};
+  EXPECT_EQ("Range: bytes=1-4,10-10,20-", GetRangeHeader(byte_ranges));
+}
+
 }  // namespace
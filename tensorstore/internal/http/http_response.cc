@@ -17,16 +17,22 @@
 #include <ctype.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <iterator>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/strip.h"
 #include "tensorstore/util/quote_string.h"
+#include "tensorstore/util/result.h"
 #include "tensorstore/util/status.h"
 
 namespace tensorstore {
@@ -135,6 +141,130 @@ absl::StatusCode HttpResponseCodeToStatusCode(const HttpResponse& response) {
   return absl::StatusCode::kUnknown;
 }
 
+/// Parses a `Content-Range` header of the form
+/// ``bytes <inclusive_min>-<inclusive_max>/<total_size>``, where
+/// `<total_size>` may be ``*``.
+///
+/// The returned range is open-ended if it extends to the end of the resource.
+Result<OptionalByteRangeRequest> ParseContentRangeHeader(
+    std::string_view header, std::uint64_t* size) {
+  auto error = [&] {
+    return absl::UnknownError(StrCat("Unexpected Content-Range header: ",
+                                     QuoteString(header)));
+  };
+  std::string_view value = header;
+  if (!absl::ConsumePrefix(&value, "bytes ")) return error();
+  const size_t dash = value.find('-');
+  const size_t slash = value.find('/');
+  if (dash == std::string_view::npos || slash == std::string_view::npos ||
+      slash < dash) {
+    return error();
+  }
+  std::uint64_t inclusive_min, inclusive_max;
+  if (!absl::SimpleAtoi(value.substr(0, dash), &inclusive_min) ||
+      !absl::SimpleAtoi(value.substr(dash + 1, slash - dash - 1),
+                        &inclusive_max) ||
+      inclusive_max < inclusive_min) {
+    return error();
+  }
+  *size = inclusive_max - inclusive_min + 1;
+  std::string_view total = value.substr(slash + 1);
+  std::uint64_t total_size;
+  if (total != "*") {
+    if (!absl::SimpleAtoi(total, &total_size) ||
+        total_size <= inclusive_max) {
+      return error();
+    }
+    if (total_size == inclusive_max + 1) {
+      return OptionalByteRangeRequest(inclusive_min);
+    }
+  }
+  return OptionalByteRangeRequest(inclusive_min, inclusive_max + 1);
+}
+
+/// Returns the `boundary` parameter of a ``multipart/byteranges``
+/// `Content-Type` header, or `std::nullopt` for other content types.
+std::optional<std::string> GetMultipartBoundary(
+    std::string_view content_type) {
+  if (!absl::StartsWithIgnoreCase(content_type, "multipart/byteranges")) {
+    return std::nullopt;
+  }
+  const size_t pos = content_type.find("boundary=");
+  if (pos == std::string_view::npos) return std::string();
+  std::string_view boundary = content_type.substr(pos + 9);
+  boundary = boundary.substr(0, boundary.find(';'));
+  boundary = absl::StripAsciiWhitespace(boundary);
+  if (boundary.size() >= 2 && boundary.front() == '"' &&
+      boundary.back() == '"') {
+    boundary.remove_prefix(1);
+    boundary.remove_suffix(1);
+  }
+  return std::string(boundary);
+}
+
+/// Maximum size of the delimiter and headers of a single part of a
+/// ``multipart/byteranges`` response.
+constexpr size_t kMaxPartHeaderSize = 4096;
+
+/// Parses a ``multipart/byteranges`` payload (RFC 7233 Appendix A).
+///
+/// The length of the body of each part is determined from its
+/// `Content-Range` header, so the boundary need not be searched for within
+/// the (possibly large) part bodies.
+Result<std::vector<HttpResponseByteRangePart>> ParseMultipartByteRanges(
+    const absl::Cord& payload, std::string_view boundary) {
+  auto error = [](std::string_view message) {
+    return absl::UnknownError(
+        StrCat("Invalid multipart/byteranges response: ", message));
+  };
+  if (boundary.empty()) return error("missing boundary");
+  const std::string delimiter = StrCat("--", boundary);
+  std::vector<HttpResponseByteRangePart> parts;
+  size_t pos = 0;
+  while (true) {
+    std::string text(payload.Subcord(pos, kMaxPartHeaderSize));
+    // Skip the preamble, or the CRLF that ends the previous part body.
+    const size_t delimiter_pos = text.find(delimiter);
+    if (delimiter_pos == std::string::npos ||
+        (!parts.empty() && delimiter_pos != 2)) {
+      return error("missing boundary delimiter");
+    }
+    std::string_view remaining(text);
+    remaining.remove_prefix(delimiter_pos + delimiter.size());
+    if (absl::StartsWith(remaining, "--")) break;
+    // Skip any transport padding before the end of the delimiter line.
+    size_t line_end = remaining.find("\r\n");
+    if (line_end == std::string_view::npos) {
+      return error("missing delimiter line ending");
+    }
+    remaining.remove_prefix(line_end + 2);
+    std::multimap<std::string, std::string> headers;
+    while (true) {
+      line_end = remaining.find("\r\n");
+      if (line_end == std::string_view::npos) {
+        return error("missing part headers");
+      }
+      if (line_end == 0) {
+        remaining.remove_prefix(2);
+        break;
+      }
+      AppendHeaderData(headers, remaining.substr(0, line_end + 2));
+      remaining.remove_prefix(line_end + 2);
+    }
+    auto it = headers.find("content-range");
+    if (it == headers.end()) return error("missing part Content-Range");
+    std::uint64_t size;
+    auto& part = parts.emplace_back();
+    TENSORSTORE_ASSIGN_OR_RETURN(part.byte_range,
+                                 ParseContentRangeHeader(it->second, &size));
+    pos += text.size() - remaining.size();
+    if (payload.size() - pos < size) return error("truncated part");
+    part.payload = payload.Subcord(pos, size);
+    pos += size;
+  }
+  return parts;
+}
+
 }  // namespace
 
 std::size_t AppendHeaderData(std::multimap<std::string, std::string>& headers,
@@ -224,5 +354,38 @@ Result<ByteRange> GetHttpResponseByteRange(
   return ByteRange{0, response.payload.size()};
 }
 
+Result<std::vector<HttpResponseByteRangePart>> GetHttpResponseByteRangeParts(
+    const HttpResponse& response) {
+  if (response.status_code != 206) {
+    // Server ignored the range request, and returned the entire resource.
+    std::vector<HttpResponseByteRangePart> parts(1);
+    parts[0].byte_range = OptionalByteRangeRequest(0);
+    parts[0].payload = response.payload;
+    return parts;
+  }
+  auto content_type_it = response.headers.find("content-type");
+  if (content_type_it != response.headers.end()) {
+    if (auto boundary = GetMultipartBoundary(content_type_it->second)) {
+      return ParseMultipartByteRanges(response.payload, *boundary);
+    }
+  }
+  auto it = response.headers.find("content-range");
+  if (it == response.headers.end()) {
+    return absl::UnknownError(
+        "Expected Content-Range header with HTTP 206 response");
+  }
+  std::uint64_t size;
+  std::vector<HttpResponseByteRangePart> parts(1);
+  TENSORSTORE_ASSIGN_OR_RETURN(parts[0].byte_range,
+                               ParseContentRangeHeader(it->second, &size));
+  if (response.payload.size() != size) {
+    return absl::UnknownError(
+        StrCat("Content-Range header ", QuoteString(it->second),
+               " does not match payload size of ", response.payload.size()));
+  }
+  parts[0].payload = response.payload;
+  return parts;
+}
+
 }  // namespace internal_http
 }  // namespace tensorstore
@@ -19,10 +19,12 @@
 #include <map>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/cord.h"
 #include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/util/result.h"
 #include "tensorstore/util/status.h"
 
 namespace tensorstore {
@@ -50,6 +52,27 @@ absl::Status HttpResponseCodeToStatus(const HttpResponse& response);
 Result<ByteRange> GetHttpResponseByteRange(
     const HttpResponse& response, OptionalByteRangeRequest byte_range_request);
 
+/// Portion of an HTTP response payload holding a byte range of the resource.
+struct HttpResponseByteRangePart {
+  /// Byte range of the resource contained in `payload`.  The `exclusive_max`
+  /// is `std::nullopt` if `payload` extends to the end of the resource.
+  OptionalByteRangeRequest byte_range;
+
+  /// Content of `byte_range`.
+  absl::Cord payload;
+};
+
+/// Splits the response to a request for one or more byte ranges into the parts
+/// returned by the server.
+///
+/// Handles an HTTP 200 response that contains the entire resource, an HTTP 206
+/// Partial Content response with a `Content-Range` header, and an HTTP 206
+/// response of type ``multipart/byteranges``.
+///
+/// \error `absl::StatusCode::kUnknown` if the response is malformed.
+Result<std::vector<HttpResponseByteRangePart>> GetHttpResponseByteRangeParts(
+    const HttpResponse& response);
+
 }  // namespace internal_http
 }  // namespace tensorstore
 
@@ -19,11 +19,19 @@
 
 #include <gtest/gtest.h>
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/util/status.h"
+#include "tensorstore/util/status_testutil.h"
 
 namespace {
 
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::OptionalByteRangeRequest;
 using ::tensorstore::internal_http::AppendHeaderData;
+using ::tensorstore::internal_http::GetHttpResponseByteRangeParts;
+using ::tensorstore::internal_http::HttpResponse;
 
 TEST(AppendHeaderData, BadHeaders) {
   std::multimap<std::string, std::string> headers;
@@ -133,4 +141,65 @@ TEST(HttpResponseCodeToStatusTest, AllCodes) {
   }
 }
 
+TEST(GetHttpResponseByteRangePartsTest, FullResponse) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto parts, GetHttpResponseByteRangeParts(
+                      HttpResponse{200, absl::Cord("abcdef"), {}}));
+  ASSERT_EQ(1, parts.size());
+  EXPECT_EQ(OptionalByteRangeRequest(0), parts[0].byte_range);
+  EXPECT_EQ("abcdef", parts[0].payload);
+}
+
+TEST(GetHttpResponseByteRangePartsTest, SingleRange) {
+  HttpResponse response{206, absl::Cord("bcd"), {}};
+  response.headers.emplace("content-range", "bytes 1-3/10");
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto parts,
+                                   GetHttpResponseByteRangeParts(response));
+  ASSERT_EQ(1, parts.size());
+  EXPECT_EQ(OptionalByteRangeRequest(1, 4), parts[0].byte_range);
+  EXPECT_EQ("bcd", parts[0].payload);
+
+  // A range that extends to the end of the resource is open-ended.
+  response.headers.find("content-range")->second = "bytes 1-3/4";
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(parts,
+                                   GetHttpResponseByteRangeParts(response));
+  EXPECT_EQ(OptionalByteRangeRequest(1), parts[0].byte_range);
+
+  response.headers.find("content-range")->second = "bytes 1-4/*";
+  EXPECT_THAT(GetHttpResponseByteRangeParts(response),
+              MatchesStatus(absl::StatusCode::kUnknown));
+  response.headers.clear();
+  EXPECT_THAT(GetHttpResponseByteRangeParts(response),
+              MatchesStatus(absl::StatusCode::kUnknown));
+}
+
+TEST(GetHttpResponseByteRangePartsTest, Multipart) {
+  HttpResponse response{206,
+                        absl::Cord("\r\n--XYZ\r\n"
+                                   "Content-Type: text/plain\r\n"
+                                   "Content-Range: bytes 1-4/10\r\n"
+                                   "\r\n"
+                                   "b\r\nd"
+                                   "\r\n--XYZ\r\n"
+                                   "Content-Range: bytes 8-9/10\r\n"
+                                   "\r\n"
+                                   "ij"
+                                   "\r\n--XYZ--\r\n"),
+                        {}};
+  response.headers.emplace("content-type",
+                           "multipart/byteranges; boundary=XYZ");
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto parts,
+                                   GetHttpResponseByteRangeParts(response));
+  ASSERT_EQ(2, parts.size());
+  EXPECT_EQ(OptionalByteRangeRequest(1, 5), parts[0].byte_range);
+  EXPECT_EQ("b\r\nd", parts[0].payload);
+  EXPECT_EQ(OptionalByteRangeRequest(8), parts[1].byte_range);
+  EXPECT_EQ("ij", parts[1].payload);
+
+  // Truncated response.
+  response.payload = response.payload.Subcord(0, 60);
+  EXPECT_THAT(GetHttpResponseByteRangeParts(response),
+              MatchesStatus(absl::StatusCode::kUnknown));
+}
+
 }  // namespace
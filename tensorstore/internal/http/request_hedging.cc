@@ -0,0 +1,231 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/http/request_hedging.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/http/http_response.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/metrics/counter.h"
+#include "tensorstore/internal/schedule_at.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_http {
+namespace {
+
+auto& http_hedged_requests = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/http/hedged_requests", "Hedged HTTP requests issued");
+
+auto& http_hedged_request_wins = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/http/hedged_request_wins",
+    "Hedged HTTP requests that completed before the original request");
+
+auto& http_hedge_budget_exhausted = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/http/hedge_budget_exhausted",
+    "HTTP requests not hedged due to an exhausted budget");
+
+// Number of recent latencies from which the hedging delay is computed.
+constexpr size_t kMaxLatencies = 128;
+
+// Minimum number of latencies required before requests are hedged.
+constexpr size_t kMinLatencies = 16;
+
+// Number of latencies recorded between updates of the hedging delay.
+constexpr size_t kUpdateInterval = 8;
+
+// Maximum budget, which bounds the number of hedged requests issued in a
+// burst.
+constexpr double kMaxBudget = 10;
+
+// Returns whether `response` may be returned while another request is
+// outstanding.
+bool IsSuccessfulResponse(const Result<HttpResponse>& response) {
+  return response.ok() && response->status_code != 429 &&
+         response->status_code < 500;
+}
+
+struct HedgedRequestState
+    : public internal::AtomicReferenceCount<HedgedRequestState> {
+  std::shared_ptr<RequestHedger> hedger;
+  std::function<Future<HttpResponse>()> issue;
+  Promise<HttpResponse> promise;
+  absl::Time start_time;
+
+  absl::Mutex mutex;
+  // Number of requests that have been issued but have not completed.
+  int outstanding ABSL_GUARDED_BY(mutex) = 0;
+  // Set once `promise` has been (or is about to be) resolved.
+  bool done ABSL_GUARDED_BY(mutex) = false;
+  // Callback registrations for the original (0) and hedged (1) requests.
+  // Unregistering releases the future, which cancels the request.
+  FutureCallbackRegistration registrations[2] ABSL_GUARDED_BY(mutex);
+
+  void Issue(int index) {
+    {
+      absl::MutexLock lock(&mutex);
+      ++outstanding;
+    }
+    auto registration = issue().ExecuteWhenReady(
+        [self = internal::IntrusivePtr<HedgedRequestState>(this),
+         index](ReadyFuture<HttpResponse> future) {
+          self->OnResponse(index, future.result());
+        });
+    {
+      absl::MutexLock lock(&mutex);
+      if (!done) {
+        registrations[index] = std::move(registration);
+        return;
+      }
+    }
+    registration.UnregisterNonBlocking();
+  }
+
+  void MaybeHedge() {
+    {
+      absl::MutexLock lock(&mutex);
+      if (done || !promise.result_needed()) return;
+    }
+    if (!hedger->TryStartHedge()) {
+      http_hedge_budget_exhausted.Increment();
+      return;
+    }
+    http_hedged_requests.Increment();
+    Issue(1);
+  }
+
+  void OnResponse(int index, const Result<HttpResponse>& response) {
+    const bool success = IsSuccessfulResponse(response);
+    FutureCallbackRegistration other;
+    {
+      absl::MutexLock lock(&mutex);
+      --outstanding;
+      if (done) return;
+      // Wait for the other request, which may still succeed.
+      if (!success && outstanding > 0) return;
+      done = true;
+      other = std::move(registrations[1 - index]);
+    }
+    other.UnregisterNonBlocking();
+    if (success) {
+      hedger->RecordLatency(absl::Now() - start_time);
+      if (index == 1) http_hedged_request_wins.Increment();
+    }
+    promise.SetResult(response);
+  }
+
+  // Called when the result is no longer needed; cancels both requests.
+  void Cancel() {
+    FutureCallbackRegistration cancelled[2];
+    {
+      absl::MutexLock lock(&mutex);
+      if (done) return;
+      done = true;
+      cancelled[0] = std::move(registrations[0]);
+      cancelled[1] = std::move(registrations[1]);
+    }
+    cancelled[0].UnregisterNonBlocking();
+    cancelled[1].UnregisterNonBlocking();
+  }
+};
+
+}  // namespace
+
+RequestHedger::RequestHedger(double percentile, absl::Duration min_delay,
+                             double max_extra_requests)
+    : percentile_(percentile),
+      min_delay_(min_delay),
+      max_extra_requests_(max_extra_requests) {
+  latencies_.reserve(kMaxLatencies);
+}
+
+absl::Duration RequestHedger::GetDelay() {
+  absl::MutexLock lock(&mutex_);
+  return delay_;
+}
+
+void RequestHedger::RecordLatency(absl::Duration latency) {
+  absl::MutexLock lock(&mutex_);
+  if (latencies_.size() < kMaxLatencies) {
+    latencies_.push_back(latency);
+  } else {
+    latencies_[next_latency_] = latency;
+    next_latency_ = (next_latency_ + 1) % kMaxLatencies;
+  }
+  if (latencies_.size() < kMinLatencies) return;
+  if (delay_ != absl::InfiniteDuration() &&
+      ++latencies_since_update_ < kUpdateInterval) {
+    return;
+  }
+  latencies_since_update_ = 0;
+  std::vector<absl::Duration> sorted = latencies_;
+  const size_t i =
+      static_cast<size_t>(std::lround(percentile_ / 100 * (sorted.size() - 1)));
+  std::nth_element(sorted.begin(), sorted.begin() + i, sorted.end());
+  delay_ = std::max(min_delay_, sorted[i]);
+}
+
+void RequestHedger::RecordRequest() {
+  absl::MutexLock lock(&mutex_);
+  budget_ = std::min(kMaxBudget, budget_ + max_extra_requests_);
+}
+
+bool RequestHedger::TryStartHedge() {
+  absl::MutexLock lock(&mutex_);
+  if (budget_ < 1) return false;
+  budget_ -= 1;
+  return true;
+}
+
+Future<HttpResponse> IssueHedgedRequest(
+    std::shared_ptr<RequestHedger> hedger,
+    std::function<Future<HttpResponse>()> issue) {
+  if (!hedger) return issue();
+  hedger->RecordRequest();
+  const absl::Duration delay = hedger->GetDelay();
+
+  auto pair = PromiseFuturePair<HttpResponse>::Make();
+  auto state = internal::MakeIntrusivePtr<HedgedRequestState>();
+  state->hedger = std::move(hedger);
+  state->issue = std::move(issue);
+  state->promise = std::move(pair.promise);
+  state->start_time = absl::Now();
+  state->Issue(0);
+  // The callback is unregistered once `promise` becomes ready.
+  state->promise.ExecuteWhenNotNeeded(
+      [state = internal::IntrusivePtr<HedgedRequestState>(state)] {
+        state->Cancel();
+      });
+  if (delay != absl::InfiniteDuration()) {
+    const absl::Time hedge_time = state->start_time + delay;
+    internal::ScheduleAt(hedge_time,
+                         [state = std::move(state)] { state->MaybeHedge(); });
+  }
+  return std::move(pair.future);
+}
+
+}  // namespace internal_http
+}  // namespace tensorstore
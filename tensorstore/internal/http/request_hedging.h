@@ -0,0 +1,178 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_INTERNAL_HTTP_REQUEST_HEDGING_H_
+#define TENSORSTORE_INTERNAL_HTTP_REQUEST_HEDGING_H_
+
+#include <stddef.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tensorstore/context_resource_provider.h"
+#include "tensorstore/internal/http/http_response.h"
+#include "tensorstore/internal/json_binding/absl_time.h"
+#include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace internal_http {
+
+/// Tracks the latency of idempotent requests in order to decide when a
+/// duplicate ("hedged") request should be issued for a slow request, and
+/// limits the number of hedged requests to a fraction of all requests.
+///
+/// Thread-safe.
+class RequestHedger {
+ public:
+  /// Constructs a hedger.
+  ///
+  /// \param percentile Latency percentile, in the range `[0, 100]`, after
+  ///     which a hedged request is issued.
+  /// \param min_delay Minimum delay before a hedged request is issued.
+  /// \param max_extra_requests Maximum number of hedged requests, as a
+  ///     fraction of the number of requests.
+  RequestHedger(double percentile, absl::Duration min_delay,
+                double max_extra_requests);
+
+  /// Returns the delay after which a hedged request should be issued, or
+  /// `absl::InfiniteDuration()` if too few latencies have been recorded.
+  absl::Duration GetDelay();
+
+  /// Records the latency of a completed request.
+  void RecordLatency(absl::Duration latency);
+
+  /// Records that a request was issued, which adds to the hedging budget.
+  void RecordRequest();
+
+  /// Consumes the budget for one hedged request.  Returns `false` if the
+  /// budget is exhausted.
+  bool TryStartHedge();
+
+ private:
+  const double percentile_;
+  const absl::Duration min_delay_;
+  const double max_extra_requests_;
+
+  absl::Mutex mutex_;
+  // Ring buffer of recent latencies.
+  std::vector<absl::Duration> latencies_ ABSL_GUARDED_BY(mutex_);
+  size_t next_latency_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Number of latencies recorded since `delay_` was last computed.
+  size_t latencies_since_update_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::Duration delay_ ABSL_GUARDED_BY(mutex_) = absl::InfiniteDuration();
+  // Number of hedged requests that may be issued.
+  double budget_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+/// Issues a request by calling `issue`.  If `hedger` is not null and the
+/// request has not completed after `hedger->GetDelay()`, issues a duplicate
+/// request by calling `issue` again, subject to the hedging budget.
+///
+/// The returned future becomes ready with the first successful response;
+/// the other request is then cancelled.  A failed response (a transport
+/// error, or HTTP 429 or 5xx) is only returned once no other request is
+/// outstanding.
+///
+/// Must only be used for idempotent requests.
+Future<HttpResponse> IssueHedgedRequest(
+    std::shared_ptr<RequestHedger> hedger,
+    std::function<Future<HttpResponse>()> issue);
+
+/// Specifies request hedging parameters as a context resource.
+template <typename Derived>
+struct RequestHedgingResource
+    : public internal::ContextResourceTraits<Derived> {
+  struct Spec {
+    bool enabled = false;
+    double percentile = 95;
+    absl::Duration min_delay = absl::Milliseconds(10);
+    double max_extra_requests = 0.05;
+  };
+  struct Resource {
+    Spec spec;
+    /// Null if hedging is disabled.
+    std::shared_ptr<RequestHedger> hedger;
+  };
+  static Spec Default() { return {}; }
+  static constexpr auto JsonBinder() {
+    namespace jb = ::tensorstore::internal_json_binding;
+    return jb::Object(
+        jb::Member("enabled",  //
+                   jb::Projection(&Spec::enabled, jb::DefaultValue([](auto* v) {
+                                    *v = Derived::Default().enabled;
+                                  }))),
+        jb::Member(
+            "percentile",  //
+            jb::Projection(
+                &Spec::percentile,
+                jb::DefaultValue(
+                    [](auto* v) { *v = Derived::Default().percentile; },
+                    jb::Validate([](const auto& options, double* x) {
+                      if (*x >= 0 && *x <= 100) return absl::OkStatus();
+                      return absl::InvalidArgumentError(tensorstore::StrCat(
+                          "Expected percentile in the range [0, 100], but "
+                          "received: ",
+                          *x));
+                    })))),
+        jb::Member(
+            "min_delay",  //
+            jb::Projection(&Spec::min_delay, jb::DefaultValue([](auto* v) {
+                             *v = Derived::Default().min_delay;
+                           }))),
+        jb::Member(
+            "max_extra_requests",  //
+            jb::Projection(
+                &Spec::max_extra_requests,
+                jb::DefaultValue(
+                    [](auto* v) {
+                      *v = Derived::Default().max_extra_requests;
+                    },
+                    jb::Validate([](const auto& options, double* x) {
+                      if (*x >= 0 && *x <= 1) return absl::OkStatus();
+                      return absl::InvalidArgumentError(tensorstore::StrCat(
+                          "Expected max_extra_requests in the range [0, 1], "
+                          "but received: ",
+                          *x));
+                    })))) /**/
+    );
+  }
+  static Result<Resource> Create(
+      const Spec& spec, internal::ContextResourceCreationContext context) {
+    Resource resource;
+    resource.spec = spec;
+    if (spec.enabled) {
+      resource.hedger = std::make_shared<RequestHedger>(
+          spec.percentile, spec.min_delay, spec.max_extra_requests);
+    }
+    return resource;
+  }
+  static Spec GetSpec(const Resource& resource,
+                      const internal::ContextSpecBuilder& builder) {
+    return resource.spec;
+  }
+};
+
+}  // namespace internal_http
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_INTERNAL_HTTP_REQUEST_HEDGING_H_
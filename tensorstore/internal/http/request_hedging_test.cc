@@ -0,0 +1,186 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/http/request_hedging.h"
+
+#include <memory>
+
+#include <gtest/gtest.h>
+#include "absl/strings/cord.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/http/http_response.h"
+#include "tensorstore/internal/queue_testutil.h"
+#include "tensorstore/util/future.h"
+
+namespace {
+
+using ::tensorstore::Future;
+using ::tensorstore::Promise;
+using ::tensorstore::PromiseFuturePair;
+using ::tensorstore::internal_http::HttpResponse;
+using ::tensorstore::internal_http::IssueHedgedRequest;
+using ::tensorstore::internal_http::RequestHedger;
+
+/// Returns a hedger that hedges requests after 1ms.
+std::shared_ptr<RequestHedger> MakeWarmHedger(double max_extra_requests = 1) {
+  auto hedger = std::make_shared<RequestHedger>(
+      /*percentile=*/50, /*min_delay=*/absl::Milliseconds(1),
+      max_extra_requests);
+  for (int i = 0; i < 16; ++i) {
+    hedger->RecordLatency(absl::Microseconds(1));
+  }
+  return hedger;
+}
+
+/// Issues requests that are completed explicitly by the test.
+struct MockIssuer {
+  Future<HttpResponse> operator()() const {
+    auto [promise, future] = PromiseFuturePair<HttpResponse>::Make();
+    promises->push(std::move(promise));
+    return std::move(future);
+  }
+
+  std::shared_ptr<tensorstore::internal::ConcurrentQueue<Promise<HttpResponse>>>
+      promises = std::make_shared<
+          tensorstore::internal::ConcurrentQueue<Promise<HttpResponse>>>();
+};
+
+/// Waits until the request corresponding to `promise` is cancelled.
+bool WaitUntilCancelled(const Promise<HttpResponse>& promise) {
+  const absl::Time deadline = absl::Now() + absl::Seconds(5);
+  while (promise.result_needed()) {
+    if (absl::Now() > deadline) return false;
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  return true;
+}
+
+TEST(RequestHedgerTest, Delay) {
+  RequestHedger hedger(/*percentile=*/90, /*min_delay=*/absl::Milliseconds(2),
+                       /*max_extra_requests=*/0.1);
+  EXPECT_EQ(absl::InfiniteDuration(), hedger.GetDelay());
+  for (int i = 1; i <= 16; ++i) {
+    hedger.RecordLatency(absl::Milliseconds(i));
+  }
+  EXPECT_LE(absl::Milliseconds(14), hedger.GetDelay());
+  EXPECT_GE(absl::Milliseconds(16), hedger.GetDelay());
+
+  // The delay is at least `min_delay`.
+  for (int i = 0; i < 128; ++i) {
+    hedger.RecordLatency(absl::Microseconds(1));
+  }
+  EXPECT_EQ(absl::Milliseconds(2), hedger.GetDelay());
+}
+
+TEST(RequestHedgerTest, Budget) {
+  RequestHedger hedger(/*percentile=*/95, /*min_delay=*/absl::Milliseconds(1),
+                       /*max_extra_requests=*/0.25);
+  EXPECT_FALSE(hedger.TryStartHedge());
+  for (int i = 0; i < 4; ++i) hedger.RecordRequest();
+  EXPECT_TRUE(hedger.TryStartHedge());
+  EXPECT_FALSE(hedger.TryStartHedge());
+}
+
+TEST(IssueHedgedRequestTest, Disabled) {
+  MockIssuer issuer;
+  auto future = IssueHedgedRequest(nullptr, issuer);
+  auto promise = issuer.promises->pop();
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_TRUE(issuer.promises->empty());
+  promise.SetResult(HttpResponse{200, absl::Cord("a")});
+  ASSERT_TRUE(future.result().ok());
+  EXPECT_EQ("a", future.value().payload);
+}
+
+TEST(IssueHedgedRequestTest, OriginalWins) {
+  MockIssuer issuer;
+  auto future = IssueHedgedRequest(MakeWarmHedger(), issuer);
+  auto original = issuer.promises->pop();
+  auto hedge = issuer.promises->pop();
+  original.SetResult(HttpResponse{200, absl::Cord("a")});
+  ASSERT_TRUE(future.result().ok());
+  EXPECT_EQ("a", future.value().payload);
+  // The hedged request is cancelled.
+  EXPECT_TRUE(WaitUntilCancelled(hedge));
+}
+
+TEST(IssueHedgedRequestTest, HedgeWins) {
+  MockIssuer issuer;
+  auto future = IssueHedgedRequest(MakeWarmHedger(), issuer);
+  auto original = issuer.promises->pop();
+  auto hedge = issuer.promises->pop();
+  hedge.SetResult(HttpResponse{200, absl::Cord("b")});
+  ASSERT_TRUE(future.result().ok());
+  EXPECT_EQ("b", future.value().payload);
+  // The original request is cancelled.
+  EXPECT_TRUE(WaitUntilCancelled(original));
+}
+
+TEST(IssueHedgedRequestTest, FailureWaitsForOtherRequest) {
+  MockIssuer issuer;
+  auto future = IssueHedgedRequest(MakeWarmHedger(), issuer);
+  auto original = issuer.promises->pop();
+  auto hedge = issuer.promises->pop();
+  original.SetResult(HttpResponse{503, absl::Cord()});
+  EXPECT_FALSE(future.ready());
+  hedge.SetResult(HttpResponse{200, absl::Cord("b")});
+  ASSERT_TRUE(future.result().ok());
+  EXPECT_EQ(200, future.value().status_code);
+}
+
+TEST(IssueHedgedRequestTest, BothFail) {
+  MockIssuer issuer;
+  auto future = IssueHedgedRequest(MakeWarmHedger(), issuer);
+  auto original = issuer.promises->pop();
+  auto hedge = issuer.promises->pop();
+  hedge.SetResult(HttpResponse{503, absl::Cord()});
+  EXPECT_FALSE(future.ready());
+  original.SetResult(HttpResponse{500, absl::Cord()});
+  ASSERT_TRUE(future.result().ok());
+  EXPECT_EQ(500, future.value().status_code);
+}
+
+TEST(IssueHedgedRequestTest, BudgetExhausted) {
+  MockIssuer issuer;
+  auto future =
+      IssueHedgedRequest(MakeWarmHedger(/*max_extra_requests=*/0), issuer);
+  auto original = issuer.promises->pop();
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_TRUE(issuer.promises->empty());
+  original.SetResult(HttpResponse{200, absl::Cord("a")});
+  EXPECT_TRUE(future.result().ok());
+}
+
+TEST(IssueHedgedRequestTest, CancelBothRequests) {
+  MockIssuer issuer;
+  auto future = IssueHedgedRequest(MakeWarmHedger(), issuer);
+  auto original = issuer.promises->pop();
+  auto hedge = issuer.promises->pop();
+  // Releasing the returned future cancels both requests.
+  future = Future<HttpResponse>();
+  EXPECT_TRUE(WaitUntilCancelled(original));
+  EXPECT_TRUE(WaitUntilCancelled(hedge));
+}
+
+TEST(IssueHedgedRequestTest, CancelBeforeHedge) {
+  MockIssuer issuer;
+  auto future =
+      IssueHedgedRequest(MakeWarmHedger(/*max_extra_requests=*/0), issuer);
+  auto original = issuer.promises->pop();
+  future = Future<HttpResponse>();
+  EXPECT_TRUE(WaitUntilCancelled(original));
+}
+
+}  // namespace
@@ -14,15 +14,22 @@
 
 #include "tensorstore/kvstore/byte_range.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
 #include <optional>
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/cord.h"
 #include "tensorstore/serialization/serialization.h"
 #include "tensorstore/serialization/std_optional.h"
 #include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
 #include "tensorstore/util/status.h"
 #include "tensorstore/util/str_cat.h"
 
@@ -45,7 +52,7 @@ std::ostream& operator<<(std::ostream& os, const ByteRange& r) {
 
 Result<ByteRange> OptionalByteRangeRequest::Validate(std::uint64_t size) const {
   assert(SatisfiesInvariants());
-  if (exclusive_max && *exclusive_max > size) {
+  if (exclusive_max ? *exclusive_max > size : inclusive_min > size) {
     return absl::OutOfRangeError(StrCat("Requested byte range ", *this,
                                         " is not valid for value of size ",
                                         size));
@@ -53,6 +60,81 @@ Result<ByteRange> OptionalByteRangeRequest::Validate(std::uint64_t size) const {
   return ByteRange{inclusive_min, exclusive_max.value_or(size)};
 }
 
+namespace internal {
+
+std::vector<CoalescedByteRange> CoalesceByteRanges(
+    span<const OptionalByteRangeRequest> requests, std::uint64_t max_gap) {
+  std::vector<std::size_t> order(requests.size());
+  std::iota(order.begin(), order.end(), std::size_t(0));
+  std::stable_sort(order.begin(), order.end(),
+                   [&](std::size_t a, std::size_t b) {
+                     return requests[a].inclusive_min <
+                            requests[b].inclusive_min;
+                   });
+  std::vector<CoalescedByteRange> groups;
+  for (std::size_t i : order) {
+    const auto& request = requests[i];
+    assert(request.SatisfiesInvariants());
+    if (!groups.empty()) {
+      auto& group = groups.back().byte_range;
+      // An open-ended group contains all requests that start after it.
+      if (!group.exclusive_max ||
+          request.inclusive_min <= *group.exclusive_max ||
+          request.inclusive_min - *group.exclusive_max <= max_gap) {
+        if (group.exclusive_max) {
+          if (!request.exclusive_max) {
+            group.exclusive_max = std::nullopt;
+          } else {
+            group.exclusive_max =
+                std::max(*group.exclusive_max, *request.exclusive_max);
+          }
+        }
+        groups.back().request_indices.push_back(i);
+        continue;
+      }
+    }
+    auto& group = groups.emplace_back();
+    group.byte_range = request;
+    group.request_indices.push_back(i);
+  }
+  return groups;
+}
+
+Result<absl::Cord> GetSubCordForRequest(const absl::Cord& value,
+                                        OptionalByteRangeRequest value_range,
+                                        OptionalByteRangeRequest request) {
+  assert(value_range.SatisfiesInvariants());
+  assert(request.SatisfiesInvariants());
+  const std::uint64_t value_end = value_range.inclusive_min + value.size();
+  if (value_range.exclusive_max && *value_range.exclusive_max != value_end) {
+    return absl::OutOfRangeError(
+        StrCat("Byte range ", value_range, " is not valid for value of size ",
+               value.size()));
+  }
+  ByteRange r;
+  if (!value_range.exclusive_max) {
+    // `value` extends to the end of the stored value, whose size is therefore
+    // known.
+    TENSORSTORE_ASSIGN_OR_RETURN(r, request.Validate(value_end));
+  } else if (request.exclusive_max) {
+    r = ByteRange{request.inclusive_min, *request.exclusive_max};
+  } else {
+    return absl::OutOfRangeError(StrCat("Requested byte range ", request,
+                                        " is not contained in ", value_range));
+  }
+  if (r.inclusive_min < value_range.inclusive_min ||
+      r.exclusive_max > value_end) {
+    return absl::OutOfRangeError(StrCat("Requested byte range ", request,
+                                        " is not contained in ",
+                                        value_range));
+  }
+  return GetSubCord(value,
+                    ByteRange{r.inclusive_min - value_range.inclusive_min,
+                              r.exclusive_max - value_range.inclusive_min});
+}
+
+}  // namespace internal
+
 }  // namespace tensorstore
 
 TENSORSTORE_DEFINE_SERIALIZER_SPECIALIZATION(
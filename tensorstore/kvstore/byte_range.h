@@ -21,10 +21,12 @@
 #include <ostream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/cord.h"
 #include "tensorstore/serialization/fwd.h"
 #include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
 #include "tensorstore/util/status.h"
 
 namespace tensorstore {
@@ -137,6 +139,33 @@ inline absl::Cord GetSubCord(const absl::Cord& s, ByteRange r) {
   return s.Subcord(r.inclusive_min, r.size());
 }
 
+/// Group of byte range requests that are satisfied by a single read.
+struct CoalescedByteRange {
+  /// Smallest byte range that contains all of the requests.
+  OptionalByteRangeRequest byte_range;
+
+  /// Indices of the requests within the list passed to `CoalesceByteRanges`.
+  std::vector<std::size_t> request_indices;
+};
+
+/// Groups the specified byte range `requests` such that requests that overlap
+/// or are separated by at most `max_gap` bytes are in the same group.
+///
+/// The groups are returned in order of increasing starting byte.
+///
+/// \dchecks `request.SatisfiesInvariants()` for all `requests`.
+std::vector<CoalescedByteRange> CoalesceByteRanges(
+    span<const OptionalByteRangeRequest> requests, std::uint64_t max_gap);
+
+/// Returns the portion of `value` corresponding to `request`, where `value` is
+/// the result of reading `value_range`, which contains `request`.
+///
+/// \error `absl::StatusCode::kOutOfRange` if `request` is not valid for the
+///     size of the stored value, or if `value` is shorter than `value_range`.
+Result<absl::Cord> GetSubCordForRequest(const absl::Cord& value,
+                                        OptionalByteRangeRequest value_range,
+                                        OptionalByteRangeRequest request);
+
 }  // namespace internal
 
 }  // namespace tensorstore
@@ -14,12 +14,17 @@
 
 #include "tensorstore/kvstore/byte_range.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
+#include "absl/strings/cord.h"
 #include "tensorstore/serialization/serialization.h"
 #include "tensorstore/serialization/test_util.h"
 #include "tensorstore/util/result.h"
@@ -33,7 +38,10 @@ using ::tensorstore::ByteRange;
 using ::tensorstore::MatchesStatus;
 using ::tensorstore::OptionalByteRangeRequest;
 using ::tensorstore::StrCat;
+using ::tensorstore::internal::CoalesceByteRanges;
 using ::tensorstore::internal::GetSubCord;
+using ::tensorstore::internal::GetSubCordForRequest;
+using ::testing::ElementsAre;
 using ::tensorstore::serialization::TestSerializationRoundTrip;
 
 TEST(ByteRangeTest, SatisfiesInvariants) {
@@ -146,6 +154,12 @@ TEST(OptionalByteRangeRequestTest, Validate) {
       MatchesStatus(absl::StatusCode::kOutOfRange,
                     "Requested byte range \\[15, 15\\) is not valid for "
                     "value of size 9"));
+  EXPECT_THAT(OptionalByteRangeRequest(10).Validate(10),
+              ::testing::Optional(ByteRange{10, 10}));
+  EXPECT_THAT(OptionalByteRangeRequest(15).Validate(9),
+              MatchesStatus(absl::StatusCode::kOutOfRange,
+                            "Requested byte range \\[15, \\?\\) is not valid "
+                            "for value of size 9"));
 }
 
 TEST(GetSubStringTest, Basic) {
@@ -154,6 +168,65 @@ TEST(GetSubStringTest, Basic) {
   EXPECT_EQ("abcde", GetSubCord(absl::Cord("abcde"), {0, 5}));
 }
 
+/// Returns the coalesced ranges and request indices as a compact string.
+std::vector<std::string> CoalesceToStrings(
+    std::vector<OptionalByteRangeRequest> requests, std::uint64_t max_gap) {
+  std::vector<std::string> result;
+  for (const auto& group : CoalesceByteRanges(requests, max_gap)) {
+    std::string s = StrCat(group.byte_range, ":");
+    for (std::size_t i : group.request_indices) s += StrCat(" ", i);
+    result.push_back(std::move(s));
+  }
+  return result;
+}
+
+TEST(CoalesceByteRangesTest, Basic) {
+  EXPECT_THAT(CoalesceToStrings({}, 0), ElementsAre());
+  EXPECT_THAT(CoalesceToStrings({{0, 10}, {20, 30}, {10, 15}}, 0),
+              ElementsAre("[0, 15): 0 2", "[20, 30): 1"));
+  EXPECT_THAT(CoalesceToStrings({{0, 10}, {20, 30}, {10, 15}}, 5),
+              ElementsAre("[0, 30): 0 2 1"));
+  // Overlapping and contained ranges.
+  EXPECT_THAT(CoalesceToStrings({{5, 10}, {0, 100}, {50, 60}}, 0),
+              ElementsAre("[0, 100): 1 0 2"));
+}
+
+TEST(CoalesceByteRangesTest, OpenEnded) {
+  EXPECT_THAT(CoalesceToStrings({{100}, {0, 10}, {200, 300}}, 0),
+              ElementsAre("[0, 10): 1", "[100, ?): 0 2"));
+  EXPECT_THAT(CoalesceToStrings({{0, 10}, {15}}, 5),
+              ElementsAre("[0, ?): 0 1"));
+}
+
+TEST(GetSubCordForRequestTest, Closed) {
+  absl::Cord value("bcdef");
+  EXPECT_THAT(GetSubCordForRequest(value, {1, 6}, {2, 4}),
+              ::testing::Optional(absl::Cord("cd")));
+  EXPECT_THAT(GetSubCordForRequest(value, {1, 6}, {1, 6}),
+              ::testing::Optional(value));
+  EXPECT_THAT(GetSubCordForRequest(value, {1, 6}, {0, 4}),
+              MatchesStatus(absl::StatusCode::kOutOfRange));
+  EXPECT_THAT(GetSubCordForRequest(value, {1, 6}, {2}),
+              MatchesStatus(absl::StatusCode::kOutOfRange));
+  // Value shorter than requested.
+  EXPECT_THAT(GetSubCordForRequest(value, {1, 7}, {2, 4}),
+              MatchesStatus(absl::StatusCode::kOutOfRange));
+}
+
+TEST(GetSubCordForRequestTest, OpenEnded) {
+  absl::Cord value("bcdef");
+  EXPECT_THAT(GetSubCordForRequest(value, {1}, {2}),
+              ::testing::Optional(absl::Cord("cdef")));
+  EXPECT_THAT(GetSubCordForRequest(value, {1}, {2, 3}),
+              ::testing::Optional(absl::Cord("c")));
+  EXPECT_THAT(GetSubCordForRequest(value, {1}, {6}),
+              ::testing::Optional(absl::Cord()));
+  EXPECT_THAT(GetSubCordForRequest(value, {1}, {2, 7}),
+              MatchesStatus(absl::StatusCode::kOutOfRange));
+  EXPECT_THAT(GetSubCordForRequest(value, {1}, {7}),
+              MatchesStatus(absl::StatusCode::kOutOfRange));
+}
+
 TEST(ByteRangeSerializationTest, Basic) {
   TestSerializationRoundTrip(ByteRange{1, 5});
 }
@@ -0,0 +1,979 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// Key-value store adapter that caches the values read from a base key-value
+/// store in a local directory.
+///
+/// Each cached value is stored in a separate file, named by a unique id, that
+/// starts with a header specifying the key, the storage generation, and the
+/// time as of which the value was known to be current.  An in-memory index,
+/// rebuilt from the headers when the cache is opened, maps each key to its
+/// file.
+///
+/// A read is served entirely from the cache if the cached value is at least as
+/// recent as the requested `staleness_bound`.  Otherwise, the base key-value
+/// store is read with `if_not_equal` set to the cached generation: if it is
+/// unchanged, only the time of the cached entry is updated; otherwise, the
+/// entire new value is cached.  Byte range requests are satisfied from the
+/// full cached value if it is available, but are otherwise passed through to
+/// the base key-value store, such that a small byte range of a large value
+/// never requires reading the full value.
+///
+/// When the total size of the cache files exceeds `max_bytes`, the least
+/// recently used entries are evicted.
+///
+/// Only a single process may access a given directory at a time, which is
+/// enforced by an exclusive lock on the `LOCK` file in the directory; within a
+/// process, all drivers opened on the same directory share a single cache.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/internal/endian.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/strip.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/context.h"
+#include "tensorstore/internal/file_io_concurrency_resource.h"
+#include "tensorstore/internal/flat_cord_builder.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/internal/logging.h"
+#include "tensorstore/internal/no_destructor.h"
+#include "tensorstore/internal/os_error_code.h"
+#include "tensorstore/internal/path.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/file/file_io_util.h"
+#include "tensorstore/kvstore/file/unique_handle.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/registry.h"
+#include "tensorstore/kvstore/spec.h"
+#include "tensorstore/util/execution/any_receiver.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/garbage_collection/garbage_collection.h"
+#include "tensorstore/util/quote_string.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
+
+// Include these last to reduce impact of macros.
+#include "tensorstore/kvstore/file/posix_file_util.h"
+#include "tensorstore/kvstore/file/windows_file_util.h"
+
+namespace tensorstore {
+namespace {
+
+namespace jb = tensorstore::internal_json_binding;
+
+using ::tensorstore::internal::GetLastErrorCode;
+using ::tensorstore::internal::GetOsErrorMessage;
+using ::tensorstore::internal_file_util::FileDescriptor;
+using ::tensorstore::internal_file_util::FileInfo;
+using ::tensorstore::internal_file_util::FileLockTraits;
+using ::tensorstore::internal_file_util::MakeDirectories;
+using ::tensorstore::internal_file_util::ReadFully;
+using ::tensorstore::internal_file_util::StatusFromErrno;
+using ::tensorstore::internal_file_util::UniqueFileDescriptor;
+using ::tensorstore::internal_file_util::WriteFully;
+using ::tensorstore::kvstore::ReadResult;
+
+/// Cache entry file header, little endian:
+///
+///     magic: u32
+///     key_size: u32
+///     generation_size: u32
+///     time: i64 (nanoseconds since the unix epoch)
+///     value_size: u64
+///     key: byte[key_size]
+///     generation: byte[generation_size]
+///     value: byte[value_size]
+///
+/// A missing value is indicated by `StorageGeneration::NoValue()`.
+constexpr std::uint32_t kEntryMagic = 0x44434531;  // "DCE1"
+constexpr std::size_t kEntryHeaderSize = 28;
+
+/// Suffix of the temporary file to which an entry is written before it is
+/// renamed to its final name.
+constexpr std::string_view kTempSuffix = ".tmp";
+
+constexpr std::string_view kLockFileName = "LOCK";
+
+std::string GetEntryFileName(std::uint64_t file_id) {
+  return absl::StrFormat("%016x", file_id);
+}
+
+/// Parses a file name produced by `GetEntryFileName`.
+std::optional<std::uint64_t> ParseEntryFileName(std::string_view name) {
+  if (name.size() != 16) return std::nullopt;
+  std::uint64_t file_id = 0;
+  for (char c : name) {
+    int digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else {
+      return std::nullopt;
+    }
+    file_id = file_id * 16 + digit;
+  }
+  return file_id;
+}
+
+std::string EncodeEntryHeader(std::string_view key,
+                              const TimestampedStorageGeneration& stamp,
+                              std::uint64_t value_size) {
+  std::string header(kEntryHeaderSize, '\0');
+  char* p = header.data();
+  absl::little_endian::Store32(p, kEntryMagic);
+  absl::little_endian::Store32(p + 4, static_cast<std::uint32_t>(key.size()));
+  absl::little_endian::Store32(
+      p + 8, static_cast<std::uint32_t>(stamp.generation.value.size()));
+  absl::little_endian::Store64(p + 12, absl::ToUnixNanos(stamp.time));
+  absl::little_endian::Store64(p + 20, value_size);
+  header.append(key.data(), key.size());
+  header.append(stamp.generation.value);
+  return header;
+}
+
+/// In-memory representation of a cache entry.
+struct CachedValue {
+  std::uint64_t file_id;
+
+  /// Generation of the value, and time as of which it was known to be
+  /// current.  The generation is `StorageGeneration::NoValue()` if the key was
+  /// not present.
+  TimestampedStorageGeneration stamp;
+
+  /// Offset of the value within the file, equal to the header size.
+  std::uint64_t value_offset;
+
+  std::uint64_t value_size;
+
+  std::uint64_t file_size() const { return value_offset + value_size; }
+};
+
+/// Reads the header of the cache entry file at `path`.
+///
+/// \param key[out] Set to the key of the entry.
+/// \error `absl::StatusCode::kDataLoss` if the file is not a complete cache
+///     entry, as may result from a crash while it was being written.
+Result<CachedValue> ReadEntryHeader(const std::string& path,
+                                    std::uint64_t file_id, std::string& key) {
+  UniqueFileDescriptor fd =
+      internal_file_util::OpenExistingFileForReading(path.c_str());
+  if (!fd.valid()) {
+    return StatusFromErrno("Error opening file: ", path);
+  }
+  FileInfo info;
+  if (!internal_file_util::GetFileInfo(fd.get(), &info)) {
+    return StatusFromErrno("Error getting file information: ", path);
+  }
+  const std::uint64_t file_size = internal_file_util::GetSize(info);
+  const auto invalid = [&] {
+    return absl::DataLossError(
+        tensorstore::StrCat("Invalid cache entry: ", path));
+  };
+  if (file_size < kEntryHeaderSize) return invalid();
+  char header[kEntryHeaderSize];
+  TENSORSTORE_RETURN_IF_ERROR(
+      ReadFully(fd.get(), path, 0, header, kEntryHeaderSize));
+  if (absl::little_endian::Load32(header) != kEntryMagic) return invalid();
+  const std::uint64_t key_size = absl::little_endian::Load32(header + 4);
+  const std::uint64_t generation_size = absl::little_endian::Load32(header + 8);
+  CachedValue cached;
+  cached.file_id = file_id;
+  cached.stamp.time =
+      absl::FromUnixNanos(absl::little_endian::Load64(header + 12));
+  cached.value_size = absl::little_endian::Load64(header + 20);
+  cached.value_offset = kEntryHeaderSize + key_size + generation_size;
+  if (cached.value_size > file_size ||
+      cached.file_size() != file_size) {
+    return invalid();
+  }
+  std::string data(key_size + generation_size, '\0');
+  TENSORSTORE_RETURN_IF_ERROR(
+      ReadFully(fd.get(), path, kEntryHeaderSize, data.data(), data.size()));
+  key = data.substr(0, key_size);
+  cached.stamp.generation.value = data.substr(key_size);
+  return cached;
+}
+
+class DiskCache;
+
+Result<std::shared_ptr<DiskCache>> GetOrOpenCache(const std::string& directory,
+                                                  std::uint64_t max_bytes);
+
+/// Local cache directory, shared by all drivers opened on the same directory.
+class DiskCache {
+ public:
+  /// Opens the cache in `directory`, creating it if it does not exist.
+  ///
+  /// This performs blocking I/O.
+  static Result<std::shared_ptr<DiskCache>> Open(std::string directory,
+                                                 std::uint64_t max_bytes);
+
+  /// Releases the directory lock if this is the last cache opened on the
+  /// directory by `GetOrOpenCache`.
+  ~DiskCache();
+
+  std::uint64_t max_bytes() const { return max_bytes_; }
+
+  /// Returns the entry for `key`, and marks it as most recently used.
+  std::optional<CachedValue> Find(const std::string& key)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /// Caches `value` as the value of `key` as of `stamp`.
+  ///
+  /// This performs blocking I/O.  Errors are logged but otherwise ignored,
+  /// since the value is simply read from the base key-value store again.
+  void Store(const std::string& key, const TimestampedStorageGeneration& stamp,
+             const std::optional<absl::Cord>& value)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /// Records that the entry `cached` for `key` is still current as of `time`.
+  void Revalidate(const std::string& key, const CachedValue& cached,
+                  absl::Time time) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /// Removes the entry `cached` for `key`, unless it has since been replaced.
+  void Remove(const std::string& key, const CachedValue& cached)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /// Removes all entries in `range`.
+  void RemoveRange(const KeyRange& range) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /// Reads the specified byte range of the value of `cached`.
+  Result<absl::Cord> ReadValue(const CachedValue& cached,
+                               ByteRange byte_range) const;
+
+  std::string GetEntryPath(std::uint64_t file_id) const {
+    return internal::JoinPath(directory_, GetEntryFileName(file_id));
+  }
+
+ private:
+  friend Result<std::shared_ptr<DiskCache>> GetOrOpenCache(
+      const std::string& directory, std::uint64_t max_bytes);
+
+  struct Entry {
+    CachedValue value;
+    std::list<std::string>::iterator lru_position;
+  };
+
+  /// Removes the entry `it`.
+  ///
+  /// \returns The iterator following `it`.
+  absl::btree_map<std::string, Entry>::iterator EraseEntry(
+      absl::btree_map<std::string, Entry>::iterator it,
+      std::vector<std::uint64_t>& files_to_delete)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Evicts least recently used entries until the total size is within
+  /// `max_bytes_`.
+  void Evict(std::vector<std::uint64_t>& files_to_delete)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  void DeleteFiles(const std::vector<std::uint64_t>& file_ids) const;
+
+  std::string directory_;
+  std::uint64_t max_bytes_;
+  /// Set by `GetOrOpenCache` once the cache holds a reference to the directory
+  /// lock.
+  bool holds_directory_lock_ = false;
+
+  absl::Mutex mutex_;
+  absl::btree_map<std::string, Entry> entries_ ABSL_GUARDED_BY(mutex_);
+  /// Keys of `entries_`, from most to least recently used.
+  std::list<std::string> lru_ ABSL_GUARDED_BY(mutex_);
+  std::uint64_t total_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::uint64_t next_file_id_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+Result<std::shared_ptr<DiskCache>> DiskCache::Open(std::string directory,
+                                                   std::uint64_t max_bytes) {
+  auto cache = std::make_shared<DiskCache>();
+  cache->directory_ = std::move(directory);
+  cache->max_bytes_ = max_bytes;
+  const std::string& dir = cache->directory_;
+  TENSORSTORE_RETURN_IF_ERROR(MakeDirectories(dir));
+
+  std::vector<std::uint64_t> file_ids;
+  std::vector<std::string> temp_files;
+  {
+    std::unique_ptr<internal_file_util::DirectoryIterator> dir_it;
+    if (!internal_file_util::DirectoryIterator::Make(
+            internal_file_util::DirectoryIterator::Entry::FromPath(dir),
+            &dir_it)) {
+      return StatusFromErrno("Failed to open directory: ", dir);
+    }
+    while (dir_it && dir_it->Next()) {
+      if (dir_it->is_directory()) continue;
+      std::string_view name = dir_it->path_component();
+      if (auto id = ParseEntryFileName(name)) {
+        file_ids.push_back(*id);
+      } else if (absl::ConsumeSuffix(&name, kTempSuffix) &&
+                 ParseEntryFileName(name)) {
+        // Incomplete entry left by a crash.
+        temp_files.push_back(
+            internal::JoinPath(dir, dir_it->path_component()));
+      }
+    }
+  }
+  for (const auto& path : temp_files) {
+    internal_file_util::DeleteFile(path);
+  }
+
+  absl::MutexLock lock(&cache->mutex_);
+  std::vector<std::uint64_t> files_to_delete;
+  std::vector<std::pair<absl::Time, std::string>> lru_order;
+  for (std::uint64_t id : file_ids) {
+    cache->next_file_id_ = std::max(cache->next_file_id_, id + 1);
+    std::string key;
+    auto cached = ReadEntryHeader(cache->GetEntryPath(id), id, key);
+    if (!cached.ok()) {
+      if (absl::IsDataLoss(cached.status())) {
+        files_to_delete.push_back(id);
+        continue;
+      }
+      return cached.status();
+    }
+    auto [it, inserted] = cache->entries_.try_emplace(key);
+    if (!inserted) {
+      // A previous value was not deleted, e.g. due to a crash; keep the most
+      // recent one.
+      if (it->second.value.stamp.time >= cached->stamp.time) {
+        files_to_delete.push_back(id);
+        continue;
+      }
+      files_to_delete.push_back(it->second.value.file_id);
+      cache->total_bytes_ -= it->second.value.file_size();
+    }
+    it->second.value = *cached;
+    cache->total_bytes_ += cached->file_size();
+  }
+  for (const auto& [key, entry] : cache->entries_) {
+    lru_order.emplace_back(entry.value.stamp.time, key);
+  }
+  // Entries validated most recently are assumed to be most recently used.
+  std::sort(lru_order.begin(), lru_order.end());
+  for (auto& [time, key] : lru_order) {
+    cache->lru_.push_front(key);
+    cache->entries_.at(key).lru_position = cache->lru_.begin();
+  }
+  cache->Evict(files_to_delete);
+  cache->DeleteFiles(files_to_delete);
+  return cache;
+}
+
+std::optional<CachedValue> DiskCache::Find(const std::string& key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return std::nullopt;
+  lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+  return it->second.value;
+}
+
+void DiskCache::Store(const std::string& key,
+                      const TimestampedStorageGeneration& stamp,
+                      const std::optional<absl::Cord>& value) {
+  const std::uint64_t value_size = value ? value->size() : 0;
+  std::vector<std::uint64_t> files_to_delete;
+  if (key.size() > std::numeric_limits<std::uint32_t>::max() ||
+      kEntryHeaderSize + key.size() + stamp.generation.value.size() +
+              value_size >
+          max_bytes_) {
+    // Too large to cache.  Any existing entry is obsolete.
+    {
+      absl::MutexLock lock(&mutex_);
+      auto it = entries_.find(key);
+      if (it == entries_.end() || it->second.value.stamp.time > stamp.time) {
+        return;
+      }
+      EraseEntry(it, files_to_delete);
+    }
+    DeleteFiles(files_to_delete);
+    return;
+  }
+  absl::Cord data(EncodeEntryHeader(key, stamp, value_size));
+  CachedValue cached;
+  cached.stamp = stamp;
+  cached.value_offset = data.size();
+  cached.value_size = value_size;
+  if (value) data.Append(*value);
+  {
+    absl::MutexLock lock(&mutex_);
+    cached.file_id = next_file_id_++;
+  }
+
+  // Each value is written to a new file, such that concurrent reads of a
+  // previous value are unaffected.  The file is written under a temporary name,
+  // synced, and then renamed, such that a crash never leaves a partially
+  // written entry under its final name.
+  const std::string path = GetEntryPath(cached.file_id);
+  const std::string temp_path = tensorstore::StrCat(path, kTempSuffix);
+  absl::Status status = [&] {
+    UniqueFileDescriptor fd =
+        internal_file_util::OpenFileForWriting(temp_path);
+    if (!fd.valid()) {
+      return StatusFromErrno("Failed to open: ", temp_path);
+    }
+    TENSORSTORE_RETURN_IF_ERROR(
+        WriteFully(fd.get(), temp_path, std::move(data)));
+    if (!internal_file_util::FsyncFile(fd.get())) {
+      return StatusFromErrno("Error calling fsync on file: ", temp_path);
+    }
+    if (!internal_file_util::RenameOpenFile(fd.get(), temp_path, path)) {
+      return StatusFromErrno("Error renaming: ", temp_path, " -> ", path);
+    }
+    return absl::OkStatus();
+  }();
+
+  if (!status.ok()) {
+    TENSORSTORE_LOG("Failed to write disk cache entry: ", status);
+    internal_file_util::DeleteFile(temp_path);
+  } else {
+    absl::MutexLock lock(&mutex_);
+    auto [it, inserted] = entries_.try_emplace(key);
+    bool replace = true;
+    if (inserted) {
+      lru_.push_front(key);
+      it->second.lru_position = lru_.begin();
+    } else if (it->second.value.stamp.time > stamp.time) {
+      // A more recent value was stored concurrently.
+      files_to_delete.push_back(cached.file_id);
+      replace = false;
+    } else {
+      files_to_delete.push_back(it->second.value.file_id);
+      total_bytes_ -= it->second.value.file_size();
+      lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+    }
+    if (replace) {
+      it->second.value = cached;
+      total_bytes_ += cached.file_size();
+      Evict(files_to_delete);
+    }
+  }
+  DeleteFiles(files_to_delete);
+}
+
+void DiskCache::Revalidate(const std::string& key, const CachedValue& cached,
+                           absl::Time time) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end() || it->second.value.file_id != cached.file_id) {
+    return;
+  }
+  auto& stamp = it->second.value.stamp;
+  stamp.time = std::max(stamp.time, time);
+}
+
+void DiskCache::Remove(const std::string& key, const CachedValue& cached) {
+  std::vector<std::uint64_t> files_to_delete;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.value.file_id != cached.file_id) {
+      return;
+    }
+    EraseEntry(it, files_to_delete);
+  }
+  DeleteFiles(files_to_delete);
+}
+
+void DiskCache::RemoveRange(const KeyRange& range) {
+  std::vector<std::uint64_t> files_to_delete;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.lower_bound(range.inclusive_min);
+    while (it != entries_.end() && Contains(range, it->first)) {
+      it = EraseEntry(it, files_to_delete);
+    }
+  }
+  DeleteFiles(files_to_delete);
+}
+
+Result<absl::Cord> DiskCache::ReadValue(const CachedValue& cached,
+                                        ByteRange byte_range) const {
+  const std::string path = GetEntryPath(cached.file_id);
+  UniqueFileDescriptor fd =
+      internal_file_util::OpenExistingFileForReading(path.c_str());
+  if (!fd.valid()) {
+    return StatusFromErrno("Error opening file: ", path);
+  }
+  internal::FlatCordBuilder buffer(byte_range.size());
+  TENSORSTORE_RETURN_IF_ERROR(
+      ReadFully(fd.get(), path, cached.value_offset + byte_range.inclusive_min,
+                buffer.data(), buffer.size()));
+  return std::move(buffer).Build();
+}
+
+absl::btree_map<std::string, DiskCache::Entry>::iterator DiskCache::EraseEntry(
+    absl::btree_map<std::string, Entry>::iterator it,
+    std::vector<std::uint64_t>& files_to_delete) {
+  files_to_delete.push_back(it->second.value.file_id);
+  total_bytes_ -= it->second.value.file_size();
+  lru_.erase(it->second.lru_position);
+  return entries_.erase(it);
+}
+
+void DiskCache::Evict(std::vector<std::uint64_t>& files_to_delete) {
+  while (total_bytes_ > max_bytes_ && !lru_.empty()) {
+    EraseEntry(entries_.find(lru_.back()), files_to_delete);
+  }
+}
+
+void DiskCache::DeleteFiles(const std::vector<std::uint64_t>& file_ids) const {
+  // Failure to delete is not an error: an orphaned file that is still present
+  // when the cache is next opened is either loaded or discarded as obsolete.
+  for (std::uint64_t id : file_ids) {
+    internal_file_util::DeleteFile(GetEntryPath(id));
+  }
+}
+
+/// Exclusive lock on the `LOCK` file of a cache directory.
+struct DirectoryLock {
+  UniqueFileDescriptor fd;
+  // Declared after `fd` so that the lock is released before `fd` is closed.
+  internal::UniqueHandle<FileDescriptor, FileLockTraits> lock;
+};
+
+/// Creates `directory` if it does not exist, and locks it.
+///
+/// \error `absl::StatusCode::kFailedPrecondition` if the directory is locked
+///     by another process.
+Result<DirectoryLock> LockDirectory(const std::string& directory) {
+  TENSORSTORE_RETURN_IF_ERROR(MakeDirectories(directory));
+  const std::string path = internal::JoinPath(directory, kLockFileName);
+  DirectoryLock lock;
+  lock.fd = internal_file_util::OpenFileForWriting(path);
+  if (!lock.fd.valid()) {
+    return StatusFromErrno("Failed to open lock file: ", path);
+  }
+  if (!FileLockTraits::TryAcquire(lock.fd.get())) {
+    return absl::FailedPreconditionError(tensorstore::StrCat(
+        "Disk cache ", QuoteString(directory),
+        " is in use by another process: ",
+        GetOsErrorMessage(GetLastErrorCode())));
+  }
+  lock.lock.reset(lock.fd.get());
+  return lock;
+}
+
+/// Caches that are currently open, indexed by directory.
+struct CacheRegistry {
+  struct Entry {
+    std::weak_ptr<DiskCache> cache;
+    /// Valid while `num_caches != 0`.
+    DirectoryLock lock;
+    /// Number of caches holding `lock` that have not yet been destroyed.  A
+    /// cache that is being destroyed may still be counted after `cache` has
+    /// expired, in which case a newly opened cache shares its lock rather
+    /// than failing to acquire it.
+    std::size_t num_caches = 0;
+  };
+  absl::Mutex mutex;
+  absl::flat_hash_map<std::string, Entry> caches ABSL_GUARDED_BY(mutex);
+};
+
+CacheRegistry& GetCacheRegistry() {
+  static internal::NoDestructor<CacheRegistry> registry;
+  return *registry;
+}
+
+DiskCache::~DiskCache() {
+  if (!holds_directory_lock_) return;
+  auto& registry = GetCacheRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  auto it = registry.caches.find(directory_);
+  assert(it != registry.caches.end());
+  if (--it->second.num_caches == 0) registry.caches.erase(it);
+}
+
+/// Returns the open cache for `directory`, or opens it.
+///
+/// \error `absl::StatusCode::kFailedPrecondition` if the cache is already open
+///     with a different `max_bytes`, or is in use by another process.
+Result<std::shared_ptr<DiskCache>> GetOrOpenCache(const std::string& directory,
+                                                  std::uint64_t max_bytes) {
+  auto& registry = GetCacheRegistry();
+  // The lock is held while opening, such that concurrent opens of the same
+  // directory wait for the first one to complete.
+  absl::MutexLock lock(&registry.mutex);
+  auto& entry = registry.caches[directory];
+  if (auto cache = entry.cache.lock()) {
+    if (cache->max_bytes() != max_bytes) {
+      return absl::FailedPreconditionError(tensorstore::StrCat(
+          "Disk cache ", QuoteString(directory),
+          " is already open with max_bytes=", cache->max_bytes()));
+    }
+    return cache;
+  }
+  if (entry.num_caches == 0) {
+    auto lock_result = LockDirectory(directory);
+    if (!lock_result.ok()) {
+      registry.caches.erase(directory);
+      return lock_result.status();
+    }
+    entry.lock = *std::move(lock_result);
+  }
+  auto cache_result = DiskCache::Open(directory, max_bytes);
+  if (!cache_result.ok()) {
+    if (entry.num_caches == 0) registry.caches.erase(directory);
+    return cache_result.status();
+  }
+  auto& cache = *cache_result;
+  cache->holds_directory_lock_ = true;
+  ++entry.num_caches;
+  entry.cache = cache;
+  return cache;
+}
+
+/// Applies the conditions and byte range of `options` to the result of a read
+/// of the full value.
+Result<ReadResult> ApplyReadOptions(ReadResult read_result,
+                                    const kvstore::ReadOptions& options) {
+  if (!read_result.has_value()) return read_result;
+  if (read_result.stamp.generation == options.if_not_equal ||
+      (!StorageGeneration::IsUnknown(options.if_equal) &&
+       read_result.stamp.generation != options.if_equal)) {
+    return ReadResult{ReadResult::kUnspecified, {},
+                      std::move(read_result.stamp)};
+  }
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      auto byte_range, options.byte_range.Validate(read_result.value.size()));
+  read_result.value = internal::GetSubCord(read_result.value, byte_range);
+  return read_result;
+}
+
+struct DiskCacheKeyValueStoreSpecData {
+  kvstore::Spec base;
+  std::string directory;
+  std::uint64_t max_bytes = 1024 * 1024 * 1024;
+  Context::Resource<internal::FileIoConcurrencyResource> file_io_concurrency;
+
+  constexpr static auto ApplyMembers = [](auto&& x, auto f) {
+    return f(x.base, x.directory, x.max_bytes, x.file_io_concurrency);
+  };
+
+  constexpr static auto default_json_binder = jb::Object(
+      jb::Member("base",
+                 jb::Projection<&DiskCacheKeyValueStoreSpecData::base>()),
+      jb::Member("directory",
+                 jb::Projection<&DiskCacheKeyValueStoreSpecData::directory>(
+                     jb::NonEmptyStringBinder)),
+      jb::Member("max_bytes",
+                 jb::Projection<&DiskCacheKeyValueStoreSpecData::max_bytes>(
+                     jb::DefaultValue<jb::kNeverIncludeDefaults>(
+                         [](auto* obj) { *obj = 1024 * 1024 * 1024; },
+                         jb::Integer<std::uint64_t>(1)))),
+      jb::Member(internal::FileIoConcurrencyResource::id,
+                 jb::Projection<&DiskCacheKeyValueStoreSpecData::
+                                    file_io_concurrency>()));
+};
+
+class DiskCacheKeyValueStoreSpec
+    : public internal_kvstore::RegisteredDriverSpec<
+          DiskCacheKeyValueStoreSpec, DiskCacheKeyValueStoreSpecData> {
+ public:
+  static constexpr char id[] = "disk_cache";
+
+  Future<kvstore::DriverPtr> DoOpen() const override;
+};
+
+class DiskCacheKeyValueStore
+    : public internal_kvstore::RegisteredDriver<DiskCacheKeyValueStore,
+                                                DiskCacheKeyValueStoreSpec> {
+ public:
+  Future<ReadResult> Read(Key key, ReadOptions options) override;
+
+  Future<TimestampedStorageGeneration> Write(Key key,
+                                             std::optional<Value> value,
+                                             WriteOptions options) override;
+
+  Future<const void> DeleteRange(KeyRange range) override;
+
+  void ListImpl(ListOptions options,
+                AnyFlowReceiver<absl::Status, Key> receiver) override {
+    options.range = KeyRange::AddPrefix(base_path_, std::move(options.range));
+    options.strip_prefix_length += base_path_.size();
+    base_->ListImpl(std::move(options), std::move(receiver));
+  }
+
+  std::string DescribeKey(std::string_view key) override {
+    return base_->DescribeKey(tensorstore::StrCat(base_path_, key));
+  }
+
+  absl::Status GetBoundSpecData(DiskCacheKeyValueStoreSpecData& spec) const {
+    spec = spec_;
+    TENSORSTORE_ASSIGN_OR_RETURN(spec.base.driver, base_->GetBoundSpec());
+    spec.base.path = base_path_;
+    return absl::OkStatus();
+  }
+
+  const Executor& executor() { return spec_.file_io_concurrency->executor; }
+
+  kvstore::Driver* base() const { return base_.get(); }
+
+  /// Returns the key of the cache entry for `key`.
+  ///
+  /// Keys are qualified by the JSON spec of the base key-value store, without
+  /// its path or context resources, followed by the path, such that a single
+  /// directory may be used to cache multiple base key-value stores.  Unlike
+  /// `DescribeKey`, which is intended only for error messages, the spec
+  /// uniquely identifies the base key-value store.
+  std::string GetCacheKey(std::string_view key) const {
+    return tensorstore::StrCat(cache_key_prefix_, key);
+  }
+
+  /// Reads a byte range of `key` that is not available from the cache.
+  ///
+  /// Only the requested byte range is read from the base key-value store,
+  /// since the full value may be arbitrarily large, and it is therefore not
+  /// cached.  If `cached` is specified, it is revalidated, and used if it is
+  /// unchanged.
+  Future<ReadResult> ReadByteRange(Key key, std::optional<CachedValue> cached,
+                                   ReadOptions options);
+
+  /// Reads `key` from the cache entry `cached`, which is sufficiently recent.
+  ///
+  /// If the entry has been evicted concurrently, falls back to `Read`.
+  Future<ReadResult> ReadFromCache(Key key, const CachedValue& cached,
+                                   ReadOptions options);
+
+  /// Spec data, excluding `base`.
+  SpecData spec_;
+  kvstore::DriverPtr base_;
+  std::string base_path_;
+  std::string cache_key_prefix_;
+  std::shared_ptr<DiskCache> cache_;
+};
+
+}  // namespace
+
+namespace garbage_collection {
+template <>
+struct GarbageCollection<DiskCacheKeyValueStore> {
+  static void Visit(GarbageCollectionVisitor& visitor,
+                    const DiskCacheKeyValueStore& value) {
+    garbage_collection::GarbageCollectionVisit(visitor, *value.base());
+  }
+};
+}  // namespace garbage_collection
+
+namespace {
+
+Future<ReadResult> DiskCacheKeyValueStore::Read(Key key, ReadOptions options) {
+  auto cached = cache_->Find(GetCacheKey(key));
+  if (cached && cached->stamp.time >= options.staleness_bound) {
+    return ReadFromCache(std::move(key), *cached, std::move(options));
+  }
+  if (options.byte_range != OptionalByteRangeRequest{}) {
+    return ReadByteRange(std::move(key), std::move(cached),
+                         std::move(options));
+  }
+  // The full value is requested, and cached if it is not too large.
+  kvstore::ReadOptions base_options;
+  base_options.staleness_bound = options.staleness_bound;
+  if (cached && !StorageGeneration::IsNoValue(cached->stamp.generation)) {
+    base_options.if_not_equal = cached->stamp.generation;
+  }
+  auto future = base_->Read(tensorstore::StrCat(base_path_, key),
+                            std::move(base_options));
+  return MapFutureValue(
+      executor(),
+      [self = internal::IntrusivePtr<DiskCacheKeyValueStore>(this),
+       key = std::move(key), cached = std::move(cached),
+       options = std::move(options)](
+          ReadResult& read_result) mutable -> Future<ReadResult> {
+        if (read_result.aborted()) {
+          if (!cached) return read_result;
+          // The cached value is unchanged.
+          self->cache_->Revalidate(self->GetCacheKey(key), *cached,
+                                   read_result.stamp.time);
+          cached->stamp.time = read_result.stamp.time;
+          return self->ReadFromCache(std::move(key), *cached,
+                                     std::move(options));
+        }
+        self->cache_->Store(self->GetCacheKey(key), read_result.stamp,
+                            read_result.optional_value());
+        return ApplyReadOptions(std::move(read_result), options);
+      },
+      std::move(future));
+}
+
+Future<ReadResult> DiskCacheKeyValueStore::ReadByteRange(
+    Key key, std::optional<CachedValue> cached, ReadOptions options) {
+  kvstore::ReadOptions base_options = options;
+  if (cached && StorageGeneration::IsUnknown(options.if_not_equal) &&
+      !StorageGeneration::IsNoValue(cached->stamp.generation)) {
+    base_options.if_not_equal = cached->stamp.generation;
+  } else {
+    cached = std::nullopt;
+  }
+  auto future = base_->Read(tensorstore::StrCat(base_path_, key),
+                            std::move(base_options));
+  return MapFutureValue(
+      executor(),
+      [self = internal::IntrusivePtr<DiskCacheKeyValueStore>(this),
+       key = std::move(key), cached = std::move(cached),
+       options = std::move(options)](
+          ReadResult& read_result) mutable -> Future<ReadResult> {
+        if (!cached) return read_result;
+        if (read_result.aborted()) {
+          if (read_result.stamp.generation != cached->stamp.generation) {
+            // `options.if_equal` was not satisfied.
+            return read_result;
+          }
+          // The cached value is unchanged.
+          self->cache_->Revalidate(self->GetCacheKey(key), *cached,
+                                   read_result.stamp.time);
+          cached->stamp.time = read_result.stamp.time;
+          return self->ReadFromCache(std::move(key), *cached,
+                                     std::move(options));
+        }
+        // Only part of the new value was read, so the obsolete entry is
+        // removed rather than replaced.
+        self->cache_->Remove(self->GetCacheKey(key), *cached);
+        return read_result;
+      },
+      std::move(future));
+}
+
+Future<ReadResult> DiskCacheKeyValueStore::ReadFromCache(
+    Key key, const CachedValue& cached, ReadOptions options) {
+  ReadResult read_result;
+  read_result.stamp = cached.stamp;
+  if (StorageGeneration::IsNoValue(cached.stamp.generation)) {
+    read_result.state = ReadResult::kMissing;
+    return read_result;
+  }
+  if (read_result.stamp.generation == options.if_not_equal ||
+      (!StorageGeneration::IsUnknown(options.if_equal) &&
+       read_result.stamp.generation != options.if_equal)) {
+    return read_result;
+  }
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      auto byte_range, options.byte_range.Validate(cached.value_size));
+  read_result.state = ReadResult::kValue;
+  if (byte_range.size() == 0) return read_result;
+  return MapFuture(
+      executor(),
+      [self = internal::IntrusivePtr<DiskCacheKeyValueStore>(this),
+       key = std::move(key), cached, byte_range, options = std::move(options),
+       read_result = std::move(read_result)]() mutable -> Future<ReadResult> {
+        auto value = self->cache_->ReadValue(cached, byte_range);
+        if (!value.ok()) {
+          // The entry may have been evicted or replaced since it was found.
+          self->cache_->Remove(self->GetCacheKey(key), cached);
+          return self->Read(std::move(key), std::move(options));
+        }
+        read_result.value = *std::move(value);
+        return read_result;
+      });
+}
+
+Future<TimestampedStorageGeneration> DiskCacheKeyValueStore::Write(
+    Key key, std::optional<Value> value, WriteOptions options) {
+  auto future = base_->Write(tensorstore::StrCat(base_path_, key), value,
+                             std::move(options));
+  // Writes through to the cache, such that the value need not be read back.
+  return MapFutureValue(
+      executor(),
+      [self = internal::IntrusivePtr<DiskCacheKeyValueStore>(this),
+       key = std::move(key), value = std::move(value)](
+          const TimestampedStorageGeneration& stamp) {
+        if (!StorageGeneration::IsUnknown(stamp.generation)) {
+          self->cache_->Store(self->GetCacheKey(key), stamp, value);
+        }
+        return stamp;
+      },
+      std::move(future));
+}
+
+Future<const void> DiskCacheKeyValueStore::DeleteRange(KeyRange range) {
+  auto future =
+      base_->DeleteRange(KeyRange::AddPrefix(base_path_, range));
+  return MapFuture(
+      executor(),
+      [self = internal::IntrusivePtr<DiskCacheKeyValueStore>(this),
+       range = KeyRange::AddPrefix(cache_key_prefix_, std::move(range))](
+          const Result<void>& result) {
+        // Cached values in `range` are obsolete even if the deletion failed
+        // part way through.
+        self->cache_->RemoveRange(range);
+        return result;
+      },
+      std::move(future));
+}
+
+Future<kvstore::DriverPtr> DiskCacheKeyValueStoreSpec::DoOpen() const {
+  // Opening the cache performs blocking I/O to load the index.
+  return MapFutureValue(
+      data_.file_io_concurrency->executor,
+      [spec = internal::IntrusivePtr<const DiskCacheKeyValueStoreSpec>(this)](
+          kvstore::KvStore& base_kvstore) -> Result<kvstore::DriverPtr> {
+        auto driver = internal::MakeIntrusivePtr<DiskCacheKeyValueStore>();
+        driver->spec_ = spec->data_;
+        driver->spec_.base = {};
+        driver->base_ = std::move(base_kvstore.driver);
+        driver->base_path_ = std::move(base_kvstore.path);
+        TENSORSTORE_ASSIGN_OR_RETURN(auto base_spec,
+                                     driver->base_->GetBoundSpec());
+        kvstore::Spec base_kvstore_spec(std::move(base_spec));
+        base_kvstore_spec.StripContext();
+        TENSORSTORE_ASSIGN_OR_RETURN(auto base_json,
+                                     base_kvstore_spec.ToJson());
+        driver->cache_key_prefix_ =
+            tensorstore::StrCat(base_json.dump(), std::string_view("\0", 1),
+                                driver->base_path_);
+        TENSORSTORE_ASSIGN_OR_RETURN(
+            driver->cache_,
+            GetOrOpenCache(spec->data_.directory, spec->data_.max_bytes));
+        return driver;
+      },
+      kvstore::Open(data_.base));
+}
+
+}  // namespace
+}  // namespace tensorstore
+
+namespace {
+const tensorstore::internal_kvstore::DriverRegistration<
+    tensorstore::DiskCacheKeyValueStoreSpec>
+    registration;
+}  // namespace
@@ -0,0 +1,306 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/match.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/context.h"
+#include "tensorstore/internal/test_util.h"
+#include "tensorstore/kvstore/file/file_io_util.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/generation_testutil.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/test_util.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/status_testutil.h"
+#include "tensorstore/util/str_cat.h"
+
+// Include system headers last to reduce impact of macros.
+#include "tensorstore/kvstore/file/posix_file_util.h"
+#include "tensorstore/kvstore/file/windows_file_util.h"
+
+namespace {
+
+namespace kvstore = tensorstore::kvstore;
+using ::tensorstore::Context;
+using ::tensorstore::KvStore;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::internal::MatchesKvsReadResult;
+using ::tensorstore::internal::MatchesKvsReadResultNotFound;
+using ::tensorstore::internal_file_util::FileLockTraits;
+using ::tensorstore::internal_file_util::UniqueFileDescriptor;
+
+::nlohmann::json GetSpec(std::string directory) {
+  return {{"driver", "disk_cache"},
+          {"base", "memory://"},
+          {"directory", directory}};
+}
+
+/// Returns the number of files in `directory`, excluding the lock file.
+std::size_t CountFiles(const std::string& directory) {
+  std::size_t count = 0;
+  TENSORSTORE_CHECK_OK(tensorstore::internal::EnumeratePaths(
+      directory, [&](const std::string& name, bool is_dir) {
+        if (!is_dir && !absl::EndsWith(name, "/LOCK")) ++count;
+        return absl::OkStatus();
+      }));
+  return count;
+}
+
+class DiskCacheKeyValueStoreTest : public ::testing::Test {
+ protected:
+  KvStore OpenCache(::nlohmann::json spec) {
+    return kvstore::Open(spec, context_).value();
+  }
+  KvStore OpenCache() { return OpenCache(GetSpec(root_)); }
+
+  /// Returns the base key-value store, which shares the memory key-value store
+  /// resource of the cache.
+  KvStore OpenBase() { return kvstore::Open("memory://", context_).value(); }
+
+  tensorstore::internal::ScopedTemporaryDirectory tempdir_;
+  std::string root_ = tempdir_.path() + "/cache";
+  Context context_ = Context::Default();
+};
+
+TEST_F(DiskCacheKeyValueStoreTest, Basic) {
+  tensorstore::internal::TestKeyValueStoreBasicFunctionality(OpenCache());
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, DeletePrefix) {
+  tensorstore::internal::TestKeyValueStoreDeletePrefix(OpenCache());
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, DeleteRange) {
+  tensorstore::internal::TestKeyValueStoreDeleteRange(OpenCache());
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, DeleteRangeToEnd) {
+  tensorstore::internal::TestKeyValueStoreDeleteRangeToEnd(OpenCache());
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, DeleteRangeFromBeginning) {
+  tensorstore::internal::TestKeyValueStoreDeleteRangeFromBeginning(
+      OpenCache());
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, StalenessBound) {
+  auto base = OpenBase();
+  auto cache = OpenCache();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp1, kvstore::Write(base, "a", absl::Cord("1")).result());
+  EXPECT_THAT(kvstore::Read(cache, "a").result(),
+              MatchesKvsReadResult(absl::Cord("1"), stamp1.generation));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp2, kvstore::Write(base, "a", absl::Cord("22")).result());
+
+  // The cached value satisfies any staleness bound before it was read.
+  kvstore::ReadOptions options;
+  options.staleness_bound = stamp1.time;
+  EXPECT_THAT(kvstore::Read(cache, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("1"), stamp1.generation));
+
+  // Byte ranges are served from the cached value.
+  options.byte_range.inclusive_min = 1;
+  EXPECT_THAT(kvstore::Read(cache, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord(""), stamp1.generation));
+
+  // A later staleness bound revalidates the value.  Since only the byte range
+  // of the new value is read, the obsolete entry is removed.
+  options.staleness_bound = absl::Now();
+  EXPECT_THAT(kvstore::Read(cache, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("2"), stamp2.generation));
+  options.byte_range = {};
+  options.staleness_bound = stamp2.time;
+  EXPECT_THAT(kvstore::Read(cache, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("22"), stamp2.generation));
+
+  // Missing values are cached as well.
+  EXPECT_THAT(kvstore::Read(cache, "b").result(),
+              MatchesKvsReadResultNotFound());
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "b", absl::Cord("3")));
+  options.staleness_bound = absl::InfinitePast();
+  EXPECT_THAT(kvstore::Read(cache, "b", options).result(),
+              MatchesKvsReadResultNotFound());
+  EXPECT_THAT(kvstore::Read(cache, "b").result(),
+              MatchesKvsReadResult(absl::Cord("3")));
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, ByteRange) {
+  auto base = OpenBase();
+  auto cache = OpenCache();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp1, kvstore::Write(base, "a", absl::Cord("abc")).result());
+
+  // A byte range of a value that is not cached is read from the base
+  // key-value store, without caching the value.
+  kvstore::ReadOptions options;
+  options.byte_range.inclusive_min = 1;
+  EXPECT_THAT(kvstore::Read(cache, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("bc"), stamp1.generation));
+  EXPECT_EQ(0, CountFiles(root_));
+
+  // Once the full value is cached, byte ranges are read from the cached value
+  // after revalidating it.
+  EXPECT_THAT(kvstore::Read(cache, "a").result(),
+              MatchesKvsReadResult(absl::Cord("abc"), stamp1.generation));
+  EXPECT_EQ(1, CountFiles(root_));
+  options.staleness_bound = absl::Now();
+  EXPECT_THAT(kvstore::Read(cache, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("bc"), stamp1.generation));
+  EXPECT_EQ(1, CountFiles(root_));
+
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp2, kvstore::Write(base, "a", absl::Cord("defg")).result());
+  options.staleness_bound = absl::Now();
+  EXPECT_THAT(kvstore::Read(cache, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("efg"), stamp2.generation));
+  EXPECT_EQ(0, CountFiles(root_));
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, Reopen) {
+  auto base = OpenBase();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp, kvstore::Write(base, "a", absl::Cord("1")).result());
+  {
+    auto cache = OpenCache();
+    EXPECT_THAT(kvstore::Read(cache, "a").result(),
+                MatchesKvsReadResult(absl::Cord("1"), stamp.generation));
+  }
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("2")));
+  auto cache = OpenCache();
+  kvstore::ReadOptions options;
+  options.staleness_bound = stamp.time;
+  EXPECT_THAT(kvstore::Read(cache, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("1"), stamp.generation));
+  EXPECT_THAT(kvstore::Read(cache, "a").result(),
+              MatchesKvsReadResult(absl::Cord("2")));
+  // The obsolete entry was replaced.
+  EXPECT_EQ(1, CountFiles(root_));
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, DeletesIncompleteEntries) {
+  auto base = OpenBase();
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("1")));
+  {
+    auto cache = OpenCache();
+    TENSORSTORE_ASSERT_OK(kvstore::Read(cache, "a").result());
+  }
+  // Simulates an entry whose write was interrupted by a crash.
+  std::ofstream(root_ + "/00000000000000ff.tmp") << "partial";
+  EXPECT_EQ(2, CountFiles(root_));
+  auto cache = OpenCache();
+  EXPECT_EQ(1, CountFiles(root_));
+  kvstore::ReadOptions options;
+  options.staleness_bound = absl::InfinitePast();
+  EXPECT_THAT(kvstore::Read(cache, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("1")));
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, Eviction) {
+  auto spec = GetSpec(root_);
+  spec["max_bytes"] = 1000;
+  auto cache = OpenCache(spec);
+  constexpr int kNumKeys = 20;
+  for (int i = 0; i < kNumKeys; ++i) {
+    TENSORSTORE_ASSERT_OK(kvstore::Write(cache, tensorstore::StrCat(i),
+                                         absl::Cord(std::string(100, 'x'))));
+  }
+  EXPECT_LT(CountFiles(root_), 10);
+  // Evicted values are read from the base key-value store.
+  for (int i = 0; i < kNumKeys; ++i) {
+    EXPECT_THAT(kvstore::Read(cache, tensorstore::StrCat(i)).result(),
+                MatchesKvsReadResult(absl::Cord(std::string(100, 'x'))));
+  }
+  // Values larger than `max_bytes` are not cached.
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(cache, "large", absl::Cord(std::string(2000, 'y'))));
+  EXPECT_THAT(kvstore::Read(cache, "large").result(),
+              MatchesKvsReadResult(absl::Cord(std::string(2000, 'y'))));
+  EXPECT_LT(CountFiles(root_), 10);
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, OpenWithDifferentMaxBytes) {
+  auto cache = OpenCache();
+  TENSORSTORE_EXPECT_OK(kvstore::Open(GetSpec(root_), context_).result());
+  auto spec = GetSpec(root_);
+  spec["max_bytes"] = 1000;
+  EXPECT_THAT(kvstore::Open(spec, context_).result(),
+              MatchesStatus(absl::StatusCode::kFailedPrecondition,
+                            ".*already open with max_bytes=1073741824"));
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, LockedByAnotherProcess) {
+  // A lock acquired through a separately opened file description conflicts
+  // with the cache's lock in the same way as a lock held by another process.
+  TENSORSTORE_ASSERT_OK(
+      tensorstore::internal_file_util::MakeDirectories(root_));
+  {
+    UniqueFileDescriptor fd =
+        tensorstore::internal_file_util::OpenFileForWriting(root_ + "/LOCK");
+    ASSERT_TRUE(fd.valid());
+    ASSERT_TRUE(FileLockTraits::TryAcquire(fd.get()));
+    EXPECT_THAT(kvstore::Open(GetSpec(root_), context_).result(),
+                MatchesStatus(absl::StatusCode::kFailedPrecondition,
+                              ".*is in use by another process.*"));
+    FileLockTraits::Close(fd.get());
+  }
+
+  auto cache = OpenCache();
+  UniqueFileDescriptor fd =
+      tensorstore::internal_file_util::OpenFileForWriting(root_ + "/LOCK");
+  ASSERT_TRUE(fd.valid());
+  EXPECT_FALSE(FileLockTraits::TryAcquire(fd.get()));
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, SpecRoundtrip) {
+  tensorstore::internal::TestKeyValueStoreSpecRoundtrip(
+      {{"driver", "disk_cache"},
+       {"base", {{"driver", "memory"}, {"path", "abc/"}}},
+       {"directory", root_},
+       {"max_bytes", 1048576}});
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, InvalidSpec) {
+  // Test with missing `"directory"` key.
+  EXPECT_THAT(
+      kvstore::Open({{"driver", "disk_cache"}, {"base", "memory://"}}, context_)
+          .result(),
+      MatchesStatus(absl::StatusCode::kInvalidArgument));
+
+  // Test with missing `"base"` key.
+  EXPECT_THAT(
+      kvstore::Open({{"driver", "disk_cache"}, {"directory", root_}}, context_)
+          .result(),
+      MatchesStatus(absl::StatusCode::kInvalidArgument));
+
+  // Test with invalid `"max_bytes"` key.
+  auto spec = GetSpec(root_);
+  spec["max_bytes"] = 0;
+  EXPECT_THAT(kvstore::Open(spec, context_).result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
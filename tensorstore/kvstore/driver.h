@@ -124,6 +124,8 @@ class Driver {
  public:
   using ReadResult = kvstore::ReadResult;
   using ReadOptions = kvstore::ReadOptions;
+  using ReadRangesResult = kvstore::ReadRangesResult;
+  using ReadRangesOptions = kvstore::ReadRangesOptions;
   using WriteOptions = kvstore::WriteOptions;
   using Key = kvstore::Key;
   using Value = kvstore::Value;
@@ -139,6 +141,21 @@ class Driver {
   ///     with an error.
   virtual Future<ReadResult> Read(Key key, ReadOptions options = {});
 
+  /// Attempts to read multiple byte ranges of the specified key.
+  ///
+  /// The default implementation coalesces the byte ranges according to
+  /// `options.coalesce_gap` and issues a separate `Read` for each group,
+  /// retrying if the groups are not all read from the same generation.
+  /// Drivers that can fetch multiple byte ranges with a single request should
+  /// override the default implementation.
+  ///
+  /// \param key The key to read.
+  /// \param options Specifies options for reading.
+  /// \returns A Future that resolves when the read completes successfully or
+  ///     with an error.
+  virtual Future<ReadRangesResult> ReadRanges(Key key,
+                                              ReadRangesOptions options);
+
   /// Performs an optionally-conditional write.
   ///
   /// Atomically updates or deletes the value stored for `key` subject to the
@@ -0,0 +1,88 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/file/file_io_util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "tensorstore/internal/os_error_code.h"
+#include "tensorstore/util/str_cat.h"
+
+// Include these last to reduce impact of macros.
+#include "tensorstore/kvstore/file/posix_file_util.h"
+#include "tensorstore/kvstore/file/windows_file_util.h"
+
+namespace tensorstore {
+namespace internal_file_util {
+
+absl::Status StatusFromErrno(std::string_view a, std::string_view b,
+                             std::string_view c, std::string_view d) {
+  return internal::StatusFromOsError(internal::GetLastErrorCode(), a, b, c, d);
+}
+
+absl::Status ReadFully(FileDescriptor fd, std::string_view path,
+                       std::uint64_t offset, char* buffer, std::size_t size) {
+  std::size_t pos = 0;
+  while (pos < size) {
+    std::ptrdiff_t n =
+        ReadFromFile(fd, buffer + pos, size - pos, offset + pos);
+    if (n > 0) {
+      pos += n;
+      continue;
+    }
+    if (n == 0) {
+      return absl::DataLossError(
+          tensorstore::StrCat("Unexpected end of file: ", path));
+    }
+    return StatusFromErrno("Error reading file: ", path);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status WriteFully(FileDescriptor fd, std::string_view path,
+                        absl::Cord value) {
+  while (!value.empty()) {
+    std::ptrdiff_t n = WriteCordToFile(fd, value);
+    if (n <= 0) {
+      return StatusFromErrno("Error writing to file: ", path);
+    }
+    value.RemovePrefix(n);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MakeDirectories(std::string path) {
+  for (std::size_t i = 1; i <= path.size(); ++i) {
+    if (i != path.size() && !IsDirSeparator(path[i])) continue;
+    // Skip empty components and drive letters.
+    if (IsDirSeparator(path[i - 1]) || path[i - 1] == ':') continue;
+    const char c = path[i];
+    path[i] = '\0';
+    const bool ok = MakeDirectory(path.c_str());
+    path[i] = c;
+    if (!ok) {
+      return StatusFromErrno("Failed to make directory: ",
+                             std::string_view(path).substr(0, i));
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace internal_file_util
+}  // namespace tensorstore
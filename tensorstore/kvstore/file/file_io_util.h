@@ -0,0 +1,64 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_FILE_FILE_IO_UTIL_H_
+#define TENSORSTORE_KVSTORE_FILE_FILE_IO_UTIL_H_
+
+/// \file
+///
+/// Status-returning wrappers of the filesystem operations provided by
+/// `posix_file_util.h` and `windows_file_util.h`, for use by drivers that
+/// manage their own files within a local directory.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+
+// Include these last to reduce impact of macros.
+#include "tensorstore/kvstore/file/posix_file_util.h"
+#include "tensorstore/kvstore/file/windows_file_util.h"
+
+namespace tensorstore {
+namespace internal_file_util {
+
+/// Returns an `absl::Status` for the last error code, with a message composed
+/// by concatenating the provided string parts.
+absl::Status StatusFromErrno(std::string_view a = {}, std::string_view b = {},
+                             std::string_view c = {}, std::string_view d = {});
+
+/// Reads exactly `size` bytes starting at `offset` of `fd` into `buffer`.
+///
+/// \param path Path of `fd`, used only for error messages.
+/// \error `absl::StatusCode::kDataLoss` if the end of the file is reached
+///     first.
+absl::Status ReadFully(FileDescriptor fd, std::string_view path,
+                       std::uint64_t offset, char* buffer, std::size_t size);
+
+/// Writes all of `value` at the current position of `fd`.
+///
+/// \param path Path of `fd`, used only for error messages.
+absl::Status WriteFully(FileDescriptor fd, std::string_view path,
+                        absl::Cord value);
+
+/// Creates the directory `path` and any of its ancestors that do not exist.
+absl::Status MakeDirectories(std::string path);
+
+}  // namespace internal_file_util
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_FILE_FILE_IO_UTIL_H_
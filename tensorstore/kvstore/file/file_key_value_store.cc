@@ -80,6 +80,11 @@
 /// 8. `fsync` the parent directory of the file (to ensure the `unlink` or
 ///    `rename` operations are durable).  This step is skipped on MS Windows,
 ///    where `fsync` is not supported for directories.
+///
+/// The `fsync` calls in steps 6b and 8 depend on the `durability` specified
+/// in the spec: with `"group_commit"`, a single sync is performed on behalf of
+/// all concurrent writes to the same directory, and with `"none"` they are
+/// skipped entirely.
 
 #include <stddef.h>
 #include <stdint.h>
@@ -87,6 +92,9 @@
 #include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
 #include <memory>
 #include <optional>
 #include <string>
@@ -95,10 +103,10 @@
 #include <utility>
 #include <vector>
 
-#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/strings/cord.h"
 #include "absl/strings/match.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include <nlohmann/json.hpp>
@@ -107,13 +115,18 @@
 #include "tensorstore/internal/context_binding.h"
 #include "tensorstore/internal/file_io_concurrency_resource.h"
 #include "tensorstore/internal/flat_cord_builder.h"
+#include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_binding/enum.h"
 #include "tensorstore/internal/json_binding/json_binding.h"
 #include "tensorstore/internal/metrics/counter.h"
+#include "tensorstore/internal/no_destructor.h"
 #include "tensorstore/internal/os_error_code.h"
 #include "tensorstore/internal/path.h"
 #include "tensorstore/internal/type_traits.h"
 #include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/file/group_commit.h"
+#include "tensorstore/kvstore/file/io_uring.h"
 #include "tensorstore/kvstore/file/unique_handle.h"
 #include "tensorstore/kvstore/file/util.h"
 #include "tensorstore/kvstore/generation.h"
@@ -336,13 +349,26 @@ Result<UniqueFileDescriptor> OpenValueFile(const char* path,
   return fd;
 }
 
+/// Minimum size of a value that is memory mapped by `ReadTask` when
+/// `memory_map` is specified.  Smaller values are copied, since mapping them is
+/// not cheaper and each mapping counts against the per-process limit.
+constexpr std::size_t kMinMemoryMapSize = 64 * 1024;
+
 /// Implements `FileKeyValueStore::Read`.
 struct ReadTask {
   std::string full_path;
   kvstore::ReadOptions options;
 
-  Result<ReadResult> operator()() const {
-    ReadResult read_result;
+  /// Specifies whether values of at least `kMinMemoryMapSize` bytes are
+  /// memory mapped rather than copied.
+  bool memory_map = false;
+
+  /// Opens the file and checks the conditions specified by `options`.
+  ///
+  /// If the value is to be read, sets `read_result.state` to `kValue` and
+  /// `byte_range` to the range to read, and returns the open file.
+  Result<UniqueFileDescriptor> Open(ReadResult& read_result,
+                                    ByteRange& byte_range) const {
     read_result.stamp.time = absl::Now();
     std::int64_t size;
     TENSORSTORE_ASSIGN_OR_RETURN(
@@ -350,21 +376,25 @@ struct ReadTask {
         OpenValueFile(full_path.c_str(), &read_result.stamp.generation, &size));
     if (!fd.valid()) {
       read_result.state = ReadResult::kMissing;
-      return read_result;
+      return fd;
     }
     if (read_result.stamp.generation == options.if_not_equal ||
         (!StorageGeneration::IsUnknown(options.if_equal) &&
          read_result.stamp.generation != options.if_equal)) {
-      return read_result;
+      return fd;
     }
-    TENSORSTORE_ASSIGN_OR_RETURN(auto byte_range,
-                                 options.byte_range.Validate(size));
+    TENSORSTORE_ASSIGN_OR_RETURN(byte_range, options.byte_range.Validate(size));
     read_result.state = ReadResult::kValue;
-    internal::FlatCordBuilder buffer(byte_range.size());
-    std::size_t offset = 0;
+    return fd;
+  }
+
+  /// Reads the remainder of `buffer`, starting at `offset`.
+  absl::Status ReadValue(FileDescriptor fd, const ByteRange& byte_range,
+                         internal::FlatCordBuilder& buffer,
+                         std::size_t offset = 0) const {
     while (offset < buffer.size()) {
       std::ptrdiff_t n = internal_file_util::ReadFromFile(
-          fd.get(), buffer.data() + offset, buffer.size() - offset,
+          fd, buffer.data() + offset, buffer.size() - offset,
           byte_range.inclusive_min + offset);
       if (n > 0) {
         file_bytes_read.IncrementBy(n);
@@ -377,11 +407,86 @@ struct ReadTask {
       }
       return StatusFromErrno("Error reading file: ", full_path);
     }
-    read_result.value = std::move(buffer).Build();
+    return absl::OkStatus();
+  }
+
+  /// Reads `byte_range` of the open file into `value`, memory mapping it if
+  /// enabled.
+  absl::Status ReadRange(FileDescriptor fd, const ByteRange& byte_range,
+                         absl::Cord& value) const {
+#ifndef _WIN32
+    if (memory_map && byte_range.size() >= kMinMemoryMapSize &&
+        internal_file_util::MapFileRegion(fd, byte_range.inclusive_min,
+                                          byte_range.size(), &value)) {
+      file_bytes_read.IncrementBy(byte_range.size());
+      return absl::OkStatus();
+    }
+    // Fall back to copying if the file cannot be mapped (e.g. if the
+    // filesystem does not support `mmap`, or the process mapping limit has
+    // been reached).
+#endif
+    internal::FlatCordBuilder buffer(byte_range.size());
+    TENSORSTORE_RETURN_IF_ERROR(ReadValue(fd, byte_range, buffer));
+    value = std::move(buffer).Build();
+    return absl::OkStatus();
+  }
+
+  Result<ReadResult> operator()() const {
+    ReadResult read_result;
+    ByteRange byte_range;
+    TENSORSTORE_ASSIGN_OR_RETURN(auto fd, Open(read_result, byte_range));
+    if (read_result.state != ReadResult::kValue) return read_result;
+    TENSORSTORE_RETURN_IF_ERROR(
+        ReadRange(fd.get(), byte_range, read_result.value));
     return read_result;
   }
 };
 
+/// Reads multiple byte ranges of a single file.
+///
+/// The file is opened and its generation checked once, and then each group of
+/// coalesced byte ranges is read with a single positioned read.
+struct ReadRangesTask {
+  std::string full_path;
+  kvstore::ReadRangesOptions options;
+  bool memory_map = false;
+
+  Result<kvstore::ReadRangesResult> operator()() const {
+    ReadTask read_task{full_path, {}, memory_map};
+    read_task.options.if_not_equal = options.if_not_equal;
+    read_task.options.if_equal = options.if_equal;
+    ReadResult read_result;
+    ByteRange file_range;
+    TENSORSTORE_ASSIGN_OR_RETURN(auto fd,
+                                 read_task.Open(read_result, file_range));
+    kvstore::ReadRangesResult result;
+    result.state = read_result.state;
+    result.stamp = std::move(read_result.stamp);
+    if (!result.has_value()) return result;
+    const std::uint64_t size = file_range.size();
+    for (const auto& byte_range : options.byte_ranges) {
+      TENSORSTORE_RETURN_IF_ERROR(byte_range.Validate(size));
+    }
+    result.values.resize(options.byte_ranges.size());
+    for (const auto& group : internal::CoalesceByteRanges(
+             options.byte_ranges, options.coalesce_gap)) {
+      TENSORSTORE_ASSIGN_OR_RETURN(auto group_range,
+                                   group.byte_range.Validate(size));
+      absl::Cord value;
+      TENSORSTORE_RETURN_IF_ERROR(
+          read_task.ReadRange(fd.get(), group_range, value));
+      // Each request is a zero-copy subrange of the group value.
+      for (std::size_t i : group.request_indices) {
+        TENSORSTORE_ASSIGN_OR_RETURN(
+            result.values[i],
+            internal::GetSubCordForRequest(value, group.byte_range,
+                                           options.byte_ranges[i]));
+      }
+    }
+    return result;
+  }
+};
+
 /// Helper class to acquire write lock for the specified path.
 struct WriteLockHelper {
   std::string lock_path;  // Composed write lock file path.
@@ -443,85 +548,220 @@ struct WriteLockHelper {
   }
 };
 
+/// Specifies how writes and deletes are made durable.
+enum class FileDurability {
+  /// Each write calls `fsync` on the value and on its parent directory before
+  /// completing.
+  kPerWrite,
+  /// As for `kPerWrite`, but the syncs of concurrent writes to the same
+  /// directory are coalesced.
+  kGroupCommit,
+  /// Writes are not synced, and may be lost if the system crashes.
+  kNone,
+};
+
+/// Coalesces the syncs of concurrent writes for
+/// `FileDurability::kGroupCommit`.  Keys are parent directory paths.
+struct GroupCommitQueues {
+  /// Syncs values before they are renamed.
+  internal_file_util::GroupCommit value;
+  /// Syncs parent directories after values are renamed or deleted.
+  internal_file_util::GroupCommit directory;
+};
+
+GroupCommitQueues& GetGroupCommitQueues() {
+  static internal::NoDestructor<GroupCommitQueues> queues;
+  return *queues;
+}
+
+/// Returns the parent directory of `full_path`, used as the group commit key.
+std::string_view GetParentPath(std::string_view full_path) {
+  size_t pos = full_path.size();
+  while (pos != 0 && !internal_file_util::IsDirSeparator(full_path[pos - 1])) {
+    --pos;
+  }
+  return full_path.substr(0, pos);
+}
+
+/// Syncs the parent directory `dir_fd` of `full_path` after a file was
+/// renamed or deleted, to ensure the change is durable.
+absl::Status SyncParentDirectory(FileDurability durability,
+                                 FileDescriptor dir_fd,
+                                 const std::string& full_path) {
+  const auto sync = [&]() -> absl::Status {
+    if (!internal_file_util::FsyncDirectory(dir_fd)) {
+      return StatusFromErrno("Error calling fsync on parent directory of: ",
+                             full_path);
+    }
+    return absl::OkStatus();
+  };
+  switch (durability) {
+    case FileDurability::kPerWrite:
+      return sync();
+    case FileDurability::kGroupCommit:
+      return GetGroupCommitQueues().directory.Sync(GetParentPath(full_path),
+                                                   sync);
+    case FileDurability::kNone:
+      break;
+  }
+  return absl::OkStatus();
+}
+
 /// Implements `FileKeyValueStore::Write`.
+///
+/// The write is performed in stages, such that the value may instead be
+/// written asynchronously by `IoUringWriteTask`:
+///
+/// 1. `Lock` acquires the lock file.
+///
+/// 2. `Prepare` checks the condition and truncates the lock file.
+///
+/// 3. `WriteValue` writes the value to the lock file and syncs it.
+///
+/// 4. `Commit` renames the lock file to the actual data path.
+///
+/// 5. `Finish` deletes the lock file if it was not renamed.
 struct WriteTask {
   std::string full_path;
   absl::Cord value;
   kvstore::WriteOptions options;
-
-  Result<TimestampedStorageGeneration> operator()() const {
-    TimestampedStorageGeneration r;
-    r.time = absl::Now();
-
-    WriteLockHelper lock_helper(full_path);
-    TENSORSTORE_ASSIGN_OR_RETURN(auto dir_fd, OpenParentDirectory(full_path));
-    TENSORSTORE_RETURN_IF_ERROR(lock_helper.CreateAndAcquire());
+  FileDurability durability = FileDurability::kPerWrite;
+
+  /// State held from `Lock` until `Finish`.
+  struct LockState {
+    explicit LockState(const std::string& full_path) : lock_helper(full_path) {}
+    absl::Time time;
+    UniqueFileDescriptor dir_fd;
+    WriteLockHelper lock_helper;
     bool delete_lock_file = true;
+  };
 
-    auto generation_result = [&]() -> Result<StorageGeneration> {
-      FileDescriptor fd = lock_helper.lock_fd.get();
-      const std::string& lock_path = lock_helper.lock_path;
-      // Check condition.
-      if (!StorageGeneration::IsUnknown(options.if_equal)) {
-        StorageGeneration generation;
-        TENSORSTORE_ASSIGN_OR_RETURN(
-            UniqueFileDescriptor value_fd,
-            OpenValueFile(full_path.c_str(), &generation));
-        if (generation != options.if_equal) {
-          return StorageGeneration::Unknown();
-        }
-      }
-      if (internal_file_util::GetSize(lock_helper.info) > value.size()) {
-        // Only truncate when the file is larger. In the common path, the lock
-        // file is newly created, so truncate is useless.
-        if (!internal_file_util::TruncateFile(fd)) {
-          return StatusFromErrno("Failed to truncate file: ", lock_path);
-        }
-      }
-      absl::Cord value_for_write = value;
-      for (; !value_for_write.empty();) {
-        std::ptrdiff_t n =
-            internal_file_util::WriteCordToFile(fd, value_for_write);
-        if (n <= 0) {
-          return StatusFromErrno("Error writing to file: ", lock_path);
-        }
-        file_bytes_written.IncrementBy(n);
-        if (n == value_for_write.size()) break;
-        value_for_write.RemovePrefix(n);
-      }
+  absl::Status Lock(LockState& state) const {
+    state.time = absl::Now();
+    TENSORSTORE_ASSIGN_OR_RETURN(state.dir_fd, OpenParentDirectory(full_path));
+    return state.lock_helper.CreateAndAcquire();
+  }
 
-      if (!internal_file_util::FsyncFile(fd)) {
-        return StatusFromErrno("Error calling fsync on file: ", lock_path);
+  /// Returns `false` if the condition is not satisfied.
+  Result<bool> Prepare(LockState& state) const {
+    // Check condition.
+    if (!StorageGeneration::IsUnknown(options.if_equal)) {
+      StorageGeneration generation;
+      TENSORSTORE_ASSIGN_OR_RETURN(
+          UniqueFileDescriptor value_fd,
+          OpenValueFile(full_path.c_str(), &generation));
+      if (generation != options.if_equal) {
+        return false;
       }
-      if (!internal_file_util::RenameOpenFile(fd, lock_path, full_path)) {
-        return StatusFromErrno("Error renaming: ", lock_path, " -> ",
-                               full_path);
+    }
+    if (internal_file_util::GetSize(state.lock_helper.info) > value.size()) {
+      // Only truncate when the file is larger. In the common path, the lock
+      // file is newly created, so truncate is useless.
+      if (!internal_file_util::TruncateFile(state.lock_helper.lock_fd.get())) {
+        return StatusFromErrno("Failed to truncate file: ",
+                               state.lock_helper.lock_path);
       }
-      delete_lock_file = false;
-      // fsync the parent directory to ensure the `rename` is durable.
-      if (!internal_file_util::FsyncDirectory(dir_fd.get())) {
-        return StatusFromErrno("Error calling fsync on parent directory of: ",
-                               full_path);
+    }
+    return true;
+  }
+
+  absl::Status WriteValue(LockState& state) const {
+    FileDescriptor fd = state.lock_helper.lock_fd.get();
+    const std::string& lock_path = state.lock_helper.lock_path;
+    absl::Cord value_for_write = value;
+    for (; !value_for_write.empty();) {
+      std::ptrdiff_t n =
+          internal_file_util::WriteCordToFile(fd, value_for_write);
+      if (n <= 0) {
+        return StatusFromErrno("Error writing to file: ", lock_path);
       }
-      lock_helper.lock = FileLock{};
+      file_bytes_written.IncrementBy(n);
+      if (n == value_for_write.size()) break;
+      value_for_write.RemovePrefix(n);
+    }
+    return SyncValue(state);
+  }
 
-      // Retrieve `FileInfo` after the fsync and rename to ensure the
-      // modification time doesn't change afterwards.
-      FileInfo info;
-      if (!GetFileInfo(fd, &info) != 0) {
-        return StatusFromErrno("Error getting file info: ", lock_path);
+  /// Syncs the value written to the lock file, such that it is durable before
+  /// the lock file is renamed.
+  absl::Status SyncValue(LockState& state) const {
+    const auto sync_file = [&]() -> absl::Status {
+      if (!internal_file_util::FsyncFile(state.lock_helper.lock_fd.get())) {
+        return StatusFromErrno("Error calling fsync on file: ",
+                               state.lock_helper.lock_path);
       }
-      return GetFileGeneration(info);
-    }();
+      return absl::OkStatus();
+    };
+    switch (durability) {
+      case FileDurability::kPerWrite:
+        return sync_file();
+      case FileDurability::kGroupCommit:
+#ifdef __linux__
+        // A single `syncfs` call makes all values written concurrently to the
+        // filesystem durable.
+        return GetGroupCommitQueues().value.Sync(
+            GetParentPath(full_path), [&]() -> absl::Status {
+              if (!internal_file_util::FsyncFilesystem(state.dir_fd.get())) {
+                return StatusFromErrno(
+                    "Error calling syncfs on parent directory of: ",
+                    full_path);
+              }
+              return absl::OkStatus();
+            });
+#else
+        // Other platforms provide no way to sync multiple files at once, so
+        // only the directory syncs are coalesced.
+        return sync_file();
+#endif
+      case FileDurability::kNone:
+        break;
+    }
+    return absl::OkStatus();
+  }
 
-    if (delete_lock_file) {
-      TENSORSTORE_RETURN_IF_ERROR(lock_helper.Delete());
+  Result<StorageGeneration> Commit(LockState& state) const {
+    FileDescriptor fd = state.lock_helper.lock_fd.get();
+    const std::string& lock_path = state.lock_helper.lock_path;
+    if (!internal_file_util::RenameOpenFile(fd, lock_path, full_path)) {
+      return StatusFromErrno("Error renaming: ", lock_path, " -> ", full_path);
+    }
+    state.delete_lock_file = false;
+    // fsync the parent directory to ensure the `rename` is durable.
+    TENSORSTORE_RETURN_IF_ERROR(
+        SyncParentDirectory(durability, state.dir_fd.get(), full_path));
+    state.lock_helper.lock = FileLock{};
+
+    // Retrieve `FileInfo` after the fsync and rename to ensure the
+    // modification time doesn't change afterwards.
+    FileInfo info;
+    if (!GetFileInfo(fd, &info) != 0) {
+      return StatusFromErrno("Error getting file info: ", lock_path);
+    }
+    return GetFileGeneration(info);
+  }
+
+  Result<TimestampedStorageGeneration> Finish(
+      LockState& state, Result<StorageGeneration> generation_result) const {
+    if (state.delete_lock_file) {
+      TENSORSTORE_RETURN_IF_ERROR(state.lock_helper.Delete());
     }
     if (!generation_result) {
       return std::move(generation_result).status();
     }
-    r.generation = std::move(*generation_result);
-    return r;
+    return TimestampedStorageGeneration{std::move(*generation_result),
+                                        state.time};
+  }
+
+  Result<TimestampedStorageGeneration> operator()() const {
+    LockState state(full_path);
+    TENSORSTORE_RETURN_IF_ERROR(Lock(state));
+    auto generation_result = [&]() -> Result<StorageGeneration> {
+      TENSORSTORE_ASSIGN_OR_RETURN(bool condition_satisfied, Prepare(state));
+      if (!condition_satisfied) return StorageGeneration::Unknown();
+      TENSORSTORE_RETURN_IF_ERROR(WriteValue(state));
+      return Commit(state);
+    }();
+    return Finish(state, std::move(generation_result));
   }
 };
 
@@ -529,6 +769,7 @@ struct WriteTask {
 struct DeleteTask {
   std::string full_path;
   kvstore::WriteOptions options;
+  FileDurability durability = FileDurability::kPerWrite;
 
   Result<TimestampedStorageGeneration> operator()() const {
     TimestampedStorageGeneration r;
@@ -563,9 +804,9 @@ struct DeleteTask {
     TENSORSTORE_RETURN_IF_ERROR(lock_helper.Delete());
 
     // fsync the parent directory to ensure the `rename` is durable.
-    if (fsync_directory && !internal_file_util::FsyncDirectory(dir_fd.get())) {
-      return StatusFromErrno("Error calling fsync on parent directory of: ",
-                             full_path);
+    if (fsync_directory) {
+      TENSORSTORE_RETURN_IF_ERROR(
+          SyncParentDirectory(durability, dir_fd.get(), full_path));
     }
     if (!generation_result) {
       return std::move(generation_result).status();
@@ -575,197 +816,557 @@ struct DeleteTask {
   }
 };
 
-struct PathRangeVisitor {
-  KeyRange range;
-  std::string prefix;
+#ifdef __linux__
+/// Implements `FileKeyValueStore::Read` using io_uring.
+///
+/// The file is opened, and its generation checked, on a `file_io_concurrency`
+/// thread, and then the value is read asynchronously, and the read completed
+/// on a `file_io_concurrency` thread.
+struct IoUringReadTask {
+  internal_file_util::IoUring* io_uring;
+  Executor executor;
+  ReadTask task;
+
+  /// State held while the read is in progress.
+  struct State {
+    ReadTask task;
+    Executor executor;
+    Promise<ReadResult> promise;
+    UniqueFileDescriptor fd;
+    ByteRange byte_range;
+    ReadResult read_result;
+    internal::FlatCordBuilder buffer;
+
+    /// Completes the read after `n` bytes have been read into `buffer`.
+    void Complete(std::int64_t n) {
+      if (n < 0) {
+        promise.SetResult(StatusFromOsError(static_cast<OsErrorCode>(-n),
+                                            "Error reading file: ",
+                                            task.full_path));
+        return;
+      }
+      file_bytes_read.IncrementBy(n);
+      if (static_cast<std::size_t>(n) != buffer.size()) {
+        // Read the remainder synchronously.  This is only expected for values
+        // larger than the maximum size of a single read (2GiB on Linux), or if
+        // the file was truncated concurrently.
+        auto status = task.ReadValue(fd.get(), byte_range, buffer, n);
+        if (!status.ok()) {
+          promise.SetResult(std::move(status));
+          return;
+        }
+      }
+      read_result.value = std::move(buffer).Build();
+      promise.SetResult(std::move(read_result));
+    }
+  };
 
-  PathRangeVisitor(KeyRange range)
-      : range(std::move(range)), prefix(LongestDirectoryPrefix(this->range)) {}
+  void operator()(Promise<ReadResult> promise) {
+    auto state = std::make_unique<State>();
+    state->task = std::move(task);
+    state->executor = std::move(executor);
+    auto fd = state->task.Open(state->read_result, state->byte_range);
+    if (!fd.ok()) {
+      promise.SetResult(std::move(fd).status());
+      return;
+    }
+    if (state->read_result.state != ReadResult::kValue ||
+        state->byte_range.size() == 0) {
+      promise.SetResult(std::move(state->read_result));
+      return;
+    }
+    state->promise = std::move(promise);
+    state->fd = std::move(*fd);
+    state->buffer = internal::FlatCordBuilder(state->byte_range.size());
+    const FileDescriptor raw_fd = state->fd.get();
+    char* const data = state->buffer.data();
+    const std::size_t size = state->buffer.size();
+    const std::int64_t offset = state->byte_range.inclusive_min;
+    Executor completion_executor = state->executor;
+    io_uring->Read(raw_fd, data, size, offset, std::move(completion_executor),
+                   [state = std::move(state)](std::int64_t n) mutable {
+                     state->Complete(n);
+                   });
+  }
+};
 
-  struct PendingDir {
-    std::unique_ptr<internal_file_util::DirectoryIterator> iterator;
+/// Implements `FileKeyValueStore::Write` using io_uring.
+///
+/// The lock is acquired on a `file_io_concurrency` thread, and then the value
+/// is written, and `fsync` called, asynchronously.  The remaining steps, which
+/// may block, are then performed on a `file_io_concurrency` thread, on which
+/// the io_uring completion callback is invoked.
+struct IoUringWriteTask {
+  internal_file_util::IoUring* io_uring;
+  Executor executor;
+  WriteTask task;
+
+  /// State held while the write is in progress.
+  struct State {
+    explicit State(WriteTask task, Executor executor,
+                   Promise<TimestampedStorageGeneration> promise)
+        : task(std::move(task)),
+          executor(std::move(executor)),
+          promise(std::move(promise)),
+          lock_state(this->task.full_path) {}
+
+    WriteTask task;
+    Executor executor;
+    Promise<TimestampedStorageGeneration> promise;
+    WriteTask::LockState lock_state;
+
+    void Complete(std::int64_t n) {
+      auto generation_result = [&]() -> Result<StorageGeneration> {
+        if (n < 0) {
+          return StatusFromOsError(static_cast<OsErrorCode>(-n),
+                                   "Error writing to file: ",
+                                   lock_state.lock_helper.lock_path);
+        }
+        file_bytes_written.IncrementBy(n);
+        if (static_cast<std::size_t>(n) != task.value.size()) {
+          // Short write: write the value again synchronously.
+          TENSORSTORE_RETURN_IF_ERROR(task.WriteValue(lock_state));
+        }
+        return task.Commit(lock_state);
+      }();
+      promise.SetResult(task.Finish(lock_state, std::move(generation_result)));
+    }
+  };
+
+  void operator()(Promise<TimestampedStorageGeneration> promise) {
+    auto state = std::make_unique<State>(std::move(task), std::move(executor),
+                                         std::move(promise));
+    if (auto status = state->task.Lock(state->lock_state); !status.ok()) {
+      state->promise.SetResult(std::move(status));
+      return;
+    }
+    auto condition_satisfied = state->task.Prepare(state->lock_state);
+    if (!condition_satisfied.ok() || !*condition_satisfied) {
+      Result<StorageGeneration> generation_result =
+          StorageGeneration::Unknown();
+      if (!condition_satisfied.ok()) {
+        generation_result = std::move(condition_satisfied).status();
+      }
+      state->promise.SetResult(
+          state->task.Finish(state->lock_state, std::move(generation_result)));
+      return;
+    }
+    const FileDescriptor fd = state->lock_state.lock_helper.lock_fd.get();
+    absl::Cord value = state->task.value;
+    Executor completion_executor = state->executor;
+    io_uring->WriteAndSync(fd, std::move(value), /*offset=*/0,
+                           std::move(completion_executor),
+                           [state = std::move(state)](std::int64_t n) mutable {
+                             state->Complete(n);
+                           });
+  }
+};
+#endif  // __linux__
+
+/// Maximum number of tasks used by a single `PathRangeVisitor`.  The number of
+/// tasks that run concurrently is further limited by `file_io_concurrency`;
+/// this limit avoids flooding the shared executor queue such that other
+/// operations are delayed.
+constexpr std::size_t kMaxPathRangeVisitorConcurrency = 16;
+
+/// Visits the files and directories contained in a `KeyRange`.
+///
+/// Each directory is scanned by a single task, but separate directories (and,
+/// if `file_batch_size` is non-zero, separate batches of files) are processed
+/// concurrently by up to `kMaxPathRangeVisitorConcurrency` tasks on
+/// `executor`.  Each directory is handled only after all of its contents have
+/// been handled.
+///
+/// The traversal stops at the first error, or if `IsCancelled` returns `true`.
+class PathRangeVisitor
+    : public internal::AtomicReferenceCount<PathRangeVisitor> {
+ public:
+  /// \param file_batch_size If non-zero, files are handled in batches of up to
+  ///     the specified size that may be processed concurrently with the
+  ///     remainder of the directory.  Otherwise, files are handled by the task
+  ///     that scans the directory.
+  PathRangeVisitor(KeyRange range, Executor executor,
+                   std::size_t file_batch_size)
+      : range_(std::move(range)),
+        executor_(std::move(executor)),
+        file_batch_size_(file_batch_size) {}
+
+  virtual ~PathRangeVisitor() = default;
+
+  /// Starts the traversal.  `Done` is called once it completes.
+  void Start() {
+    std::string prefix(LongestDirectoryPrefix(range_));
+    const bool fully_contained =
+        tensorstore::ContainsPrefix(range_, GetDirPath(prefix));
+    {
+      absl::MutexLock lock(&mutex_);
+      Directory* root = NewDirectory(std::move(prefix), fully_contained,
+                                     /*parent=*/nullptr);
+      queue_.push_back({root, {}});
+      active_tasks_ = 1;
+    }
+    executor_([self = internal::IntrusivePtr<PathRangeVisitor>(this)] {
+      self->Run();
+    });
+  }
+
+ protected:
+  virtual bool IsCancelled() = 0;
+
+  /// Handles a file contained in the range.
+  virtual absl::Status HandleFile(std::string path) = 0;
+
+  /// Handles a directory that intersects the range after all of its contents
+  /// have been handled.
+  virtual absl::Status HandleDirectory(const std::string& path,
+                                       bool fully_contained) = 0;
+
+  /// Called exactly once when the traversal completes.
+  virtual void Done(absl::Status status) = 0;
+
+ private:
+  struct Directory {
+    std::string path;
     /// Indicates whether this directory is fully (rather than partially)
-    /// contained in `range`.  If `true`, we can save the cost of checking
-    /// whether every (recursive) child entry is contained in `range`.
+    /// contained in `range_`.  If `true`, we can save the cost of checking
+    /// whether every (recursive) child entry is contained in `range_`.
     bool fully_contained;
+    /// Indicates whether the directory was found.
+    bool exists = true;
+    Directory* parent;
+    /// Number of work items and child directories that must complete before
+    /// this directory is handled.
+    std::size_t remaining = 1;
+    std::list<Directory>::iterator list_it;
+  };
+
+  /// Scans `directory` if `files` is empty, or otherwise handles `files`.
+  struct WorkItem {
+    Directory* directory;
+    std::vector<std::string> files;
   };
 
-  std::vector<PendingDir> pending_dirs;
+  static std::string JoinPath(std::string_view dir_path,
+                              std::string_view name) {
+    const char* slash =
+        (!dir_path.empty() && dir_path.back() != '/') ? "/" : "";
+    return StrCat(dir_path, slash, name);
+  }
 
-  absl::Status Visit(
-      absl::FunctionRef<bool()> is_cancelled,
-      absl::FunctionRef<absl::Status()> handle_file_at,
-      absl::FunctionRef<absl::Status(bool fully_contained)> handle_dir_at) {
-    auto status = VisitImpl(is_cancelled, handle_file_at, handle_dir_at);
-    if (!status.ok()) {
-      return MaybeAnnotateStatus(status,
-                                 StrCat("While processing: ", GetFullPath()));
+  static std::string GetDirPath(std::string path) {
+    if (!path.empty() && path.back() != '/') {
+      path += '/';
     }
-    return absl::OkStatus();
+    return path;
   }
 
-  absl::Status VisitImpl(
-      absl::FunctionRef<bool()> is_cancelled,
-      absl::FunctionRef<absl::Status()> handle_file_at,
-      absl::FunctionRef<absl::Status(bool fully_contained)> handle_dir_at) {
-    // First, try and open the prefix as a directory.
-    TENSORSTORE_RETURN_IF_ERROR(EnqueueDirectory());
+  Directory* NewDirectory(std::string path, bool fully_contained,
+                          Directory* parent)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    auto it = directories_.insert(directories_.end(), Directory{});
+    it->path = std::move(path);
+    it->fully_contained = fully_contained;
+    it->parent = parent;
+    it->list_it = it;
+    return &*it;
+  }
 
-    // As long there are pending directories, look at the top of the stack.
-    for (; !pending_dirs.empty();) {
-      if (is_cancelled()) {
-        return absl::CancelledError("");
+  /// Adds a work item to the queue, and starts a new task if permitted.
+  void Enqueue(WorkItem item) {
+    bool start_task = false;
+    {
+      absl::MutexLock lock(&mutex_);
+      // The scan of a new directory is accounted for by its initial
+      // `remaining` count, while the directory itself must complete before its
+      // parent.
+      ++(item.files.empty() ? item.directory->parent : item.directory)
+            ->remaining;
+      queue_.push_back(std::move(item));
+      if (active_tasks_ < kMaxPathRangeVisitorConcurrency) {
+        ++active_tasks_;
+        start_task = true;
       }
-      bool fully_contained = pending_dirs.back().fully_contained;
-      if (auto& iterator = *pending_dirs.back().iterator; iterator.Next()) {
-        const std::string_view name_view = iterator.path_component();
-        if (name_view != "." && name_view != "..") {
-          if (iterator.is_directory()) {
-            if (fully_contained ||
-                tensorstore::IntersectsPrefix(range, GetFullDirPath())) {
-              TENSORSTORE_RETURN_IF_ERROR(EnqueueDirectory());
-            }
-          } else {
-            // Treat the entry as a file; while this may not be strictly the
-            // case, it is a reasonable default.
-            if (fully_contained ||
-                tensorstore::Contains(range, GetFullPath())) {
-              TENSORSTORE_RETURN_IF_ERROR(handle_file_at());
-            }
-          }
+    }
+    if (start_task) {
+      executor_([self = internal::IntrusivePtr<PathRangeVisitor>(this)] {
+        self->Run();
+      });
+    }
+  }
+
+  /// Processes work items until the queue is empty or an error occurs.
+  void Run() {
+    while (true) {
+      WorkItem item;
+      {
+        absl::MutexLock lock(&mutex_);
+        if (!status_.ok() || queue_.empty()) {
+          if (--active_tasks_ != 0) return;
+          // Since tasks only enqueue work items while they are active, the
+          // traversal is complete.
+          break;
         }
-        continue;
+        item = std::move(queue_.front());
+        queue_.pop_front();
       }
-
-      // No more entries were encountered in the directory, so finish handling
-      // the current directory.
-      pending_dirs.pop_back();
-      TENSORSTORE_RETURN_IF_ERROR(handle_dir_at(fully_contained));
+      absl::Status status;
+      if (IsCancelled()) {
+        status = absl::CancelledError("");
+      } else if (item.files.empty()) {
+        status = ScanDirectory(*item.directory);
+      } else {
+        for (auto& path : item.files) {
+          status = HandleFile(std::move(path));
+          if (!status.ok()) break;
+        }
+      }
+      if (!status.ok()) {
+        SetError(MaybeAnnotateStatus(
+            status, StrCat("While processing: ", item.directory->path)));
+      }
+      CompleteDirectory(item.directory);
     }
-
-    return absl::OkStatus();
+    absl::Status status;
+    {
+      absl::MutexLock lock(&mutex_);
+      status = status_;
+    }
+    Done(std::move(status));
   }
 
-  internal_file_util::DirectoryIterator::Entry GetCurrentEntry() {
-    if (pending_dirs.empty()) {
-      return internal_file_util::DirectoryIterator::Entry::FromPath(prefix);
-    } else {
-      return pending_dirs.back().iterator->GetEntry();
-    }
+  void SetError(absl::Status status) {
+    absl::MutexLock lock(&mutex_);
+    if (status_.ok()) status_ = std::move(status);
   }
 
-  absl::Status EnqueueDirectory() {
+  absl::Status ScanDirectory(Directory& directory) {
     std::unique_ptr<internal_file_util::DirectoryIterator> iterator;
-    if (!internal_file_util::DirectoryIterator::Make(GetCurrentEntry(),
-                                                     &iterator)) {
+    if (!internal_file_util::DirectoryIterator::Make(
+            internal_file_util::DirectoryIterator::Entry::FromPath(
+                directory.path),
+            &iterator)) {
       return StatusFromErrno("Failed to open directory");
     }
-    if (iterator) {
-      bool fully_contained =
-          (!pending_dirs.empty() && pending_dirs.back().fully_contained) ||
-          tensorstore::ContainsPrefix(range, GetFullDirPath());
-      pending_dirs.push_back({std::move(iterator), fully_contained});
+    if (!iterator) {
+      // The directory does not exist.
+      directory.exists = false;
+      return absl::OkStatus();
+    }
+    std::vector<std::string> files;
+    while (iterator->Next()) {
+      if (IsCancelled()) {
+        return absl::CancelledError("");
+      }
+      const std::string_view name_view = iterator->path_component();
+      if (name_view == "." || name_view == "..") continue;
+      std::string path = JoinPath(directory.path, name_view);
+      if (iterator->is_directory()) {
+        const std::string dir_path = GetDirPath(path);
+        if (directory.fully_contained ||
+            tensorstore::IntersectsPrefix(range_, dir_path)) {
+          const bool fully_contained =
+              directory.fully_contained ||
+              tensorstore::ContainsPrefix(range_, dir_path);
+          Directory* child;
+          {
+            absl::MutexLock lock(&mutex_);
+            child = NewDirectory(std::move(path), fully_contained, &directory);
+          }
+          Enqueue({child, {}});
+        }
+        continue;
+      }
+      // Treat the entry as a file; while this may not be strictly the case,
+      // it is a reasonable default.
+      if (!directory.fully_contained && !tensorstore::Contains(range_, path)) {
+        continue;
+      }
+      if (file_batch_size_ == 0) {
+        TENSORSTORE_RETURN_IF_ERROR(HandleFile(std::move(path)));
+        continue;
+      }
+      files.push_back(std::move(path));
+      if (files.size() == file_batch_size_) {
+        Enqueue({&directory, std::move(files)});
+        files.clear();
+      }
+    }
+    // Handle the last partial batch directly.
+    for (auto& path : files) {
+      TENSORSTORE_RETURN_IF_ERROR(HandleFile(std::move(path)));
     }
     return absl::OkStatus();
   }
 
-  std::string GetFullPath() {
-    std::string path = prefix;
-    for (const auto& entry : pending_dirs) {
-      const char* slash =
-          (!path.empty() && path[path.size() - 1] != '/') ? "/" : "";
-      StrAppend(&path, slash, entry.iterator->path_component());
+  /// Marks a work item or child of `directory` as complete, and handles the
+  /// directory if it was the last one.
+  void CompleteDirectory(Directory* directory) {
+    while (directory) {
+      bool handle;
+      {
+        absl::MutexLock lock(&mutex_);
+        if (--directory->remaining != 0) return;
+        handle = status_.ok() && directory->exists;
+      }
+      if (handle) {
+        auto status =
+            HandleDirectory(directory->path, directory->fully_contained);
+        if (!status.ok()) {
+          SetError(MaybeAnnotateStatus(
+              status, StrCat("While processing: ", directory->path)));
+        }
+      }
+      Directory* parent = directory->parent;
+      absl::MutexLock lock(&mutex_);
+      directories_.erase(directory->list_it);
+      directory = parent;
     }
-    return path;
   }
 
-  std::string GetFullDirPath() {
-    std::string path = GetFullPath();
-    if (!path.empty() && path.back() != '/') {
-      path += '/';
-    }
-    return path;
-  }
+  KeyRange range_;
+  Executor executor_;
+  std::size_t file_batch_size_;
+
+  absl::Mutex mutex_;
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+  std::deque<WorkItem> queue_ ABSL_GUARDED_BY(mutex_);
+  std::size_t active_tasks_ ABSL_GUARDED_BY(mutex_) = 0;
+  /// Directories that have not yet been handled.  If the traversal stops
+  /// early, the remaining directories are freed when the visitor is
+  /// destroyed.
+  std::list<Directory> directories_ ABSL_GUARDED_BY(mutex_);
 };
 
-struct DeleteRangeTask {
-  KeyRange range;
+/// Implements `FileKeyValueStore::DeleteRange`.
+///
+/// Files are deleted in batches, such that large directories are deleted in
+/// parallel.
+class DeleteRangeVisitor : public PathRangeVisitor {
+ public:
+  /// Number of files deleted by each work item.
+  static constexpr std::size_t kFileBatchSize = 256;
 
-  void operator()(Promise<void> promise) {
-    PathRangeVisitor visitor(range);
-    auto is_cancelled = [&promise] { return !promise.result_needed(); };
-    auto remove_directory = [&](bool fully_contained) {
-      if (!fully_contained) {
-        return absl::OkStatus();
-      }
-      const auto entry = visitor.GetCurrentEntry();
-      if (entry.Delete(/*is_directory=*/true)) {
-        return absl::OkStatus();
-      }
-      auto status_code = GetOsErrorStatusCode(GetLastErrorCode());
-      if (status_code == absl::StatusCode::kNotFound ||
-          status_code == absl::StatusCode::kAlreadyExists) {
-        return absl::OkStatus();
-      }
-      return StatusFromErrno("Failed to remove directory");
-    };
-    auto delete_file = [&] {
-      auto entry = visitor.GetCurrentEntry();
-      if (entry.Delete(/*is_directory=*/false)) {
-        // File deleted.
-      } else if (GetOsErrorStatusCode(GetLastErrorCode()) !=
-                 absl::StatusCode::kNotFound) {
-        return StatusFromErrno("Failed to remove file");
-      }
+  DeleteRangeVisitor(KeyRange range, Executor executor,
+                     Promise<void> promise)
+      : PathRangeVisitor(std::move(range), std::move(executor),
+                         kFileBatchSize),
+        promise_(std::move(promise)) {}
+
+ private:
+  bool IsCancelled() override { return !promise_.result_needed(); }
+
+  absl::Status HandleFile(std::string path) override {
+    if (!internal_file_util::DirectoryIterator::Entry::FromPath(path).Delete(
+            /*is_directory=*/false) &&
+        GetOsErrorStatusCode(GetLastErrorCode()) !=
+            absl::StatusCode::kNotFound) {
+      return StatusFromErrno("Failed to remove file: ", path);
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status HandleDirectory(const std::string& path,
+                               bool fully_contained) override {
+    if (!fully_contained) {
       return absl::OkStatus();
-    };
+    }
+    if (internal_file_util::DirectoryIterator::Entry::FromPath(path).Delete(
+            /*is_directory=*/true)) {
+      return absl::OkStatus();
+    }
+    auto status_code = GetOsErrorStatusCode(GetLastErrorCode());
+    if (status_code == absl::StatusCode::kNotFound ||
+        status_code == absl::StatusCode::kAlreadyExists) {
+      return absl::OkStatus();
+    }
+    return StatusFromErrno("Failed to remove directory");
+  }
 
-    promise.SetResult(
-        MakeResult(visitor.Visit(is_cancelled, delete_file, remove_directory)));
+  void Done(absl::Status status) override {
+    promise_.SetResult(MakeResult(std::move(status)));
   }
+
+  Promise<void> promise_;
 };
 
-struct ListTask {
-  KeyRange range;
-  size_t strip_prefix_length;
-  AnyFlowReceiver<absl::Status, kvstore::Key> receiver;
+/// Implements `FileKeyValueStore::ListImpl`.
+///
+/// Keys are emitted as they are found, in no particular order.
+class ListVisitor : public PathRangeVisitor {
+ public:
+  ListVisitor(KeyRange range, Executor executor, size_t strip_prefix_length,
+              AnyFlowReceiver<absl::Status, kvstore::Key> receiver)
+      : PathRangeVisitor(std::move(range), std::move(executor),
+                         /*file_batch_size=*/0),
+        strip_prefix_length_(strip_prefix_length),
+        receiver_(std::move(receiver)) {
+    execution::set_starting(receiver_, [this] {
+      cancelled_.store(true, std::memory_order_relaxed);
+    });
+  }
 
-  void operator()() {
-    PathRangeVisitor visitor(range);
+ private:
+  bool IsCancelled() override {
+    return cancelled_.load(std::memory_order_relaxed);
+  }
 
-    std::atomic<bool> cancelled = false;
-    execution::set_starting(receiver, [&cancelled] {
-      cancelled.store(true, std::memory_order_relaxed);
-    });
-    auto is_cancelled = [&cancelled] {
-      return cancelled.load(std::memory_order_relaxed);
-    };
-    auto handle_file_at = [this, &visitor] {
-      std::string path = visitor.GetFullPath();
-      if (!absl::EndsWith(path, kLockSuffix)) {
-        path.erase(0, strip_prefix_length);
-        execution::set_value(receiver, std::move(path));
-      }
-      return absl::OkStatus();
-    };
-    auto handle_dir_at = [](bool fully_contained) { return absl::OkStatus(); };
+  absl::Status HandleFile(std::string path) override {
+    if (!absl::EndsWith(path, kLockSuffix)) {
+      path.erase(0, strip_prefix_length_);
+      // Directories are scanned concurrently, but the receiver requires that
+      // keys are delivered sequentially, and not after cancellation.
+      absl::MutexLock lock(&receiver_mutex_);
+      if (IsCancelled()) return absl::CancelledError("");
+      execution::set_value(receiver_, std::move(path));
+    }
+    return absl::OkStatus();
+  }
 
-    auto status = visitor.Visit(is_cancelled, handle_file_at, handle_dir_at);
-    if (!status.ok() && !is_cancelled()) {
-      execution::set_error(receiver, std::move(status));
-      execution::set_stopping(receiver);
-      return;
+  absl::Status HandleDirectory(const std::string& path,
+                               bool fully_contained) override {
+    return absl::OkStatus();
+  }
+
+  void Done(absl::Status status) override {
+    if (!status.ok() && !IsCancelled()) {
+      execution::set_error(receiver_, std::move(status));
+    } else {
+      execution::set_done(receiver_);
     }
-    execution::set_done(receiver);
-    execution::set_stopping(receiver);
+    execution::set_stopping(receiver_);
   }
+
+  size_t strip_prefix_length_;
+  std::atomic<bool> cancelled_ = false;
+  absl::Mutex receiver_mutex_;
+  AnyFlowReceiver<absl::Status, kvstore::Key> receiver_;
+};
+
+/// Mechanism used to read and write values.
+enum class FileIoEngine {
+  /// Blocking system calls on `file_io_concurrency` threads.
+  kThreadPool,
+  /// Asynchronous reads and writes using io_uring, if supported.
+  kIoUring,
+};
+
+/// Mechanism used to return values that are read.
+enum class FileReadMode {
+  /// Values are copied into newly-allocated memory.
+  kCopy,
+  /// Values are memory mapped, such that the returned `absl::Cord` references
+  /// the page cache directly.
+  kMmap,
 };
 
 struct FileKeyValueStoreSpecData {
   Context::Resource<internal::FileIoConcurrencyResource> file_io_concurrency;
+  FileIoEngine io_engine = FileIoEngine::kThreadPool;
+  FileReadMode read_mode = FileReadMode::kCopy;
+  FileDurability durability = FileDurability::kPerWrite;
 
   constexpr static auto ApplyMembers = [](auto& x, auto f) {
-    return f(x.file_io_concurrency);
+    return f(x.file_io_concurrency, x.io_engine, x.read_mode, x.durability);
   };
 
   // TODO(jbms): Storing a UNIX path as a JSON string presents a challenge
@@ -783,9 +1384,38 @@ struct FileKeyValueStoreSpecData {
   // including base64-encoding, or using NUL as an escape sequence (taking
   // advantage of the fact that valid paths on all operating systems
   // cannot contain NUL characters).
-  constexpr static auto default_json_binder = jb::Object(jb::Member(
-      internal::FileIoConcurrencyResource::id,
-      jb::Projection<&FileKeyValueStoreSpecData::file_io_concurrency>()));
+  constexpr static auto default_json_binder = jb::Object(
+      jb::Member(
+          internal::FileIoConcurrencyResource::id,
+          jb::Projection<&FileKeyValueStoreSpecData::file_io_concurrency>()),
+      jb::Member(
+          "io_engine",
+          jb::Projection<&FileKeyValueStoreSpecData::io_engine>(
+              jb::DefaultValue<jb::kNeverIncludeDefaults>(
+                  [](auto* obj) { *obj = FileIoEngine::kThreadPool; },
+                  jb::Enum<FileIoEngine, std::string_view>({
+                      {FileIoEngine::kThreadPool, "thread_pool"},
+                      {FileIoEngine::kIoUring, "io_uring"},
+                  })))),
+      jb::Member(
+          "read_mode",
+          jb::Projection<&FileKeyValueStoreSpecData::read_mode>(
+              jb::DefaultValue<jb::kNeverIncludeDefaults>(
+                  [](auto* obj) { *obj = FileReadMode::kCopy; },
+                  jb::Enum<FileReadMode, std::string_view>({
+                      {FileReadMode::kCopy, "copy"},
+                      {FileReadMode::kMmap, "mmap"},
+                  })))),
+      jb::Member(
+          "durability",
+          jb::Projection<&FileKeyValueStoreSpecData::durability>(
+              jb::DefaultValue<jb::kNeverIncludeDefaults>(
+                  [](auto* obj) { *obj = FileDurability::kPerWrite; },
+                  jb::Enum<FileDurability, std::string_view>({
+                      {FileDurability::kPerWrite, "per_write"},
+                      {FileDurability::kGroupCommit, "group_commit"},
+                      {FileDurability::kNone, "none"},
+                  })))));
 };
 
 class FileKeyValueStoreSpec
@@ -808,7 +1438,30 @@ class FileKeyValueStore
   Future<ReadResult> Read(Key key, ReadOptions options) override {
     file_read.Increment();
     TENSORSTORE_RETURN_IF_ERROR(ValidateKey(key));
-    return MapFuture(executor(), ReadTask{std::move(key), std::move(options)});
+    const bool memory_map = spec_.read_mode == FileReadMode::kMmap;
+#ifdef __linux__
+    // Memory-mapped reads do not copy the value, and therefore do not benefit
+    // from io_uring.
+    if (io_uring_ && !memory_map) {
+      return PromiseFuturePair<ReadResult>::Link(
+                 WithExecutor(executor(),
+                              IoUringReadTask{io_uring_, executor(),
+                                              ReadTask{std::move(key),
+                                                       std::move(options)}}))
+          .future;
+    }
+#endif
+    return MapFuture(executor(), ReadTask{std::move(key), std::move(options),
+                                          memory_map});
+  }
+
+  Future<ReadRangesResult> ReadRanges(Key key,
+                                     ReadRangesOptions options) override {
+    file_read.Increment();
+    TENSORSTORE_RETURN_IF_ERROR(ValidateKey(key));
+    return MapFuture(executor(),
+                     ReadRangesTask{std::move(key), std::move(options),
+                                    spec_.read_mode == FileReadMode::kMmap});
   }
 
   Future<TimestampedStorageGeneration> Write(Key key,
@@ -816,12 +1469,26 @@ class FileKeyValueStore
                                              WriteOptions options) override {
     file_write.Increment();
     TENSORSTORE_RETURN_IF_ERROR(ValidateKey(key));
+    const FileDurability durability = spec_.durability;
     if (value) {
-      return MapFuture(executor(), WriteTask{std::move(key), std::move(*value),
-                                             std::move(options)});
-    } else {
+#ifdef __linux__
+      // `IoUring::WriteAndSync` always syncs each value individually.
+      if (io_uring_ && durability == FileDurability::kPerWrite) {
+        return PromiseFuturePair<TimestampedStorageGeneration>::Link(
+                   WithExecutor(executor(),
+                                IoUringWriteTask{
+                                    io_uring_, executor(),
+                                    WriteTask{std::move(key), std::move(*value),
+                                              std::move(options)}}))
+            .future;
+      }
+#endif
       return MapFuture(executor(),
-                       DeleteTask{std::move(key), std::move(options)});
+                       WriteTask{std::move(key), std::move(*value),
+                                 std::move(options), durability});
+    } else {
+      return MapFuture(executor(), DeleteTask{std::move(key),
+                                              std::move(options), durability});
     }
   }
 
@@ -829,9 +1496,11 @@ class FileKeyValueStore
     file_delete_range.Increment();
     if (range.empty()) return absl::OkStatus();  // Converted to a ReadyFuture.
     TENSORSTORE_RETURN_IF_ERROR(ValidateKeyRange(range));
-    return PromiseFuturePair<void>::Link(
-               WithExecutor(executor(), DeleteRangeTask{std::move(range)}))
-        .future;
+    auto [promise, future] = PromiseFuturePair<void>::Make();
+    internal::MakeIntrusivePtr<DeleteRangeVisitor>(
+        std::move(range), executor(), std::move(promise))
+        ->Start();
+    return std::move(future);
   }
 
   void ListImpl(ListOptions options,
@@ -849,8 +1518,10 @@ class FileKeyValueStore
       execution::set_stopping(receiver);
       return;
     }
-    executor()(ListTask{std::move(options.range), options.strip_prefix_length,
-                        std::move(receiver)});
+    internal::MakeIntrusivePtr<ListVisitor>(
+        std::move(options.range), executor(), options.strip_prefix_length,
+        std::move(receiver))
+        ->Start();
   }
   const Executor& executor() { return spec_.file_io_concurrency->executor; }
 
@@ -864,11 +1535,23 @@ class FileKeyValueStore
   }
 
   SpecData spec_;
+
+#ifdef __linux__
+  /// Ring used to read and write values, or `nullptr` to use blocking system
+  /// calls.
+  internal_file_util::IoUring* io_uring_ = nullptr;
+#endif
 };
 
 Future<kvstore::DriverPtr> FileKeyValueStoreSpec::DoOpen() const {
   auto driver_ptr = internal::MakeIntrusivePtr<FileKeyValueStore>();
   driver_ptr->spec_ = data_;
+#ifdef __linux__
+  if (data_.io_engine == FileIoEngine::kIoUring) {
+    // Fall back to blocking system calls if io_uring is not available.
+    driver_ptr->io_uring_ = internal_file_util::IoUring::GetShared();
+  }
+#endif
   return driver_ptr;
 }
 
@@ -0,0 +1,122 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/// \file
+/// Compares the read throughput of the "file" driver using each `io_engine`,
+/// and the write throughput using each `durability` level.
+///
+/// Each iteration issues concurrent reads or writes of `kNumKeys` distinct
+/// values.  Unless the page cache is dropped externally, the values are read
+/// from memory, such that the read benchmarks primarily measure per-operation
+/// overhead.  The write benchmarks are dominated by `fsync` latency, except
+/// with a `durability` of `"none"`.
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/strings/cord.h"
+#include <benchmark/benchmark.h>
+#include "tensorstore/internal/global_initializer.h"
+#include "tensorstore/internal/test_util.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace {
+
+namespace kvstore = ::tensorstore::kvstore;
+using ::tensorstore::Future;
+using ::tensorstore::TimestampedStorageGeneration;
+using ::tensorstore::internal::ScopedTemporaryDirectory;
+
+constexpr int kNumKeys = 64;
+
+void BenchmarkRead(::benchmark::State& state, std::string_view io_engine,
+                   std::size_t value_size) {
+  ScopedTemporaryDirectory tempdir;
+  auto store = kvstore::Open({{"driver", "file"},
+                              {"path", tempdir.path() + "/"},
+                              {"io_engine", io_engine}})
+                   .value();
+  const absl::Cord value(std::string(value_size, 'x'));
+  for (int i = 0; i < kNumKeys; ++i) {
+    TENSORSTORE_CHECK_OK(
+        kvstore::Write(store, tensorstore::StrCat(i), value).result());
+  }
+  std::vector<Future<kvstore::ReadResult>> futures(kNumKeys);
+  for (auto s : state) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      futures[i] = kvstore::Read(store, tensorstore::StrCat(i));
+    }
+    for (auto& future : futures) {
+      TENSORSTORE_CHECK_OK(future.result());
+    }
+  }
+  // Items per second corresponds to IOPS.
+  state.SetItemsProcessed(state.iterations() * kNumKeys);
+  state.SetBytesProcessed(state.iterations() * kNumKeys * value_size);
+}
+
+void BenchmarkWrite(::benchmark::State& state, std::string_view durability,
+                    std::size_t value_size) {
+  ScopedTemporaryDirectory tempdir;
+  // Allow all writes to proceed concurrently, such that `"group_commit"` may
+  // coalesce all of their syncs.
+  auto store = kvstore::Open({{"driver", "file"},
+                              {"path", tempdir.path() + "/"},
+                              {"file_io_concurrency", {{"limit", kNumKeys}}},
+                              {"durability", durability}})
+                   .value();
+  const absl::Cord value(std::string(value_size, 'x'));
+  std::vector<Future<TimestampedStorageGeneration>> futures(kNumKeys);
+  for (auto s : state) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      futures[i] = kvstore::Write(store, tensorstore::StrCat(i), value);
+    }
+    for (auto& future : futures) {
+      TENSORSTORE_CHECK_OK(future.result());
+    }
+  }
+  // Items per second corresponds to chunks written per second.
+  state.SetItemsProcessed(state.iterations() * kNumKeys);
+  state.SetBytesProcessed(state.iterations() * kNumKeys * value_size);
+}
+
+TENSORSTORE_GLOBAL_INITIALIZER {
+  for (std::string_view io_engine : {"thread_pool", "io_uring"}) {
+    for (std::size_t value_size = 4096; value_size <= 4 * 1024 * 1024;
+         value_size *= 4) {
+      ::benchmark::RegisterBenchmark(
+          tensorstore::StrCat("Read_", io_engine, "_", value_size).c_str(),
+          [=](auto& state) { BenchmarkRead(state, io_engine, value_size); })
+          ->UseRealTime();
+    }
+  }
+  for (std::string_view durability : {"per_write", "group_commit", "none"}) {
+    for (std::size_t value_size : {4096, 1024 * 1024}) {
+      ::benchmark::RegisterBenchmark(
+          tensorstore::StrCat("Write_", durability, "_", value_size).c_str(),
+          [=](auto& state) { BenchmarkWrite(state, durability, value_size); })
+          ->UseRealTime();
+    }
+  }
+}
+
+}  // namespace
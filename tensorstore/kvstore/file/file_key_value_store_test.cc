@@ -33,6 +33,7 @@
 #include "tensorstore/internal/file_io_concurrency_resource.h"
 #include "tensorstore/internal/test_util.h"
 #include "tensorstore/internal/thread.h"
+#include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/generation_testutil.h"
 #include "tensorstore/kvstore/key_range.h"
@@ -62,6 +63,7 @@ using ::tensorstore::KeyRange;
 using ::tensorstore::KvStore;
 using ::tensorstore::MatchesStatus;
 using ::tensorstore::StorageGeneration;
+using ::tensorstore::TimestampedStorageGeneration;
 using ::tensorstore::internal::MatchesKvsReadResultNotFound;
 using ::tensorstore::internal::MatchesTimestampedStorageGeneration;
 using ::testing::HasSubstr;
@@ -198,6 +200,119 @@ TEST(FileKeyValueStoreTest, NestedDirectories) {
                        MatchesStatus(absl::StatusCode::kFailedPrecondition)));
 }
 
+TEST(FileKeyValueStoreTest, BasicIoUring) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  // Falls back to blocking system calls if io_uring is not available.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open(
+          {{"driver", "file"}, {"path", root + "/"}, {"io_engine", "io_uring"}})
+          .result());
+  tensorstore::internal::TestKeyValueStoreBasicFunctionality(store);
+
+  // Test conditional writes, and that no lock files are left around.
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(store, "a/foo", absl::Cord("xyz"),
+                     {/*.if_equal=*/StorageGeneration::NoValue()})
+          .result());
+  EXPECT_THAT(
+      kvstore::Write(store, "a/foo", absl::Cord("qqq"),
+                     {/*.if_equal=*/StorageGeneration::NoValue()})
+          .result(),
+      MatchesTimestampedStorageGeneration(StorageGeneration::Unknown()));
+  EXPECT_THAT(GetDirectoryContents(root),
+              ::testing::UnorderedElementsAre("a", "a/foo"));
+
+  // Test reading a large value composed of many chunks.
+  absl::Cord value;
+  for (int i = 0; i < 2000; ++i) {
+    value.Append(absl::Cord(std::string(1000, 'a' + i % 26)));
+  }
+  TENSORSTORE_ASSERT_OK(kvstore::Write(store, "a/large", value).result());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto read_result,
+                                   kvstore::Read(store, "a/large").result());
+  EXPECT_EQ(value, read_result.value);
+  kvstore::ReadOptions options;
+  options.byte_range = tensorstore::OptionalByteRangeRequest(999, 1001);
+  EXPECT_THAT(kvstore::Read(store, "a/large", options).result(),
+              ::testing::Optional(::testing::Field(
+                  &kvstore::ReadResult::value, absl::Cord("ab"))));
+}
+
+TEST(FileKeyValueStoreTest, BasicMmap) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open(
+          {{"driver", "file"}, {"path", root + "/"}, {"read_mode", "mmap"}})
+          .result());
+  tensorstore::internal::TestKeyValueStoreBasicFunctionality(store);
+
+  // Test reading a value large enough to be memory mapped.
+  std::string value(1000000, '\0');
+  for (size_t i = 0; i < value.size(); ++i) value[i] = 'a' + i % 26;
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(store, "a/large", absl::Cord(value)).result());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto read_result,
+                                   kvstore::Read(store, "a/large").result());
+  EXPECT_EQ(value, read_result.value);
+  EXPECT_TRUE(read_result.value.TryFlat());
+
+  // Test reading a byte range that does not start on a page boundary.
+  kvstore::ReadOptions options;
+  options.byte_range = tensorstore::OptionalByteRangeRequest(4097, 300001);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto range_result, kvstore::Read(store, "a/large", options).result());
+  EXPECT_EQ(value.substr(4097, 300001 - 4097), range_result.value);
+
+  // Values are replaced by renaming a new file, which does not affect values
+  // that remain mapped.
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(store, "a/large", absl::Cord(std::string(1000000, 'x')))
+          .result());
+  TENSORSTORE_ASSERT_OK(kvstore::Delete(store, "a/large").result());
+  EXPECT_EQ(value, read_result.value);
+}
+
+TEST(FileKeyValueStoreTest, BasicDurability) {
+  for (std::string_view durability : {"group_commit", "none"}) {
+    SCOPED_TRACE(durability);
+    tensorstore::internal::ScopedTemporaryDirectory tempdir;
+    std::string root = tempdir.path() + "/root";
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto store, kvstore::Open({{"driver", "file"},
+                                   {"path", root + "/"},
+                                   {"durability", durability}})
+                        .result());
+    tensorstore::internal::TestKeyValueStoreBasicFunctionality(store);
+
+    // Test concurrent writes to the same directory, which are coalesced by
+    // `"group_commit"`, and that no lock files are left around.
+    std::vector<tensorstore::Future<TimestampedStorageGeneration>> futures;
+    for (int i = 0; i < 32; ++i) {
+      futures.push_back(kvstore::Write(store, tensorstore::StrCat("a/", i),
+                                       absl::Cord("value")));
+    }
+    for (auto& future : futures) {
+      TENSORSTORE_EXPECT_OK(future.result());
+    }
+    for (int i = 0; i < 32; ++i) {
+      EXPECT_THAT(kvstore::Read(store, tensorstore::StrCat("a/", i)).result(),
+                  ::testing::Optional(::testing::Field(
+                      &kvstore::ReadResult::value, absl::Cord("value"))));
+    }
+    EXPECT_THAT(GetDirectoryContents(root), ::testing::Contains("a/0"));
+    EXPECT_THAT(GetDirectoryContents(root),
+                ::testing::Not(::testing::Contains(
+                    HasSubstr(".__lock"))));
+    TENSORSTORE_EXPECT_OK(kvstore::Delete(store, "a/0").result());
+    EXPECT_THAT(kvstore::Read(store, "a/0").result(),
+                MatchesKvsReadResultNotFound());
+  }
+}
+
 TEST(FileKeyValueStoreTest, ConcurrentWrites) {
   constexpr std::size_t num_threads = 4;
   std::vector<tensorstore::internal::Thread> threads;
@@ -351,6 +466,24 @@ TEST(FileKeyValueStoreTest, DeleteRangeFromBeginning) {
   tensorstore::internal::TestKeyValueStoreDeleteRangeFromBeginning(store);
 }
 
+TEST(FileKeyValueStoreTest, ReadRanges) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  auto store = GetStore(root);
+  tensorstore::internal::TestKeyValueStoreReadRanges(store);
+}
+
+TEST(FileKeyValueStoreTest, ReadRangesMmap) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open(
+          {{"driver", "file"}, {"path", root + "/"}, {"read_mode", "mmap"}})
+          .result());
+  tensorstore::internal::TestKeyValueStoreReadRanges(store);
+}
+
 TEST(FileKeyValueStoreTest, ListErrors) {
   tensorstore::internal::ScopedTemporaryDirectory tempdir;
   std::string root = tempdir.path() + "/root";
@@ -485,6 +618,52 @@ TEST(FileKeyValueStoreTest, List) {
   }
 }
 
+TEST(FileKeyValueStoreTest, ListAndDeleteRangeMany) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  auto store = GetStore(root);
+
+  // Nested directories are traversed concurrently, and files are deleted in
+  // batches.
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; ++i) {
+    keys.push_back(tensorstore::StrCat("a/", i));
+  }
+  for (int i = 0; i < 10; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      keys.push_back(tensorstore::StrCat("b/", i, "/", j, "/0"));
+    }
+  }
+  std::vector<tensorstore::Future<TimestampedStorageGeneration>> futures;
+  for (const auto& key : keys) {
+    futures.push_back(kvstore::Write(store, key, absl::Cord("x")));
+  }
+  for (auto& future : futures) {
+    TENSORSTORE_ASSERT_OK(future.result());
+  }
+  EXPECT_THAT(ListFuture(store).result(),
+              ::testing::Optional(::testing::UnorderedElementsAreArray(keys)));
+
+  TENSORSTORE_ASSERT_OK(
+      kvstore::DeleteRange(store, KeyRange("a/5", "b/5")).result());
+  std::vector<std::string> remaining_keys;
+  for (const auto& key : keys) {
+    if (!tensorstore::Contains(KeyRange("a/5", "b/5"), key)) {
+      remaining_keys.push_back(key);
+    }
+  }
+  EXPECT_THAT(ListFuture(store).result(),
+              ::testing::Optional(
+                  ::testing::UnorderedElementsAreArray(remaining_keys)));
+  EXPECT_THAT(GetDirectoryContents(root),
+              ::testing::Not(::testing::Contains("b/0")));
+  EXPECT_THAT(GetDirectoryContents(root), ::testing::Contains("b/5"));
+
+  TENSORSTORE_ASSERT_OK(kvstore::DeleteRange(store, KeyRange()).result());
+  EXPECT_THAT(ListFuture(store).result(),
+              ::testing::Optional(::testing::ElementsAre()));
+}
+
 TEST(FileKeyValueStoreTest, SpecRoundtrip) {
   tensorstore::internal::ScopedTemporaryDirectory tempdir;
   std::string root = tempdir.path() + "/root";
@@ -492,6 +671,27 @@ TEST(FileKeyValueStoreTest, SpecRoundtrip) {
       {{"driver", "file"}, {"path", root}});
 }
 
+TEST(FileKeyValueStoreTest, SpecRoundtripIoUring) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  tensorstore::internal::TestKeyValueStoreSpecRoundtrip(
+      {{"driver", "file"}, {"path", root}, {"io_engine", "io_uring"}});
+}
+
+TEST(FileKeyValueStoreTest, SpecRoundtripDurability) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  tensorstore::internal::TestKeyValueStoreSpecRoundtrip(
+      {{"driver", "file"}, {"path", root}, {"durability", "group_commit"}});
+}
+
+TEST(FileKeyValueStoreTest, SpecRoundtripMmap) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  tensorstore::internal::TestKeyValueStoreSpecRoundtrip(
+      {{"driver", "file"}, {"path", root}, {"read_mode", "mmap"}});
+}
+
 TEST(FileKeyValueStoreTest, InvalidSpec) {
   tensorstore::internal::ScopedTemporaryDirectory tempdir;
   std::string root = tempdir.path() + "/root";
@@ -504,6 +704,28 @@ TEST(FileKeyValueStoreTest, InvalidSpec) {
           .result(),
       MatchesStatus(absl::StatusCode::kInvalidArgument));
 
+  // Test with invalid `"io_engine"` key.
+  EXPECT_THAT(
+      kvstore::Open({{"driver", "file"}, {"path", root}, {"io_engine", "aio"}},
+                    context)
+          .result(),
+      MatchesStatus(absl::StatusCode::kInvalidArgument));
+
+  // Test with invalid `"read_mode"` key.
+  EXPECT_THAT(
+      kvstore::Open({{"driver", "file"}, {"path", root}, {"read_mode", 1}},
+                    context)
+          .result(),
+      MatchesStatus(absl::StatusCode::kInvalidArgument));
+
+  // Test with invalid `"durability"` key.
+  EXPECT_THAT(kvstore::Open({{"driver", "file"},
+                             {"path", root},
+                             {"durability", "eventual"}},
+                            context)
+                  .result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+
   // Test with invalid `"path"` key.
   EXPECT_THAT(
       kvstore::Open({{"driver", "file"}, {"path", 5}}, context).result(),
@@ -0,0 +1,61 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/file/group_commit.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+
+namespace tensorstore {
+namespace internal_file_util {
+
+absl::Status GroupCommit::Sync(std::string_view key,
+                               absl::FunctionRef<absl::Status()> sync) {
+  absl::MutexLock lock(&mutex_);
+  auto& group_ptr = groups_[key];
+  if (!group_ptr) group_ptr = std::make_unique<Group>();
+  Group& group = *group_ptr;
+  ++group.users;
+  const std::uint64_t ticket = ++group.requested;
+  while (group.completed < ticket && group.in_progress) {
+    group.cond_var.Wait(&mutex_);
+  }
+  if (group.completed < ticket) {
+    // No sync that started after this request has completed, and none is in
+    // progress: perform one on behalf of all pending requests.
+    group.in_progress = true;
+    const std::uint64_t batch = group.requested;
+    mutex_.Unlock();
+    absl::Status status = sync();
+    mutex_.Lock();
+    group.in_progress = false;
+    group.completed = batch;
+    group.status = std::move(status);
+    group.cond_var.SignalAll();
+  }
+  absl::Status status = group.status;
+  if (--group.users == 0) {
+    groups_.erase(key);
+  }
+  return status;
+}
+
+}  // namespace internal_file_util
+}  // namespace tensorstore
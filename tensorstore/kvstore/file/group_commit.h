@@ -0,0 +1,79 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_FILE_GROUP_COMMIT_H_
+#define TENSORSTORE_KVSTORE_FILE_GROUP_COMMIT_H_
+
+/// \file Coalesces concurrent `fsync` calls.
+///
+/// This is used by the "file" driver when its spec specifies a `durability`
+/// of `"group_commit"`.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+
+namespace tensorstore {
+namespace internal_file_util {
+
+/// Coalesces concurrent sync operations that apply to the same key (normally a
+/// directory path), such that a single sync operation makes the changes of
+/// many concurrent callers durable.
+///
+/// This class is thread-safe.
+class GroupCommit {
+ public:
+  /// Blocks until `sync`, or the sync function of another caller with the same
+  /// `key`, has been called and returned after this call started.
+  ///
+  /// While one caller is syncing, other callers with the same `key` wait, and
+  /// then one of them performs a single sync on behalf of all of them.
+  /// Therefore, the sync functions specified for a given `key` must be
+  /// interchangeable.
+  ///
+  /// \returns The status returned by the sync function that was called.
+  absl::Status Sync(std::string_view key,
+                    absl::FunctionRef<absl::Status()> sync);
+
+ private:
+  struct Group {
+    /// Number of callers that have requested a sync.
+    std::uint64_t requested = 0;
+    /// Value of `requested` when the last completed sync started.
+    std::uint64_t completed = 0;
+    /// Indicates that a sync is in progress.
+    bool in_progress = false;
+    /// Status returned by the last completed sync.
+    absl::Status status;
+    /// Number of callers of `Sync` that reference this group.
+    std::size_t users = 0;
+    absl::CondVar cond_var;
+  };
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::unique_ptr<Group>> groups_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace internal_file_util
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_FILE_GROUP_COMMIT_H_
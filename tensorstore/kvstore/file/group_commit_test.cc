@@ -0,0 +1,91 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/file/group_commit.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/thread.h"
+
+namespace {
+
+using ::tensorstore::internal_file_util::GroupCommit;
+
+TEST(GroupCommitTest, Sequential) {
+  GroupCommit group_commit;
+  int calls = 0;
+  auto sync = [&] {
+    ++calls;
+    return absl::OkStatus();
+  };
+  EXPECT_TRUE(group_commit.Sync("a", sync).ok());
+  EXPECT_TRUE(group_commit.Sync("a", sync).ok());
+  EXPECT_EQ(2, calls);
+  EXPECT_EQ(absl::UnknownError("x"),
+            group_commit.Sync("a", [] { return absl::UnknownError("x"); }));
+}
+
+TEST(GroupCommitTest, Coalesces) {
+  GroupCommit group_commit;
+  absl::Notification first_sync_started, release_first_sync;
+  std::atomic<int> calls{0};
+
+  // The first caller blocks in its sync function until all other callers are
+  // waiting.
+  tensorstore::internal::Thread first({"first"}, [&] {
+    EXPECT_TRUE(group_commit
+                    .Sync("a",
+                          [&] {
+                            ++calls;
+                            first_sync_started.Notify();
+                            release_first_sync.WaitForNotification();
+                            return absl::OkStatus();
+                          })
+                    .ok());
+  });
+  first_sync_started.WaitForNotification();
+
+  constexpr int kNumWaiters = 8;
+  std::vector<tensorstore::internal::Thread> threads;
+  for (int i = 0; i < kNumWaiters; ++i) {
+    threads.emplace_back(tensorstore::internal::Thread({"waiter"}, [&] {
+      EXPECT_EQ(absl::UnknownError("x"), group_commit.Sync("a", [&] {
+        ++calls;
+        return absl::UnknownError("x");
+      }));
+    }));
+  }
+  // Requests for a different key are not blocked.
+  EXPECT_TRUE(group_commit.Sync("b", [] { return absl::OkStatus(); }).ok());
+
+  // Allow the waiters to block.
+  absl::SleepFor(absl::Milliseconds(50));
+  release_first_sync.Notify();
+  first.Join();
+  for (auto& thread : threads) thread.Join();
+  // The waiters are never satisfied by the sync that started before their
+  // requests, and normally all of them are satisfied by a single additional
+  // sync.
+  EXPECT_GE(calls, 2);
+  EXPECT_LE(calls, 1 + kNumWaiters);
+}
+
+}  // namespace
@@ -0,0 +1,480 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef __linux__
+
+#include "tensorstore/kvstore/file/io_uring.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/logging.h"
+#include "tensorstore/internal/os_error_code.h"
+#include "tensorstore/internal/thread.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/status.h"
+
+// Include system headers last to reduce impact of macros.
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace tensorstore {
+namespace internal_file_util {
+namespace {
+
+using ::tensorstore::internal::StatusFromOsError;
+
+/// Number of submission queue entries of the shared ring.
+constexpr unsigned kSharedQueueDepth = 256;
+
+/// Maximum number of iovecs in a single write.
+constexpr std::size_t kMaxIovecs = 1024;
+
+/// Bit set in the `user_data` of the `fsync` that follows a write.
+constexpr std::uint64_t kFsyncTag = 1;
+
+/// `user_data` of the no-op used to stop the completion thread.
+constexpr std::uint64_t kShutdownUserData = 0;
+
+/// Interval at which submission is retried if the kernel rejects entries while
+/// no operations are pending, and therefore no completion will arrive.
+constexpr absl::Duration kSubmitRetryInterval = absl::Milliseconds(1);
+
+int IoUringSetup(unsigned entries, ::io_uring_params* params) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                 unsigned flags) {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, to_submit,
+                                    min_complete, flags, nullptr, 0));
+}
+
+::io_uring_sqe MakeSqe(std::uint8_t opcode, int fd, const void* addr,
+                       std::uint32_t len, std::int64_t offset,
+                       std::uint64_t user_data) {
+  ::io_uring_sqe sqe;
+  std::memset(&sqe, 0, sizeof(sqe));
+  sqe.opcode = opcode;
+  sqe.fd = fd;
+  sqe.addr = reinterpret_cast<std::uintptr_t>(addr);
+  sqe.len = len;
+  sqe.off = static_cast<std::uint64_t>(offset);
+  sqe.user_data = user_data;
+  return sqe;
+}
+
+/// State of a submitted operation.  The `user_data` of each submission queue
+/// entry is the address of the `Operation`, which must therefore be aligned to
+/// at least 2 bytes to leave room for `kFsyncTag`.
+struct Operation {
+  Executor executor;
+  IoUring::Callback callback;
+
+  /// File descriptor on which `fsync` is called once the write completes in
+  /// full, or -1 for a read.
+  int sync_fd = -1;
+
+  /// Result passed to `callback`.
+  std::int64_t result = 0;
+
+  /// Value being written, which owns the buffers referenced by `iovecs`.
+  absl::Cord value;
+
+  absl::InlinedVector<::iovec, 1> iovecs;
+};
+
+::io_uring_sqe MakeFsyncSqe(Operation* op) {
+  return MakeSqe(IORING_OP_FSYNC, op->sync_fd, nullptr, 0, 0,
+                 reinterpret_cast<std::uintptr_t>(op) | kFsyncTag);
+}
+
+class IoUringImpl : public IoUring {
+ public:
+  absl::Status Init(unsigned queue_depth);
+
+  ~IoUringImpl() override;
+
+  void Read(int fd, void* buffer, std::size_t size, std::int64_t offset,
+            Executor executor, Callback callback) override;
+
+  void WriteAndSync(int fd, absl::Cord value, std::int64_t offset,
+                    Executor executor, Callback callback) override;
+
+ private:
+  /// Submits `sqe` to the kernel, or queues it if the ring is full.
+  void Submit(const ::io_uring_sqe& sqe);
+
+  bool HasSpace() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return unsubmitted_ < sq_entries_ && in_flight_ < cq_entries_;
+  }
+
+  /// Copies `sqe` to the submission queue.
+  void Push(const ::io_uring_sqe& sqe) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Passes all pushed submission queue entries to the kernel, unless another
+  /// thread is already doing so, and then unlocks `mutex_`.
+  ///
+  /// If the kernel temporarily cannot accept more entries (`EAGAIN` or
+  /// `EBUSY`), waits for the completion thread to consume completions before
+  /// retrying if `may_wait` is `true`, and otherwise leaves the remaining
+  /// entries to be submitted by the completion thread.
+  void SubmitPendingAndUnlock(bool may_wait) ABSL_UNLOCK_FUNCTION(mutex_);
+
+  /// Returns `true` if entries are left unsubmitted, but none of the entries
+  /// passed to the kernel are pending, such that no completion will arrive.
+  bool IsSubmissionStalled() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return unsubmitted_ != 0 && !submitting_ && in_flight_ == unsubmitted_;
+  }
+
+  void RunCompletionThread();
+
+  int ring_fd_ = -1;
+
+  void* sq_ring_ = MAP_FAILED;
+  std::size_t sq_ring_size_ = 0;
+  void* cq_ring_ = MAP_FAILED;
+  std::size_t cq_ring_size_ = 0;
+  ::io_uring_sqe* sqes_ = static_cast<::io_uring_sqe*>(MAP_FAILED);
+  std::size_t sqes_size_ = 0;
+
+  unsigned sq_entries_ = 0;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+
+  unsigned cq_entries_ = 0;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  ::io_uring_cqe* cqes_ = nullptr;
+
+  internal::Thread completion_thread_;
+
+  absl::Mutex mutex_;
+
+  /// Number of entries pushed to the submission queue that have not yet been
+  /// passed to the kernel.
+  std::size_t unsubmitted_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  /// Number of entries pushed to the submission queue whose completion queue
+  /// entries have not yet been consumed.  This is bounded by `cq_entries_` to
+  /// ensure the completion queue never overflows.
+  std::size_t in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  /// Indicates that a thread is calling `io_uring_enter` to submit entries.
+  bool submitting_ ABSL_GUARDED_BY(mutex_) = false;
+
+  /// Signalled when the completion thread consumes completion queue entries.
+  absl::CondVar completions_consumed_;
+
+  /// Submissions deferred because the ring was full.
+  std::deque<::io_uring_sqe> overflow_ ABSL_GUARDED_BY(mutex_);
+
+  /// Indicates that the completion thread should exit once `in_flight_`
+  /// reaches 0.
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+absl::Status IoUringImpl::Init(unsigned queue_depth) {
+  ::io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  ring_fd_ = IoUringSetup(queue_depth, &params);
+  if (ring_fd_ < 0) {
+    return StatusFromOsError(errno, "io_uring_setup failed");
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+  const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    return StatusFromOsError(errno, "Failed to map io_uring submission queue");
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      return StatusFromOsError(errno,
+                               "Failed to map io_uring completion queue");
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(::io_uring_sqe);
+  sqes_ = static_cast<::io_uring_sqe*>(
+      ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+  if (sqes_ == MAP_FAILED) {
+    return StatusFromOsError(errno, "Failed to map io_uring entries");
+  }
+
+  char* sq = static_cast<char*>(sq_ring_);
+  sq_entries_ = params.sq_entries;
+  sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+  char* cq = static_cast<char*>(cq_ring_);
+  cq_entries_ = params.cq_entries;
+  cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<::io_uring_cqe*>(cq + params.cq_off.cqes);
+
+  completion_thread_ =
+      internal::Thread({"tensorstore_io_uring"},
+                       &IoUringImpl::RunCompletionThread, this);
+  return absl::OkStatus();
+}
+
+IoUringImpl::~IoUringImpl() {
+  if (cqes_) {
+    // Submit a no-op to wake the completion thread, which exits once all
+    // pending operations have completed.
+    Submit(MakeSqe(IORING_OP_NOP, -1, nullptr, 0, 0, kShutdownUserData));
+    completion_thread_.Join();
+  }
+  if (sqes_ != MAP_FAILED) ::munmap(sqes_, sqes_size_);
+  if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+    ::munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != MAP_FAILED) ::munmap(sq_ring_, sq_ring_size_);
+  if (ring_fd_ != -1) ::close(ring_fd_);
+}
+
+void IoUringImpl::Read(int fd, void* buffer, std::size_t size,
+                       std::int64_t offset, Executor executor,
+                       Callback callback) {
+  auto* op = new Operation;
+  op->executor = std::move(executor);
+  op->callback = std::move(callback);
+  op->iovecs.push_back({buffer, size});
+  Submit(MakeSqe(IORING_OP_READV, fd, op->iovecs.data(), 1, offset,
+                 reinterpret_cast<std::uintptr_t>(op)));
+}
+
+void IoUringImpl::WriteAndSync(int fd, absl::Cord value, std::int64_t offset,
+                               Executor executor, Callback callback) {
+  auto* op = new Operation;
+  op->executor = std::move(executor);
+  op->callback = std::move(callback);
+  op->sync_fd = fd;
+  if (value.empty()) {
+    Submit(MakeFsyncSqe(op));
+    return;
+  }
+  if (static_cast<std::size_t>(std::distance(
+          value.chunk_begin(), value.chunk_end())) > kMaxIovecs) {
+    value = absl::Cord(std::string(value));
+  }
+  op->value = std::move(value);
+  for (std::string_view chunk : op->value.Chunks()) {
+    op->iovecs.push_back({const_cast<char*>(chunk.data()), chunk.size()});
+  }
+  // The `fsync` is submitted by the completion thread once the write completes
+  // in full.  It is not linked to the write using `IOSQE_IO_LINK`, since the
+  // kernel may accept only the first entry of a linked pair, and then submits
+  // it without the link.
+  Submit(MakeSqe(IORING_OP_WRITEV, fd, op->iovecs.data(), op->iovecs.size(),
+                 offset, reinterpret_cast<std::uintptr_t>(op)));
+}
+
+void IoUringImpl::Submit(const ::io_uring_sqe& sqe) {
+  mutex_.Lock();
+  if (!overflow_.empty() || !HasSpace()) {
+    overflow_.push_back(sqe);
+    mutex_.Unlock();
+    return;
+  }
+  Push(sqe);
+  SubmitPendingAndUnlock(/*may_wait=*/true);
+}
+
+void IoUringImpl::Push(const ::io_uring_sqe& sqe) {
+  // Only threads holding `mutex_` modify the tail, and the kernel never does.
+  const unsigned tail = *sq_tail_;
+  const unsigned index = tail & sq_mask_;
+  sqes_[index] = sqe;
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  ++unsubmitted_;
+  ++in_flight_;
+}
+
+void IoUringImpl::SubmitPendingAndUnlock(bool may_wait) {
+  if (submitting_) {
+    // The entries will be submitted by the thread that is already submitting.
+    mutex_.Unlock();
+    return;
+  }
+  submitting_ = true;
+  while (unsubmitted_ != 0) {
+    const unsigned to_submit = unsubmitted_;
+    mutex_.Unlock();
+    int n = IoUringEnter(ring_fd_, to_submit, 0, 0);
+    int error = 0;
+    if (n < 0) {
+      error = errno;
+      if (error != EINTR && error != EAGAIN && error != EBUSY) {
+        TENSORSTORE_LOG_FATAL("io_uring_enter failed: ",
+                              StatusFromOsError(error));
+      }
+      n = 0;
+    }
+    mutex_.Lock();
+    unsubmitted_ -= n;
+    if (n != 0 || error == EINTR) continue;
+    // The kernel cannot accept more entries until pending operations
+    // complete.  Rather than retrying immediately, wait for the completion
+    // thread to consume a completion, which it signals; the timeout only
+    // matters if no operation is pending.
+    if (!may_wait) break;
+    completions_consumed_.WaitWithTimeout(&mutex_, kSubmitRetryInterval);
+  }
+  submitting_ = false;
+  mutex_.Unlock();
+}
+
+void IoUringImpl::RunCompletionThread() {
+  std::vector<Operation*> completed;
+  std::vector<::io_uring_sqe> fsyncs;
+  while (true) {
+    unsigned head = *cq_head_;
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      mutex_.Lock();
+      if (IsSubmissionStalled()) {
+        // Submission was left to this thread, but no completion will arrive
+        // to wake it.
+        mutex_.Unlock();
+        absl::SleepFor(kSubmitRetryInterval);
+        mutex_.Lock();
+        SubmitPendingAndUnlock(/*may_wait=*/false);
+        continue;
+      }
+      mutex_.Unlock();
+      if (IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+          errno != EINTR) {
+        TENSORSTORE_LOG_FATAL("io_uring_enter failed: ",
+                              StatusFromOsError(errno));
+      }
+      continue;
+    }
+    const unsigned count = tail - head;
+    bool shutdown = false;
+    for (; head != tail; ++head) {
+      const ::io_uring_cqe& cqe = cqes_[head & cq_mask_];
+      const std::uint64_t user_data = cqe.user_data;
+      const std::int64_t res = cqe.res;
+      if (user_data == kShutdownUserData) {
+        shutdown = true;
+        continue;
+      }
+      auto* op = reinterpret_cast<Operation*>(user_data & ~kFsyncTag);
+      if (user_data & kFsyncTag) {
+        if (res < 0) op->result = res;
+      } else {
+        op->result = res;
+        if (op->sync_fd != -1 &&
+            res == static_cast<std::int64_t>(op->value.size())) {
+          fsyncs.push_back(MakeFsyncSqe(op));
+          continue;
+        }
+      }
+      completed.push_back(op);
+    }
+    __atomic_store_n(cq_head_, tail, __ATOMIC_RELEASE);
+
+    // Release the consumed entries, and submit deferred operations, before
+    // dispatching callbacks (which may submit further operations).
+    mutex_.Lock();
+    in_flight_ -= count;
+    completions_consumed_.SignalAll();
+    overflow_.insert(overflow_.end(), fsyncs.begin(), fsyncs.end());
+    fsyncs.clear();
+    shutdown_ = shutdown_ || shutdown;
+    const bool exit = shutdown_ && in_flight_ == 0 && overflow_.empty();
+    while (!overflow_.empty() && HasSpace()) {
+      Push(overflow_.front());
+      overflow_.pop_front();
+    }
+    // This thread must not wait for its own completions, so entries that the
+    // kernel cannot accept yet are retried after the next completions.
+    SubmitPendingAndUnlock(/*may_wait=*/false);
+
+    for (Operation* op : completed) {
+      // `op->executor` is moved out since `op` is owned by the task.
+      auto executor = std::move(op->executor);
+      executor([op = std::unique_ptr<Operation>(op)] {
+        op->callback(op->result);
+      });
+    }
+    completed.clear();
+    if (exit) return;
+  }
+}
+
+}  // namespace
+
+IoUring::~IoUring() = default;
+
+Result<std::unique_ptr<IoUring>> IoUring::Create(unsigned queue_depth) {
+  auto ring = std::make_unique<IoUringImpl>();
+  TENSORSTORE_RETURN_IF_ERROR(ring->Init(queue_depth));
+  return ring;
+}
+
+IoUring* IoUring::GetShared() {
+  static IoUring* const ring = []() -> IoUring* {
+    auto ring = Create(kSharedQueueDepth);
+    if (!ring.ok()) {
+      TENSORSTORE_LOG("io_uring is not available: ", ring.status());
+      return nullptr;
+    }
+    return ring->release();
+  }();
+  return ring;
+}
+
+}  // namespace internal_file_util
+}  // namespace tensorstore
+
+#endif  // __linux__
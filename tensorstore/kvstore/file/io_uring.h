@@ -0,0 +1,97 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_FILE_IO_URING_H_
+#define TENSORSTORE_KVSTORE_FILE_IO_URING_H_
+
+/// \file Asynchronous file I/O using the Linux io_uring interface.
+///
+/// This is used by the "file" driver when its spec specifies an `io_engine` of
+/// `"io_uring"`.  It is only available on Linux; on other platforms this
+/// header defines nothing.
+
+#ifdef __linux__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "absl/strings/cord.h"
+#include "tensorstore/internal/poly/poly.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_file_util {
+
+/// Submission and completion queue pair used to perform file reads and writes
+/// asynchronously.
+///
+/// Operations may be submitted from any thread without blocking: operations
+/// submitted concurrently are passed to the kernel by a single
+/// `io_uring_enter` system call, and operations submitted while the queue is
+/// full are retained in memory until space becomes available, or until the
+/// kernel has resources to accept them.
+///
+/// Completions are received by a single completion thread owned by the
+/// `IoUring`, which submits each completion callback to the executor specified
+/// for the operation.  Callbacks may therefore block, unless the executor
+/// invokes them inline.
+///
+/// This class is thread-safe.
+class IoUring {
+ public:
+  /// Callback invoked with the number of bytes transferred, or a negated
+  /// `errno` value on error.
+  using Callback = poly::Poly<0, /*Copyable=*/false, void(std::int64_t)>;
+
+  /// Creates a new ring with `queue_depth` submission queue entries.
+  ///
+  /// Returns an error if io_uring is not supported by the kernel, or is
+  /// prohibited (e.g. by a seccomp policy).
+  static Result<std::unique_ptr<IoUring>> Create(unsigned queue_depth);
+
+  /// Returns a process-wide ring, created on first use, or `nullptr` if
+  /// io_uring is not available.
+  static IoUring* GetShared();
+
+  /// Waits for all pending operations to complete.  Their callbacks may still
+  /// be running, or not yet have started, on their executors.
+  virtual ~IoUring();
+
+  /// Reads up to `size` bytes at `offset` from `fd` into `buffer`.
+  ///
+  /// As with `pread`, fewer than `size` bytes may be read.  `fd` and `buffer`
+  /// must remain valid until `callback` is invoked using `executor`.
+  virtual void Read(int fd, void* buffer, std::size_t size,
+                    std::int64_t offset, Executor executor,
+                    Callback callback) = 0;
+
+  /// Writes `value` to `fd` at `offset` and then, if it was written in full,
+  /// calls `fsync` on `fd`.
+  ///
+  /// `callback` is invoked using `executor` with the number of bytes written,
+  /// which may be less than `value.size()` (in which case `fsync` was not
+  /// called), or with the negated `errno` value if either the write or the
+  /// `fsync` failed.  `fd` must remain valid until `callback` is invoked.
+  virtual void WriteAndSync(int fd, absl::Cord value, std::int64_t offset,
+                            Executor executor, Callback callback) = 0;
+};
+
+}  // namespace internal_file_util
+}  // namespace tensorstore
+
+#endif  // __linux__
+
+#endif  // TENSORSTORE_KVSTORE_FILE_IO_URING_H_
@@ -0,0 +1,223 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifdef __linux__
+
+#include "tensorstore/kvstore/file/io_uring.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/cord.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/notification.h"
+#include "tensorstore/internal/test_util.h"
+#include "tensorstore/internal/thread.h"
+#include "tensorstore/internal/thread_pool.h"
+#include "tensorstore/util/executor.h"
+
+// Include system headers last to reduce impact of macros.
+#include <errno.h>
+#include <fcntl.h>
+
+namespace {
+
+using ::tensorstore::Executor;
+using ::tensorstore::InlineExecutor;
+using ::tensorstore::internal::ScopedTemporaryDirectory;
+using ::tensorstore::internal_file_util::IoUring;
+
+/// Creates a ring, or returns `nullptr` if io_uring is not available.
+std::unique_ptr<IoUring> CreateRing(unsigned queue_depth) {
+  auto ring = IoUring::Create(queue_depth);
+  if (!ring.ok()) return nullptr;
+  return std::move(*ring);
+}
+
+std::int64_t Read(IoUring& ring, int fd, std::string& buffer,
+                  std::int64_t offset) {
+  absl::Notification done;
+  std::int64_t result;
+  ring.Read(fd, buffer.data(), buffer.size(), offset, InlineExecutor{},
+            [&](std::int64_t n) {
+              result = n;
+              done.Notify();
+            });
+  done.WaitForNotification();
+  return result;
+}
+
+std::int64_t WriteAndSync(IoUring& ring, int fd, absl::Cord value) {
+  absl::Notification done;
+  std::int64_t result;
+  ring.WriteAndSync(fd, std::move(value), 0, InlineExecutor{},
+                    [&](std::int64_t n) {
+                      result = n;
+                      done.Notify();
+                    });
+  done.WaitForNotification();
+  return result;
+}
+
+class IoUringTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ring_ = CreateRing(4);
+    if (!ring_) GTEST_SKIP() << "io_uring is not available";
+    path_ = tempdir_.path() + "/file";
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    ASSERT_NE(-1, fd_);
+  }
+
+  void TearDown() override {
+    ring_.reset();
+    if (fd_ != -1) ::close(fd_);
+  }
+
+  ScopedTemporaryDirectory tempdir_;
+  std::unique_ptr<IoUring> ring_;
+  std::string path_;
+  int fd_ = -1;
+};
+
+TEST_F(IoUringTest, WriteAndRead) {
+  // Value with more chunks than can be written by a single `writev`.
+  absl::Cord value;
+  for (int i = 0; i < 2000; ++i) {
+    value.Append(absl::Cord(std::string(600, 'a' + i % 26)));
+  }
+  EXPECT_EQ(value.size(), WriteAndSync(*ring_, fd_, value));
+
+  std::string buffer(1000, '\0');
+  EXPECT_EQ(1000, Read(*ring_, fd_, buffer, 599));
+  EXPECT_EQ(std::string(value.Subcord(599, 1000)), buffer);
+
+  // Short read at the end of the file.
+  EXPECT_EQ(10, Read(*ring_, fd_, buffer, value.size() - 10));
+
+  // Empty value.
+  EXPECT_EQ(0, WriteAndSync(*ring_, fd_, absl::Cord()));
+}
+
+TEST_F(IoUringTest, Errors) {
+  std::string buffer(10, '\0');
+  EXPECT_EQ(-EBADF, Read(*ring_, -1, buffer, 0));
+
+  int read_only_fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  ASSERT_NE(-1, read_only_fd);
+  EXPECT_EQ(-EBADF, WriteAndSync(*ring_, read_only_fd, absl::Cord("abc")));
+  ::close(read_only_fd);
+}
+
+// Tests that more concurrent operations than the queue depth may be submitted,
+// including from completion callbacks.
+TEST_F(IoUringTest, ConcurrentReads) {
+  const std::string value(8192, 'x');
+  ASSERT_EQ(value.size(), WriteAndSync(*ring_, fd_, absl::Cord(value)));
+
+  constexpr int kNumThreads = 4;
+  constexpr int kNumReadsPerThread = 100;
+  constexpr int kNumReads = kNumThreads * kNumReadsPerThread;
+  std::vector<std::string> buffers(kNumReads, std::string(4096, '\0'));
+  std::vector<std::string> nested_buffers(kNumReads, std::string(1, '\0'));
+  std::vector<std::int64_t> results(kNumReads * 2);
+  absl::BlockingCounter remaining(kNumReads * 2);
+  Executor executor = tensorstore::internal::DetachedThreadPool(2);
+  std::vector<tensorstore::internal::Thread> threads;
+  for (int thread_i = 0; thread_i < kNumThreads; ++thread_i) {
+    threads.emplace_back(tensorstore::internal::Thread(
+        {"io_uring_test"}, [&, thread_i] {
+          for (int j = 0; j < kNumReadsPerThread; ++j) {
+            const int i = thread_i * kNumReadsPerThread + j;
+            ring_->Read(fd_, buffers[i].data(), buffers[i].size(), i, executor,
+                        [&, i](std::int64_t n) {
+                          results[i] = n;
+                          ring_->Read(fd_, nested_buffers[i].data(), 1, 0,
+                                      executor, [&, i](std::int64_t n) {
+                                        results[kNumReads + i] = n;
+                                        remaining.DecrementCount();
+                                      });
+                          remaining.DecrementCount();
+                        });
+          }
+        }));
+  }
+  for (auto& thread : threads) thread.Join();
+  remaining.Wait();
+  for (int i = 0; i < kNumReads; ++i) {
+    EXPECT_EQ(4096, results[i]);
+    EXPECT_EQ(std::string(4096, 'x'), buffers[i]);
+    EXPECT_EQ(1, results[kNumReads + i]);
+  }
+}
+
+// Tests that more concurrent writes than the queue depth may be submitted, each
+// followed by an `fsync` submitted from the completion thread.
+TEST_F(IoUringTest, ConcurrentWrites) {
+  constexpr int kNumWrites = 100;
+  constexpr int kSize = 10;
+  std::vector<std::int64_t> results(kNumWrites);
+  absl::BlockingCounter remaining(kNumWrites);
+  for (int i = 0; i < kNumWrites; ++i) {
+    ring_->WriteAndSync(fd_, absl::Cord(std::string(kSize, 'a' + i % 26)),
+                        i * kSize, InlineExecutor{}, [&, i](std::int64_t n) {
+                          results[i] = n;
+                          remaining.DecrementCount();
+                        });
+  }
+  remaining.Wait();
+  for (int i = 0; i < kNumWrites; ++i) {
+    EXPECT_EQ(kSize, results[i]);
+  }
+  std::string buffer(kNumWrites * kSize, '\0');
+  ASSERT_EQ(buffer.size(), Read(*ring_, fd_, buffer, 0));
+  for (int i = 0; i < kNumWrites; ++i) {
+    EXPECT_EQ(std::string(kSize, 'a' + i % 26),
+              buffer.substr(i * kSize, kSize));
+  }
+}
+
+// Tests that a blocking callback does not prevent other operations from
+// completing, since callbacks are invoked on their executor rather than on the
+// completion thread.
+TEST_F(IoUringTest, BlockingCallback) {
+  ASSERT_EQ(3, WriteAndSync(*ring_, fd_, absl::Cord("abc")));
+  Executor executor = tensorstore::internal::DetachedThreadPool(2);
+  std::string buffer1(3, '\0'), buffer2(3, '\0');
+  absl::Notification second_done;
+  absl::Notification first_done;
+  ring_->Read(fd_, buffer1.data(), buffer1.size(), 0, executor,
+              [&](std::int64_t n) {
+                EXPECT_EQ(3, n);
+                second_done.WaitForNotification();
+                first_done.Notify();
+              });
+  ring_->Read(fd_, buffer2.data(), buffer2.size(), 0, executor,
+              [&](std::int64_t n) {
+                EXPECT_EQ(3, n);
+                second_done.Notify();
+              });
+  first_done.WaitForNotification();
+  EXPECT_EQ("abc", buffer1);
+  EXPECT_EQ("abc", buffer2);
+}
+
+}  // namespace
+
+#endif  // __linux__
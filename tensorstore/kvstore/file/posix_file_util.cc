@@ -17,6 +17,7 @@
 #include "tensorstore/kvstore/file/posix_file_util.h"
 
 // More system headers
+#include <sys/mman.h>
 #include <sys/uio.h>
 #include <unistd.h>
 
@@ -77,6 +78,25 @@ std::ptrdiff_t WriteCordToFile(FileDescriptor fd, absl::Cord value) {
   return n;
 }
 
+bool MapFileRegion(FileDescriptor fd, std::int64_t offset, std::size_t size,
+                   absl::Cord* value) {
+  static const std::int64_t page_size = ::sysconf(_SC_PAGESIZE);
+  // `mmap` requires a page-aligned offset.
+  const std::size_t page_offset = static_cast<std::size_t>(offset % page_size);
+  const std::size_t map_size = size + page_offset;
+  void* addr;
+  {
+    PotentiallyBlockingRegion region;
+    addr = ::mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd,
+                  static_cast<off_t>(offset - page_offset));
+  }
+  if (addr == MAP_FAILED) return false;
+  *value = absl::MakeCordFromExternal(
+      std::string_view(static_cast<const char*>(addr) + page_offset, size),
+      [addr, map_size] { ::munmap(addr, map_size); });
+  return true;
+}
+
 bool FileLockTraits::Acquire(int fd) {
   PotentiallyBlockingRegion region;
   while (true) {
@@ -106,6 +126,25 @@ bool FileLockTraits::Acquire(int fd) {
   }
 }
 
+bool FileLockTraits::TryAcquire(int fd) {
+  PotentiallyBlockingRegion region;
+  while (true) {
+#ifdef __linux__
+    struct ::flock lock;
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    lock.l_start = 0;
+    lock.l_len = 0;
+    lock.l_pid = 0;
+    if (::fcntl(fd, 37 /*F_OFD_SETLK*/, &lock) == 0) return true;
+#else
+    if (::flock(fd, LOCK_EX | LOCK_NB) == 0) return true;
+#endif
+    if (errno == EINTR) continue;
+    return false;
+  }
+}
+
 void FileLockTraits::Close(int fd) {
   PotentiallyBlockingRegion region;
   // This releases a lock acquired above.
@@ -128,6 +128,13 @@ struct FileLockTraits {
   /// \returns `true` on success, or `false` in case of an error (in which case
   ///     `GetLastErrorCode()` retrieves the error).
   static bool Acquire(int fd);
+
+  /// Same as `Acquire`, but fails immediately rather than blocking if the lock
+  /// is held by another open file description.
+  ///
+  /// \returns `true` on success, or `false` in case of an error (in which case
+  ///     `GetLastErrorCode()` retrieves the error).
+  static bool TryAcquire(int fd);
 };
 
 /// Opens an file that must already exist for reading.
@@ -160,6 +167,22 @@ inline std::ptrdiff_t ReadFromFile(FileDescriptor fd, void* buf,
   return ::pread(fd, buf, count, static_cast<off_t>(offset));
 }
 
+/// Maps a region of an open file into memory for reading.
+///
+/// The returned Cord references the mapped pages directly, and the mapping is
+/// released when the last reference to the Cord data is destroyed.  The
+/// mapping remains valid if the file is subsequently renamed or deleted, but
+/// accessing it raises `SIGBUS` if the file is truncated.
+///
+/// \param fd Open file descriptor.
+/// \param offset Byte offset within file at which the region starts.
+/// \param size Size of the region, must be non-zero.
+/// \param value[out] Set to the mapped region on success.
+/// \returns `true` on success, `false` on error (in which case
+///     `GetLastErrorCode()` retrieves the error).
+bool MapFileRegion(FileDescriptor fd, std::int64_t offset, std::size_t size,
+                   absl::Cord* value);
+
 /// Writes to an open file.
 ///
 /// \param fd Open file descriptor.
@@ -193,6 +216,15 @@ std::ptrdiff_t WriteCordToFile(FileDescriptor fd, absl::Cord value);
 ///     `GetLastErrorCode()` retrieves the error).
 inline bool TruncateFile(FileDescriptor fd) { return ::ftruncate(fd, 0) == 0; }
 
+/// Truncates an open file to `size` bytes.  The file position is unspecified
+/// afterwards.
+///
+/// \returns `true` on success, or `false` in case of an error (in which case
+///     `GetLastErrorCode()` retrieves the error).
+inline bool TruncateFileTo(FileDescriptor fd, std::uint64_t size) {
+  return ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+}
+
 /// Renames an open file.
 ///
 /// \param fd The open file descriptor (ignored by POSIX implementation).
@@ -247,6 +279,14 @@ inline bool MakeDirectory(const char* path) {
 ///     retrieve the error).
 inline bool FsyncFile(FileDescriptor fd) { return ::fsync(fd) == 0; }
 
+#ifdef __linux__
+/// Syncs all files on the filesystem containing an open file or directory.
+///
+/// \returns `true` on success, `false` on error (call `GetLastErrorCode()` to
+///     retrieve the error).
+inline bool FsyncFilesystem(FileDescriptor fd) { return ::syncfs(fd) == 0; }
+#endif
+
 /// Syncs an open directory descriptor.
 ///
 /// \returns `true` on success, `false` on error (call `GetLastErrorCode()` to
@@ -142,6 +142,14 @@ bool MakeDirectory(const char* path) {
              converter.wc_str(), /*lpSecurityAttributes=*/nullptr)) ||
          ::GetLastError() == ERROR_ALREADY_EXISTS;
 }
+bool TruncateFileTo(FileDescriptor fd, std::uint64_t size) {
+  LARGE_INTEGER position;
+  position.QuadPart = static_cast<LONGLONG>(size);
+  return static_cast<bool>(::SetFilePointerEx(fd, position,
+                                              /*lpNewFilePointer=*/nullptr,
+                                              FILE_BEGIN)) &&
+         static_cast<bool>(::SetEndOfFile(fd));
+}
 bool FsyncFile(FileDescriptor fd) {
   return static_cast<bool>(::FlushFileBuffers(fd));
 }
@@ -288,6 +296,16 @@ bool FileLockTraits::Acquire(HANDLE handle) {
                       /*lpOverlapped=*/&lock_offset);
 }
 
+bool FileLockTraits::TryAcquire(HANDLE handle) {
+  auto lock_offset = GetLockOverlapped();
+  return ::LockFileEx(
+      handle, /*dwFlags=*/LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY,
+      /*dwReserved=*/0,
+      /*nNumberOfBytesToLockLow=*/1,
+      /*nNumberOfBytesToLockHigh=*/0,
+      /*lpOverlapped=*/&lock_offset);
+}
+
 bool DirectoryIterator::Entry::Delete(bool is_directory) const {
   if (is_directory) {
     WindowsPathConverter converter(path);
@@ -83,6 +83,7 @@ struct FileLockTraits {
   static const HANDLE Invalid() { return INVALID_HANDLE_VALUE; }
   static void Close(HANDLE handle);
   static bool Acquire(HANDLE handle);
+  static bool TryAcquire(HANDLE handle);
 };
 
 UniqueFileDescriptor OpenExistingFileForReading(std::string_view path);
@@ -99,6 +100,8 @@ inline bool TruncateFile(FileDescriptor fd) {
   return static_cast<bool>(::SetEndOfFile(fd));
 }
 
+bool TruncateFileTo(FileDescriptor fd, std::uint64_t size);
+
 bool RenameOpenFile(FileDescriptor fd, std::string_view old_name,
                     std::string_view new_name);
 
@@ -16,10 +16,14 @@
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <optional>
 
 #include "absl/base/call_once.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "tensorstore/context.h"
 #include "tensorstore/context_resource_provider.h"
 #include "tensorstore/internal/json_binding/json_binding.h"
@@ -36,10 +40,32 @@ namespace jb = tensorstore::internal_json_binding;
 namespace tensorstore {
 namespace internal_storage_gcs {
 
-AdmissionQueue::AdmissionQueue(size_t limit)
-    : limit_(limit == 0 ? std::numeric_limits<size_t>::max() : limit) {
+namespace {
+
+// Initial limit of an adaptive queue, which then grows by one for each
+// successful request until the first throttled request.
+constexpr double kInitialAdaptiveLimit = 4;
+
+// Factor by which the limit of an adaptive queue is reduced when a request is
+// throttled.
+constexpr double kDecreaseFactor = 0.5;
+
+// Weights of new samples in the short-term and long-term latency averages.
+constexpr double kShortLatencyWeight = 0.2;
+constexpr double kLongLatencyWeight = 0.02;
+
+// The limit does not grow while the short-term latency average exceeds the
+// long-term average by more than this factor.
+constexpr double kLatencyTolerance = 2;
+
+}  // namespace
+
+AdmissionQueue::AdmissionQueue(size_t limit, bool adaptive)
+    : limit_(limit == 0 ? std::numeric_limits<size_t>::max() : limit),
+      adaptive_(adaptive) {
   absl::MutexLock l(&mutex_);
   internal::intrusive_linked_list::Initialize(AdmissionAccessor{}, &head_);
+  window_ = std::min(kInitialAdaptiveLimit, static_cast<double>(limit_));
 }
 
 AdmissionQueue::~AdmissionQueue() {
@@ -47,6 +73,16 @@ AdmissionQueue::~AdmissionQueue() {
   assert(head_.next_ == &head_);
 }
 
+size_t AdmissionQueue::CurrentLimit() const {
+  if (!adaptive_) return limit_;
+  return std::clamp(static_cast<size_t>(window_), size_t(1), limit_);
+}
+
+size_t AdmissionQueue::limit() {
+  absl::MutexLock lock(&mutex_);
+  return CurrentLimit();
+}
+
 void AdmissionQueue::Admit(AdmissionNode* node, AdmissionNode::StartFn fn) {
   assert(node->next_ == nullptr);
   assert(node->prev_ == nullptr);
@@ -54,33 +90,80 @@ void AdmissionQueue::Admit(AdmissionNode* node, AdmissionNode::StartFn fn) {
 
   {
     absl::MutexLock lock(&mutex_);
-    if (in_flight_++ >= limit_) {
+    if (in_flight_ >= CurrentLimit()) {
       node->start_fn_ = fn;
       internal::intrusive_linked_list::InsertBefore(AdmissionAccessor{}, &head_,
                                                     node);
       return;
     }
+    in_flight_++;
   }
   fn(node);
 }
 
 void AdmissionQueue::Finish(AdmissionNode* node) {
-  AdmissionNode* next_node = nullptr;
   {
     absl::MutexLock lock(&mutex_);
     in_flight_--;
-    next_node = head_.next_;
-    if (next_node == &head_) return;
-    internal::intrusive_linked_list::Remove(AdmissionAccessor{}, next_node);
   }
+  StartQueued();
+}
+
+void AdmissionQueue::StartQueued() {
+  while (true) {
+    AdmissionNode* next_node = nullptr;
+    {
+      absl::MutexLock lock(&mutex_);
+      next_node = head_.next_;
+      if (next_node == &head_ || in_flight_ >= CurrentLimit()) return;
+      internal::intrusive_linked_list::Remove(AdmissionAccessor{}, next_node);
+      in_flight_++;
+    }
+
+    // Next node gets a chance to run after clearing admission queue state.
+    AdmissionNode::StartFn fn = next_node->start_fn_;
+    assert(fn != nullptr);
+    next_node->next_ = nullptr;
+    next_node->prev_ = nullptr;
+    next_node->start_fn_ = nullptr;
+    fn(next_node);
+  }
+}
 
-  // Next node gets a chance to run after clearing admission queue state.
-  AdmissionNode::StartFn fn = next_node->start_fn_;
-  assert(fn != nullptr);
-  next_node->next_ = nullptr;
-  next_node->prev_ = nullptr;
-  next_node->start_fn_ = nullptr;
-  fn(next_node);
+void AdmissionQueue::Report(Outcome outcome, absl::Time start_time,
+                            absl::Time now) {
+  if (!adaptive_) return;
+  {
+    absl::MutexLock lock(&mutex_);
+    switch (outcome) {
+      case Outcome::kThrottled:
+        if (start_time < last_decrease_) break;
+        last_decrease_ = now;
+        slow_start_ = false;
+        window_ = std::max(1.0, window_ * kDecreaseFactor);
+        break;
+      case Outcome::kError:
+        // Neither grow nor shrink on errors that may be unrelated to load.
+        break;
+      case Outcome::kSuccess: {
+        const absl::Duration latency = now - start_time;
+        if (long_latency_ == absl::ZeroDuration()) {
+          short_latency_ = long_latency_ = latency;
+        } else {
+          short_latency_ += (latency - short_latency_) * kShortLatencyWeight;
+          long_latency_ += (latency - long_latency_) * kLongLatencyWeight;
+        }
+        // Only grow while the limit is actually constraining the number of
+        // concurrent requests, and latency is not degrading.
+        if (in_flight_ < CurrentLimit() && head_.next_ == &head_) break;
+        if (short_latency_ > long_latency_ * kLatencyTolerance) break;
+        window_ += slow_start_ ? 1.0 : 1.0 / window_;
+        window_ = std::min(window_, static_cast<double>(limit_));
+        break;
+      }
+    }
+  }
+  StartQueued();
 }
 
 AdmissionQueueResource::AdmissionQueueResource(size_t shared_limit)
@@ -92,7 +175,9 @@ AdmissionQueueResource::JsonBinder() {
     return jb::Object(jb::Member(
         "limit",
         jb::Projection<&Spec::limit>(jb::DefaultInitializedValue(
-            jb::Optional(jb::Integer<size_t>(1), [] { return "shared"; })))))(
+            jb::Optional(jb::Integer<size_t>(1), [] { return "shared"; })))),
+        jb::Member("adaptive", jb::Projection<&Spec::adaptive>(
+                                   jb::DefaultInitializedValue())))(
         is_loading, options, obj, j);
   };
 }
@@ -102,14 +187,16 @@ Result<AdmissionQueueResource::Resource> AdmissionQueueResource::Create(
   Resource value;
   value.spec = spec;
   if (spec.limit) {
-    value.queue = std::make_shared<AdmissionQueue>(*spec.limit);
+    value.queue = std::make_shared<AdmissionQueue>(*spec.limit, spec.adaptive);
   } else {
-    absl::call_once(shared_once_, [&] {
-      TENSORSTORE_LOG("Using default AdmissionQueue with limit ",
-                      shared_limit_);
-      shared_queue_ = std::make_shared<AdmissionQueue>(shared_limit_);
+    const int i = spec.adaptive;
+    absl::call_once(shared_once_[i], [&] {
+      TENSORSTORE_LOG("Using default ", spec.adaptive ? "adaptive " : "",
+                      "AdmissionQueue with limit ", shared_limit_);
+      shared_queue_[i] =
+          std::make_shared<AdmissionQueue>(shared_limit_, spec.adaptive);
     });
-    value.queue = shared_queue_;
+    value.queue = shared_queue_[i];
   }
   return value;
 }
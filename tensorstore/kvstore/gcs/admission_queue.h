@@ -25,6 +25,8 @@
 #include "absl/base/call_once.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "tensorstore/context.h"
 #include "tensorstore/context_resource_provider.h"
 #include "tensorstore/internal/intrusive_linked_list.h"
@@ -59,8 +61,24 @@ using AdmissionAccessor = internal::intrusive_linked_list::MemberAccessor<
 
 class AdmissionQueue {
  public:
+  // Outcome of a request issued by an admitted task, used to adjust the limit
+  // of an adaptive queue.
+  enum class Outcome {
+    // The request completed, successfully or with an error unrelated to load.
+    kSuccess,
+    // The request failed with a transient error, such as a timeout, that may
+    // or may not be related to load.
+    kError,
+    // The server rejected the request due to load (e.g. HTTP 429 or 503).
+    kThrottled,
+  };
+
   // Create an admission queue with the given limit.
-  AdmissionQueue(size_t limit);
+  //
+  // If `adaptive` is true, the number of tasks admitted concurrently is
+  // adjusted between 1 and `limit` using additive-increase /
+  // multiplicative-decrease (AIMD) based on the outcomes passed to `Report`.
+  AdmissionQueue(size_t limit, bool adaptive = false);
   ~AdmissionQueue();
 
   // Admit a task node to the queue.  If the node is admitted, then the
@@ -72,11 +90,45 @@ class AdmissionQueue {
   // node will have it's start function invoked.
   void Finish(AdmissionNode* node);
 
+  // Reports the `outcome` of a request that was issued at `start_time` and
+  // completed at `now`.  Has no effect unless the queue is adaptive.
+  //
+  // Successful requests increase the limit, provided the queue is fully
+  // utilized and latency is not increasing, while throttled requests decrease
+  // it.
+  void Report(Outcome outcome, absl::Time start_time,
+              absl::Time now = absl::Now());
+
+  // Returns the current limit on the number of concurrently admitted tasks.
+  size_t limit();
+
  private:
+  size_t CurrentLimit() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Starts queued nodes while the number of admitted tasks is below the
+  // current limit.
+  void StartQueued();
+
   const size_t limit_;
+  const bool adaptive_;
   size_t in_flight_ = 0;
   absl::Mutex mutex_;
   AdmissionNode head_ ABSL_GUARDED_BY(mutex_);
+
+  // Adaptive state.
+
+  // Current congestion window, in the range `[1, limit_]`.
+  double window_ ABSL_GUARDED_BY(mutex_);
+  // Whether the window is still growing exponentially, i.e. no request has
+  // been throttled yet.
+  bool slow_start_ ABSL_GUARDED_BY(mutex_) = true;
+  // Time of the last decrease.  Requests issued before this time do not cause
+  // a further decrease, which limits decreases to one per round trip.
+  absl::Time last_decrease_ ABSL_GUARDED_BY(mutex_) = absl::InfinitePast();
+  // Short-term and long-term moving averages of the latency of successful
+  // requests.  Growth pauses while the short-term average is elevated.
+  absl::Duration short_latency_ ABSL_GUARDED_BY(mutex_);
+  absl::Duration long_latency_ ABSL_GUARDED_BY(mutex_);
 };
 
 /// Specifies an admission queue as a resource, compatible with a concurrency
@@ -88,13 +140,15 @@ struct AdmissionQueueResource {
   struct Spec {
     // If equal to `nullopt`, indicates that the shared executor is used.
     std::optional<size_t> limit;
+    // Indicates that `limit` is an upper bound on an adaptive limit.
+    bool adaptive = false;
   };
   struct Resource {
     Spec spec;
     std::shared_ptr<AdmissionQueue> queue;
   };
 
-  static Spec Default() { return Spec{std::nullopt}; }
+  static Spec Default() { return Spec{std::nullopt, false}; }
 
   static internal::AnyContextResourceJsonBinder<Spec> JsonBinder();
 
@@ -107,10 +161,11 @@ struct AdmissionQueueResource {
  private:
   /// Size of thread pool referenced by `shared_queue_`.
   size_t shared_limit_;
-  /// Protects initialization of `shared_queue_`.
-  mutable absl::once_flag shared_once_;
-  /// Lazily-initialized shared AdmissionQueue used by default spec.
-  mutable std::shared_ptr<AdmissionQueue> shared_queue_;
+  /// Protects initialization of `shared_queue_`, indexed by `Spec::adaptive`.
+  mutable absl::once_flag shared_once_[2];
+  /// Lazily-initialized shared AdmissionQueue used by default spec, indexed
+  /// by `Spec::adaptive`.
+  mutable std::shared_ptr<AdmissionQueue> shared_queue_[2];
 };
 
 }  // namespace internal_storage_gcs
@@ -0,0 +1,302 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/gcs/admission_queue.h"
+
+#include <stddef.h>
+
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/time/time.h"
+
+namespace {
+
+using ::tensorstore::internal_storage_gcs::AdmissionNode;
+using ::tensorstore::internal_storage_gcs::AdmissionQueue;
+using Outcome = AdmissionQueue::Outcome;
+
+/// Admits `num_nodes` nodes to a queue, and tracks which have been started.
+class AdmissionQueueTester {
+ public:
+  struct Node : public AdmissionNode {
+    AdmissionQueueTester* tester;
+  };
+
+  AdmissionQueueTester(AdmissionQueue& queue, size_t num_nodes)
+      : queue_(queue), nodes_(num_nodes) {
+    for (auto& node : nodes_) {
+      node.tester = this;
+      queue_.Admit(&node, &Start);
+    }
+  }
+
+  ~AdmissionQueueTester() {
+    while (!running_.empty()) FinishOne();
+  }
+
+  static void Start(void* node) {
+    auto* self = static_cast<Node*>(node);
+    self->tester->running_.push_back(self);
+    ++self->tester->started_;
+  }
+
+  void FinishOne() {
+    auto* node = running_.front();
+    running_.pop_front();
+    queue_.Finish(node);
+  }
+
+  size_t started() const { return started_; }
+  size_t running() const { return running_.size(); }
+
+ private:
+  AdmissionQueue& queue_;
+  std::vector<Node> nodes_;
+  std::deque<Node*> running_;
+  size_t started_ = 0;
+};
+
+const absl::Time kStart = absl::UnixEpoch();
+
+/// Simulates, using a fake clock, requests admitted by a queue and issued to a
+/// server that throttles requests beyond `capacity` concurrent requests.
+///
+/// As in the gcs driver, an admitted request is retried after a backoff while
+/// it remains admitted.
+class ThrottlingServerSimulator {
+ public:
+  struct Request : public AdmissionNode {
+    ThrottlingServerSimulator* simulator;
+    absl::Time start_time;
+  };
+
+  // Latency of successful requests.
+  static constexpr absl::Duration kLatency = absl::Milliseconds(5);
+  // Latency of throttled requests.
+  static constexpr absl::Duration kThrottledLatency = absl::Milliseconds(1);
+  // Delay before a throttled request is retried.
+  static constexpr absl::Duration kBackoff = absl::Milliseconds(1);
+
+  ThrottlingServerSimulator(AdmissionQueue& queue, size_t capacity)
+      : queue_(queue), capacity_(capacity) {}
+
+  /// Completes `num_requests` requests, and returns the number of throttled
+  /// attempts.
+  size_t Run(size_t num_requests) {
+    std::vector<Request> requests(num_requests);
+    for (auto& request : requests) {
+      request.simulator = this;
+      queue_.Admit(&request, &Start);
+      IssueStarted();
+    }
+    size_t completed = 0;
+    while (!events_.empty()) {
+      auto it = events_.begin();
+      now_ = it->first;
+      auto [type, request] = it->second;
+      events_.erase(it);
+      switch (type) {
+        case kComplete:
+          --active_;
+          ++completed;
+          queue_.Report(Outcome::kSuccess, request->start_time, now_);
+          queue_.Finish(request);
+          break;
+        case kThrottle:
+          ++throttled_;
+          queue_.Report(Outcome::kThrottled, request->start_time, now_);
+          events_.emplace(now_ + kBackoff, std::make_pair(kRetry, request));
+          break;
+        case kRetry:
+          Issue(request);
+          break;
+      }
+      IssueStarted();
+    }
+    EXPECT_EQ(num_requests, completed);
+    return throttled_;
+  }
+
+ private:
+  enum EventType { kComplete, kThrottle, kRetry };
+
+  static void Start(void* node) {
+    auto* request = static_cast<Request*>(node);
+    request->simulator->started_.push_back(request);
+  }
+
+  void IssueStarted() {
+    while (!started_.empty()) {
+      auto* request = started_.front();
+      started_.pop_front();
+      Issue(request);
+    }
+  }
+
+  void Issue(Request* request) {
+    request->start_time = now_;
+    if (active_ < capacity_) {
+      ++active_;
+      events_.emplace(now_ + kLatency, std::make_pair(kComplete, request));
+    } else {
+      events_.emplace(now_ + kThrottledLatency,
+                      std::make_pair(kThrottle, request));
+    }
+  }
+
+  AdmissionQueue& queue_;
+  const size_t capacity_;
+  absl::Time now_ = kStart;
+  size_t active_ = 0;
+  size_t throttled_ = 0;
+  std::deque<Request*> started_;
+  std::multimap<absl::Time, std::pair<EventType, Request*>> events_;
+};
+
+TEST(AdmissionQueueTest, Fixed) {
+  AdmissionQueue queue(2);
+  EXPECT_EQ(2, queue.limit());
+  AdmissionQueueTester tester(queue, 5);
+  EXPECT_EQ(2, tester.started());
+  tester.FinishOne();
+  EXPECT_EQ(3, tester.started());
+  EXPECT_EQ(2, tester.running());
+
+  // Reported outcomes have no effect.
+  queue.Report(Outcome::kThrottled, kStart, kStart + absl::Milliseconds(1));
+  EXPECT_EQ(2, queue.limit());
+}
+
+TEST(AdmissionQueueTest, AdaptiveSlowStart) {
+  AdmissionQueue queue(100, /*adaptive=*/true);
+  EXPECT_EQ(4, queue.limit());
+  AdmissionQueueTester tester(queue, 50);
+  EXPECT_EQ(4, tester.started());
+
+  // Each success increases the limit by one until the first throttled
+  // request, and starts a queued node.
+  for (int i = 0; i < 4; ++i) {
+    queue.Report(Outcome::kSuccess, kStart, kStart + absl::Milliseconds(10));
+  }
+  EXPECT_EQ(8, queue.limit());
+  EXPECT_EQ(8, tester.started());
+
+  // Errors neither increase nor decrease the limit.
+  queue.Report(Outcome::kError, kStart, kStart + absl::Milliseconds(10));
+  EXPECT_EQ(8, queue.limit());
+}
+
+TEST(AdmissionQueueTest, AdaptiveDecrease) {
+  AdmissionQueue queue(100, /*adaptive=*/true);
+  AdmissionQueueTester tester(queue, 50);
+  for (int i = 0; i < 12; ++i) {
+    queue.Report(Outcome::kSuccess, kStart, kStart + absl::Milliseconds(10));
+  }
+  EXPECT_EQ(16, queue.limit());
+
+  const absl::Time t1 = kStart + absl::Seconds(1);
+  queue.Report(Outcome::kThrottled, kStart, t1);
+  EXPECT_EQ(8, queue.limit());
+
+  // Requests issued before the last decrease do not decrease the limit again.
+  queue.Report(Outcome::kThrottled, t1 - absl::Milliseconds(1), t1);
+  EXPECT_EQ(8, queue.limit());
+
+  // Throttled requests are not started again until enough nodes finish.
+  EXPECT_EQ(16, tester.running());
+  tester.FinishOne();
+  EXPECT_EQ(15, tester.running());
+
+  const absl::Time t2 = t1 + absl::Seconds(1);
+  queue.Report(Outcome::kThrottled, t1, t2);
+  EXPECT_EQ(4, queue.limit());
+
+  for (int i = 0; i < 5; ++i) {
+    const absl::Time t = t2 + absl::Seconds(i + 1);
+    queue.Report(Outcome::kThrottled, t, t);
+  }
+  EXPECT_EQ(1, queue.limit());
+}
+
+TEST(AdmissionQueueTest, AdaptiveAdditiveIncrease) {
+  AdmissionQueue queue(100, /*adaptive=*/true);
+  AdmissionQueueTester tester(queue, 50);
+  for (int i = 0; i < 4; ++i) {
+    queue.Report(Outcome::kSuccess, kStart, kStart + absl::Milliseconds(10));
+  }
+  queue.Report(Outcome::kThrottled, kStart, kStart + absl::Seconds(1));
+  EXPECT_EQ(4, queue.limit());
+
+  // After the first throttled request, the limit grows by roughly one for
+  // each window of successful requests.
+  for (int i = 0; i < 4; ++i) {
+    queue.Report(Outcome::kSuccess, kStart, kStart + absl::Milliseconds(10));
+  }
+  EXPECT_EQ(4, queue.limit());
+  queue.Report(Outcome::kSuccess, kStart, kStart + absl::Milliseconds(10));
+  EXPECT_EQ(5, queue.limit());
+}
+
+TEST(AdmissionQueueTest, AdaptiveUpperBound) {
+  AdmissionQueue queue(6, /*adaptive=*/true);
+  AdmissionQueueTester tester(queue, 50);
+  for (int i = 0; i < 10; ++i) {
+    queue.Report(Outcome::kSuccess, kStart, kStart + absl::Milliseconds(10));
+  }
+  EXPECT_EQ(6, queue.limit());
+  EXPECT_EQ(6, tester.running());
+}
+
+TEST(AdmissionQueueTest, AdaptiveNoIncreaseWhenUnderutilized) {
+  AdmissionQueue queue(100, /*adaptive=*/true);
+  AdmissionQueueTester tester(queue, 2);
+  for (int i = 0; i < 10; ++i) {
+    queue.Report(Outcome::kSuccess, kStart, kStart + absl::Milliseconds(10));
+  }
+  EXPECT_EQ(4, queue.limit());
+}
+
+TEST(AdmissionQueueTest, AdaptiveNoIncreaseWhenLatencyIncreases) {
+  AdmissionQueue queue(100, /*adaptive=*/true);
+  AdmissionQueueTester tester(queue, 50);
+  queue.Report(Outcome::kSuccess, kStart, kStart + absl::Milliseconds(10));
+  EXPECT_EQ(5, queue.limit());
+  // A sustained latency increase pauses growth.
+  for (int i = 0; i < 10; ++i) {
+    queue.Report(Outcome::kSuccess, kStart, kStart + absl::Seconds(1));
+  }
+  EXPECT_EQ(5, queue.limit());
+}
+
+TEST(AdmissionQueueTest, AdaptiveReducesThrottling) {
+  AdmissionQueue fixed_queue(32);
+  const size_t fixed_throttled =
+      ThrottlingServerSimulator(fixed_queue, /*capacity=*/4).Run(200);
+
+  AdmissionQueue adaptive_queue(32, /*adaptive=*/true);
+  const size_t adaptive_throttled =
+      ThrottlingServerSimulator(adaptive_queue, /*capacity=*/4).Run(200);
+
+  EXPECT_LT(adaptive_throttled * 4, fixed_throttled)
+      << "adaptive_throttled=" << adaptive_throttled
+      << ", fixed_throttled=" << fixed_throttled;
+  // The limit settles near the capacity of the server.
+  EXPECT_GE(8, adaptive_queue.limit());
+}
+
+}  // namespace
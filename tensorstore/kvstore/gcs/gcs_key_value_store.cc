@@ -45,6 +45,7 @@
 #include "tensorstore/internal/http/http_request.h"
 #include "tensorstore/internal/http/http_response.h"
 #include "tensorstore/internal/http/http_transport.h"
+#include "tensorstore/internal/http/request_hedging.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/json_binding/bindable.h"
 #include "tensorstore/internal/json_binding/json_binding.h"
@@ -133,6 +134,10 @@ auto& gcs_read = internal_metrics::Counter<int64_t>::New(
 auto& gcs_write = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/kvstore/gcs/write", "GCS driver kvstore::Write calls");
 
+auto& gcs_composite_write = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/gcs/composite_write",
+    "GCS driver kvstore::Write calls uploaded as composed parts");
+
 auto& gcs_delete_range = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/kvstore/gcs/delete_range",
     "GCS driver kvstore::DeleteRange calls");
@@ -206,12 +211,89 @@ struct GcsRequestRetries : public internal::RetriesResource<GcsRequestRetries> {
   static constexpr char id[] = "gcs_request_retries";
 };
 
+/// Specifies whether slow reads are hedged with a duplicate request.
+struct GcsRequestHedging
+    : public internal_http::RequestHedgingResource<GcsRequestHedging> {
+  static constexpr char id[] = "gcs_request_hedging";
+};
+
+/// Specifies whether large writes are uploaded as parts in parallel, which
+/// are then combined into the destination object with the compose API.
+struct GcsCompositeUploadResource
+    : public internal::ContextResourceTraits<GcsCompositeUploadResource> {
+  static constexpr char id[] = "gcs_composite_upload";
+  struct Spec {
+    bool enabled = false;
+    // Minimum size, in bytes, of a value that is uploaded in parts.
+    size_t threshold = 64 * 1024 * 1024;
+    // Size, in bytes, of each part.
+    size_t part_size = 16 * 1024 * 1024;
+    // Prefix, within the bucket, of the names of the temporary part objects.
+    std::string temp_prefix = ".tensorstore-tmp/";
+  };
+  using Resource = Spec;
+  static Spec Default() { return {}; }
+  static constexpr auto JsonBinder() {
+    return jb::Object(
+        jb::Member("enabled",  //
+                   jb::Projection(&Spec::enabled, jb::DefaultValue([](auto* v) {
+                                    *v = Default().enabled;
+                                  }))),
+        jb::Member("threshold",  //
+                   jb::Projection(&Spec::threshold,
+                                  jb::DefaultValue(
+                                      [](auto* v) { *v = Default().threshold; },
+                                      jb::Integer<size_t>(1)))),
+        jb::Member("part_size",  //
+                   jb::Projection(&Spec::part_size,
+                                  jb::DefaultValue(
+                                      [](auto* v) { *v = Default().part_size; },
+                                      jb::Integer<size_t>(1)))),
+        jb::Member("temp_prefix",  //
+                   jb::Projection(&Spec::temp_prefix,
+                                  jb::DefaultValue([](auto* v) {
+                                    *v = Default().temp_prefix;
+                                  }))) /**/
+    );
+  }
+  static Result<Resource> Create(
+      const Spec& spec, internal::ContextResourceCreationContext context) {
+    return spec;
+  }
+  static Spec GetSpec(const Resource& resource,
+                      const internal::ContextSpecBuilder& builder) {
+    return resource;
+  }
+};
+
 const internal::ContextResourceRegistration<GcsAdmissionQueueResource>
     gcs_admission_queue_registration;
 const internal::ContextResourceRegistration<GcsUserProjectResource>
     gcs_user_project_registration;
 const internal::ContextResourceRegistration<GcsRequestRetries>
     gcs_request_retries_registration;
+const internal::ContextResourceRegistration<GcsRequestHedging>
+    gcs_request_hedging_registration;
+const internal::ContextResourceRegistration<GcsCompositeUploadResource>
+    gcs_composite_upload_registration;
+
+/// Returns a random 128-bit identifier, as a hex string.
+std::string MakeRandomId() {
+  struct RandomState {
+    absl::Mutex mutex;
+    absl::BitGen gen ABSL_GUARDED_BY(mutex);
+  };
+  static RandomState random_state;
+  uint64_t uuid[2];
+  {
+    absl::MutexLock lock(&random_state.mutex);
+    for (auto& x : uuid) {
+      x = absl::Uniform<uint64_t>(random_state.gen);
+    }
+  }
+  return tensorstore::StrCat(absl::Hex(uuid[0], absl::kZeroPad16),
+                             absl::Hex(uuid[1], absl::kZeroPad16));
+}
 
 /// Adds the generation query parameter to the provided url.
 bool AddGenerationParam(std::string* url, const bool has_query,
@@ -293,11 +375,13 @@ struct GcsKeyValueStoreSpecData {
   Context::Resource<GcsAdmissionQueueResource> admission_queue;
   Context::Resource<GcsUserProjectResource> user_project;
   Context::Resource<GcsRequestRetries> retries;
+  Context::Resource<GcsRequestHedging> hedging;
+  Context::Resource<GcsCompositeUploadResource> composite_upload;
   Context::Resource<DataCopyConcurrencyResource> data_copy_concurrency;
 
   constexpr static auto ApplyMembers = [](auto& x, auto f) {
     return f(x.bucket, x.admission_queue, x.user_project, x.retries,
-             x.data_copy_concurrency);
+             x.hedging, x.composite_upload, x.data_copy_concurrency);
   };
 
   constexpr static auto default_json_binder = jb::Object(
@@ -321,6 +405,10 @@ struct GcsKeyValueStoreSpecData {
                  jb::Projection<&GcsKeyValueStoreSpecData::user_project>()),
       jb::Member(GcsRequestRetries::id,
                  jb::Projection<&GcsKeyValueStoreSpecData::retries>()),
+      jb::Member(GcsRequestHedging::id,
+                 jb::Projection<&GcsKeyValueStoreSpecData::hedging>()),
+      jb::Member(GcsCompositeUploadResource::id,
+                 jb::Projection<&GcsKeyValueStoreSpecData::composite_upload>()),
       jb::Member(DataCopyConcurrencyResource::id,
                  jb::Projection<
                      &GcsKeyValueStoreSpecData::data_copy_concurrency>()) /**/
@@ -418,6 +506,30 @@ class GcsKeyValueStore
     return transport_->IssueRequest(request, payload);
   }
 
+  // Reports the outcome of a request issued at `start_time` to the admission
+  // queue, which adjusts its limit if adaptive.
+  void ReportResponse(absl::Time start_time,
+                      const Result<HttpResponse>& response) {
+    auto outcome = AdmissionQueue::Outcome::kSuccess;
+    if (!response.ok()) {
+      outcome = AdmissionQueue::Outcome::kError;
+    } else {
+      switch (response->status_code) {
+        case 429:  // Too Many Requests
+        case 503:  // Service Unavailable
+          outcome = AdmissionQueue::Outcome::kThrottled;
+          break;
+        case 408:  // Request Timeout
+        case 500:  // Internal Server Error
+        case 502:  // Bad Gateway
+        case 504:  // Gateway Timeout
+          outcome = AdmissionQueue::Outcome::kError;
+          break;
+      }
+    }
+    admission_queue().Report(outcome, start_time);
+  }
+
   // Apply default backoff/retry logic to the task.
   // Returns whether the task will be retried. On false, max retries have
   // been met or exceeded.  On true, `task->Retry()` will be scheduled to run
@@ -475,19 +587,7 @@ Future<kvstore::DriverPtr> GcsKeyValueStoreSpec::DoOpen() const {
 // As a workaround, specify a unique query parameter in every request.  That
 // ensures the cache is bypassed.
 void AddUniqueQueryParameterToDisableCaching(std::string& url) {
-  struct RandomState {
-    absl::Mutex mutex;
-    absl::BitGen gen ABSL_GUARDED_BY(mutex);
-  };
-  static RandomState random_state;
-  uint64_t uuid[2];
-  absl::MutexLock lock(&random_state.mutex);
-  for (auto& x : uuid) {
-    x = absl::Uniform<uint64_t>(random_state.gen);
-  }
-  tensorstore::StrAppend(&url,
-                         "&tensorstore=", absl::Hex(uuid[0], absl::kZeroPad16),
-                         absl::Hex(uuid[1], absl::kZeroPad16));
+  tensorstore::StrAppend(&url, "&tensorstore=", MakeRandomId());
 }
 
 ////////////////////////////////////////////////////
@@ -558,7 +658,11 @@ struct ReadTask : public AdmissionNode,
     }
     auto request = request_builder.EnableAcceptEncoding().BuildRequest();
     start_time_ = absl::Now();
-    auto future = owner->IssueRequest("ReadTask", request, {});
+    // Reads are idempotent, and may be hedged.
+    auto future = internal_http::IssueHedgedRequest(
+        owner->spec_.hedging->hedger, [owner = owner, request] {
+          return owner->IssueRequest("ReadTask", request, {});
+        });
     future.ExecuteWhenReady([self = IntrusivePtr<ReadTask>(this)](
                                 ReadyFuture<HttpResponse> response) {
       self->OnResponse(response.result());
@@ -566,6 +670,7 @@ struct ReadTask : public AdmissionNode,
   }
 
   void OnResponse(const Result<HttpResponse>& response) {
+    owner->ReportResponse(start_time_, response);
     if (!promise.result_needed()) {
       return;
     }
@@ -740,6 +845,7 @@ struct WriteTask : public AdmissionNode,
   }
 
   void OnResponse(const Result<HttpResponse>& response) {
+    owner->ReportResponse(start_time_, response);
     if (!promise.result_needed()) {
       return;
     }
@@ -812,6 +918,21 @@ struct WriteTask : public AdmissionNode,
   }
 };
 
+/// Admits a WriteTask which writes `value` to the object.
+Future<TimestampedStorageGeneration> StartWriteTask(
+    IntrusivePtr<GcsKeyValueStore> owner, std::string encoded_object_name,
+    absl::Cord value, kvstore::WriteOptions options) {
+  auto op = PromiseFuturePair<TimestampedStorageGeneration>::Make();
+  auto& admission_queue = owner->admission_queue();
+  auto state = internal::MakeIntrusivePtr<WriteTask>(
+      std::move(owner), std::move(encoded_object_name), std::move(value),
+      std::move(options), std::move(op.promise));
+
+  intrusive_ptr_increment(state.get());  // adopted by WriteTask::Start.
+  admission_queue.Admit(state.get(), &WriteTask::Start);
+  return std::move(op.future);
+}
+
 /// A DeleteTask is a function object used to satisfy a
 /// GcsKeyValueStore::Delete request.
 struct DeleteTask : public AdmissionNode,
@@ -877,6 +998,7 @@ struct DeleteTask : public AdmissionNode,
   }
 
   void OnResponse(const Result<HttpResponse>& response) {
+    owner->ReportResponse(start_time_, response);
     if (!promise.result_needed()) {
       return;
     }
@@ -931,6 +1053,356 @@ struct DeleteTask : public AdmissionNode,
   }
 };
 
+/// Admits a DeleteTask which removes the object.
+Future<TimestampedStorageGeneration> StartDeleteTask(
+    IntrusivePtr<GcsKeyValueStore> owner,
+    std::string_view encoded_object_name, kvstore::WriteOptions options) {
+  auto op = PromiseFuturePair<TimestampedStorageGeneration>::Make();
+  std::string resource = tensorstore::internal::JoinPath(
+      owner->resource_root(), "/o/", encoded_object_name);
+  auto& admission_queue = owner->admission_queue();
+  auto state = internal::MakeIntrusivePtr<DeleteTask>(
+      std::move(owner), std::move(resource), std::move(options),
+      std::move(op.promise));
+
+  intrusive_ptr_increment(state.get());  // adopted by DeleteTask::Start.
+  admission_queue.Admit(state.get(), &DeleteTask::Start);
+  return std::move(op.future);
+}
+
+/// A ComposeTask is a function object which concatenates source objects into
+/// a destination object.
+///
+/// https://cloud.google.com/storage/docs/json_api/v1/objects/compose
+struct ComposeTask : public AdmissionNode,
+                     public internal::AtomicReferenceCount<ComposeTask> {
+  IntrusivePtr<GcsKeyValueStore> owner;
+  std::string encoded_object_name;
+  // JSON request body, which specifies the source objects.
+  absl::Cord body;
+  kvstore::WriteOptions options;
+  Promise<TimestampedStorageGeneration> promise;
+
+  int attempt_ = 0;
+  absl::Time start_time_;
+
+  ComposeTask(IntrusivePtr<GcsKeyValueStore> owner,
+              std::string encoded_object_name, absl::Cord body,
+              kvstore::WriteOptions options,
+              Promise<TimestampedStorageGeneration> promise)
+      : owner(std::move(owner)),
+        encoded_object_name(std::move(encoded_object_name)),
+        body(std::move(body)),
+        options(std::move(options)),
+        promise(std::move(promise)) {}
+
+  ~ComposeTask() { owner->admission_queue().Finish(this); }
+
+  static void Start(void* task) {
+    auto* self = reinterpret_cast<ComposeTask*>(task);
+    self->owner->executor()(
+        [state = IntrusivePtr<ComposeTask>(self, internal::adopt_object_ref)] {
+          state->Retry();
+        });
+  }
+
+  /// Composes the source objects in GCS.
+  void Retry() {
+    if (!promise.result_needed()) {
+      return;
+    }
+    std::string compose_url = StrCat(owner->resource_root(), "/o/",
+                                     encoded_object_name, "/compose");
+
+    // Add the ifGenerationMatch condition for the destination object.
+    bool has_query = AddGenerationParam(&compose_url, false,
+                                        "ifGenerationMatch", options.if_equal);
+
+    // Assume that if the user_project field is set, that we want to provide
+    // it on the uri for a requestor pays bucket.
+    AddUserProjectParam(&compose_url, has_query, owner->encoded_user_project());
+
+    auto maybe_auth_header = owner->GetAuthHeader();
+    if (!maybe_auth_header.ok()) {
+      promise.SetResult(maybe_auth_header.status());
+      return;
+    }
+    HttpRequestBuilder request_builder("POST", compose_url);
+    if (maybe_auth_header.value().has_value()) {
+      request_builder.AddHeader(*maybe_auth_header.value());
+    }
+    auto request = request_builder  //
+                       .AddHeader("Content-Type: application/json")
+                       .AddHeader(StrCat("Content-Length: ", body.size()))
+                       .BuildRequest();
+    start_time_ = absl::Now();
+    auto future = owner->IssueRequest("ComposeTask", request, body);
+    future.ExecuteWhenReady([self = IntrusivePtr<ComposeTask>(this)](
+                                ReadyFuture<HttpResponse> response) {
+      self->OnResponse(response.result());
+    });
+  }
+
+  void OnResponse(const Result<HttpResponse>& response) {
+    owner->ReportResponse(start_time_, response);
+    if (!promise.result_needed()) {
+      return;
+    }
+    MaybeLogResponse("ComposeTask", response);
+    absl::Status status = [&]() -> absl::Status {
+      if (!response.ok()) return response.status();
+      if (response.value().status_code == 412) {
+        // Failed precondition implies the generation did not match.
+        return absl::OkStatus();
+      }
+      return HttpResponseCodeToStatus(response.value());
+    }();
+
+    if (!status.ok() && IsRetriable(status)) {
+      if (owner->BackoffForAttemptAsync(attempt_++, this)) {
+        return;
+      }
+      status =
+          absl::AbortedError(StrCat("All retry attempts failed: ", status));
+    }
+    if (!status.ok()) {
+      promise.SetResult(status);
+      return;
+    }
+
+    TimestampedStorageGeneration r;
+    r.time = start_time_;
+    if (response.value().status_code == 412) {
+      r.generation = StorageGeneration::Unknown();
+      promise.SetResult(std::move(r));
+      return;
+    }
+    auto payload = response.value().payload;
+    auto parsed_object_metadata = ParseObjectMetadata(payload.Flatten());
+    if (!parsed_object_metadata.ok()) {
+      promise.SetResult(parsed_object_metadata.status());
+      return;
+    }
+    r.generation =
+        StorageGeneration::FromUint64(parsed_object_metadata->generation);
+    promise.SetResult(std::move(r));
+  }
+};
+
+/// Admits a ComposeTask which composes the objects specified by `body` into
+/// the object.
+Future<TimestampedStorageGeneration> StartComposeTask(
+    IntrusivePtr<GcsKeyValueStore> owner, std::string encoded_object_name,
+    absl::Cord body, kvstore::WriteOptions options) {
+  auto op = PromiseFuturePair<TimestampedStorageGeneration>::Make();
+  auto& admission_queue = owner->admission_queue();
+  auto state = internal::MakeIntrusivePtr<ComposeTask>(
+      std::move(owner), std::move(encoded_object_name), std::move(body),
+      std::move(options), std::move(op.promise));
+
+  intrusive_ptr_increment(state.get());  // adopted by ComposeTask::Start.
+  admission_queue.Admit(state.get(), &ComposeTask::Start);
+  return std::move(op.future);
+}
+
+/// A CompositeWriteTask satisfies a GcsKeyValueStore::Write request for a
+/// large value by uploading parts of the value as temporary objects in
+/// parallel, composing the parts into the destination object, and finally
+/// deleting the parts.
+///
+/// Each part is uploaded with `ifGenerationMatch=0` and composed with a
+/// precondition on its generation, while `options.if_equal` is applied to
+/// the compose request, so the write has the same semantics as a single
+/// upload.  Since GCS responds to the compose request with 412 if either kind
+/// of precondition fails, the destination object is read to determine which
+/// one failed.
+struct CompositeWriteTask
+    : public internal::AtomicReferenceCount<CompositeWriteTask> {
+  IntrusivePtr<GcsKeyValueStore> owner;
+  std::string key;
+  std::string encoded_object_name;
+  kvstore::WriteOptions options;
+  Promise<TimestampedStorageGeneration> promise;
+
+  // Names of the temporary part objects.
+  std::vector<std::string> part_names;
+
+  // Number of part uploads, or part deletions, that have not completed.
+  std::atomic<size_t> remaining{0};
+
+  absl::Mutex mutex;
+  // First error encountered while uploading the parts.
+  absl::Status status ABSL_GUARDED_BY(mutex);
+  // Generations of the uploaded parts.  `std::nullopt` indicates that the
+  // part object was not created by this task, and must not be deleted.
+  std::vector<std::optional<StorageGeneration>> part_generations
+      ABSL_GUARDED_BY(mutex);
+  // Result of the write, which is set once the parts are deleted.
+  Result<TimestampedStorageGeneration> result{
+      TimestampedStorageGeneration::Unconditional()};
+
+  /// Uploads `value` as parts of `part_size` bytes.
+  void Start(const absl::Cord& value, size_t part_size) {
+    {
+      absl::MutexLock lock(&mutex);
+      part_generations.assign(part_names.size(), StorageGeneration::Unknown());
+    }
+    remaining = part_names.size();
+    for (size_t i = 0; i < part_names.size(); ++i) {
+      kvstore::WriteOptions part_options;
+      part_options.if_equal = StorageGeneration::NoValue();
+      StartWriteTask(owner,
+                     internal::PercentEncodeUriComponent(part_names[i]),
+                     value.Subcord(i * part_size, part_size),
+                     std::move(part_options))
+          .ExecuteWhenReady(
+              [self = IntrusivePtr<CompositeWriteTask>(this),
+               i](ReadyFuture<TimestampedStorageGeneration> future) {
+                self->OnPartWritten(i, future.result());
+              });
+    }
+  }
+
+  void OnPartWritten(size_t i,
+                     const Result<TimestampedStorageGeneration>& r) {
+    {
+      absl::MutexLock lock(&mutex);
+      if (!r.ok()) {
+        if (status.ok()) status = r.status();
+      } else if (StorageGeneration::IsUnknown(r->generation)) {
+        part_generations[i] = std::nullopt;
+        if (status.ok()) {
+          status = absl::AbortedError(StrCat(
+              "Temporary object ", QuoteString(part_names[i]),
+              " already exists"));
+        }
+      } else {
+        part_generations[i] = r->generation;
+      }
+    }
+    if (--remaining != 0) return;
+    absl::Status part_status;
+    {
+      absl::MutexLock lock(&mutex);
+      part_status = status;
+    }
+    if (!part_status.ok()) {
+      DeleteParts(std::move(part_status));
+    } else if (!promise.result_needed()) {
+      DeleteParts(absl::CancelledError());
+    } else {
+      Compose();
+    }
+  }
+
+  void Compose() {
+    ::nlohmann::json::array_t source_objects;
+    {
+      absl::MutexLock lock(&mutex);
+      for (size_t i = 0; i < part_names.size(); ++i) {
+        source_objects.push_back(
+            {{"name", part_names[i]},
+             {"objectPreconditions",
+              {{"ifGenerationMatch",
+                StrCat(StorageGeneration::ToUint64(*part_generations[i]))}}}});
+      }
+    }
+    ::nlohmann::json body{
+        {"sourceObjects", std::move(source_objects)},
+        {"destination", {{"contentType", "application/octet-stream"}}}};
+    auto future = StartComposeTask(owner, encoded_object_name,
+                                   absl::Cord(body.dump()), options);
+    future.ExecuteWhenReady(
+        [self = IntrusivePtr<CompositeWriteTask>(this)](
+            ReadyFuture<TimestampedStorageGeneration> future) {
+          self->OnComposed(future.result());
+        });
+  }
+
+  void OnComposed(Result<TimestampedStorageGeneration> r) {
+    if (!r.ok() || !StorageGeneration::IsUnknown(r->generation)) {
+      DeleteParts(std::move(r));
+      return;
+    }
+    if (StorageGeneration::IsUnknown(options.if_equal)) {
+      // Only the part preconditions were specified.
+      DeleteParts(PartPreconditionError());
+      return;
+    }
+    // The destination precondition held if the destination still has the
+    // generation `options.if_equal`.  Only the first byte is requested, since
+    // the value is not needed.
+    kvstore::ReadOptions read_options;
+    read_options.if_not_equal = options.if_equal;
+    read_options.byte_range = OptionalByteRangeRequest(0, 1);
+    owner->Read(key, std::move(read_options))
+        .ExecuteWhenReady([self = IntrusivePtr<CompositeWriteTask>(this),
+                           r = std::move(r)](
+                              ReadyFuture<kvstore::ReadResult> future) mutable {
+          auto& read_result = future.result();
+          if (read_result.ok() &&
+              read_result->stamp.generation == self->options.if_equal) {
+            self->DeleteParts(self->PartPreconditionError());
+          } else {
+            self->DeleteParts(std::move(r));
+          }
+        });
+  }
+
+  absl::Status PartPreconditionError() {
+    return absl::AbortedError(
+        StrCat("Temporary objects ", QuoteString(part_names.front()),
+               ", ... were modified or deleted before they were composed"));
+  }
+
+  /// Deletes the part objects, and then completes the write with `r`.
+  void DeleteParts(Result<TimestampedStorageGeneration> r) {
+    result = std::move(r);
+    std::vector<std::optional<StorageGeneration>> generations;
+    {
+      absl::MutexLock lock(&mutex);
+      generations = part_generations;
+    }
+    // The additional count is released below, once all deletions are issued.
+    remaining = part_names.size() + 1;
+    for (size_t i = 0; i < part_names.size(); ++i) {
+      if (!generations[i]) {
+        OnPartDeleted();
+        continue;
+      }
+      kvstore::WriteOptions part_options;
+      part_options.if_equal = std::move(*generations[i]);
+      StartDeleteTask(owner, internal::PercentEncodeUriComponent(part_names[i]),
+                      std::move(part_options))
+          .ExecuteWhenReady([self = IntrusivePtr<CompositeWriteTask>(this)](
+                                ReadyFuture<TimestampedStorageGeneration>) {
+            // A part that cannot be deleted does not affect the result.
+            self->OnPartDeleted();
+          });
+    }
+    OnPartDeleted();
+  }
+
+  void OnPartDeleted() {
+    if (--remaining != 0) return;
+    promise.SetResult(std::move(result));
+  }
+};
+
+/// Returns the number of parts, and the size of each part, in which a value
+/// of `size` bytes is uploaded by a CompositeWriteTask.
+std::pair<size_t, size_t> GetCompositeUploadParts(size_t size,
+                                                  size_t part_size) {
+  // Maximum number of source objects of a compose request.
+  constexpr size_t kMaxComposeSources = 32;
+  size_t num_parts = (size + part_size - 1) / part_size;
+  if (num_parts > kMaxComposeSources) {
+    part_size = (size + kMaxComposeSources - 1) / kMaxComposeSources;
+    num_parts = (size + part_size - 1) / part_size;
+  }
+  return {num_parts, part_size};
+}
+
 Future<TimestampedStorageGeneration> GcsKeyValueStore::Write(
     Key key, std::optional<Value> value, WriteOptions options) {
   gcs_write.Increment();
@@ -942,27 +1414,41 @@ Future<TimestampedStorageGeneration> GcsKeyValueStore::Write(
   }
 
   std::string encoded_object_name = internal::PercentEncodeUriComponent(key);
-  auto op = PromiseFuturePair<TimestampedStorageGeneration>::Make();
-
-  if (value) {
-    auto state = internal::MakeIntrusivePtr<WriteTask>(
-        IntrusivePtr<GcsKeyValueStore>(this), std::move(encoded_object_name),
-        std::move(*value), std::move(options), std::move(op.promise));
-
-    intrusive_ptr_increment(state.get());  // adopted by WriteTask::Start.
-    admission_queue().Admit(state.get(), &WriteTask::Start);
-  } else {
-    std::string resource = tensorstore::internal::JoinPath(
-        resource_root_, "/o/", encoded_object_name);
-
-    auto state = internal::MakeIntrusivePtr<DeleteTask>(
-        IntrusivePtr<GcsKeyValueStore>(this), std::move(resource),
-        std::move(options), std::move(op.promise));
+  if (!value) {
+    return StartDeleteTask(IntrusivePtr<GcsKeyValueStore>(this),
+                           encoded_object_name, std::move(options));
+  }
 
-    intrusive_ptr_increment(state.get());  // adopted by DeleteTask::Start.
-    admission_queue().Admit(state.get(), &DeleteTask::Start);
+  const auto& composite_upload = *spec_.composite_upload;
+  if (composite_upload.enabled &&
+      value->size() >= composite_upload.threshold &&
+      value->size() > composite_upload.part_size) {
+    // Parts are named with a random component to avoid conflicts, under a
+    // common prefix so that parts left behind by a failed write are not
+    // mistaken for keys, and may be removed by a bucket lifecycle rule.
+    auto [num_parts, part_size] =
+        GetCompositeUploadParts(value->size(), composite_upload.part_size);
+    const std::string part_prefix =
+        StrCat(composite_upload.temp_prefix, MakeRandomId(), "/");
+    if (IsValidObjectName(StrCat(part_prefix, num_parts - 1))) {
+      gcs_composite_write.Increment();
+      auto op = PromiseFuturePair<TimestampedStorageGeneration>::Make();
+      auto state = internal::MakeIntrusivePtr<CompositeWriteTask>();
+      state->owner = IntrusivePtr<GcsKeyValueStore>(this);
+      state->key = std::move(key);
+      state->encoded_object_name = std::move(encoded_object_name);
+      state->options = std::move(options);
+      state->promise = std::move(op.promise);
+      for (size_t i = 0; i < num_parts; ++i) {
+        state->part_names.push_back(StrCat(part_prefix, i));
+      }
+      state->Start(*value, part_size);
+      return std::move(op.future);
+    }
   }
-  return std::move(op.future);
+  return StartWriteTask(IntrusivePtr<GcsKeyValueStore>(this),
+                        std::move(encoded_object_name), std::move(*value),
+                        std::move(options));
 }
 
 // List responds with a Json payload that includes these fields.
@@ -992,6 +1478,7 @@ struct ListTask : public AdmissionNode,
   int attempt_ = 0;
   bool has_query_parameters_;
   std::atomic<bool> cancelled_{false};
+  absl::Time start_time_;
 
   ListTask(internal::IntrusivePtr<GcsKeyValueStore> owner, ListOptions options,
            AnyFlowReceiver<absl::Status, Key> receiver, std::string resource)
@@ -1064,6 +1551,7 @@ struct ListTask : public AdmissionNode,
       request_builder.AddHeader(auth_header->value());
     auto request = request_builder.BuildRequest();
 
+    start_time_ = absl::Now();
     auto future = owner_->IssueRequest("List", request, {});
     future.ExecuteWhenReady(WithExecutor(
         owner_->executor(), [self = IntrusivePtr<ListTask>(this)](
@@ -1073,6 +1561,7 @@ struct ListTask : public AdmissionNode,
   }
 
   void OnResponse(const Result<HttpResponse>& response) {
+    owner_->ReportResponse(start_time_, response);
     auto status = OnResponseImpl(response);
     // OkStatus are handled by OnResponseImpl
     if (absl::IsCancelled(status)) {
@@ -1222,6 +1711,10 @@ Result<kvstore::Spec> ParseGcsUrl(std::string_view url) {
       Context::Resource<GcsUserProjectResource>::DefaultSpec();
   driver_spec->data_.retries =
       Context::Resource<GcsRequestRetries>::DefaultSpec();
+  driver_spec->data_.hedging =
+      Context::Resource<GcsRequestHedging>::DefaultSpec();
+  driver_spec->data_.composite_upload =
+      Context::Resource<GcsCompositeUploadResource>::DefaultSpec();
   driver_spec->data_.data_copy_concurrency =
       Context::Resource<DataCopyConcurrencyResource>::DefaultSpec();
 
@@ -619,11 +619,13 @@ TEST(GcsKeyValueStoreTest, DeleteRangeCancellation) {
 
 class MyConcurrentMockTransport : public MyMockTransport {
  public:
-  void reset(std::size_t limit) {
+  void reset(std::size_t limit, std::size_t capacity = 0) {
     absl::MutexLock lock(&concurrent_request_mutex_);
     expected_concurrent_requests_ = limit;
     cur_concurrent_requests_ = 0;
     max_concurrent_requests_ = 0;
+    capacity_ = capacity;
+    throttled_requests_ = 0;
   }
 
   Future<HttpResponse> IssueRequest(const HttpRequest& request,
@@ -645,6 +647,13 @@ class MyConcurrentMockTransport : public MyMockTransport {
       ++cur_concurrent_requests_;
       max_concurrent_requests_ =
           std::max(max_concurrent_requests_, cur_concurrent_requests_);
+      // Simulate a server that throttles requests beyond its capacity.
+      if (capacity_ != 0 && cur_concurrent_requests_ > capacity_) {
+        --cur_concurrent_requests_;
+        ++throttled_requests_;
+        return tensorstore::MakeReadyFuture<HttpResponse>(
+            HttpResponse{429, absl::Cord()});
+      }
     }
 
     /// Schedule the completion 5ms in the future.
@@ -664,6 +673,8 @@ class MyConcurrentMockTransport : public MyMockTransport {
   std::size_t expected_concurrent_requests_ = 0;
   std::size_t cur_concurrent_requests_ = 0;
   std::size_t max_concurrent_requests_ = 0;
+  std::size_t capacity_ = 0;
+  std::size_t throttled_requests_ = 0;
   absl::Mutex concurrent_request_mutex_;
 };
 
@@ -701,6 +712,196 @@ TEST(GcsKeyValueStoreTest, Concurrency) {
   TestConcurrency(3);
 }
 
+TEST(GcsKeyValueStoreTest, AdaptiveConcurrency) {
+  auto mock_transport = std::make_shared<MyConcurrentMockTransport>();
+  DefaultHttpTransportSetter mock_transport_setter{mock_transport};
+
+  GCSMockStorageBucket bucket("my-bucket");
+  mock_transport->buckets_.push_back(&bucket);
+
+  // Requests to a server with a capacity of 4 concurrent requests are
+  // throttled, and retried.  The effect of the adaptive limit on the number of
+  // throttled requests is tested deterministically in admission_queue_test.cc.
+  constexpr size_t kLimit = 32;
+  mock_transport->reset(kLimit, /*capacity=*/4);
+  Context context{Context::Spec::FromJson(
+                      {{"gcs_request_retries",
+                        {{"max_retries", 1000},
+                         {"initial_delay", "1ms"},
+                         {"max_delay", "10ms"}}},
+                       {"gcs_request_concurrency",
+                        {{"limit", kLimit}, {"adaptive", true}}}})
+                      .value()};
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", kDriver}, {"bucket", "my-bucket"}}, context)
+          .result());
+
+  std::vector<tensorstore::Future<kvstore::ReadResult>> futures;
+  for (size_t i = 0; i < 200; ++i) {
+    futures.push_back(kvstore::Read(store, "abc"));
+  }
+  for (const auto& future : futures) {
+    TENSORSTORE_EXPECT_OK(future.result());
+  }
+  EXPECT_LE(mock_transport->max_concurrent_requests_, kLimit);
+}
+
+TEST(GcsKeyValueStoreTest, CompositeUpload) {
+  auto mock_transport = std::make_shared<MyMockTransport>();
+  DefaultHttpTransportSetter mock_transport_setter{mock_transport};
+
+  GCSMockStorageBucket bucket("my-bucket");
+  mock_transport->buckets_.push_back(&bucket);
+
+  Context context{Context::Spec::FromJson(
+                      {{"gcs_request_retries",
+                        {{"max_retries", 10},
+                         {"initial_delay", "1ms"},
+                         {"max_delay", "10ms"}}},
+                       {"gcs_composite_upload",
+                        {{"enabled", true},
+                         {"threshold", 100},
+                         {"part_size", 30}}}})
+                      .value()};
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", kDriver}, {"bucket", "my-bucket"}}, context)
+          .result());
+
+  // 1000 bytes exceeds 32 parts of 30 bytes, so 32 parts of 32 bytes are
+  // uploaded.
+  std::string value(1000, '\0');
+  for (size_t i = 0; i < value.size(); ++i) value[i] = 'a' + i % 26;
+
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp, kvstore::Write(store, "large", absl::Cord(value)).result());
+  EXPECT_TRUE(StorageGeneration::IsUint64(stamp.generation));
+  EXPECT_THAT(kvstore::Read(store, "large").result(),
+              tensorstore::internal::MatchesKvsReadResult(absl::Cord(value),
+                                                          stamp.generation));
+
+  // The temporary parts are deleted.
+  EXPECT_THAT(ListFuture(store, {}).result(),
+              ::testing::Optional(::testing::ElementsAre("large")));
+
+  // `if_equal` is applied to the composed object.
+  const std::string new_value(value.rbegin(), value.rend());
+  {
+    kvstore::WriteOptions options;
+    options.if_equal = StorageGeneration::NoValue();
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto new_stamp,
+        kvstore::Write(store, "large", absl::Cord(new_value), options)
+            .result());
+    EXPECT_TRUE(StorageGeneration::IsUnknown(new_stamp.generation));
+  }
+  {
+    kvstore::WriteOptions options;
+    options.if_equal = StorageGeneration::FromUint64(1);
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto new_stamp,
+        kvstore::Write(store, "large", absl::Cord(new_value), options)
+            .result());
+    EXPECT_TRUE(StorageGeneration::IsUnknown(new_stamp.generation));
+  }
+  EXPECT_THAT(kvstore::Read(store, "large").result(),
+              tensorstore::internal::MatchesKvsReadResult(absl::Cord(value),
+                                                          stamp.generation));
+  {
+    kvstore::WriteOptions options;
+    options.if_equal = stamp.generation;
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto new_stamp,
+        kvstore::Write(store, "large", absl::Cord(new_value), options)
+            .result());
+    EXPECT_NE(stamp.generation, new_stamp.generation);
+    EXPECT_THAT(kvstore::Read(store, "large").result(),
+                tensorstore::internal::MatchesKvsReadResult(
+                    absl::Cord(new_value), new_stamp.generation));
+  }
+  {
+    kvstore::WriteOptions options;
+    options.if_equal = StorageGeneration::NoValue();
+    TENSORSTORE_EXPECT_OK(
+        kvstore::Write(store, "other", absl::Cord(value), options).result());
+  }
+  EXPECT_THAT(ListFuture(store, {}).result(),
+              ::testing::Optional(
+                  ::testing::UnorderedElementsAre("large", "other")));
+}
+
+/// Transport that overwrites the first source object of the first compose
+/// request before it is issued.
+class ModifyPartMockTransport : public MyMockTransport {
+ public:
+  Future<HttpResponse> IssueRequest(const HttpRequest& request,
+                                    absl::Cord payload,
+                                    absl::Duration request_timeout,
+                                    absl::Duration connect_timeout) override {
+    if (absl::EndsWith(request.url(), "/compose") && part_name_.empty()) {
+      part_name_ = ::nlohmann::json::parse(std::string(payload))
+                       ["sourceObjects"][0]["name"]
+                           .get<std::string>();
+      auto upload = tensorstore::internal_http::HttpRequestBuilder(
+                        "POST",
+                        StrCat("https://storage.googleapis.com/upload/storage/"
+                               "v1/b/my-bucket/o?uploadType=media&name=",
+                               tensorstore::internal::PercentEncodeUriComponent(
+                                   part_name_)))
+                        .BuildRequest();
+      // Retry the throttling errors injected by the mock.
+      while (MyMockTransport::IssueRequest(upload, absl::Cord("x"),
+                                           request_timeout, connect_timeout)
+                 .value()
+                 .status_code != 200) {
+      }
+    }
+    return MyMockTransport::IssueRequest(request, payload, request_timeout,
+                                         connect_timeout);
+  }
+
+  std::string part_name_;
+};
+
+TEST(GcsKeyValueStoreTest, CompositeUploadPartModified) {
+  auto mock_transport = std::make_shared<ModifyPartMockTransport>();
+  DefaultHttpTransportSetter mock_transport_setter{mock_transport};
+
+  GCSMockStorageBucket bucket("my-bucket");
+  mock_transport->buckets_.push_back(&bucket);
+
+  Context context{Context::Spec::FromJson(
+                      {{"gcs_request_retries",
+                        {{"max_retries", 10},
+                         {"initial_delay", "1ms"},
+                         {"max_delay", "10ms"}}},
+                       {"gcs_composite_upload",
+                        {{"enabled", true},
+                         {"threshold", 100},
+                         {"part_size", 30},
+                         {"temp_prefix", "tmp/"}}}})
+                      .value()};
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", kDriver}, {"bucket", "my-bucket"}}, context)
+          .result());
+
+  // The failed part precondition is not reported as a failed `if_equal`
+  // condition, since the destination object does not exist.
+  kvstore::WriteOptions options;
+  options.if_equal = StorageGeneration::NoValue();
+  EXPECT_THAT(
+      kvstore::Write(store, "large", absl::Cord(std::string(1000, 'a')),
+                     options)
+          .result(),
+      MatchesStatus(absl::StatusCode::kAborted,
+                    "Temporary objects .* were modified or deleted .*"));
+  EXPECT_TRUE(absl::StartsWith(mock_transport->part_name_, "tmp/"));
+  EXPECT_THAT(kvstore::Read(store, "large").result(),
+              tensorstore::internal::MatchesKvsReadResultNotFound());
+}
+
 TEST(GcsKeyValueStoreTest, UrlRoundtrip) {
   tensorstore::internal::TestKeyValueStoreUrlRoundtrip(
       {{"driver", kDriver}, {"bucket", "my-bucket"}, {"path", "abc"}},
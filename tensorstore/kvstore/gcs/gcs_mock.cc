@@ -28,6 +28,7 @@
 #include "absl/strings/str_split.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/mutex.h"
+#include <nlohmann/json.hpp>
 #include "tensorstore/internal/http/curl_handle.h"
 #include "tensorstore/internal/http/http_request.h"
 #include "tensorstore/internal/http/http_response.h"
@@ -180,6 +181,13 @@ GCSMockStorageBucket::Match(const HttpRequest& request, absl::Cord payload) {
               R"({ "error": { "code": 400, "message": "Uploads must be sent to the upload URL." } })")};
     }
     return HandleInsertRequest(path, params, payload);
+  } else if (absl::StartsWith(path, "/o/") &&
+             absl::EndsWith(path, "/compose") && request.method() == "POST") {
+    // POST request to compose an object.
+    if (is_upload) {
+      return HttpResponse{404, absl::Cord()};
+    }
+    return HandleComposeRequest(path, params, payload);
   } else if (absl::StartsWith(path, "/o/") && request.method() == "GET") {
     // GET request on an object.
     return HandleGetRequest(path, params);
@@ -190,7 +198,6 @@ GCSMockStorageBucket::Match(const HttpRequest& request, absl::Cord payload) {
 
   // NOT HANDLED
   // update (PUT request)
-  // .../compose
   // .../watch
   // .../rewrite/...
   // patch (PATCH request)
@@ -311,6 +318,88 @@ GCSMockStorageBucket::HandleInsertRequest(std::string_view path,
   return HttpResponse{404, absl::Cord()};
 }
 
+std::variant<std::monostate, HttpResponse, absl::Status>
+GCSMockStorageBucket::HandleComposeRequest(std::string_view path,
+                                           const ParamMap& params,
+                                           absl::Cord payload) {
+  // https://cloud.google.com/storage/docs/json_api/v1/objects/compose
+  path.remove_prefix(3);  // remove /o/
+  path.remove_suffix(8);  // remove /compose
+  std::string name = internal::PercentDecode(path);
+
+  QueryParameters parsed_parameters;
+  {
+    auto parse_result = ParseQueryParameters(params, &parsed_parameters);
+    if (parse_result.has_value()) {
+      return std::move(parse_result.value());
+    }
+  }
+
+  auto body = ::nlohmann::json::parse(std::string(payload), nullptr,
+                                      /*allow_exceptions=*/false);
+  if (!body.is_object() || !body.contains("sourceObjects") ||
+      !body["sourceObjects"].is_array() || body["sourceObjects"].empty() ||
+      body["sourceObjects"].size() > 32) {
+    return HttpResponse{400, absl::Cord()};
+  }
+
+  absl::Cord data;
+  for (const auto& source : body["sourceObjects"]) {
+    if (!source.is_object() || !source.contains("name") ||
+        !source["name"].is_string()) {
+      return HttpResponse{400, absl::Cord()};
+    }
+    auto it = data_.find(source["name"].get<std::string>());
+    if (it == data_.end()) {
+      return HttpResponse{404, absl::Cord()};
+    }
+    if (source.contains("objectPreconditions")) {
+      const auto& preconditions = source["objectPreconditions"];
+      if (preconditions.is_object() &&
+          preconditions.contains("ifGenerationMatch")) {
+        // The generation is an int64, which is encoded as a string.
+        const auto& value = preconditions["ifGenerationMatch"];
+        std::int64_t v = 0;
+        if (!value.is_string() ||
+            !absl::SimpleAtoi(value.get<std::string>(), &v)) {
+          return HttpResponse{400, absl::Cord()};
+        }
+        if (v != it->second.generation) {
+          // generation does not match.
+          return HttpResponse{412, absl::Cord()};
+        }
+      }
+    }
+    data.Append(it->second.data);
+  }
+
+  auto it = data_.find(name);
+  if (parsed_parameters.ifGenerationMatch.has_value()) {
+    const std::int64_t v = parsed_parameters.ifGenerationMatch.value();
+    if (v == 0) {
+      if (it != data_.end()) {
+        // Live version => failure
+        return HttpResponse{412, absl::Cord()};
+      }
+      // No live versions => success;
+    } else if (it == data_.end() || v != it->second.generation) {
+      // generation does not match.
+      return HttpResponse{412, absl::Cord()};
+    }
+  }
+
+  auto& obj = data_[name];
+  if (obj.name.empty()) {
+    obj.name = std::move(name);
+  }
+  obj.generation = ++next_generation_;
+  obj.data = std::move(data);
+
+  TENSORSTORE_LOG("Composed: ", obj.name, " ", obj.generation);
+
+  return ObjectMetadataResponse(obj);
+}
+
 std::variant<std::monostate, HttpResponse, absl::Status>
 GCSMockStorageBucket::HandleGetRequest(std::string_view path,
                                        const ParamMap& params) {
@@ -81,6 +81,11 @@ class GCSMockStorageBucket {
   HandleInsertRequest(std::string_view path, const ParamMap& params,
                       absl::Cord payload);
 
+  // Compose source objects into an object.
+  std::variant<std::monostate, internal_http::HttpResponse, absl::Status>
+  HandleComposeRequest(std::string_view path, const ParamMap& params,
+                       absl::Cord payload);
+
   // Get an object, which might be the data or the metadata.
   std::variant<std::monostate, internal_http::HttpResponse, absl::Status>
   HandleGetRequest(std::string_view path, const ParamMap& params);
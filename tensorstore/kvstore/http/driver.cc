@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <memory>
 #include <optional>
@@ -22,6 +25,7 @@
 
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include <nlohmann/json.hpp>
@@ -36,6 +40,7 @@
 #include "tensorstore/internal/http/http_request.h"
 #include "tensorstore/internal/http/http_response.h"
 #include "tensorstore/internal/http/http_transport.h"
+#include "tensorstore/internal/http/request_hedging.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/json_binding/bindable.h"
 #include "tensorstore/internal/json_binding/json_binding.h"
@@ -55,6 +60,7 @@
 #include "tensorstore/util/future.h"
 #include "tensorstore/util/quote_string.h"
 #include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
 #include "tensorstore/util/status.h"
 #include "tensorstore/util/str_cat.h"
 
@@ -71,6 +77,43 @@ auto& http_bytes_read = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/kvstore/http/bytes_read",
     "Bytes read by the http kvstore driver");
 
+/// Maximum number of byte ranges in a single multi-range request.  Servers
+/// commonly reject or ignore requests with many ranges.
+constexpr std::size_t kMaxRangesPerRequest = 64;
+
+/// Returns `true` if `byte_range` is empty, in which case it cannot be
+/// specified in a Range header.
+bool IsEmptyByteRange(const OptionalByteRangeRequest& byte_range) {
+  return byte_range.exclusive_max == byte_range.inclusive_min;
+}
+
+/// Returns the ranges to request for the non-empty `byte_ranges`, coalescing
+/// ranges separated by at most `coalesce_gap` bytes, and additionally the
+/// closest remaining ranges until there are at most `kMaxRangesPerRequest`.
+std::vector<OptionalByteRangeRequest> GetRequestByteRanges(
+    span<const OptionalByteRangeRequest> byte_ranges,
+    std::uint64_t coalesce_gap) {
+  auto groups = internal::CoalesceByteRanges(byte_ranges, coalesce_gap);
+  if (groups.size() > kMaxRangesPerRequest) {
+    // Only the last group may be unbounded, since it would otherwise contain
+    // all of the following groups.
+    std::vector<std::uint64_t> gaps;
+    for (std::size_t i = 1; i < groups.size(); ++i) {
+      gaps.push_back(groups[i].byte_range.inclusive_min -
+                     *groups[i - 1].byte_range.exclusive_max);
+    }
+    auto max_gap = gaps.begin() + (groups.size() - kMaxRangesPerRequest - 1);
+    std::nth_element(gaps.begin(), max_gap, gaps.end());
+    groups = internal::CoalesceByteRanges(byte_ranges, *max_gap);
+  }
+  std::vector<OptionalByteRangeRequest> request_ranges;
+  request_ranges.reserve(groups.size());
+  for (const auto& group : groups) {
+    request_ranges.push_back(group.byte_range);
+  }
+  return request_ranges;
+}
+
 struct HttpRequestConcurrencyResource : public internal::ConcurrencyResource {
   static constexpr char id[] = "http_request_concurrency";
 };
@@ -93,6 +136,15 @@ const internal::ContextResourceRegistration<
 const internal::ContextResourceRegistration<HttpRequestRetries>
     http_request_retries_registration;
 
+/// Specifies whether slow reads are hedged with a duplicate request.
+struct HttpRequestHedging
+    : public internal_http::RequestHedgingResource<HttpRequestHedging> {
+  static constexpr char id[] = "http_request_hedging";
+};
+
+const internal::ContextResourceRegistration<HttpRequestHedging>
+    http_request_hedging_registration;
+
 /// Returns whether the absl::Status is a retriable request.
 bool IsRetriable(const absl::Status& status) {
   return (status.code() == absl::StatusCode::kDeadlineExceeded ||
@@ -129,10 +181,12 @@ struct HttpKeyValueStoreSpecData {
   std::string base_url;
   Context::Resource<HttpRequestConcurrencyResource> request_concurrency;
   Context::Resource<HttpRequestRetries> retries;
+  Context::Resource<HttpRequestHedging> hedging;
   std::vector<std::string> headers;
 
   constexpr static auto ApplyMembers = [](auto& x, auto f) {
-    return f(x.base_url, x.request_concurrency, x.retries, x.headers);
+    return f(x.base_url, x.request_concurrency, x.retries, x.hedging,
+             x.headers);
   };
 
   constexpr static auto default_json_binder = jb::Object(
@@ -152,7 +206,9 @@ struct HttpKeyValueStoreSpecData {
           HttpRequestConcurrencyResource::id,
           jb::Projection<&HttpKeyValueStoreSpecData::request_concurrency>()),
       jb::Member(HttpRequestRetries::id,
-                 jb::Projection<&HttpKeyValueStoreSpecData::retries>()));
+                 jb::Projection<&HttpKeyValueStoreSpecData::retries>()),
+      jb::Member(HttpRequestHedging::id,
+                 jb::Projection<&HttpKeyValueStoreSpecData::hedging>()));
 
   std::string GetUrl(std::string_view path) const {
     auto parsed = internal::ParseGenericUri(base_url);
@@ -201,6 +257,9 @@ class HttpKeyValueStore
  public:
   Future<ReadResult> Read(Key key, ReadOptions options) override;
 
+  Future<ReadRangesResult> ReadRanges(Key key,
+                                      ReadRangesOptions options) override;
+
   const Executor& executor() const {
     return spec_.request_concurrency->executor;
   }
@@ -233,42 +292,53 @@ Future<kvstore::DriverPtr> HttpKeyValueStoreSpec::DoOpen() const {
   return driver;
 }
 
-/// A ReadTask is a function object used to satisfy a
-/// HttpKeyValueStore::Read request.
-struct ReadTask {
+/// Common implementation of `ReadTask` and `ReadRangesTask`.
+struct ReadTaskBase {
   IntrusivePtr<HttpKeyValueStore> owner;
   std::string url;
-  kvstore::ReadOptions options;
-
-  Result<kvstore::ReadResult> operator()() {
-    kvstore::ReadResult read_result;
-
+  StorageGeneration if_not_equal;
+  absl::Time staleness_bound;
+  StorageGeneration if_equal;
+
+  /// Issues a GET request, including the `range_header` if not empty, or a
+  /// HEAD request if `head` is `true`.
+  ///
+  /// Sets `read_result.state` and `read_result.stamp` from the response, but
+  /// leaves `read_result.value` empty.  The returned response payload is only
+  /// meaningful if `read_result.state == kValue`.
+  Result<HttpResponse> IssueRequest(const std::string& range_header,
+                                    kvstore::ReadResult& read_result,
+                                    bool head = false) const {
     HttpResponse httpresponse;
     auto retry_status = owner->RetryRequestWithBackoff([&] {
-      HttpRequestBuilder request_builder("GET", url);
+      HttpRequestBuilder request_builder(head ? "HEAD" : "GET", url);
       for (const auto& header : owner->spec_.headers) {
         request_builder.AddHeader(header);
       }
-      internal_http::AddStalenessBoundCacheControlHeader(
-          request_builder, options.staleness_bound);
-      if (options.byte_range.inclusive_min != 0 ||
-          options.byte_range.exclusive_max) {
-        request_builder.AddHeader(
-            internal_http::GetRangeHeader(options.byte_range));
+      internal_http::AddStalenessBoundCacheControlHeader(request_builder,
+                                                         staleness_bound);
+      if (!range_header.empty()) {
+        request_builder.AddHeader(range_header);
       }
-      if (StorageGeneration::IsCleanValidValue(options.if_equal)) {
+      if (StorageGeneration::IsCleanValidValue(if_equal)) {
         request_builder.AddHeader(tensorstore::StrCat(
-            "if-match: \"", StorageGeneration::DecodeString(options.if_equal),
-            "\""));
+            "if-match: \"", StorageGeneration::DecodeString(if_equal), "\""));
       }
-      if (StorageGeneration::IsCleanValidValue(options.if_not_equal)) {
+      if (StorageGeneration::IsCleanValidValue(if_not_equal)) {
         request_builder.AddHeader(tensorstore::StrCat(
-            "if-none-match: \"",
-            StorageGeneration::DecodeString(options.if_not_equal), "\""));
+            "if-none-match: \"", StorageGeneration::DecodeString(if_not_equal),
+            "\""));
       }
       auto request = request_builder.EnableAcceptEncoding().BuildRequest();
       read_result.stamp.time = absl::Now();
-      auto response = owner->transport_->IssueRequest(request, {}).result();
+      // Reads are idempotent, and may be hedged.
+      auto response =
+          internal_http::IssueHedgedRequest(
+              owner->spec_.hedging->hedger,
+              [transport = owner->transport_, request] {
+                return transport->IssueRequest(request, {});
+              })
+              .result();
       if (!response.ok()) return GetStatus(response);
       httpresponse = std::move(*response);
       switch (httpresponse.status_code) {
@@ -299,13 +369,13 @@ struct ReadTask {
                                   tensorstore::QuoteString(date_it->second)));
         }
         if (response_date < read_result.stamp.time) {
-          if (options.staleness_bound < read_result.stamp.time &&
-              response_date < options.staleness_bound) {
+          if (staleness_bound < read_result.stamp.time &&
+              response_date < staleness_bound) {
             // `response_date` does not satisfy the `staleness_bound`
             // requirement, possibly due to time skew.  Due to the way we
             // compute `max-age` in the request header, in the case of time skew
             // it is correct to just use `staleness_bound` instead.
-            read_result.stamp.time = options.staleness_bound;
+            read_result.stamp.time = staleness_bound;
           } else {
             read_result.stamp.time = response_date;
           }
@@ -319,24 +389,20 @@ struct ReadTask {
         // Object not found.
         read_result.stamp.generation = StorageGeneration::NoValue();
         read_result.state = kvstore::ReadResult::kMissing;
-        return read_result;
+        return httpresponse;
       case 412:
         // "Failed precondition": indicates the If-Match condition did
         // not hold.
         read_result.stamp.generation = StorageGeneration::Unknown();
-        return read_result;
+        return httpresponse;
       case 304:
         // "Not modified": indicates that the If-None-Match condition did
         // not hold.
-        read_result.stamp.generation = options.if_not_equal;
-        return read_result;
+        read_result.stamp.generation = if_not_equal;
+        return httpresponse;
     }
 
-    TENSORSTORE_ASSIGN_OR_RETURN(
-        auto byte_range,
-        GetHttpResponseByteRange(httpresponse, options.byte_range));
     read_result.state = kvstore::ReadResult::kValue;
-    read_result.value = internal::GetSubCord(httpresponse.payload, byte_range);
 
     // Parse `ETag` header from response.
     {
@@ -354,15 +420,138 @@ struct ReadTask {
       }
     }
 
+    return httpresponse;
+  }
+};
+
+/// A ReadTask is a function object used to satisfy a
+/// HttpKeyValueStore::Read request.
+struct ReadTask : public ReadTaskBase {
+  OptionalByteRangeRequest byte_range;
+
+  Result<kvstore::ReadResult> operator()() const {
+    kvstore::ReadResult read_result;
+    if (IsEmptyByteRange(byte_range)) {
+      // Only the metadata is needed.
+      TENSORSTORE_ASSIGN_OR_RETURN(
+          auto httpresponse, IssueRequest({}, read_result, /*head=*/true));
+      if (!read_result.has_value()) return read_result;
+      auto it = httpresponse.headers.find("content-length");
+      std::uint64_t size;
+      if (it != httpresponse.headers.end() &&
+          absl::SimpleAtoi(it->second, &size)) {
+        TENSORSTORE_RETURN_IF_ERROR(byte_range.Validate(size));
+      }
+      return read_result;
+    }
+    std::string range_header;
+    if (byte_range.inclusive_min != 0 || byte_range.exclusive_max) {
+      range_header = internal_http::GetRangeHeader(byte_range);
+    }
+    TENSORSTORE_ASSIGN_OR_RETURN(auto httpresponse,
+                                 IssueRequest(range_header, read_result));
+    if (!read_result.has_value()) return read_result;
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        auto response_byte_range,
+        GetHttpResponseByteRange(httpresponse, byte_range));
+    read_result.value =
+        internal::GetSubCord(httpresponse.payload, response_byte_range);
     return read_result;
   }
 };
 
+/// A ReadRangesTask is a function object used to satisfy a
+/// HttpKeyValueStore::ReadRanges request with a single multi-range request.
+struct ReadRangesTask : public ReadTaskBase {
+  std::vector<OptionalByteRangeRequest> byte_ranges;
+  std::uint64_t coalesce_gap;
+
+  Result<kvstore::ReadRangesResult> operator()() const {
+    // Empty ranges cannot be specified in a Range header, and are satisfied
+    // locally.
+    std::vector<OptionalByteRangeRequest> nonempty_ranges;
+    for (const auto& byte_range : byte_ranges) {
+      if (!IsEmptyByteRange(byte_range)) nonempty_ranges.push_back(byte_range);
+    }
+    kvstore::ReadResult read_result;
+    if (nonempty_ranges.empty()) {
+      // Only the metadata is needed.
+      TENSORSTORE_RETURN_IF_ERROR(
+          IssueRequest({}, read_result, /*head=*/true).status());
+      kvstore::ReadRangesResult result;
+      result.state = read_result.state;
+      result.stamp = std::move(read_result.stamp);
+      if (result.has_value()) result.values.resize(byte_ranges.size());
+      return result;
+    }
+    auto request_ranges = GetRequestByteRanges(nonempty_ranges, coalesce_gap);
+    std::string range_header;
+    if (request_ranges.size() != 1 || request_ranges[0].inclusive_min != 0 ||
+        request_ranges[0].exclusive_max) {
+      range_header = internal_http::GetRangeHeader(request_ranges);
+    }
+    TENSORSTORE_ASSIGN_OR_RETURN(auto httpresponse,
+                                 IssueRequest(range_header, read_result));
+    kvstore::ReadRangesResult result;
+    result.state = read_result.state;
+    result.stamp = std::move(read_result.stamp);
+    if (!result.has_value()) return result;
+    // The server may return the ranges in any order, and may coalesce them
+    // further or return the entire value.
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        auto parts, internal_http::GetHttpResponseByteRangeParts(httpresponse));
+    result.values.reserve(byte_ranges.size());
+    for (const auto& byte_range : byte_ranges) {
+      if (IsEmptyByteRange(byte_range)) {
+        result.values.emplace_back();
+        continue;
+      }
+      absl::Status status = absl::UnknownError(tensorstore::StrCat(
+          "Requested byte range ", byte_range, " not returned by server"));
+      for (const auto& part : parts) {
+        auto value = internal::GetSubCordForRequest(
+            part.payload, part.byte_range, byte_range);
+        if (value.ok()) {
+          result.values.push_back(*std::move(value));
+          status = absl::OkStatus();
+          break;
+        }
+        // Prefer errors indicating that the request exceeds the value size.
+        if (!part.byte_range.exclusive_max) status = value.status();
+      }
+      TENSORSTORE_RETURN_IF_ERROR(status);
+    }
+    return result;
+  }
+};
+
 Future<kvstore::ReadResult> HttpKeyValueStore::Read(Key key,
                                                     ReadOptions options) {
-  std::string url = spec_.GetUrl(key);
-  return MapFuture(executor(), ReadTask{IntrusivePtr<HttpKeyValueStore>(this),
-                                        std::move(url), std::move(options)});
+  ReadTask task;
+  task.owner = IntrusivePtr<HttpKeyValueStore>(this);
+  task.url = spec_.GetUrl(key);
+  task.if_not_equal = std::move(options.if_not_equal);
+  task.staleness_bound = options.staleness_bound;
+  task.if_equal = std::move(options.if_equal);
+  task.byte_range = options.byte_range;
+  return MapFuture(executor(), std::move(task));
+}
+
+Future<kvstore::ReadRangesResult> HttpKeyValueStore::ReadRanges(
+    Key key, ReadRangesOptions options) {
+  if (options.byte_ranges.empty()) {
+    // A Range header cannot specify an empty set of byte ranges.
+    return Driver::ReadRanges(std::move(key), std::move(options));
+  }
+  ReadRangesTask task;
+  task.owner = IntrusivePtr<HttpKeyValueStore>(this);
+  task.url = spec_.GetUrl(key);
+  task.if_not_equal = std::move(options.if_not_equal);
+  task.staleness_bound = options.staleness_bound;
+  task.if_equal = std::move(options.if_equal);
+  task.byte_ranges = std::move(options.byte_ranges);
+  task.coalesce_gap = options.coalesce_gap;
+  return MapFuture(executor(), std::move(task));
 }
 
 Result<kvstore::Spec> ParseHttpUrl(std::string_view url) {
@@ -375,6 +564,8 @@ Result<kvstore::Spec> ParseHttpUrl(std::string_view url) {
       Context::Resource<HttpRequestConcurrencyResource>::DefaultSpec();
   driver_spec->data_.retries =
       Context::Resource<HttpRequestRetries>::DefaultSpec();
+  driver_spec->data_.hedging =
+      Context::Resource<HttpRequestHedging>::DefaultSpec();
   return {std::in_place, std::move(driver_spec), std::move(path)};
 }
 
@@ -12,6 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/time/time.h"
@@ -141,6 +145,175 @@ TEST_F(HttpKeyValueStoreTest, ReadByteRange) {
                                    StorageGeneration::Invalid()));
 }
 
+TEST_F(HttpKeyValueStoreTest, ReadRangesMultipart) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open("https://example.com/my/path/").result());
+  kvstore::ReadRangesOptions options;
+  options.byte_ranges = {{30, 35}, {10, 12}, {12, 15}, {40}};
+  options.coalesce_gap = 0;
+  auto read_future = kvstore::ReadRanges(store, "abc", options);
+  auto request = mock_transport->requests_.pop();
+  EXPECT_EQ("https://example.com/my/path/abc", request.request.url());
+  EXPECT_THAT(request.request.headers(),
+              ::testing::ElementsAre("cache-control: no-cache",
+                                     "Range: bytes=10-14,30-34,40-"));
+  request.promise.SetResult(
+      HttpResponse{206,
+                   absl::Cord("--B\r\n"
+                              "Content-Range: bytes 10-14/45\r\n\r\n"
+                              "abcde\r\n"
+                              "--B\r\n"
+                              "Content-Range: bytes 30-34/45\r\n\r\n"
+                              "fghij\r\n"
+                              "--B\r\n"
+                              "Content-Range: bytes 40-44/45\r\n\r\n"
+                              "klmno\r\n"
+                              "--B--\r\n"),
+                   {{"content-type", "multipart/byteranges; boundary=B"},
+                    {"etag", "\"xyz\""}}});
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto result, read_future.result());
+  EXPECT_TRUE(result.has_value());
+  EXPECT_EQ(StorageGeneration::FromString("xyz"), result.stamp.generation);
+  EXPECT_THAT(result.values,
+              ::testing::ElementsAre("fghij", "ab", "cde", "klmno"));
+}
+
+TEST_F(HttpKeyValueStoreTest, ReadRangesSingleRangeResponse) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open("https://example.com/my/path/").result());
+  kvstore::ReadRangesOptions options;
+  options.byte_ranges = {{10, 12}, {14, 15}};
+  auto read_future = kvstore::ReadRanges(store, "abc", options);
+  auto request = mock_transport->requests_.pop();
+  // The nearby ranges are coalesced into a single range.
+  EXPECT_THAT(
+      request.request.headers(),
+      ::testing::ElementsAre("cache-control: no-cache", "Range: bytes=10-14"));
+  request.promise.SetResult(HttpResponse{
+      206, absl::Cord("abcde"), {{"content-range", "bytes 10-14/50"}}});
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto result, read_future.result());
+  EXPECT_THAT(result.values, ::testing::ElementsAre("ab", "e"));
+}
+
+TEST_F(HttpKeyValueStoreTest, ReadRangesFullResponse) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open("https://example.com/my/path/").result());
+  kvstore::ReadRangesOptions options;
+  options.byte_ranges = {{1, 2}, {4}};
+  options.coalesce_gap = 0;
+  auto read_future = kvstore::ReadRanges(store, "abc", options);
+  auto request = mock_transport->requests_.pop();
+  EXPECT_THAT(request.request.headers(),
+              ::testing::ElementsAre("cache-control: no-cache",
+                                     "Range: bytes=1-1,4-"));
+  // Server ignores the Range header.
+  request.promise.SetResult(HttpResponse{200, absl::Cord("abcdef"), {}});
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto result, read_future.result());
+  EXPECT_THAT(result.values, ::testing::ElementsAre("b", "ef"));
+}
+
+TEST_F(HttpKeyValueStoreTest, ReadRangesEmptyRange) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open("https://example.com/my/path/").result());
+  kvstore::ReadRangesOptions options;
+  options.byte_ranges = {{1, 2}, {3, 3}, {4, 5}};
+  options.coalesce_gap = 0;
+  auto read_future = kvstore::ReadRanges(store, "abc", options);
+  auto request = mock_transport->requests_.pop();
+  // The empty range is not requested.
+  EXPECT_THAT(request.request.headers(),
+              ::testing::ElementsAre("cache-control: no-cache",
+                                     "Range: bytes=1-1,4-4"));
+  request.promise.SetResult(HttpResponse{200, absl::Cord("abcdef"), {}});
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto result, read_future.result());
+  EXPECT_THAT(result.values, ::testing::ElementsAre("b", "", "e"));
+}
+
+TEST_F(HttpKeyValueStoreTest, ReadRangesOnlyEmptyRanges) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open("https://example.com/my/path/").result());
+  kvstore::ReadRangesOptions options;
+  options.byte_ranges = {{3, 3}, {0, 0}};
+  auto read_future = kvstore::ReadRanges(store, "abc", options);
+  auto request = mock_transport->requests_.pop();
+  // Only the metadata is requested.
+  EXPECT_EQ("HEAD", request.request.method());
+  EXPECT_THAT(request.request.headers(),
+              ::testing::ElementsAre("cache-control: no-cache"));
+  request.promise.SetResult(
+      HttpResponse{200, absl::Cord(), {{"etag", "\"xyz\""}}});
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto result, read_future.result());
+  EXPECT_TRUE(result.has_value());
+  EXPECT_EQ(StorageGeneration::FromString("xyz"), result.stamp.generation);
+  EXPECT_THAT(result.values, ::testing::ElementsAre("", ""));
+}
+
+TEST_F(HttpKeyValueStoreTest, ReadRangesMaxRanges) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open("https://example.com/my/path/").result());
+  kvstore::ReadRangesOptions options;
+  // 100 ranges of 1 byte, separated by gaps of 1 byte, except for a larger gap
+  // after every other range.
+  std::string value;
+  std::uint64_t offset = 0;
+  for (int i = 0; i < 100; ++i) {
+    options.byte_ranges.push_back({offset, offset + 1});
+    value += static_cast<char>('a' + i % 26);
+    value += (i % 2 == 0) ? "-" : "-------";
+    offset = value.size();
+  }
+  options.coalesce_gap = 0;
+  auto read_future = kvstore::ReadRanges(store, "abc", options);
+  auto request = mock_transport->requests_.pop();
+  // Pairs of ranges separated by the smaller gap are coalesced, leaving 50
+  // ranges.
+  ASSERT_EQ(2, request.request.headers().size());
+  const std::string& range_header = request.request.headers()[1];
+  EXPECT_EQ(50, std::count(range_header.begin(), range_header.end(), ',') + 1);
+  request.promise.SetResult(HttpResponse{200, absl::Cord(value), {}});
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto result, read_future.result());
+  ASSERT_EQ(100, result.values.size());
+  EXPECT_EQ("z", result.values[25]);
+}
+
+TEST_F(HttpKeyValueStoreTest, ReadEmptyByteRange) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open("https://example.com/my/path/").result());
+  kvstore::ReadOptions options;
+  options.byte_range = {10, 10};
+  {
+    auto read_future = kvstore::Read(store, "abc", options);
+    auto request = mock_transport->requests_.pop();
+    EXPECT_EQ("HEAD", request.request.method());
+    request.promise.SetResult(
+        HttpResponse{200, absl::Cord(), {{"content-length", "20"}}});
+    EXPECT_THAT(read_future.result(),
+                MatchesKvsReadResult(absl::Cord(),
+                                     StorageGeneration::Invalid()));
+  }
+  {
+    auto read_future = kvstore::Read(store, "abc", options);
+    auto request = mock_transport->requests_.pop();
+    request.promise.SetResult(
+        HttpResponse{200, absl::Cord(), {{"content-length", "5"}}});
+    EXPECT_THAT(read_future.result(),
+                MatchesStatus(absl::StatusCode::kOutOfRange));
+  }
+}
+
+TEST_F(HttpKeyValueStoreTest, ReadRangesNotFound) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open("https://example.com/my/path/").result());
+  kvstore::ReadRangesOptions options;
+  options.byte_ranges = {{1, 2}};
+  auto read_future = kvstore::ReadRanges(store, "abc", options);
+  auto request = mock_transport->requests_.pop();
+  request.promise.SetResult(HttpResponse{404, absl::Cord()});
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto result, read_future.result());
+  EXPECT_TRUE(result.not_found());
+  EXPECT_THAT(result.values, ::testing::ElementsAre());
+}
+
 TEST_F(HttpKeyValueStoreTest, ReadWithStalenessBound) {
   TENSORSTORE_ASSERT_OK_AND_ASSIGN(
       auto store, kvstore::Open("https://example.com/my/path/").result());
@@ -268,6 +441,36 @@ TEST_F(HttpKeyValueStoreTest, RetryMax) {
   EXPECT_THAT(read_future.result(), MatchesStatus(absl::StatusCode::kAborted));
 }
 
+TEST_F(HttpKeyValueStoreTest, HedgedRead) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", "http"},
+                     {"base_url", "https://example.com/my/path/"},
+                     {"context",
+                      {{"http_request_hedging",
+                        {{"enabled", true},
+                         {"min_delay", "1ms"},
+                         {"max_extra_requests", 1}}}}}})
+          .result());
+
+  // Reads are not hedged until enough latencies have been recorded.
+  for (int i = 0; i < 16; ++i) {
+    auto read_future = kvstore::Read(store, "abc");
+    mock_transport->requests_.pop().promise.SetResult(
+        HttpResponse{200, absl::Cord("value")});
+    TENSORSTORE_ASSERT_OK(read_future.result());
+  }
+  EXPECT_TRUE(mock_transport->requests_.empty());
+
+  // A slow read is hedged, and the hedged response is used.
+  auto read_future = kvstore::Read(store, "abc");
+  auto original = mock_transport->requests_.pop();
+  auto hedge = mock_transport->requests_.pop();
+  EXPECT_EQ(original.request.url(), hedge.request.url());
+  hedge.promise.SetResult(HttpResponse{200, absl::Cord("hedged")});
+  EXPECT_THAT(read_future.result(), MatchesKvsReadResult(absl::Cord("hedged")));
+}
+
 TEST_F(HttpKeyValueStoreTest, Date) {
   TENSORSTORE_ASSERT_OK_AND_ASSIGN(
       auto store, kvstore::Open("https://example.com/my/path/").result());
@@ -14,6 +14,7 @@
 
 #include "tensorstore/kvstore/kvstore.h"
 
+#include <algorithm>
 #include <functional>
 #include <optional>
 #include <ostream>
@@ -32,6 +33,7 @@
 #include "tensorstore/internal/json_binding/json_binding.h"
 #include "tensorstore/internal/logging.h"
 #include "tensorstore/internal/no_destructor.h"
+#include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/driver.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/read_result.h"
@@ -50,6 +52,7 @@
 #include "tensorstore/util/future.h"
 #include "tensorstore/util/quote_string.h"
 #include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
 #include "tensorstore/util/status.h"
 #include "tensorstore/util/str_cat.h"
 
@@ -195,6 +198,21 @@ std::ostream& operator<<(std::ostream& os, const ReadResult& x) {
   }
   return os << "{value=" << value << ", stamp=" << x.stamp << "}";
 }
+
+std::ostream& operator<<(std::ostream& os, const ReadRangesResult& x) {
+  os << "{values=";
+  if (x.state == ReadResult::kValue) {
+    os << "[";
+    for (size_t i = 0; i < x.values.size(); ++i) {
+      if (i != 0) os << ", ";
+      os << tensorstore::QuoteString(absl::Cord(x.values[i]).Flatten());
+    }
+    os << "]";
+  } else {
+    os << x.state;
+  }
+  return os << ", stamp=" << x.stamp << "}";
+}
 }  // namespace kvstore
 
 namespace internal_kvstore {
@@ -304,6 +322,138 @@ Future<ReadResult> Driver::Read(Key key, ReadOptions options) {
   return absl::UnimplementedError("KeyValueStore does not support reading");
 }
 
+namespace {
+
+/// Shared state used by the default implementation of `Driver::ReadRanges`.
+struct CoalescedReadState
+    : public internal::AtomicReferenceCount<CoalescedReadState> {
+  DriverPtr driver;
+  Key key;
+  ReadRangesOptions options;
+  std::vector<internal::CoalescedByteRange> groups;
+};
+
+using CoalescedReadStatePtr = internal::IntrusivePtr<CoalescedReadState>;
+
+/// Assembles the result of a `ReadRanges` operation from the `ReadResult` of
+/// each coalesced group, which must all be consistent.
+Result<ReadRangesResult> CombineCoalescedReadResults(
+    const CoalescedReadState& state, span<const ReadResult> results) {
+  ReadRangesResult result;
+  result.state = results[0].state;
+  result.stamp = results[0].stamp;
+  for (const auto& r : results) {
+    result.stamp.time = std::min(result.stamp.time, r.stamp.time);
+  }
+  if (!result.has_value()) return result;
+  result.values.resize(state.options.byte_ranges.size());
+  for (size_t group_i = 0; group_i < state.groups.size(); ++group_i) {
+    const auto& group = state.groups[group_i];
+    for (size_t i : group.request_indices) {
+      TENSORSTORE_ASSIGN_OR_RETURN(
+          result.values[i],
+          internal::GetSubCordForRequest(results[group_i].value,
+                                         group.byte_range,
+                                         state.options.byte_ranges[i]));
+    }
+  }
+  return result;
+}
+
+/// Issues a `Read` for each coalesced group.
+///
+/// Since the groups are read independently, the stored value may change
+/// between reads.  In that case the reads are retried conditioned on the most
+/// recent generation observed.
+///
+/// \param state The shared state.
+/// \param pinned_generation Generation to which the reads are conditioned in
+///     addition to `state->options.if_equal`, or
+///     `StorageGeneration::Unknown()` for the initial attempt.
+Future<ReadRangesResult> ReadCoalescedGroups(
+    CoalescedReadStatePtr state, StorageGeneration pinned_generation) {
+  const auto& options = state->options;
+  std::vector<Future<ReadResult>> futures;
+  std::vector<AnyFuture> any_futures;
+  futures.reserve(state->groups.size());
+  any_futures.reserve(state->groups.size());
+  for (const auto& group : state->groups) {
+    ReadOptions read_options;
+    read_options.if_not_equal = options.if_not_equal;
+    read_options.staleness_bound = options.staleness_bound;
+    read_options.if_equal = StorageGeneration::IsUnknown(pinned_generation)
+                                ? options.if_equal
+                                : pinned_generation;
+    read_options.byte_range = group.byte_range;
+    futures.push_back(state->driver->Read(state->key, std::move(read_options)));
+    any_futures.push_back(futures.back());
+  }
+  return MapFuture(
+      InlineExecutor{},
+      [state = std::move(state), futures = std::move(futures),
+       pinned_generation = std::move(pinned_generation)](
+          const Result<void>& ready) -> Future<ReadRangesResult> {
+        if (!ready.ok()) return ready.status();
+        std::vector<ReadResult> results;
+        results.reserve(futures.size());
+        for (const auto& future : futures) {
+          results.push_back(future.value());
+        }
+        const auto& options = state->options;
+        const ReadResult* newest = &results[0];
+        bool consistent = true;
+        for (const auto& r : results) {
+          if (r.stamp.time > newest->stamp.time) newest = &r;
+          if (r.state != results[0].state ||
+              (r.has_value() &&
+               r.stamp.generation != results[0].stamp.generation)) {
+            consistent = false;
+          }
+        }
+        const bool pinned = !StorageGeneration::IsUnknown(pinned_generation);
+        if (consistent) {
+          // An abort caused by the pinned generation, rather than by the
+          // conditions in `options`, indicates that the value changed again.
+          if (!pinned || !results[0].aborted() ||
+              pinned_generation == options.if_not_equal) {
+            return CombineCoalescedReadResults(*state, results);
+          }
+        } else if (!StorageGeneration::IsUnknown(options.if_equal)) {
+          // The value changed, so it cannot match `options.if_equal` for all
+          // groups.
+          ReadRangesResult result;
+          result.stamp = newest->stamp;
+          if (!newest->aborted()) {
+            result.stamp.generation = StorageGeneration::Unknown();
+          }
+          return result;
+        }
+        if (pinned) {
+          return ReadCoalescedGroups(std::move(state),
+                                     StorageGeneration::Unknown());
+        }
+        return ReadCoalescedGroups(std::move(state), newest->stamp.generation);
+      },
+      WaitAllFuture(any_futures));
+}
+
+}  // namespace
+
+Future<ReadRangesResult> Driver::ReadRanges(Key key,
+                                            ReadRangesOptions options) {
+  auto state = internal::MakeIntrusivePtr<CoalescedReadState>();
+  state->driver.reset(this);
+  state->key = std::move(key);
+  state->groups =
+      internal::CoalesceByteRanges(options.byte_ranges, options.coalesce_gap);
+  if (state->groups.empty()) {
+    // Still read to determine the state and generation.
+    state->groups.emplace_back().byte_range = OptionalByteRangeRequest(0, 0);
+  }
+  state->options = std::move(options);
+  return ReadCoalescedGroups(std::move(state), StorageGeneration::Unknown());
+}
+
 Future<TimestampedStorageGeneration> Driver::Write(Key key,
                                                    std::optional<Value> value,
                                                    WriteOptions options) {
@@ -437,6 +587,22 @@ Future<ReadResult> Read(const KvStore& store, std::string_view key,
       std::move(transactional_read_options));
 }
 
+Future<ReadRangesResult> ReadRanges(const KvStore& store, std::string_view key,
+                                    ReadRangesOptions options) {
+  if (store.transaction != no_transaction) {
+    return absl::UnimplementedError(
+        "ReadRanges not supported for transactional reads");
+  }
+  for (const auto& byte_range : options.byte_ranges) {
+    if (!byte_range.SatisfiesInvariants()) {
+      return absl::InvalidArgumentError(
+          tensorstore::StrCat("Invalid byte range: ", byte_range));
+    }
+  }
+  return store.driver->ReadRanges(tensorstore::StrCat(store.path, key),
+                                  std::move(options));
+}
+
 Future<TimestampedStorageGeneration> Write(const KvStore& store,
                                            std::string_view key,
                                            std::optional<Value> value,
@@ -0,0 +1,206 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/log_structured/log_format.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/base/internal/endian.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_format.h"
+#include "tensorstore/util/result.h"
+
+// Include zlib header last because it defines a bunch of poorly-named macros.
+#include <zlib.h>
+
+namespace tensorstore {
+namespace internal_log_structured {
+namespace {
+
+constexpr std::uint32_t kRecordMagic = 0x4c535231;
+constexpr std::uint32_t kCheckpointMagic = 0x4c534331;
+constexpr std::string_view kSegmentFilePrefix = "segment-";
+
+/// Size of the fixed-size portion of a checkpoint, excluding the checksum.
+constexpr std::size_t kCheckpointHeaderSize = 36;
+
+std::uint32_t ComputeCrc32(std::uint32_t crc, std::string_view data) {
+  // `crc32` takes a 32-bit length; process large inputs in pieces.
+  while (!data.empty()) {
+    const std::size_t n =
+        std::min(data.size(), static_cast<std::size_t>(1) << 30);
+    crc = ::crc32(crc, reinterpret_cast<const Bytef*>(data.data()),
+                  static_cast<uInt>(n));
+    data.remove_prefix(n);
+  }
+  return crc;
+}
+
+std::uint32_t ComputeCrc32(std::uint32_t crc, const absl::Cord& data) {
+  for (std::string_view chunk : data.Chunks()) {
+    crc = ComputeCrc32(crc, chunk);
+  }
+  return crc;
+}
+
+void AppendUint32(std::string& out, std::uint32_t value) {
+  char buf[4];
+  absl::little_endian::Store32(buf, value);
+  out.append(buf, 4);
+}
+
+void AppendUint64(std::string& out, std::uint64_t value) {
+  char buf[8];
+  absl::little_endian::Store64(buf, value);
+  out.append(buf, 8);
+}
+
+}  // namespace
+
+absl::Cord EncodeRecord(RecordType type, std::string_view key,
+                        std::uint64_t generation, const absl::Cord& value) {
+  std::string header(kRecordHeaderSize, '\0');
+  char* p = header.data();
+  absl::little_endian::Store32(p, kRecordMagic);
+  p[8] = static_cast<char>(type);
+  absl::little_endian::Store32(p + 9, static_cast<std::uint32_t>(key.size()));
+  absl::little_endian::Store64(p + 13, generation);
+  absl::little_endian::Store64(p + 21, value.size());
+  std::uint32_t crc = ComputeCrc32(0, std::string_view(p + 8, 21));
+  crc = ComputeCrc32(crc, key);
+  crc = ComputeCrc32(crc, value);
+  absl::little_endian::Store32(p + 4, crc);
+  header.append(key);
+  absl::Cord record(std::move(header));
+  record.Append(value);
+  return record;
+}
+
+std::optional<DecodedRecord> DecodeRecord(std::string_view data,
+                                          std::uint64_t offset) {
+  if (offset > data.size() || data.size() - offset < kRecordHeaderSize) {
+    return std::nullopt;
+  }
+  const char* p = data.data() + offset;
+  if (absl::little_endian::Load32(p) != kRecordMagic) return std::nullopt;
+  DecodedRecord record;
+  record.type = static_cast<RecordType>(p[8]);
+  if (record.type != RecordType::kValue &&
+      record.type != RecordType::kDeletion) {
+    return std::nullopt;
+  }
+  const std::uint64_t key_size = absl::little_endian::Load32(p + 9);
+  record.generation = absl::little_endian::Load64(p + 13);
+  record.value_size = absl::little_endian::Load64(p + 21);
+  const std::uint64_t available = data.size() - offset - kRecordHeaderSize;
+  if (key_size > available || record.value_size > available - key_size) {
+    return std::nullopt;
+  }
+  if (record.type == RecordType::kDeletion && record.value_size != 0) {
+    return std::nullopt;
+  }
+  record.record_size = kRecordHeaderSize + key_size + record.value_size;
+  if (ComputeCrc32(0, std::string_view(p + 8, record.record_size - 8)) !=
+      absl::little_endian::Load32(p + 4)) {
+    return std::nullopt;
+  }
+  record.key = std::string_view(p + kRecordHeaderSize, key_size);
+  record.value_offset = offset + kRecordHeaderSize + key_size;
+  return record;
+}
+
+std::string EncodeCheckpoint(const CheckpointHeader& header,
+                             const Index& index) {
+  std::string out;
+  AppendUint32(out, kCheckpointMagic);
+  AppendUint64(out, header.next_generation);
+  AppendUint64(out, header.replay_segment_id);
+  AppendUint64(out, header.replay_offset);
+  AppendUint64(out, index.size());
+  for (const auto& [key, entry] : index) {
+    AppendUint32(out, static_cast<std::uint32_t>(key.size()));
+    out.append(key);
+    AppendUint64(out, entry.generation);
+    AppendUint64(out, entry.segment_id);
+    AppendUint64(out, entry.value_offset);
+    AppendUint64(out, entry.value_size);
+  }
+  AppendUint32(out, ComputeCrc32(0, out));
+  return out;
+}
+
+Result<Checkpoint> DecodeCheckpoint(std::string_view data) {
+  const auto corrupt = [] {
+    return absl::DataLossError("Invalid log_structured checkpoint");
+  };
+  if (data.size() < kCheckpointHeaderSize + 4) return corrupt();
+  const std::string_view body = data.substr(0, data.size() - 4);
+  if (ComputeCrc32(0, body) !=
+      absl::little_endian::Load32(data.data() + body.size())) {
+    return corrupt();
+  }
+  const char* p = body.data();
+  if (absl::little_endian::Load32(p) != kCheckpointMagic) return corrupt();
+  Checkpoint checkpoint;
+  checkpoint.header.next_generation = absl::little_endian::Load64(p + 4);
+  checkpoint.header.replay_segment_id = absl::little_endian::Load64(p + 12);
+  checkpoint.header.replay_offset = absl::little_endian::Load64(p + 20);
+  std::uint64_t num_entries = absl::little_endian::Load64(p + 28);
+  std::size_t pos = kCheckpointHeaderSize;
+  for (; num_entries > 0; --num_entries) {
+    if (body.size() - pos < 4) return corrupt();
+    const std::size_t key_size = absl::little_endian::Load32(p + pos);
+    pos += 4;
+    if (body.size() - pos < key_size + 32) return corrupt();
+    std::string key(p + pos, key_size);
+    pos += key_size;
+    IndexEntry entry;
+    entry.generation = absl::little_endian::Load64(p + pos);
+    entry.segment_id = absl::little_endian::Load64(p + pos + 8);
+    entry.value_offset = absl::little_endian::Load64(p + pos + 16);
+    entry.value_size = absl::little_endian::Load64(p + pos + 24);
+    pos += 32;
+    checkpoint.index.insert(checkpoint.index.end(),
+                            {std::move(key), entry});
+  }
+  if (pos != body.size()) return corrupt();
+  return checkpoint;
+}
+
+std::string GetSegmentFileName(std::uint64_t id) {
+  return absl::StrFormat("%s%016x", kSegmentFilePrefix, id);
+}
+
+std::optional<std::uint64_t> ParseSegmentFileName(std::string_view name) {
+  if (name.size() != kSegmentFilePrefix.size() + 16 ||
+      name.substr(0, kSegmentFilePrefix.size()) != kSegmentFilePrefix) {
+    return std::nullopt;
+  }
+  std::uint64_t id = 0;
+  for (char c : name.substr(kSegmentFilePrefix.size())) {
+    if (!absl::ascii_isxdigit(c)) return std::nullopt;
+    id = id * 16 + (absl::ascii_isdigit(c) ? c - '0'
+                                           : absl::ascii_tolower(c) - 'a' + 10);
+  }
+  return id;
+}
+
+}  // namespace internal_log_structured
+}  // namespace tensorstore
@@ -0,0 +1,168 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_LOG_STRUCTURED_LOG_FORMAT_H_
+#define TENSORSTORE_KVSTORE_LOG_STRUCTURED_LOG_FORMAT_H_
+
+/// \file
+/// On-disk format of the "log_structured" key-value store.
+///
+/// The store directory contains:
+///
+/// - Segment files named `segment-{id}`, where `{id}` is a 16-digit
+///   hexadecimal number.  Each segment consists of a sequence of records, each
+///   of which either sets the value of a key or deletes it.  Records are only
+///   ever appended, and segments are deleted once they no longer contain any
+///   live values.
+///
+/// - A checkpoint file named `checkpoint`, which contains a snapshot of the
+///   index that maps each key to the location of its current value, along
+///   with the position in the log from which records must be replayed to
+///   bring the index up to date.
+///
+/// All integers are encoded in little endian format.
+///
+/// Record format:
+///
+///     magic (4 bytes): 0x4c535231
+///     checksum (4 bytes): CRC-32 of the remainder of the record
+///     type (1 byte): 1 for a value, 2 for a deletion
+///     key_size (4 bytes)
+///     generation (8 bytes)
+///     value_size (8 bytes): must be 0 for a deletion
+///     key (key_size bytes)
+///     value (value_size bytes)
+///
+/// Checkpoint format:
+///
+///     magic (4 bytes): 0x4c534331
+///     next_generation (8 bytes)
+///     replay_segment_id (8 bytes)
+///     replay_offset (8 bytes)
+///     num_entries (8 bytes)
+///     for each entry, in key order:
+///       key_size (4 bytes)
+///       key (key_size bytes)
+///       generation (8 bytes)
+///       segment_id (8 bytes)
+///       value_offset (8 bytes)
+///       value_size (8 bytes)
+///     checksum (4 bytes): CRC-32 of all preceding bytes
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/container/btree_map.h"
+#include "absl/strings/cord.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_log_structured {
+
+enum class RecordType : std::uint8_t {
+  kValue = 1,
+  kDeletion = 2,
+};
+
+/// Size in bytes of the fixed-size portion of a record.
+constexpr std::uint64_t kRecordHeaderSize = 29;
+
+/// Location of a value in the log.
+struct IndexEntry {
+  std::uint64_t generation;
+  std::uint64_t segment_id;
+  /// Offset of the value (not the start of the record) within the segment.
+  std::uint64_t value_offset;
+  std::uint64_t value_size;
+
+  /// Returns the total size of the record that contains the value.
+  std::uint64_t record_size(std::string_view key) const {
+    return kRecordHeaderSize + key.size() + value_size;
+  }
+
+  friend bool operator==(const IndexEntry& a, const IndexEntry& b) {
+    return a.generation == b.generation && a.segment_id == b.segment_id &&
+           a.value_offset == b.value_offset && a.value_size == b.value_size;
+  }
+  friend bool operator!=(const IndexEntry& a, const IndexEntry& b) {
+    return !(a == b);
+  }
+};
+
+using Index = absl::btree_map<std::string, IndexEntry>;
+
+/// Returns the encoded representation of a record.
+///
+/// \param value The value, must be empty if `type == RecordType::kDeletion`.
+absl::Cord EncodeRecord(RecordType type, std::string_view key,
+                        std::uint64_t generation, const absl::Cord& value);
+
+struct DecodedRecord {
+  RecordType type;
+  std::string_view key;
+  std::uint64_t generation;
+  /// Offset of the value relative to the start of the decoded data.
+  std::uint64_t value_offset;
+  std::uint64_t value_size;
+  /// Total size of the record.
+  std::uint64_t record_size;
+};
+
+/// Decodes the record that starts at `offset` within `data`.
+///
+/// \returns The decoded record, or `std::nullopt` if `data` does not contain a
+///     complete, valid record at `offset`, as is expected at the end of a
+///     segment that was being written when the process terminated.
+std::optional<DecodedRecord> DecodeRecord(std::string_view data,
+                                          std::uint64_t offset);
+
+/// Fixed-size portion of a checkpoint.
+struct CheckpointHeader {
+  /// Generation number to assign to the next value written.
+  std::uint64_t next_generation = 1;
+  /// Records starting at this position are not reflected in the checkpointed
+  /// index.
+  std::uint64_t replay_segment_id = 0;
+  std::uint64_t replay_offset = 0;
+};
+
+/// Snapshot of the index.
+struct Checkpoint {
+  CheckpointHeader header;
+  Index index;
+};
+
+std::string EncodeCheckpoint(const CheckpointHeader& header,
+                             const Index& index);
+
+/// Decodes a checkpoint encoded by `EncodeCheckpoint`.
+///
+/// \error `absl::StatusCode::kDataLoss` if `data` is not a valid checkpoint.
+Result<Checkpoint> DecodeCheckpoint(std::string_view data);
+
+/// Returns the name of the segment file with the specified `id`.
+std::string GetSegmentFileName(std::uint64_t id);
+
+/// Parses a segment file name.
+///
+/// \returns The segment id, or `std::nullopt` if `name` is not a segment file
+///     name.
+std::optional<std::uint64_t> ParseSegmentFileName(std::string_view name);
+
+}  // namespace internal_log_structured
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_LOG_STRUCTURED_LOG_FORMAT_H_
@@ -0,0 +1,120 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/log_structured/log_format.h"
+
+#include <optional>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/cord.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::internal_log_structured::CheckpointHeader;
+using ::tensorstore::internal_log_structured::DecodeCheckpoint;
+using ::tensorstore::internal_log_structured::DecodeRecord;
+using ::tensorstore::internal_log_structured::EncodeCheckpoint;
+using ::tensorstore::internal_log_structured::EncodeRecord;
+using ::tensorstore::internal_log_structured::GetSegmentFileName;
+using ::tensorstore::internal_log_structured::Index;
+using ::tensorstore::internal_log_structured::IndexEntry;
+using ::tensorstore::internal_log_structured::kRecordHeaderSize;
+using ::tensorstore::internal_log_structured::ParseSegmentFileName;
+using ::tensorstore::internal_log_structured::RecordType;
+
+TEST(LogFormatTest, RecordRoundTrip) {
+  std::string data =
+      std::string(EncodeRecord(RecordType::kValue, "key", 5,
+                               absl::Cord("value"))) +
+      std::string(EncodeRecord(RecordType::kDeletion, "other", 6, {}));
+  auto first = DecodeRecord(data, 0);
+  ASSERT_TRUE(first);
+  EXPECT_EQ(RecordType::kValue, first->type);
+  EXPECT_EQ("key", first->key);
+  EXPECT_EQ(5, first->generation);
+  EXPECT_EQ(kRecordHeaderSize + 3, first->value_offset);
+  EXPECT_EQ(5, first->value_size);
+  EXPECT_EQ(kRecordHeaderSize + 8, first->record_size);
+  EXPECT_EQ("value", data.substr(first->value_offset, first->value_size));
+
+  auto second = DecodeRecord(data, first->record_size);
+  ASSERT_TRUE(second);
+  EXPECT_EQ(RecordType::kDeletion, second->type);
+  EXPECT_EQ("other", second->key);
+  EXPECT_EQ(6, second->generation);
+  EXPECT_EQ(0, second->value_size);
+  EXPECT_EQ(data.size(), first->record_size + second->record_size);
+
+  EXPECT_FALSE(DecodeRecord(data, data.size()));
+}
+
+TEST(LogFormatTest, RecordTruncatedOrCorrupt) {
+  const std::string data(
+      EncodeRecord(RecordType::kValue, "key", 1, absl::Cord("value")));
+  for (size_t n = 0; n < data.size(); ++n) {
+    EXPECT_FALSE(DecodeRecord(data.substr(0, n), 0)) << n;
+  }
+  for (size_t i = 0; i < data.size(); ++i) {
+    std::string corrupted = data;
+    corrupted[i] ^= 1;
+    EXPECT_FALSE(DecodeRecord(corrupted, 0)) << i;
+  }
+}
+
+TEST(LogFormatTest, CheckpointRoundTrip) {
+  CheckpointHeader header;
+  header.next_generation = 10;
+  header.replay_segment_id = 3;
+  header.replay_offset = 100;
+  Index index;
+  index["a"] = IndexEntry{1, 2, 3, 4};
+  index["b/c"] = IndexEntry{5, 6, 7, 8};
+  const std::string encoded = EncodeCheckpoint(header, index);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto decoded, DecodeCheckpoint(encoded));
+  EXPECT_EQ(10, decoded.header.next_generation);
+  EXPECT_EQ(3, decoded.header.replay_segment_id);
+  EXPECT_EQ(100, decoded.header.replay_offset);
+  EXPECT_EQ(index, decoded.index);
+
+  EXPECT_THAT(DecodeCheckpoint(encoded.substr(0, encoded.size() - 1)),
+              MatchesStatus(absl::StatusCode::kDataLoss));
+  std::string corrupted = encoded;
+  corrupted[20] ^= 1;
+  EXPECT_THAT(DecodeCheckpoint(corrupted),
+              MatchesStatus(absl::StatusCode::kDataLoss));
+}
+
+TEST(LogFormatTest, CheckpointEmptyIndex) {
+  CheckpointHeader header;
+  header.next_generation = 2;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto decoded, DecodeCheckpoint(EncodeCheckpoint(header, Index())));
+  EXPECT_EQ(2, decoded.header.next_generation);
+  EXPECT_TRUE(decoded.index.empty());
+}
+
+TEST(LogFormatTest, SegmentFileName) {
+  EXPECT_EQ("segment-000000000000002a", GetSegmentFileName(42));
+  EXPECT_EQ(42, ParseSegmentFileName("segment-000000000000002a"));
+  EXPECT_EQ(std::nullopt, ParseSegmentFileName("segment-2a"));
+  EXPECT_EQ(std::nullopt, ParseSegmentFileName("segment-0x0000000000002a"));
+  EXPECT_EQ(std::nullopt, ParseSegmentFileName("checkpoint"));
+}
+
+}  // namespace
@@ -0,0 +1,1148 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// Key-value store that packs values into large, append-only segment files
+/// within a single local directory.  See `log_format.h` for the on-disk
+/// format.
+///
+/// Writes are appended to the "active" segment by a single writer task, which
+/// drains all pending writes at once and issues a single `fsync` for the whole
+/// batch.  Once the batch is durable, the in-memory index, which maps each key
+/// to the segment, offset, size, and generation of its current value, is
+/// updated and the writes complete.  Reads look up the index and then read the
+/// requested byte range directly from the segment file.
+///
+/// Overwritten and deleted values leave dead records behind.  When the fraction
+/// of dead bytes in a segment other than the active segment reaches
+/// `compaction_threshold`, the writer task copies the remaining live records
+/// (with unchanged generations) to the active segment, writes a checkpoint, and
+/// deletes the old segment.
+///
+/// The index is checkpointed after every `checkpoint_interval` bytes appended,
+/// after each compaction, and when the store is opened.  On open, the
+/// checkpoint is loaded and any records appended after it was written are
+/// replayed; a truncated or corrupt record at the end of a segment, as may
+/// result from a crash during a write, marks the end of the segment.
+///
+/// Only a single process may access a given directory at a time, which is
+/// enforced by an exclusive lock on the `LOCK` file in the directory; within a
+/// process, all drivers opened on the same directory share a single store.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/context.h"
+#include "tensorstore/internal/file_io_concurrency_resource.h"
+#include "tensorstore/internal/flat_cord_builder.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/internal/logging.h"
+#include "tensorstore/internal/no_destructor.h"
+#include "tensorstore/internal/os_error_code.h"
+#include "tensorstore/internal/path.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/file/file_io_util.h"
+#include "tensorstore/kvstore/file/unique_handle.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/log_structured/log_format.h"
+#include "tensorstore/kvstore/registry.h"
+#include "tensorstore/util/execution/any_receiver.h"
+#include "tensorstore/util/execution/execution.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/quote_string.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
+
+// Include these last to reduce impact of macros.
+#include "tensorstore/kvstore/file/posix_file_util.h"
+#include "tensorstore/kvstore/file/windows_file_util.h"
+
+namespace tensorstore {
+namespace {
+
+namespace jb = tensorstore::internal_json_binding;
+
+using ::tensorstore::internal::GetLastErrorCode;
+using ::tensorstore::internal::GetOsErrorMessage;
+using ::tensorstore::internal::GetOsErrorStatusCode;
+using ::tensorstore::internal::StatusFromOsError;
+using ::tensorstore::internal_file_util::FileDescriptor;
+using ::tensorstore::internal_file_util::FileInfo;
+using ::tensorstore::internal_file_util::FileLockTraits;
+using ::tensorstore::internal_file_util::MakeDirectories;
+using ::tensorstore::internal_file_util::ReadFully;
+using ::tensorstore::internal_file_util::StatusFromErrno;
+using ::tensorstore::internal_file_util::UniqueFileDescriptor;
+using ::tensorstore::internal_file_util::WriteFully;
+using ::tensorstore::internal_log_structured::CheckpointHeader;
+using ::tensorstore::internal_log_structured::DecodeCheckpoint;
+using ::tensorstore::internal_log_structured::DecodeRecord;
+using ::tensorstore::internal_log_structured::EncodeCheckpoint;
+using ::tensorstore::internal_log_structured::EncodeRecord;
+using ::tensorstore::internal_log_structured::GetSegmentFileName;
+using ::tensorstore::internal_log_structured::Index;
+using ::tensorstore::internal_log_structured::IndexEntry;
+using ::tensorstore::internal_log_structured::kRecordHeaderSize;
+using ::tensorstore::internal_log_structured::ParseSegmentFileName;
+using ::tensorstore::internal_log_structured::RecordType;
+using ::tensorstore::kvstore::ReadResult;
+
+constexpr std::string_view kCheckpointFileName = "checkpoint";
+constexpr std::string_view kLockFileName = "LOCK";
+constexpr std::string_view kCheckpointTempFileName = "checkpoint.tmp";
+
+/// Reads the entire contents of the file at `path`.
+///
+/// \returns `std::nullopt` if the file does not exist.
+Result<std::optional<std::string>> ReadFileIfExists(const std::string& path) {
+  UniqueFileDescriptor fd =
+      internal_file_util::OpenExistingFileForReading(path.c_str());
+  if (!fd.valid()) {
+    auto error = GetLastErrorCode();
+    if (GetOsErrorStatusCode(error) == absl::StatusCode::kNotFound) {
+      return std::nullopt;
+    }
+    return StatusFromOsError(error, "Error opening file: ", path);
+  }
+  FileInfo info;
+  if (!internal_file_util::GetFileInfo(fd.get(), &info)) {
+    return StatusFromErrno("Error getting file information: ", path);
+  }
+  std::string data(internal_file_util::GetSize(info), '\0');
+  TENSORSTORE_RETURN_IF_ERROR(
+      ReadFully(fd.get(), path, 0, data.data(), data.size()));
+  return data;
+}
+
+/// Parameters of a `LogStructuredStore`, specified by the spec used to open it.
+struct StoreOptions {
+  std::uint64_t segment_size;
+  double compaction_threshold;
+  std::uint64_t checkpoint_interval;
+
+  friend bool operator==(const StoreOptions& a, const StoreOptions& b) {
+    return a.segment_size == b.segment_size &&
+           a.compaction_threshold == b.compaction_threshold &&
+           a.checkpoint_interval == b.checkpoint_interval;
+  }
+  friend bool operator!=(const StoreOptions& a, const StoreOptions& b) {
+    return !(a == b);
+  }
+};
+
+/// Pending call to `Write`.
+struct WriteOperation {
+  std::string key;
+  std::optional<absl::Cord> value;
+  StorageGeneration if_equal;
+  Promise<TimestampedStorageGeneration> promise;
+};
+
+/// Pending call to `DeleteRange`.
+struct DeleteRangeOperation {
+  KeyRange range;
+  Promise<void> promise;
+};
+
+using PendingOperation = std::variant<WriteOperation, DeleteRangeOperation>;
+
+struct SegmentInfo {
+  /// File descriptor used for reading.  Reads hold a reference while in
+  /// progress, which allows the segment to be deleted concurrently.
+  std::shared_ptr<UniqueFileDescriptor> fd;
+
+  /// Size of the segment, including any truncated or corrupt data.
+  std::uint64_t size = 0;
+
+  /// Total size of the records referenced by the index.
+  std::uint64_t live_bytes = 0;
+};
+
+class LogStructuredStore;
+
+Result<std::shared_ptr<LogStructuredStore>> GetOrOpenStore(
+    const std::string& directory, const Executor& executor,
+    const StoreOptions& options);
+
+/// Open log-structured store, shared by all drivers opened on the same
+/// directory.
+class LogStructuredStore
+    : public std::enable_shared_from_this<LogStructuredStore> {
+ public:
+  /// Opens the store in `directory`, creating it if it does not exist.
+  ///
+  /// This performs blocking I/O.
+  static Result<std::shared_ptr<LogStructuredStore>> Open(
+      std::string directory, Executor executor, StoreOptions options);
+
+  /// Releases the directory lock if this is the last store opened on the
+  /// directory by `GetOrOpenStore`.
+  ~LogStructuredStore();
+
+  /// Returns the index entry for `key` and the file containing its value.
+  std::optional<IndexEntry> Find(
+      std::string_view key, std::shared_ptr<UniqueFileDescriptor>& fd,
+      std::string& path) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /// Returns the keys in `range`.
+  std::vector<std::string> ListKeys(const KeyRange& range,
+                                    const std::atomic<bool>& cancelled)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /// Queues an operation to be performed by the writer task.
+  void Enqueue(PendingOperation operation) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  const std::string& directory() const { return directory_; }
+  const Executor& executor() const { return executor_; }
+  const StoreOptions& options() const { return options_; }
+
+  std::string GetSegmentPath(std::uint64_t segment_id) const {
+    return internal::JoinPath(directory_, GetSegmentFileName(segment_id));
+  }
+
+ private:
+  friend Result<std::shared_ptr<LogStructuredStore>> GetOrOpenStore(
+      const std::string& directory, const Executor& executor,
+      const StoreOptions& options);
+
+  /// Record appended by `WriteBatch`.
+  struct BatchRecord {
+    std::string key;
+    std::optional<IndexEntry> entry;
+    std::uint64_t record_size;
+  };
+
+  /// Record copied by `CompactSegment`.
+  struct CopiedRecord {
+    std::string key;
+    IndexEntry old_entry;
+    IndexEntry new_entry;
+  };
+
+  /// Performs pending operations, compactions, and checkpoints until there is
+  /// nothing left to do.
+  void RunWriter();
+
+  /// Performs a batch of operations, with a single `fsync`.
+  void WriteBatch(std::vector<PendingOperation> operations);
+
+  /// Returns the id of a segment that should be compacted.
+  std::optional<std::uint64_t> FindCompactionCandidate()
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+
+  /// Copies the live records of a segment to the active segment and deletes
+  /// it.
+  absl::Status CompactSegment(std::uint64_t segment_id);
+
+  /// Appends `data` to the active segment and syncs it.  On failure, any part
+  /// of `data` that was written is discarded.
+  ///
+  /// \param offset[out] Set to the offset within the active segment at which
+  ///     `data` was written.
+  absl::Status Append(const absl::Cord& data, std::uint64_t& offset);
+
+  /// Discards the records of an append to the active segment at `path` that
+  /// failed with `error`.
+  void DiscardFailedAppend(const std::string& path, const absl::Status& error);
+
+  /// Creates a new active segment.
+  absl::Status StartNewSegment();
+
+  /// Writes a checkpoint of the index as of the current end of the log.
+  absl::Status WriteCheckpoint();
+
+  /// Returns the current generation of `key`, taking into account any
+  /// modifications made by the current batch, or `std::nullopt` if `key` is
+  /// not present.
+  std::optional<std::uint64_t> GetCurrentGeneration(
+      const std::string& key,
+      const absl::btree_map<std::string, std::optional<std::uint64_t>>&
+          modified) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  std::string directory_;
+  Executor executor_;
+  StoreOptions options_;
+  /// Set by `GetOrOpenStore` once the store holds a reference to the directory
+  /// lock.
+  bool holds_directory_lock_ = false;
+
+  absl::Mutex mutex_;
+  Index index_ ABSL_GUARDED_BY(mutex_);
+  absl::btree_map<std::uint64_t, SegmentInfo> segments_ ABSL_GUARDED_BY(mutex_);
+  std::vector<PendingOperation> pending_ ABSL_GUARDED_BY(mutex_);
+  bool writer_running_ ABSL_GUARDED_BY(mutex_) = false;
+
+  // The remaining members are only accessed by `Open` and the writer task,
+  // which never run concurrently.
+  UniqueFileDescriptor directory_fd_;
+  /// Id of the segment to which new records are appended.
+  std::uint64_t active_segment_id_ = 0;
+  /// File descriptor used for appending to the active segment.  Invalid if an
+  /// error occurred, in which case the next append starts a new segment.
+  UniqueFileDescriptor active_fd_;
+  /// Number of bytes successfully appended to the active segment.
+  std::uint64_t active_size_ = 0;
+  std::uint64_t next_generation_ = 1;
+  std::uint64_t bytes_since_checkpoint_ = 0;
+  /// Compaction is disabled after an error, to avoid retrying indefinitely.
+  bool compaction_failed_ = false;
+  /// Set if the records of a failed append could not be discarded.  All
+  /// subsequent appends fail, since the result of replaying the log is no
+  /// longer consistent with the results reported to callers.
+  absl::Status unrecoverable_error_;
+};
+
+Result<std::shared_ptr<LogStructuredStore>> LogStructuredStore::Open(
+    std::string directory, Executor executor, StoreOptions options) {
+  auto store = std::make_shared<LogStructuredStore>();
+  store->directory_ = std::move(directory);
+  store->executor_ = std::move(executor);
+  store->options_ = options;
+  const std::string& dir = store->directory_;
+
+  TENSORSTORE_RETURN_IF_ERROR(MakeDirectories(dir));
+  store->directory_fd_.reset(
+      internal_file_util::OpenDirectoryDescriptor(dir.c_str()));
+  if (!store->directory_fd_.valid()) {
+    return StatusFromErrno("Failed to open directory: ", dir);
+  }
+
+  // Load the checkpoint, if any.
+  const std::string checkpoint_path =
+      internal::JoinPath(dir, kCheckpointFileName);
+  TENSORSTORE_ASSIGN_OR_RETURN(auto checkpoint_data,
+                               ReadFileIfExists(checkpoint_path));
+  internal_log_structured::Checkpoint checkpoint;
+  if (checkpoint_data) {
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        checkpoint, DecodeCheckpoint(*checkpoint_data),
+        tensorstore::MaybeAnnotateStatus(
+            _, tensorstore::StrCat("Reading ", checkpoint_path)));
+  }
+  const CheckpointHeader& header = checkpoint.header;
+  Index& index = checkpoint.index;
+  std::uint64_t next_generation = header.next_generation;
+
+  // Find the existing segments.
+  std::vector<std::uint64_t> segment_ids;
+  {
+    std::unique_ptr<internal_file_util::DirectoryIterator> dir_it;
+    if (!internal_file_util::DirectoryIterator::Make(
+            internal_file_util::DirectoryIterator::Entry::FromPath(dir),
+            &dir_it)) {
+      return StatusFromErrno("Failed to open directory: ", dir);
+    }
+    while (dir_it && dir_it->Next()) {
+      if (dir_it->is_directory()) continue;
+      if (auto id = ParseSegmentFileName(dir_it->path_component())) {
+        segment_ids.push_back(*id);
+      }
+    }
+  }
+  std::sort(segment_ids.begin(), segment_ids.end());
+
+  // Open the segments, and replay any records not reflected in the
+  // checkpoint.
+  absl::btree_map<std::uint64_t, SegmentInfo> segments;
+  for (std::uint64_t id : segment_ids) {
+    const std::string path = store->GetSegmentPath(id);
+    auto fd = std::make_shared<UniqueFileDescriptor>(
+        internal_file_util::OpenExistingFileForReading(path.c_str()));
+    if (!fd->valid()) {
+      return StatusFromErrno("Error opening file: ", path);
+    }
+    FileInfo info;
+    if (!internal_file_util::GetFileInfo(fd->get(), &info)) {
+      return StatusFromErrno("Error getting file information: ", path);
+    }
+    SegmentInfo& segment = segments[id];
+    segment.size = internal_file_util::GetSize(info);
+    segment.fd = std::move(fd);
+    if (id < header.replay_segment_id) continue;
+    const std::uint64_t start =
+        id == header.replay_segment_id ? header.replay_offset : 0;
+    if (start >= segment.size) continue;
+    std::string data(segment.size - start, '\0');
+    TENSORSTORE_RETURN_IF_ERROR(
+        ReadFully(segment.fd->get(), path, start, data.data(), data.size()));
+    for (std::uint64_t offset = 0;;) {
+      auto record = DecodeRecord(data, offset);
+      if (!record) break;
+      next_generation = std::max(next_generation, record->generation + 1);
+      if (record->type == RecordType::kValue) {
+        index[std::string(record->key)] =
+            IndexEntry{record->generation, id, start + record->value_offset,
+                       record->value_size};
+      } else {
+        index.erase(std::string(record->key));
+      }
+      offset += record->record_size;
+    }
+  }
+
+  for (const auto& [key, entry] : index) {
+    auto it = segments.find(entry.segment_id);
+    if (it == segments.end() ||
+        entry.value_offset + entry.value_size > it->second.size) {
+      return absl::DataLossError(tensorstore::StrCat(
+          "Value of ", QuoteString(key), " refers to missing data in ",
+          store->GetSegmentPath(entry.segment_id)));
+    }
+    it->second.live_bytes += entry.record_size(key);
+  }
+
+  {
+    absl::MutexLock lock(&store->mutex_);
+    store->index_ = std::move(index);
+    store->segments_ = std::move(segments);
+  }
+  store->next_generation_ = next_generation;
+  store->active_segment_id_ =
+      std::max(header.replay_segment_id,
+               segment_ids.empty() ? 0 : segment_ids.back());
+  TENSORSTORE_RETURN_IF_ERROR(store->StartNewSegment());
+
+  // Checkpoint the recovered index, which makes all segments that do not
+  // contain live records garbage.
+  TENSORSTORE_RETURN_IF_ERROR(store->WriteCheckpoint());
+  absl::MutexLock lock(&store->mutex_);
+  for (auto it = store->segments_.begin(); it != store->segments_.end();) {
+    if (it->first == store->active_segment_id_ || it->second.live_bytes != 0) {
+      ++it;
+      continue;
+    }
+    // Failure to delete is not an error; the segment is simply retried the
+    // next time the store is opened.
+    internal_file_util::DeleteFile(store->GetSegmentPath(it->first));
+    it = store->segments_.erase(it);
+  }
+  return store;
+}
+
+std::optional<IndexEntry> LogStructuredStore::Find(
+    std::string_view key, std::shared_ptr<UniqueFileDescriptor>& fd,
+    std::string& path) {
+  absl::ReaderMutexLock lock(&mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) return std::nullopt;
+  auto segment_it = segments_.find(it->second.segment_id);
+  assert(segment_it != segments_.end());
+  fd = segment_it->second.fd;
+  path = GetSegmentPath(it->second.segment_id);
+  return it->second;
+}
+
+std::vector<std::string> LogStructuredStore::ListKeys(
+    const KeyRange& range, const std::atomic<bool>& cancelled) {
+  std::vector<std::string> keys;
+  absl::ReaderMutexLock lock(&mutex_);
+  auto it = index_.lower_bound(range.inclusive_min);
+  auto end = range.exclusive_max.empty()
+                 ? index_.end()
+                 : index_.lower_bound(range.exclusive_max);
+  for (; it != end; ++it) {
+    if (cancelled.load(std::memory_order_relaxed)) break;
+    keys.push_back(it->first);
+  }
+  return keys;
+}
+
+void LogStructuredStore::Enqueue(PendingOperation operation) {
+  {
+    absl::MutexLock lock(&mutex_);
+    pending_.push_back(std::move(operation));
+    if (writer_running_) return;
+    writer_running_ = true;
+  }
+  executor_([self = shared_from_this()] { self->RunWriter(); });
+}
+
+void LogStructuredStore::RunWriter() {
+  while (true) {
+    std::vector<PendingOperation> operations;
+    std::optional<std::uint64_t> compaction_candidate;
+    {
+      absl::MutexLock lock(&mutex_);
+      std::swap(operations, pending_);
+      compaction_candidate = FindCompactionCandidate();
+      if (operations.empty() && !compaction_candidate) {
+        writer_running_ = false;
+        return;
+      }
+    }
+    if (!operations.empty()) {
+      WriteBatch(std::move(operations));
+    }
+    // At most one segment is compacted between batches, to limit the latency
+    // added to pending writes.
+    if (compaction_candidate) {
+      if (auto status = CompactSegment(*compaction_candidate); !status.ok()) {
+        TENSORSTORE_LOG("Compaction of ",
+                        GetSegmentPath(*compaction_candidate),
+                        " failed: ", status);
+        compaction_failed_ = true;
+      }
+    }
+    if (bytes_since_checkpoint_ >= options_.checkpoint_interval) {
+      if (auto status = WriteCheckpoint(); !status.ok()) {
+        TENSORSTORE_LOG("Checkpoint of ", directory_, " failed: ", status);
+      }
+    }
+  }
+}
+
+std::optional<std::uint64_t> LogStructuredStore::GetCurrentGeneration(
+    const std::string& key,
+    const absl::btree_map<std::string, std::optional<std::uint64_t>>&
+        modified) {
+  if (auto it = modified.find(key); it != modified.end()) return it->second;
+  absl::ReaderMutexLock lock(&mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) return std::nullopt;
+  return it->second.generation;
+}
+
+void LogStructuredStore::WriteBatch(std::vector<PendingOperation> operations) {
+  absl::Cord data;
+  std::vector<BatchRecord> records;
+  // Generation of each key modified by this batch, or `std::nullopt` if the
+  // key was deleted.
+  absl::btree_map<std::string, std::optional<std::uint64_t>> modified;
+  std::vector<StorageGeneration> results(operations.size());
+
+  const auto append_record = [&](const std::string& key,
+                                 const absl::Cord* value) {
+    const std::uint64_t generation = next_generation_++;
+    const RecordType type =
+        value ? RecordType::kValue : RecordType::kDeletion;
+    BatchRecord record;
+    record.key = key;
+    if (value) {
+      // `value_offset` is relative to the start of the batch until the batch
+      // has been appended.
+      record.entry = IndexEntry{generation, 0,
+                                data.size() + kRecordHeaderSize + key.size(),
+                                value->size()};
+      modified[key] = generation;
+    } else {
+      modified[key] = std::nullopt;
+    }
+    absl::Cord encoded =
+        EncodeRecord(type, key, generation, value ? *value : absl::Cord());
+    record.record_size = encoded.size();
+    data.Append(std::move(encoded));
+    records.push_back(std::move(record));
+    return generation;
+  };
+
+  for (std::size_t i = 0; i < operations.size(); ++i) {
+    if (auto* op = std::get_if<WriteOperation>(&operations[i])) {
+      auto existing = GetCurrentGeneration(op->key, modified);
+      if (!StorageGeneration::IsUnknown(op->if_equal) &&
+          op->if_equal != (existing ? StorageGeneration::FromUint64(*existing)
+                                    : StorageGeneration::NoValue())) {
+        results[i] = StorageGeneration::Unknown();
+        continue;
+      }
+      if (!op->value) {
+        if (existing) append_record(op->key, nullptr);
+        results[i] = StorageGeneration::NoValue();
+        continue;
+      }
+      results[i] =
+          StorageGeneration::FromUint64(append_record(op->key, &*op->value));
+      continue;
+    }
+    auto& op = std::get<DeleteRangeOperation>(operations[i]);
+    // Determine the keys within the range that currently exist.
+    std::vector<std::string> keys;
+    {
+      absl::ReaderMutexLock lock(&mutex_);
+      auto it = index_.lower_bound(op.range.inclusive_min);
+      auto end = op.range.exclusive_max.empty()
+                     ? index_.end()
+                     : index_.lower_bound(op.range.exclusive_max);
+      for (; it != end; ++it) {
+        if (!modified.count(it->first)) keys.push_back(it->first);
+      }
+    }
+    for (const auto& [key, generation] : modified) {
+      if (generation && Contains(op.range, key)) keys.push_back(key);
+    }
+    for (const auto& key : keys) {
+      append_record(key, nullptr);
+    }
+  }
+
+  absl::Status status;
+  if (!records.empty()) {
+    std::uint64_t offset;
+    status = Append(data, offset);
+    if (status.ok()) {
+      absl::MutexLock lock(&mutex_);
+      auto& active_segment = segments_.at(active_segment_id_);
+      for (auto& record : records) {
+        auto it = index_.find(record.key);
+        if (it != index_.end()) {
+          segments_.at(it->second.segment_id).live_bytes -=
+              it->second.record_size(it->first);
+        }
+        if (!record.entry) {
+          if (it != index_.end()) index_.erase(it);
+          continue;
+        }
+        record.entry->segment_id = active_segment_id_;
+        record.entry->value_offset += offset;
+        active_segment.live_bytes += record.record_size;
+        if (it != index_.end()) {
+          it->second = *record.entry;
+        } else {
+          index_.emplace(std::move(record.key), *record.entry);
+        }
+      }
+    }
+  }
+
+  const absl::Time time = absl::Now();
+  for (std::size_t i = 0; i < operations.size(); ++i) {
+    if (auto* op = std::get_if<WriteOperation>(&operations[i])) {
+      if (!status.ok()) {
+        op->promise.SetResult(status);
+      } else {
+        op->promise.SetResult(
+            TimestampedStorageGeneration{std::move(results[i]), time});
+      }
+    } else {
+      std::get<DeleteRangeOperation>(operations[i]).promise.SetResult(status);
+    }
+  }
+}
+
+std::optional<std::uint64_t> LogStructuredStore::FindCompactionCandidate() {
+  if (compaction_failed_) return std::nullopt;
+  for (const auto& [id, segment] : segments_) {
+    if (id == active_segment_id_) continue;
+    if (segment.live_bytes == 0 ||
+        static_cast<double>(segment.size - segment.live_bytes) >=
+            options_.compaction_threshold * segment.size) {
+      return id;
+    }
+  }
+  return std::nullopt;
+}
+
+absl::Status LogStructuredStore::CompactSegment(std::uint64_t segment_id) {
+  const std::string path = GetSegmentPath(segment_id);
+  std::shared_ptr<UniqueFileDescriptor> fd;
+  std::uint64_t size;
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    const auto& segment = segments_.at(segment_id);
+    fd = segment.fd;
+    size = segment.live_bytes == 0 ? 0 : segment.size;
+  }
+
+  // Copy the live records to the active segment.
+  std::string data(size, '\0');
+  TENSORSTORE_RETURN_IF_ERROR(
+      ReadFully(fd->get(), path, 0, data.data(), data.size()));
+  absl::Cord copies;
+  std::vector<CopiedRecord> copied;
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    for (std::uint64_t offset = 0;;) {
+      auto record = DecodeRecord(data, offset);
+      if (!record) break;
+      offset += record->record_size;
+      if (record->type != RecordType::kValue) continue;
+      auto it = index_.find(record->key);
+      if (it == index_.end() || it->second.segment_id != segment_id ||
+          it->second.value_offset != record->value_offset) {
+        continue;
+      }
+      CopiedRecord copy;
+      copy.key = it->first;
+      copy.old_entry = it->second;
+      copy.new_entry = it->second;
+      copy.new_entry.value_offset =
+          copies.size() + kRecordHeaderSize + record->key.size();
+      copies.Append(EncodeRecord(
+          RecordType::kValue, record->key, record->generation,
+          absl::Cord(std::string_view(data).substr(record->value_offset,
+                                                   record->value_size))));
+      copied.push_back(std::move(copy));
+    }
+  }
+  if (!copied.empty()) {
+    std::uint64_t offset;
+    TENSORSTORE_RETURN_IF_ERROR(Append(copies, offset));
+    absl::MutexLock lock(&mutex_);
+    auto& active_segment = segments_.at(active_segment_id_);
+    for (auto& copy : copied) {
+      auto it = index_.find(copy.key);
+      assert(it != index_.end() && it->second == copy.old_entry);
+      copy.new_entry.segment_id = active_segment_id_;
+      copy.new_entry.value_offset += offset;
+      it->second = copy.new_entry;
+      active_segment.live_bytes += copy.new_entry.record_size(copy.key);
+    }
+  }
+
+  // The segment can be deleted once a checkpoint that does not refer to it has
+  // been written.
+  TENSORSTORE_RETURN_IF_ERROR(WriteCheckpoint());
+  {
+    absl::MutexLock lock(&mutex_);
+    segments_.erase(segment_id);
+  }
+  // Failure to delete is not an error; the segment is simply retried the next
+  // time the store is opened.
+  internal_file_util::DeleteFile(path);
+  return absl::OkStatus();
+}
+
+absl::Status LogStructuredStore::Append(const absl::Cord& data,
+                                        std::uint64_t& offset) {
+  TENSORSTORE_RETURN_IF_ERROR(unrecoverable_error_);
+  if (!active_fd_.valid() || (active_size_ > 0 && active_size_ + data.size() >
+                                                     options_.segment_size)) {
+    TENSORSTORE_RETURN_IF_ERROR(StartNewSegment());
+  }
+  const std::string path = GetSegmentPath(active_segment_id_);
+  absl::Status status = WriteFully(active_fd_.get(), path, data);
+  if (status.ok() && !internal_file_util::FsyncFile(active_fd_.get())) {
+    status = StatusFromErrno("Error calling fsync on file: ", path);
+  }
+  if (!status.ok()) {
+    DiscardFailedAppend(path, status);
+    return status;
+  }
+  offset = active_size_;
+  active_size_ += data.size();
+  bytes_since_checkpoint_ += data.size();
+  absl::MutexLock lock(&mutex_);
+  segments_.at(active_segment_id_).size = active_size_;
+  return absl::OkStatus();
+}
+
+void LogStructuredStore::DiscardFailedAppend(const std::string& path,
+                                             const absl::Status& error) {
+  // The records may have been written, in part or in full, even though the
+  // append failed; they must not be replayed when the store is next opened,
+  // since the failure is reported to the callers.  Truncate the segment to its
+  // size before the append.
+  const bool truncated =
+      internal_file_util::TruncateFileTo(active_fd_.get(), active_size_) &&
+      internal_file_util::FsyncFile(active_fd_.get());
+  absl::Status truncate_status;
+  if (!truncated) {
+    truncate_status = StatusFromErrno("Error truncating file: ", path);
+  }
+  // Stop appending to the segment, such that the next append starts a new
+  // segment.
+  active_fd_.reset();
+  if (truncated) return;
+  // Otherwise, a checkpoint, which starts replay at a new segment, ensures
+  // that the records are never replayed.
+  absl::Status status = StartNewSegment();
+  if (status.ok()) status = WriteCheckpoint();
+  if (status.ok()) return;
+  TENSORSTORE_LOG("Failed to discard records from ", path, " after error (",
+                  error, "): ", truncate_status, "; ", status);
+  unrecoverable_error_ = absl::DataLossError(tensorstore::StrCat(
+      "Log-structured store ", QuoteString(directory_),
+      " may replay records of a failed write: ", error.message()));
+}
+
+absl::Status LogStructuredStore::StartNewSegment() {
+  // Never reuse an id, even if creating the segment fails.
+  const std::uint64_t id = ++active_segment_id_;
+  active_fd_.reset();
+  active_size_ = 0;
+  const std::string path = GetSegmentPath(id);
+  UniqueFileDescriptor write_fd = internal_file_util::OpenFileForWriting(path);
+  if (!write_fd.valid()) {
+    return StatusFromErrno("Failed to open file: ", path);
+  }
+  auto read_fd = std::make_shared<UniqueFileDescriptor>(
+      internal_file_util::OpenExistingFileForReading(path.c_str()));
+  if (!read_fd->valid()) {
+    return StatusFromErrno("Error opening file: ", path);
+  }
+  if (!internal_file_util::FsyncDirectory(directory_fd_.get())) {
+    return StatusFromErrno("Error calling fsync on directory: ", directory_);
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    segments_[id].fd = std::move(read_fd);
+  }
+  active_fd_ = std::move(write_fd);
+  return absl::OkStatus();
+}
+
+absl::Status LogStructuredStore::WriteCheckpoint() {
+  CheckpointHeader header;
+  header.next_generation = next_generation_;
+  header.replay_segment_id = active_segment_id_;
+  header.replay_offset = active_size_;
+  std::string encoded;
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    encoded = EncodeCheckpoint(header, index_);
+  }
+  const std::string temp_path =
+      internal::JoinPath(directory_, kCheckpointTempFileName);
+  const std::string path = internal::JoinPath(directory_, kCheckpointFileName);
+  UniqueFileDescriptor fd = internal_file_util::OpenFileForWriting(temp_path);
+  if (!fd.valid()) {
+    return StatusFromErrno("Failed to open file: ", temp_path);
+  }
+  if (!internal_file_util::TruncateFile(fd.get())) {
+    return StatusFromErrno("Failed to truncate file: ", temp_path);
+  }
+  TENSORSTORE_RETURN_IF_ERROR(
+      WriteFully(fd.get(), temp_path, absl::Cord(std::move(encoded))));
+  if (!internal_file_util::FsyncFile(fd.get())) {
+    return StatusFromErrno("Error calling fsync on file: ", temp_path);
+  }
+  if (!internal_file_util::RenameOpenFile(fd.get(), temp_path, path)) {
+    return StatusFromErrno("Error renaming: ", temp_path, " -> ", path);
+  }
+  if (!internal_file_util::FsyncDirectory(directory_fd_.get())) {
+    return StatusFromErrno("Error calling fsync on directory: ", directory_);
+  }
+  bytes_since_checkpoint_ = 0;
+  return absl::OkStatus();
+}
+
+/// Stores that are currently open, indexed by directory.
+/// Exclusive lock on the `LOCK` file of a store directory.
+struct DirectoryLock {
+  UniqueFileDescriptor fd;
+  // Declared after `fd` so that the lock is released before `fd` is closed.
+  internal::UniqueHandle<FileDescriptor, FileLockTraits> lock;
+};
+
+/// Creates `directory` if it does not exist, and locks it.
+///
+/// \error `absl::StatusCode::kFailedPrecondition` if the directory is locked
+///     by another process.
+Result<DirectoryLock> LockDirectory(const std::string& directory) {
+  TENSORSTORE_RETURN_IF_ERROR(MakeDirectories(directory));
+  const std::string path = internal::JoinPath(directory, kLockFileName);
+  DirectoryLock lock;
+  lock.fd = internal_file_util::OpenFileForWriting(path);
+  if (!lock.fd.valid()) {
+    return StatusFromErrno("Failed to open lock file: ", path);
+  }
+  if (!FileLockTraits::TryAcquire(lock.fd.get())) {
+    return absl::FailedPreconditionError(tensorstore::StrCat(
+        "Log-structured store ", QuoteString(directory),
+        " is in use by another process: ",
+        GetOsErrorMessage(GetLastErrorCode())));
+  }
+  lock.lock.reset(lock.fd.get());
+  return lock;
+}
+
+struct StoreRegistry {
+  struct Entry {
+    std::weak_ptr<LogStructuredStore> store;
+    /// Valid while `num_stores != 0`.
+    DirectoryLock lock;
+    /// Number of stores holding `lock` that have not yet been destroyed.  A
+    /// store that is being destroyed may still be counted after `store` has
+    /// expired, in which case a newly opened store shares its lock rather
+    /// than failing to acquire it.
+    std::size_t num_stores = 0;
+  };
+  absl::Mutex mutex;
+  absl::flat_hash_map<std::string, Entry> stores ABSL_GUARDED_BY(mutex);
+};
+
+StoreRegistry& GetStoreRegistry() {
+  static internal::NoDestructor<StoreRegistry> registry;
+  return *registry;
+}
+
+LogStructuredStore::~LogStructuredStore() {
+  if (!holds_directory_lock_) return;
+  auto& registry = GetStoreRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  auto it = registry.stores.find(directory_);
+  assert(it != registry.stores.end());
+  if (--it->second.num_stores == 0) registry.stores.erase(it);
+}
+
+/// Returns the open store for `directory`, or opens it.
+///
+/// \error `absl::StatusCode::kFailedPrecondition` if the store is already open
+///     with different `options`.
+Result<std::shared_ptr<LogStructuredStore>> GetOrOpenStore(
+    const std::string& directory, const Executor& executor,
+    const StoreOptions& options) {
+  auto& registry = GetStoreRegistry();
+  // The lock is held while opening, such that concurrent opens of the same
+  // directory wait for the first one to complete.
+  absl::MutexLock lock(&registry.mutex);
+  auto& entry = registry.stores[directory];
+  if (auto store = entry.store.lock()) {
+    if (store->options() != options) {
+      return absl::FailedPreconditionError(tensorstore::StrCat(
+          "Log-structured store ", QuoteString(directory),
+          " is already open with different options"));
+    }
+    return store;
+  }
+  if (entry.num_stores == 0) {
+    auto lock_result = LockDirectory(directory);
+    if (!lock_result.ok()) {
+      registry.stores.erase(directory);
+      return lock_result.status();
+    }
+    entry.lock = *std::move(lock_result);
+  }
+  auto store_result = LogStructuredStore::Open(directory, executor, options);
+  if (!store_result.ok()) {
+    if (entry.num_stores == 0) registry.stores.erase(directory);
+    return store_result.status();
+  }
+  auto& store = *store_result;
+  store->holds_directory_lock_ = true;
+  ++entry.num_stores;
+  entry.store = store;
+  return store;
+}
+
+/// Implements `LogStructuredKeyValueStore::Read` for values that must be read
+/// from a segment.
+struct ReadTask {
+  std::shared_ptr<UniqueFileDescriptor> fd;
+  std::string path;
+  std::uint64_t offset;
+  std::size_t size;
+  ReadResult read_result;
+
+  Result<ReadResult> operator()() const {
+    internal::FlatCordBuilder buffer(size);
+    TENSORSTORE_RETURN_IF_ERROR(
+        ReadFully(fd->get(), path, offset, buffer.data(), buffer.size()));
+    ReadResult result = read_result;
+    result.value = std::move(buffer).Build();
+    return result;
+  }
+};
+
+struct LogStructuredKeyValueStoreSpecData {
+  std::string directory;
+  Context::Resource<internal::FileIoConcurrencyResource> file_io_concurrency;
+  std::uint64_t segment_size = 64 * 1024 * 1024;
+  double compaction_threshold = 0.5;
+  std::uint64_t checkpoint_interval = 64 * 1024 * 1024;
+
+  constexpr static auto ApplyMembers = [](auto& x, auto f) {
+    return f(x.directory, x.file_io_concurrency, x.segment_size,
+             x.compaction_threshold, x.checkpoint_interval);
+  };
+
+  constexpr static auto default_json_binder = jb::Object(
+      jb::Member("directory",
+                 jb::Projection<&LogStructuredKeyValueStoreSpecData::directory>(
+                     jb::NonEmptyStringBinder)),
+      jb::Member(internal::FileIoConcurrencyResource::id,
+                 jb::Projection<&LogStructuredKeyValueStoreSpecData::
+                                    file_io_concurrency>()),
+      jb::Member(
+          "segment_size",
+          jb::Projection<&LogStructuredKeyValueStoreSpecData::segment_size>(
+              jb::DefaultValue<jb::kNeverIncludeDefaults>(
+                  [](auto* obj) { *obj = 64 * 1024 * 1024; },
+                  jb::Integer<std::uint64_t>(1)))),
+      jb::Member(
+          "compaction_threshold",
+          jb::Projection<
+              &LogStructuredKeyValueStoreSpecData::compaction_threshold>(
+              jb::DefaultValue<jb::kNeverIncludeDefaults>(
+                  [](auto* obj) { *obj = 0.5; },
+                  jb::Validate(
+                      [](const auto& options, double* x) {
+                        if (!(*x > 0 && *x <= 1)) {
+                          return absl::InvalidArgumentError(
+                              "Expected a number in the range (0, 1]");
+                        }
+                        return absl::OkStatus();
+                      },
+                      jb::FloatBinder)))),
+      jb::Member(
+          "checkpoint_interval",
+          jb::Projection<
+              &LogStructuredKeyValueStoreSpecData::checkpoint_interval>(
+              jb::DefaultValue<jb::kNeverIncludeDefaults>(
+                  [](auto* obj) { *obj = 64 * 1024 * 1024; },
+                  jb::Integer<std::uint64_t>(1)))));
+};
+
+class LogStructuredKeyValueStoreSpec
+    : public internal_kvstore::RegisteredDriverSpec<
+          LogStructuredKeyValueStoreSpec, LogStructuredKeyValueStoreSpecData> {
+ public:
+  static constexpr char id[] = "log_structured";
+
+  Future<kvstore::DriverPtr> DoOpen() const override;
+};
+
+class LogStructuredKeyValueStore
+    : public internal_kvstore::RegisteredDriver<
+          LogStructuredKeyValueStore, LogStructuredKeyValueStoreSpec> {
+ public:
+  Future<ReadResult> Read(Key key, ReadOptions options) override {
+    std::shared_ptr<UniqueFileDescriptor> fd;
+    std::string path;
+    ReadResult read_result;
+    auto entry = store_->Find(key, fd, path);
+    read_result.stamp.time = absl::Now();
+    if (!entry) {
+      read_result.stamp.generation = StorageGeneration::NoValue();
+      read_result.state = ReadResult::kMissing;
+      return read_result;
+    }
+    read_result.stamp.generation =
+        StorageGeneration::FromUint64(entry->generation);
+    if (read_result.stamp.generation == options.if_not_equal ||
+        (!StorageGeneration::IsUnknown(options.if_equal) &&
+         read_result.stamp.generation != options.if_equal)) {
+      return read_result;
+    }
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        auto byte_range, options.byte_range.Validate(entry->value_size));
+    read_result.state = ReadResult::kValue;
+    if (byte_range.size() == 0) return read_result;
+    return MapFuture(
+        executor(),
+        ReadTask{std::move(fd), std::move(path),
+                 entry->value_offset + byte_range.inclusive_min,
+                 static_cast<std::size_t>(byte_range.size()),
+                 std::move(read_result)});
+  }
+
+  Future<TimestampedStorageGeneration> Write(Key key,
+                                             std::optional<Value> value,
+                                             WriteOptions options) override {
+    if (key.size() > std::numeric_limits<std::uint32_t>::max()) {
+      return absl::InvalidArgumentError("Key is too long");
+    }
+    auto [promise, future] =
+        PromiseFuturePair<TimestampedStorageGeneration>::Make();
+    store_->Enqueue(WriteOperation{std::move(key), std::move(value),
+                                   std::move(options.if_equal),
+                                   std::move(promise)});
+    return std::move(future);
+  }
+
+  Future<const void> DeleteRange(KeyRange range) override {
+    if (range.empty()) return absl::OkStatus();  // Converted to a ReadyFuture.
+    auto [promise, future] = PromiseFuturePair<void>::Make();
+    store_->Enqueue(DeleteRangeOperation{std::move(range), std::move(promise)});
+    return std::move(future);
+  }
+
+  void ListImpl(ListOptions options,
+                AnyFlowReceiver<absl::Status, Key> receiver) override {
+    std::atomic<bool> cancelled{false};
+    execution::set_starting(receiver, [&cancelled] {
+      cancelled.store(true, std::memory_order_relaxed);
+    });
+    auto keys = store_->ListKeys(options.range, cancelled);
+    for (auto& key : keys) {
+      if (cancelled.load(std::memory_order_relaxed)) break;
+      execution::set_value(
+          receiver,
+          key.substr(std::min(options.strip_prefix_length, key.size())));
+    }
+    execution::set_done(receiver);
+    execution::set_stopping(receiver);
+  }
+
+  const Executor& executor() { return spec_.file_io_concurrency->executor; }
+
+  std::string DescribeKey(std::string_view key) override {
+    return tensorstore::StrCat(QuoteString(key), " in log-structured store ",
+                               QuoteString(spec_.directory));
+  }
+
+  absl::Status GetBoundSpecData(
+      LogStructuredKeyValueStoreSpecData& spec) const {
+    spec = spec_;
+    return absl::OkStatus();
+  }
+
+  SpecData spec_;
+  std::shared_ptr<LogStructuredStore> store_;
+};
+
+Future<kvstore::DriverPtr> LogStructuredKeyValueStoreSpec::DoOpen() const {
+  auto driver = internal::MakeIntrusivePtr<LogStructuredKeyValueStore>();
+  driver->spec_ = data_;
+  // Opening the store performs blocking I/O to load the index.
+  return MapFuture(
+      driver->executor(), [driver]() mutable -> Result<kvstore::DriverPtr> {
+        const auto& spec = driver->spec_;
+        TENSORSTORE_ASSIGN_OR_RETURN(
+            driver->store_,
+            GetOrOpenStore(spec.directory, driver->executor(),
+                           StoreOptions{spec.segment_size,
+                                        spec.compaction_threshold,
+                                        spec.checkpoint_interval}));
+        return driver;
+      });
+}
+
+}  // namespace
+}  // namespace tensorstore
+
+TENSORSTORE_DECLARE_GARBAGE_COLLECTION_NOT_REQUIRED(
+    tensorstore::LogStructuredKeyValueStore)
+
+namespace {
+const tensorstore::internal_kvstore::DriverRegistration<
+    tensorstore::LogStructuredKeyValueStoreSpec>
+    registration;
+}  // namespace
@@ -0,0 +1,251 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/match.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/context.h"
+#include "tensorstore/internal/test_util.h"
+#include "tensorstore/kvstore/file/file_io_util.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/generation_testutil.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/test_util.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/status_testutil.h"
+#include "tensorstore/util/str_cat.h"
+
+// Include system headers last to reduce impact of macros.
+#include "tensorstore/kvstore/file/posix_file_util.h"
+#include "tensorstore/kvstore/file/windows_file_util.h"
+
+namespace {
+
+namespace kvstore = tensorstore::kvstore;
+using ::tensorstore::KvStore;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::StorageGeneration;
+using ::tensorstore::internal::MatchesKvsReadResult;
+using ::tensorstore::internal::MatchesKvsReadResultNotFound;
+using ::tensorstore::internal_file_util::FileLockTraits;
+using ::tensorstore::internal_file_util::UniqueFileDescriptor;
+
+::nlohmann::json GetSpec(std::string directory) {
+  return {{"driver", "log_structured"}, {"directory", directory}};
+}
+
+KvStore GetStore(std::string directory) {
+  return kvstore::Open(GetSpec(directory)).value();
+}
+
+/// Returns the number of segment files in `directory`.
+std::size_t CountSegments(const std::string& directory) {
+  std::size_t count = 0;
+  TENSORSTORE_CHECK_OK(tensorstore::internal::EnumeratePaths(
+      directory, [&](const std::string& name, bool is_dir) {
+        if (!is_dir && absl::StrContains(name, "/segment-")) ++count;
+        return absl::OkStatus();
+      }));
+  return count;
+}
+
+TEST(LogStructuredKeyValueStoreTest, Basic) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  auto store = GetStore(tempdir.path() + "/root");
+  tensorstore::internal::TestKeyValueStoreBasicFunctionality(store);
+}
+
+TEST(LogStructuredKeyValueStoreTest, DeletePrefix) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  auto store = GetStore(tempdir.path() + "/root");
+  tensorstore::internal::TestKeyValueStoreDeletePrefix(store);
+}
+
+TEST(LogStructuredKeyValueStoreTest, DeleteRange) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  auto store = GetStore(tempdir.path() + "/root");
+  tensorstore::internal::TestKeyValueStoreDeleteRange(store);
+}
+
+TEST(LogStructuredKeyValueStoreTest, DeleteRangeToEnd) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  auto store = GetStore(tempdir.path() + "/root");
+  tensorstore::internal::TestKeyValueStoreDeleteRangeToEnd(store);
+}
+
+TEST(LogStructuredKeyValueStoreTest, DeleteRangeFromBeginning) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  auto store = GetStore(tempdir.path() + "/root");
+  tensorstore::internal::TestKeyValueStoreDeleteRangeFromBeginning(store);
+}
+
+TEST(LogStructuredKeyValueStoreTest, Reopen) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  StorageGeneration generation;
+  {
+    auto store = GetStore(root);
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto stamp, kvstore::Write(store, "a", absl::Cord("1")).result());
+    generation = stamp.generation;
+    TENSORSTORE_ASSERT_OK(kvstore::Write(store, "b", absl::Cord("2")));
+    TENSORSTORE_ASSERT_OK(kvstore::Delete(store, "b"));
+  }
+  auto store = GetStore(root);
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("1"), generation));
+  EXPECT_THAT(kvstore::Read(store, "b").result(),
+              MatchesKvsReadResultNotFound());
+  // Generations are not reused after reopening.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp, kvstore::Write(store, "a", absl::Cord("1")).result());
+  EXPECT_NE(generation, stamp.generation);
+}
+
+TEST(LogStructuredKeyValueStoreTest, Compaction) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  auto spec = GetSpec(root);
+  spec["segment_size"] = 4096;
+  constexpr int kNumKeys = 10;
+  constexpr int kNumIterations = 50;
+  {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store, kvstore::Open(spec).result());
+    for (int i = 0; i < kNumIterations; ++i) {
+      std::vector<
+          tensorstore::Future<tensorstore::TimestampedStorageGeneration>>
+          futures;
+      for (int key = 0; key < kNumKeys; ++key) {
+        futures.push_back(kvstore::Write(
+            store, tensorstore::StrCat(key),
+            absl::Cord(std::string(100, static_cast<char>('a' + i % 26)))));
+      }
+      for (auto& future : futures) {
+        TENSORSTORE_ASSERT_OK(future);
+      }
+    }
+    // Compaction runs between batches of writes; issue additional writes
+    // until it catches up.  Without compaction, there would be at least 13
+    // segments.
+    for (int i = 0; i < 20 && CountSegments(root) > 3; ++i) {
+      TENSORSTORE_ASSERT_OK(kvstore::Write(store, "sync", absl::Cord("x")));
+    }
+    EXPECT_LE(CountSegments(root), 3);
+  }
+
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store, kvstore::Open(spec).result());
+  for (int key = 0; key < kNumKeys; ++key) {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto read_result,
+        kvstore::Read(store, tensorstore::StrCat(key)).result());
+    EXPECT_EQ(std::string(100, 'a' + (kNumIterations - 1) % 26),
+              read_result.value);
+  }
+}
+
+TEST(LogStructuredKeyValueStoreTest, OpenWithDifferentOptions) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  auto store = GetStore(root);
+  TENSORSTORE_EXPECT_OK(kvstore::Open(GetSpec(root)).result());
+  auto spec = GetSpec(root);
+  spec["segment_size"] = 4096;
+  EXPECT_THAT(kvstore::Open(spec).result(),
+              MatchesStatus(absl::StatusCode::kFailedPrecondition,
+                            ".*already open with different options"));
+}
+
+TEST(LogStructuredKeyValueStoreTest, LockedByAnotherProcess) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  // A lock acquired through a separately opened file description conflicts
+  // with the store's lock in the same way as a lock held by another process.
+  TENSORSTORE_ASSERT_OK(tensorstore::internal_file_util::MakeDirectories(root));
+  {
+    UniqueFileDescriptor fd =
+        tensorstore::internal_file_util::OpenFileForWriting(root + "/LOCK");
+    ASSERT_TRUE(fd.valid());
+    ASSERT_TRUE(FileLockTraits::TryAcquire(fd.get()));
+    EXPECT_THAT(kvstore::Open(GetSpec(root)).result(),
+                MatchesStatus(absl::StatusCode::kFailedPrecondition,
+                              ".*is in use by another process.*"));
+    FileLockTraits::Close(fd.get());
+  }
+
+  auto store = GetStore(root);
+  UniqueFileDescriptor fd =
+      tensorstore::internal_file_util::OpenFileForWriting(root + "/LOCK");
+  ASSERT_TRUE(fd.valid());
+  EXPECT_FALSE(FileLockTraits::TryAcquire(fd.get()));
+}
+
+TEST(LogStructuredKeyValueStoreTest, SpecRoundtrip) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  tensorstore::internal::TestKeyValueStoreSpecRoundtrip(
+      GetSpec(tempdir.path() + "/root"));
+}
+
+TEST(LogStructuredKeyValueStoreTest, SpecRoundtripOptions) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  auto spec = GetSpec(tempdir.path() + "/root");
+  spec["segment_size"] = 1048576;
+  spec["compaction_threshold"] = 0.25;
+  spec["checkpoint_interval"] = 4096;
+  tensorstore::internal::TestKeyValueStoreSpecRoundtrip(spec);
+}
+
+TEST(LogStructuredKeyValueStoreTest, InvalidSpec) {
+  tensorstore::internal::ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  auto context = tensorstore::Context::Default();
+
+  // Test with extra key.
+  EXPECT_THAT(
+      kvstore::Open({{"driver", "log_structured"},
+                     {"directory", root},
+                     {"extra", "key"}},
+                    context)
+          .result(),
+      MatchesStatus(absl::StatusCode::kInvalidArgument));
+
+  // Test with missing `"directory"` key.
+  EXPECT_THAT(kvstore::Open({{"driver", "log_structured"}}, context).result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+
+  // Test with invalid `"segment_size"` key.
+  EXPECT_THAT(kvstore::Open({{"driver", "log_structured"},
+                             {"directory", root},
+                             {"segment_size", 0}},
+                            context)
+                  .result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+
+  // Test with invalid `"compaction_threshold"` key.
+  EXPECT_THAT(kvstore::Open({{"driver", "log_structured"},
+                             {"directory", root},
+                             {"compaction_threshold", 0}},
+                            context)
+                  .result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
@@ -52,6 +52,11 @@ TEST(MemoryKeyValueStoreTest, Basic) {
   tensorstore::internal::TestKeyValueStoreBasicFunctionality(store);
 }
 
+TEST(MemoryKeyValueStoreTest, ReadRanges) {
+  auto store = tensorstore::GetMemoryKeyValueStore();
+  tensorstore::internal::TestKeyValueStoreReadRanges(store);
+}
+
 TEST(MemoryKeyValueStoreTest, DeleteRange) {
   auto store = tensorstore::GetMemoryKeyValueStore();
   TENSORSTORE_EXPECT_OK(store->Write("a/b", absl::Cord("xyz")));
@@ -0,0 +1,229 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/neuroglancer_uint64_sharded/bulk_shard_writer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded.h"
+#include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded_encoder.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace neuroglancer_uint64_sharded {
+
+/// State shared between a `BulkShardWriter` and its pending shard writes.
+struct BulkShardWriter::State {
+  explicit State(Executor data_executor, std::size_t max_pending)
+      : data_executor(std::move(data_executor)), max_pending(max_pending) {}
+
+  const Executor data_executor;
+
+  /// Maximum number of shards that may be encoded or written concurrently.
+  const std::size_t max_pending;
+
+  absl::Mutex mutex;
+
+  /// Number of shards being encoded or written.
+  std::size_t num_pending ABSL_GUARDED_BY(mutex) = 0;
+
+  /// Completed shards that are waiting for `num_pending` to drop below
+  /// `max_pending`, in the order they were completed.
+  std::deque<ExecutorTask> queued ABSL_GUARDED_BY(mutex);
+
+  /// First error that occurred writing a shard.
+  absl::Status status ABSL_GUARDED_BY(mutex);
+
+  /// Promise returned by `Write` while `queued` is not empty, set once it
+  /// becomes empty.
+  Promise<void> capacity_promise ABSL_GUARDED_BY(mutex);
+
+  /// Promise returned by `Finalize`, set once `num_pending` reaches 0.
+  Promise<void> finalize_promise ABSL_GUARDED_BY(mutex);
+
+  /// Starts encoding and writing a completed shard, or queues it if
+  /// `max_pending` shards are already pending.
+  void StartShard(ExecutorTask task) {
+    {
+      absl::MutexLock lock(&mutex);
+      if (num_pending >= max_pending) {
+        queued.push_back(std::move(task));
+        return;
+      }
+      ++num_pending;
+    }
+    data_executor(std::move(task));
+  }
+
+  /// Returns an error if a completed shard is queued, meaning that the future
+  /// returned by the previous `Write` is not ready.
+  absl::Status CheckCapacity() {
+    absl::MutexLock lock(&mutex);
+    if (queued.empty()) return absl::OkStatus();
+    return absl::FailedPreconditionError(
+        "Write called before the future returned by the previous call became "
+        "ready");
+  }
+
+  /// Returns a future that becomes ready once no completed shards are queued.
+  Future<const void> GetCapacityFuture() {
+    absl::MutexLock lock(&mutex);
+    TENSORSTORE_RETURN_IF_ERROR(status);
+    if (queued.empty()) return MakeReadyFuture();
+    if (auto future = capacity_promise.future(); !future.null()) {
+      return future;
+    }
+    auto [promise, future] = PromiseFuturePair<void>::Make(MakeResult());
+    capacity_promise = std::move(promise);
+    return std::move(future);
+  }
+
+  /// Marks a shard write as complete, and starts the next queued shard.
+  void ShardDone(const absl::Status& shard_status) {
+    ExecutorTask next;
+    Promise<void> capacity;
+    Promise<void> finalize;
+    absl::Status final_status;
+    {
+      absl::MutexLock lock(&mutex);
+      status.Update(shard_status);
+      final_status = status;
+      if (!queued.empty()) {
+        // The next shard takes the place of this one in `num_pending`.
+        next = std::move(queued.front());
+        queued.pop_front();
+        if (queued.empty()) capacity = std::move(capacity_promise);
+      } else if (--num_pending == 0) {
+        finalize = std::move(finalize_promise);
+      }
+    }
+    if (!capacity.null()) capacity.SetResult(MakeResult(final_status));
+    if (!finalize.null()) finalize.SetResult(MakeResult(final_status));
+    if (next) data_executor(std::move(next));
+  }
+};
+
+namespace {
+
+/// Encodes a shard from unencoded chunks with distinct ids.
+absl::Cord EncodeShardFromChunks(const ShardingSpec& sharding_spec,
+                                 std::vector<EncodedChunk>& chunks) {
+  std::sort(chunks.begin(), chunks.end(),
+            [](const EncodedChunk& a, const EncodedChunk& b) {
+              return a.minishard_and_chunk_id < b.minishard_and_chunk_id;
+            });
+  for (auto& chunk : chunks) {
+    chunk.encoded_data =
+        EncodeData(chunk.encoded_data, sharding_spec.data_encoding);
+  }
+  auto encoded = EncodeShard(sharding_spec, chunks);
+  assert(encoded);
+  return std::move(*encoded);
+}
+
+}  // namespace
+
+BulkShardWriter::BulkShardWriter(kvstore::DriverPtr base_kvstore,
+                                 Executor data_executor, std::string key_prefix,
+                                 const ShardingSpec& sharding_spec,
+                                 std::size_t max_pending_shards)
+    : base_kvstore_(std::move(base_kvstore)),
+      key_prefix_(std::move(key_prefix)),
+      sharding_spec_(sharding_spec),
+      state_(std::make_shared<State>(
+          std::move(data_executor),
+          std::max(max_pending_shards, std::size_t(1)))) {}
+
+BulkShardWriter::~BulkShardWriter() = default;
+
+Future<const void> BulkShardWriter::Write(ChunkId chunk_id,
+                                          absl::Cord value) {
+  TENSORSTORE_RETURN_IF_ERROR(state_->CheckCapacity());
+  const auto shard_info = GetSplitShardInfo(
+      sharding_spec_, GetChunkShardInfo(sharding_spec_, chunk_id));
+  if (shard_ != shard_info.shard) {
+    if (completed_shards_.contains(shard_info.shard)) {
+      return absl::InvalidArgumentError(tensorstore::StrCat(
+          "Chunk ", chunk_id.value, " belongs to shard ", shard_info.shard,
+          ", which was already completed; chunks must be grouped by shard"));
+    }
+    FlushShard();
+    shard_ = shard_info.shard;
+  }
+  if (!chunk_ids_.insert(chunk_id.value).second) {
+    return absl::InvalidArgumentError(tensorstore::StrCat(
+        "Chunk ", chunk_id.value, " written more than once"));
+  }
+  chunks_.push_back(EncodedChunk{{shard_info.minishard, chunk_id},
+                                 std::move(value)});
+  return state_->GetCapacityFuture();
+}
+
+void BulkShardWriter::FlushShard() {
+  if (!shard_) return;
+  const std::uint64_t shard = *shard_;
+  completed_shards_.insert(shard);
+  shard_ = std::nullopt;
+  chunk_ids_.clear();
+  if (chunks_.empty()) return;
+  state_->StartShard([state = state_, base_kvstore = base_kvstore_,
+                      key = GetShardKey(sharding_spec_, key_prefix_, shard),
+                      sharding_spec = sharding_spec_,
+                      chunks = std::exchange(chunks_, {})]() mutable {
+    auto encoded = EncodeShardFromChunks(sharding_spec, chunks);
+    chunks.clear();
+    auto future = base_kvstore->Write(key, std::move(encoded));
+    future.Force();
+    future.ExecuteWhenReady([state = std::move(state)](
+                                ReadyFuture<TimestampedStorageGeneration> f) {
+      state->ShardDone(GetStatus(f.result()));
+    });
+  });
+}
+
+Future<const void> BulkShardWriter::Finalize() {
+  FlushShard();
+  auto [promise, future] = PromiseFuturePair<void>::Make(MakeResult());
+  absl::Status status;
+  {
+    absl::MutexLock lock(&state_->mutex);
+    if (state_->num_pending != 0) {
+      state_->finalize_promise = std::move(promise);
+      return std::move(future);
+    }
+    status = state_->status;
+  }
+  promise.SetResult(MakeResult(status));
+  return std::move(future);
+}
+
+}  // namespace neuroglancer_uint64_sharded
+}  // namespace tensorstore
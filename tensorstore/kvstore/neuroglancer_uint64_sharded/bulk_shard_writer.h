@@ -0,0 +1,144 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_NEUROGLANCER_UINT64_SHARDED_BULK_SHARD_WRITER_H_
+#define TENSORSTORE_KVSTORE_NEUROGLANCER_UINT64_SHARDED_BULK_SHARD_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+
+namespace tensorstore {
+namespace neuroglancer_uint64_sharded {
+
+/// Writes a new sharded database in a single pass, without buffering all of
+/// the chunks of a shard in a transaction.
+///
+/// Writing through the `KeyValueStore` returned by `GetShardedKeyValueStore`
+/// requires all of the chunks of a shard to be buffered (typically within a
+/// transaction) until the shard is committed.  In contrast, `BulkShardWriter`
+/// requires that the chunks be written grouped by shard: once a chunk of a
+/// different shard is written, the current shard is complete, and it is
+/// encoded using `data_executor` and written to `base_kvstore` in the
+/// background.  Multiple shards are encoded concurrently.
+///
+/// .. warning::
+///
+///    Each call to `Write` must wait for the future returned by the previous
+///    call to become ready; a call made earlier fails with
+///    `absl::StatusCode::kFailedPrecondition`.  This bounds memory usage by the
+///    data of `max_pending_shards + 1` completed shards and the chunks of the
+///    current shard.
+///
+/// Shards are written unconditionally, replacing any existing shard.  All of
+/// the chunks of a given shard must be written by a single `BulkShardWriter`.
+///
+/// The `Write` and `Finalize` methods must not be called concurrently.
+///
+/// Example usage:
+///
+///     BulkShardWriter writer(base_kvstore, executor, "prefix",
+///                            sharding_spec);
+///     for (...) {
+///       TENSORSTORE_RETURN_IF_ERROR(writer.Write(chunk_id, value).result());
+///     }
+///     TENSORSTORE_RETURN_IF_ERROR(writer.Finalize().result());
+class BulkShardWriter {
+ public:
+  /// Constructs a writer.
+  ///
+  /// \param base_kvstore The underlying `KeyValueStore` to which the shard
+  ///     files are written.
+  /// \param data_executor Executor used to encode the shards.
+  /// \param key_prefix Prefix of the sharded database within `base_kvstore`.
+  /// \param sharding_spec Sharding specification.
+  /// \param max_pending_shards Maximum number of completed shards that may be
+  ///     concurrently encoded or written.  Must be at least 1.
+  explicit BulkShardWriter(kvstore::DriverPtr base_kvstore,
+                           Executor data_executor, std::string key_prefix,
+                           const ShardingSpec& sharding_spec,
+                           std::size_t max_pending_shards = 2);
+
+  BulkShardWriter(const BulkShardWriter&) = delete;
+  BulkShardWriter& operator=(const BulkShardWriter&) = delete;
+
+  /// Discards any chunks written since the last complete shard.  Shards that
+  /// are already being written continue in the background.
+  ~BulkShardWriter();
+
+  /// Writes a chunk.
+  ///
+  /// If `chunk_id` belongs to a different shard than the previous chunk, the
+  /// previous shard is completed and written in the background, or queued if
+  /// `max_pending_shards` shards are already being encoded or written.  Never
+  /// blocks, so it may be called from `data_executor`.
+  ///
+  /// \param chunk_id The chunk id.
+  /// \param value The unencoded chunk data.
+  /// \returns A future that becomes ready once no completed shard is queued,
+  ///     at which point the next chunk may be written.
+  /// \error `absl::StatusCode::kFailedPrecondition` if the future returned by
+  ///     the previous call is not yet ready.
+  /// \error `absl::StatusCode::kInvalidArgument` if the shard of `chunk_id`
+  ///     was already completed, or `chunk_id` was already written.
+  /// \error Any error from writing a previously completed shard.
+  Future<const void> Write(ChunkId chunk_id, absl::Cord value);
+
+  /// Completes the current shard.
+  ///
+  /// \returns A future that becomes ready once all shards have been written.
+  /// \error Any error from writing a shard to `base_kvstore`.
+  Future<const void> Finalize();
+
+ private:
+  struct State;
+
+  /// Starts encoding and writing the current shard, if any.
+  void FlushShard();
+
+  kvstore::DriverPtr base_kvstore_;
+  std::string key_prefix_;
+  ShardingSpec sharding_spec_;
+
+  /// Shared with the pending shard writes.
+  std::shared_ptr<State> state_;
+
+  /// Shard to which the chunks in `chunks_` belong.
+  std::optional<std::uint64_t> shard_;
+
+  /// Unencoded chunks of `shard_`, in the order they were written.
+  std::vector<EncodedChunk> chunks_;
+
+  /// Ids of the chunks in `chunks_`.
+  absl::flat_hash_set<std::uint64_t> chunk_ids_;
+
+  /// Shards that have been completed.
+  absl::flat_hash_set<std::uint64_t> completed_shards_;
+};
+
+}  // namespace neuroglancer_uint64_sharded
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_NEUROGLANCER_UINT64_SHARDED_BULK_SHARD_WRITER_H_
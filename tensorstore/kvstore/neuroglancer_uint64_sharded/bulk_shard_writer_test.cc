@@ -0,0 +1,159 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/neuroglancer_uint64_sharded/bulk_shard_writer.h"
+
+#include <cstdint>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/internal/cache/cache.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/memory/memory_key_value_store.h"
+#include "tensorstore/kvstore/mock_kvstore.h"
+#include "tensorstore/kvstore/neuroglancer_uint64_sharded/neuroglancer_uint64_sharded.h"
+#include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded.h"
+#include "tensorstore/kvstore/test_util.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+namespace kvstore = ::tensorstore::kvstore;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::internal::CachePool;
+using ::tensorstore::internal::MatchesKvsReadResult;
+using ::tensorstore::internal::MatchesKvsReadResultNotFound;
+using ::tensorstore::internal::MockKeyValueStore;
+using ::tensorstore::neuroglancer_uint64_sharded::BulkShardWriter;
+using ::tensorstore::neuroglancer_uint64_sharded::ChunkIdToKey;
+using ::tensorstore::neuroglancer_uint64_sharded::GetShardedKeyValueStore;
+using ::tensorstore::neuroglancer_uint64_sharded::ShardingSpec;
+
+class BulkShardWriterTest : public ::testing::Test {
+ protected:
+  // Chunk `i` is stored in minishard `i % 2` of shard `i / 2`.
+  ::nlohmann::json sharding_spec_json{
+      {"@type", "neuroglancer_uint64_sharded_v1"},
+      {"hash", "identity"},
+      {"preshift_bits", 0},
+      {"minishard_bits", 1},
+      {"shard_bits", 2},
+      {"data_encoding", "gzip"},
+      {"minishard_index_encoding", "gzip"}};
+  ShardingSpec sharding_spec =
+      ShardingSpec::FromJson(sharding_spec_json).value();
+  kvstore::DriverPtr base_kv_store = tensorstore::GetMemoryKeyValueStore();
+  BulkShardWriter writer{base_kv_store, tensorstore::InlineExecutor{},
+                         "prefix", sharding_spec};
+
+  kvstore::DriverPtr GetStore() {
+    return GetShardedKeyValueStore(
+        base_kv_store, tensorstore::InlineExecutor{}, "prefix", sharding_spec,
+        CachePool::WeakPtr(CachePool::Make(CachePool::Limits{})));
+  }
+};
+
+TEST_F(BulkShardWriterTest, Basic) {
+  TENSORSTORE_ASSERT_OK(writer.Write({1}, absl::Cord("b")).result());
+  TENSORSTORE_ASSERT_OK(writer.Write({0}, absl::Cord("a")).result());
+  TENSORSTORE_ASSERT_OK(writer.Write({3}, absl::Cord("d")).result());
+  // Shard 0 is written as soon as a chunk of another shard is written.
+  EXPECT_THAT(base_kv_store->Read("prefix/0.shard").result(),
+              MatchesKvsReadResult(::testing::_));
+  EXPECT_THAT(base_kv_store->Read("prefix/1.shard").result(),
+              MatchesKvsReadResultNotFound());
+  TENSORSTORE_ASSERT_OK(writer.Write({6}, absl::Cord("g")).result());
+  TENSORSTORE_ASSERT_OK(writer.Finalize().result());
+
+  auto store = GetStore();
+  EXPECT_THAT(store->Read(ChunkIdToKey({0})).result(),
+              MatchesKvsReadResult(absl::Cord("a")));
+  EXPECT_THAT(store->Read(ChunkIdToKey({1})).result(),
+              MatchesKvsReadResult(absl::Cord("b")));
+  EXPECT_THAT(store->Read(ChunkIdToKey({2})).result(),
+              MatchesKvsReadResultNotFound());
+  EXPECT_THAT(store->Read(ChunkIdToKey({3})).result(),
+              MatchesKvsReadResult(absl::Cord("d")));
+  EXPECT_THAT(store->Read(ChunkIdToKey({6})).result(),
+              MatchesKvsReadResult(absl::Cord("g")));
+}
+
+TEST_F(BulkShardWriterTest, Empty) {
+  TENSORSTORE_ASSERT_OK(writer.Finalize().result());
+}
+
+TEST_F(BulkShardWriterTest, ShardAlreadyCompleted) {
+  TENSORSTORE_ASSERT_OK(writer.Write({0}, absl::Cord("a")).result());
+  TENSORSTORE_ASSERT_OK(writer.Write({2}, absl::Cord("c")).result());
+  EXPECT_THAT(writer.Write({1}, absl::Cord("b")).result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument,
+                            "Chunk 1 belongs to shard 0, which was already "
+                            "completed; chunks must be grouped by shard"));
+  TENSORSTORE_ASSERT_OK(writer.Finalize().result());
+}
+
+TEST_F(BulkShardWriterTest, DuplicateChunk) {
+  TENSORSTORE_ASSERT_OK(writer.Write({0}, absl::Cord("a")).result());
+  EXPECT_THAT(writer.Write({0}, absl::Cord("b")).result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument,
+                            "Chunk 0 written more than once"));
+  TENSORSTORE_ASSERT_OK(writer.Finalize().result());
+  EXPECT_THAT(GetStore()->Read(ChunkIdToKey({0})).result(),
+              MatchesKvsReadResult(absl::Cord("a")));
+}
+
+// Completed shards are queued, rather than blocking `Write`, while
+// `max_pending_shards` shards are being written, and at most one shard is
+// queued.
+TEST_F(BulkShardWriterTest, Capacity) {
+  auto mock_store = MockKeyValueStore::Make();
+  BulkShardWriter mock_writer{mock_store, tensorstore::InlineExecutor{},
+                              "prefix", sharding_spec,
+                              /*max_pending_shards=*/1};
+  TENSORSTORE_ASSERT_OK(mock_writer.Write({0}, absl::Cord("a")).result());
+  // Shard 0 is written.
+  TENSORSTORE_ASSERT_OK(mock_writer.Write({2}, absl::Cord("c")).result());
+  // Shard 1 is queued.
+  auto future = mock_writer.Write({4}, absl::Cord("e"));
+  EXPECT_FALSE(future.ready());
+  // Writing another chunk before `future` is ready would buffer an unbounded
+  // number of shards.
+  EXPECT_THAT(mock_writer.Write({5}, absl::Cord("f")).result(),
+              MatchesStatus(absl::StatusCode::kFailedPrecondition,
+                            "Write called before the future returned by the "
+                            "previous call became ready"));
+  {
+    auto req = mock_store->write_requests.pop();
+    EXPECT_EQ("prefix/0.shard", req.key);
+    req(base_kv_store);
+  }
+  ASSERT_TRUE(future.ready());
+  TENSORSTORE_ASSERT_OK(future.result());
+  auto finalize_future = mock_writer.Finalize();
+  for (const char* key : {"prefix/1.shard", "prefix/2.shard"}) {
+    EXPECT_FALSE(finalize_future.ready());
+    auto req = mock_store->write_requests.pop();
+    EXPECT_EQ(key, req.key);
+    req(base_kv_store);
+  }
+  TENSORSTORE_ASSERT_OK(finalize_future.result());
+  EXPECT_THAT(GetStore()->Read(ChunkIdToKey({4})).result(),
+              MatchesKvsReadResult(absl::Cord("e")));
+}
+
+}  // namespace
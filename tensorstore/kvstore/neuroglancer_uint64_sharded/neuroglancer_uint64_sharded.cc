@@ -14,23 +14,34 @@
 
 #include "tensorstore/kvstore/neuroglancer_uint64_sharded/neuroglancer_uint64_sharded.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/base/internal/endian.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "tensorstore/internal/cache/async_cache.h"
 #include "tensorstore/internal/cache/cache_pool_resource.h"
 #include "tensorstore/internal/cache/kvs_backed_cache.h"
+#include "tensorstore/internal/cache_key/absl_time.h"
 #include "tensorstore/internal/compression/zlib.h"
 #include "tensorstore/internal/data_copy_concurrency_resource.h"
 #include "tensorstore/internal/estimate_heap_usage/estimate_heap_usage.h"
 #include "tensorstore/internal/estimate_heap_usage/std_vector.h"
+#include "tensorstore/internal/json_binding/absl_time.h"
 #include "tensorstore/internal/json_binding/bindable.h"
 #include "tensorstore/internal/json_binding/json_binding.h"
 #include "tensorstore/internal/mutex.h"
+#include "tensorstore/internal/schedule_at.h"
 #include "tensorstore/json_serialization_options_base.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded.h"
@@ -38,6 +49,7 @@
 #include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded_encoder.h"
 #include "tensorstore/kvstore/registry.h"
 #include "tensorstore/kvstore/transaction.h"
+#include "tensorstore/serialization/absl_time.h"
 #include "tensorstore/util/execution/any_receiver.h"
 #include "tensorstore/util/execution/result_sender.h"
 #include "tensorstore/util/future.h"
@@ -53,6 +65,305 @@ namespace {
 using ::tensorstore::internal::ConvertInvalidArgumentToFailedPrecondition;
 using ::tensorstore::internal::IntrusivePtr;
 
+/// Combines concurrent reads of byte ranges of the same shard.
+///
+/// Reads of the same key with the same `if_equal` and `if_not_equal`
+/// conditions that are issued within `window` of the first such read are
+/// combined into a single `ReadRanges` request to the base kvstore, which
+/// fetches nearby byte ranges together.  All reads of the shard index,
+/// minishard indices, and chunk data go through the batcher if read batching is
+/// enabled, such that reading many chunks of the same shard requires only a few
+/// requests to the base kvstore.
+class ShardReadBatcher
+    : public internal::AtomicReferenceCount<ShardReadBatcher> {
+ public:
+  explicit ShardReadBatcher(kvstore::DriverPtr base, absl::Duration window)
+      : base_(std::move(base)), window_(window) {}
+
+  absl::Duration window() const { return window_; }
+
+  Future<kvstore::ReadResult> Read(std::string key,
+                                   kvstore::ReadOptions options) {
+    auto [promise, future] = PromiseFuturePair<kvstore::ReadResult>::Make();
+    BatchKey batch_key{std::move(key), options.if_equal.value,
+                       options.if_not_equal.value};
+    bool first;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto [it, inserted] = pending_.try_emplace(batch_key);
+      Batch& batch = it->second;
+      first = inserted;
+      if (first) {
+        batch.if_equal = std::move(options.if_equal);
+        batch.if_not_equal = std::move(options.if_not_equal);
+        batch.staleness_bound = options.staleness_bound;
+      } else {
+        // Satisfy the most restrictive staleness bound of the batch.
+        batch.staleness_bound =
+            std::max(batch.staleness_bound, options.staleness_bound);
+      }
+      batch.reads.push_back(
+          PendingRead{options.byte_range, std::move(promise)});
+    }
+    if (first) {
+      internal::ScheduleAt(
+          absl::Now() + window_,
+          [self = IntrusivePtr<ShardReadBatcher>(this),
+           batch_key = std::move(batch_key)] { self->Flush(batch_key); });
+    }
+    return std::move(future);
+  }
+
+ private:
+  struct PendingRead {
+    OptionalByteRangeRequest byte_range;
+    Promise<kvstore::ReadResult> promise;
+  };
+
+  struct Batch {
+    StorageGeneration if_equal;
+    StorageGeneration if_not_equal;
+    absl::Time staleness_bound;
+    std::vector<PendingRead> reads;
+  };
+
+  /// Key, `if_equal` and `if_not_equal` of a batch.
+  using BatchKey = std::tuple<std::string, std::string, std::string>;
+
+  /// Issues the pending batch for `batch_key`.
+  void Flush(const BatchKey& batch_key) {
+    Batch batch;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto it = pending_.find(batch_key);
+      batch = std::move(it->second);
+      pending_.erase(it);
+    }
+    const std::string& key = std::get<0>(batch_key);
+    if (batch.reads.size() == 1) {
+      IssueRead(key, batch, batch.reads[0]);
+      return;
+    }
+    kvstore::ReadRangesOptions options;
+    options.if_equal = batch.if_equal;
+    options.if_not_equal = batch.if_not_equal;
+    options.staleness_bound = batch.staleness_bound;
+    options.byte_ranges.reserve(batch.reads.size());
+    for (const auto& read : batch.reads) {
+      options.byte_ranges.push_back(read.byte_range);
+    }
+    base_->ReadRanges(key, std::move(options))
+        .ExecuteWhenReady([self = IntrusivePtr<ShardReadBatcher>(this), key,
+                           batch = std::move(batch)](
+                              ReadyFuture<kvstore::ReadRangesResult> future) {
+          auto& r = future.result();
+          if (!r.ok()) {
+            // A single invalid byte range fails the entire `ReadRanges`
+            // request.  Retry each read individually such that only the
+            // affected reads fail.
+            for (const auto& read : batch.reads) {
+              self->IssueRead(key, batch, read);
+            }
+            return;
+          }
+          for (size_t i = 0; i < batch.reads.size(); ++i) {
+            kvstore::ReadResult read_result{r->state, {}, r->stamp};
+            if (r->has_value()) read_result.value = r->values[i];
+            batch.reads[i].promise.SetResult(std::move(read_result));
+          }
+        });
+  }
+
+  void IssueRead(const std::string& key, const Batch& batch,
+                 const PendingRead& read) {
+    kvstore::ReadOptions options;
+    options.if_equal = batch.if_equal;
+    options.if_not_equal = batch.if_not_equal;
+    options.staleness_bound = batch.staleness_bound;
+    options.byte_range = read.byte_range;
+    LinkResult(read.promise, base_->Read(key, std::move(options)));
+  }
+
+  kvstore::DriverPtr base_;
+  absl::Duration window_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<BatchKey, Batch> pending_ ABSL_GUARDED_BY(mutex_);
+};
+
+/// Reads `key` from `base`, via `batcher` if read batching is enabled.
+Future<kvstore::ReadResult> ReadShard(kvstore::Driver& base,
+                                      ShardReadBatcher* batcher,
+                                      std::string key,
+                                      kvstore::ReadOptions options) {
+  if (batcher) return batcher->Read(std::move(key), std::move(options));
+  return base.Read(std::move(key), std::move(options));
+}
+
+/// Read-only KeyValueStore for retrieving a shard index
+///
+/// The key is the uint64 shard number (in native memory layout).  The value is
+/// the encoded shard index, which is read from the beginning of the shard.
+///
+/// This is used by `ShardIndexCache`, in the same way that
+/// `MinishardIndexKeyValueStore` is used by `MinishardIndexCache`.
+class ShardIndexKeyValueStore : public kvstore::Driver {
+ public:
+  explicit ShardIndexKeyValueStore(kvstore::DriverPtr base, Executor executor,
+                                   std::string key_prefix,
+                                   const ShardingSpec& sharding_spec,
+                                   IntrusivePtr<ShardReadBatcher> batcher)
+      : base_(std::move(base)),
+        executor_(std::move(executor)),
+        key_prefix_(key_prefix),
+        sharding_spec_(sharding_spec),
+        batcher_(std::move(batcher)) {}
+
+  Future<ReadResult> Read(Key key, ReadOptions options) override {
+    std::uint64_t shard;
+    if (key.size() != sizeof(shard)) {
+      return absl::InvalidArgumentError("Key does not specify a shard");
+    }
+    std::memcpy(&shard, key.data(), sizeof(shard));
+    if (options.byte_range != OptionalByteRangeRequest()) {
+      // Byte range requests are not useful for shard indices.
+      return absl::InvalidArgumentError("Byte ranges not supported");
+    }
+    options.byte_range = {
+        0, static_cast<int64_t>(ShardIndexSize(sharding_spec_))};
+    return ReadShard(*base_, batcher_.get(),
+                     GetShardKey(sharding_spec_, key_prefix_, shard),
+                     std::move(options));
+  }
+
+  std::string DescribeKey(std::string_view key) override {
+    std::uint64_t shard;
+    if (key.size() != sizeof(shard)) {
+      return tensorstore::StrCat("invalid key ", tensorstore::QuoteString(key));
+    }
+    std::memcpy(&shard, key.data(), sizeof(shard));
+    return tensorstore::StrCat(
+        "shard index in ",
+        base_->DescribeKey(GetShardKey(sharding_spec_, key_prefix_, shard)));
+  }
+
+  void GarbageCollectionVisit(
+      garbage_collection::GarbageCollectionVisitor& visitor) const final {
+    // No-op
+  }
+
+  const ShardingSpec& sharding_spec() { return sharding_spec_; }
+  const Executor& executor() const { return executor_; }
+
+ private:
+  kvstore::DriverPtr base_;
+  Executor executor_;
+  std::string key_prefix_;
+  ShardingSpec sharding_spec_;
+  IntrusivePtr<ShardReadBatcher> batcher_;
+};
+
+/// Caches shard indexes.
+///
+/// Each cache entry corresponds to a particular shard, and the entry key
+/// directly encodes the uint64 shard number (via `memcpy`).  The decoded
+/// shard index specifies the absolute byte range of each minishard index, such
+/// that an uncached minishard index can be located without an additional read
+/// of its shard index entry.
+///
+/// This cache is only used for reading.
+class ShardIndexCache
+    : public internal::KvsBackedCache<ShardIndexCache, internal::AsyncCache> {
+  using Base = internal::KvsBackedCache<ShardIndexCache, internal::AsyncCache>;
+
+ public:
+  /// Absolute byte range of the minishard index, indexed by minishard.
+  using ReadData = std::vector<ByteRange>;
+
+  static std::string ShardToKey(std::uint64_t shard) {
+    return std::string(reinterpret_cast<const char*>(&shard), sizeof(shard));
+  }
+
+  class Entry : public Base::Entry {
+   public:
+    using OwningCache = ShardIndexCache;
+
+    std::size_t ComputeReadDataSizeInBytes(const void* read_data) override {
+      return internal::EstimateHeapUsage(
+          *static_cast<const ReadData*>(read_data));
+    }
+
+    void DoDecode(std::optional<absl::Cord> value,
+                  DecodeReceiver receiver) override {
+      GetOwningCache(*this).executor()(
+          [this, value = std::move(value),
+           receiver = std::move(receiver)]() mutable {
+            std::shared_ptr<ReadData> read_data;
+            if (value) {
+              if (auto result = DecodeShardIndex(
+                      *value, GetOwningCache(*this).sharding_spec());
+                  result.ok()) {
+                read_data = std::make_shared<ReadData>(std::move(*result));
+              } else {
+                execution::set_error(receiver,
+                                     ConvertInvalidArgumentToFailedPrecondition(
+                                         std::move(result).status()));
+                return;
+              }
+            }
+            execution::set_value(receiver, std::move(read_data));
+          });
+    }
+
+    static Result<ReadData> DecodeShardIndex(
+        const absl::Cord& value, const ShardingSpec& sharding_spec) {
+      if (value.size() != ShardIndexSize(sharding_spec)) {
+        return absl::FailedPreconditionError(
+            tensorstore::StrCat("Expected shard index of size ",
+                                ShardIndexSize(sharding_spec),
+                                ", but received: ", value.size()));
+      }
+      const std::string flat(value);
+      ReadData shard_index(sharding_spec.num_minishards());
+      for (size_t i = 0; i < shard_index.size(); ++i) {
+        TENSORSTORE_ASSIGN_OR_RETURN(
+            auto byte_range,
+            DecodeShardIndexEntry(std::string_view(flat).substr(i * 16, 16)));
+        TENSORSTORE_ASSIGN_OR_RETURN(
+            shard_index[i],
+            GetAbsoluteShardByteRange(byte_range, sharding_spec),
+            tensorstore::MaybeAnnotateStatus(
+                _, tensorstore::StrCat("Error decoding shard index entry for "
+                                       "minishard ",
+                                       i)));
+      }
+      return shard_index;
+    }
+  };
+
+  Entry* DoAllocateEntry() final { return new Entry; }
+  std::size_t DoGetSizeofEntry() final { return sizeof(Entry); }
+  TransactionNode* DoAllocateTransactionNode(AsyncCache::Entry& entry) final {
+    return new TransactionNode(static_cast<Entry&>(entry));
+  }
+
+  explicit ShardIndexCache(kvstore::DriverPtr base_kvstore, Executor executor,
+                           std::string key_prefix,
+                           const ShardingSpec& sharding_spec,
+                           IntrusivePtr<ShardReadBatcher> batcher = {})
+      : Base(kvstore::DriverPtr(new ShardIndexKeyValueStore(
+            std::move(base_kvstore), executor, std::move(key_prefix),
+            sharding_spec, std::move(batcher)))) {}
+
+  ShardIndexKeyValueStore* kvstore_driver() {
+    return static_cast<ShardIndexKeyValueStore*>(this->Base::kvstore_driver());
+  }
+
+  const ShardingSpec& sharding_spec() {
+    return kvstore_driver()->sharding_spec();
+  }
+  const Executor& executor() { return kvstore_driver()->executor(); }
+};
+
 /// Read-only KeyValueStore for retrieving a minishard index
 ///
 /// The key is a `ChunkCombinedShardInfo` (in native memory layout).  The value
@@ -64,14 +375,17 @@ using ::tensorstore::internal::IntrusivePtr;
 /// advantage of `KvsBackedCache` to define `MinishardIndexCache`.
 class MinishardIndexKeyValueStore : public kvstore::Driver {
  public:
-  explicit MinishardIndexKeyValueStore(kvstore::DriverPtr base,
-                                       Executor executor,
-                                       std::string key_prefix,
-                                       const ShardingSpec& sharding_spec)
+  explicit MinishardIndexKeyValueStore(
+      kvstore::DriverPtr base, Executor executor, std::string key_prefix,
+      const ShardingSpec& sharding_spec,
+      internal::CachePtr<ShardIndexCache> shard_index_cache,
+      IntrusivePtr<ShardReadBatcher> batcher)
       : base_(std::move(base)),
         executor_(std::move(executor)),
         key_prefix_(key_prefix),
-        sharding_spec_(sharding_spec) {}
+        sharding_spec_(sharding_spec),
+        shard_index_cache_(std::move(shard_index_cache)),
+        batcher_(std::move(batcher)) {}
 
   Future<ReadResult> Read(Key key, ReadOptions options) override {
     ChunkCombinedShardInfo combined_info;
@@ -112,6 +426,22 @@ class MinishardIndexKeyValueStore : public kvstore::Driver {
   const std::string& key_prefix() const { return key_prefix_; }
   const Executor& executor() const { return executor_; }
 
+  /// Reads a byte range of the specified shard.
+  Future<ReadResult> ReadFromShard(std::uint64_t shard, ReadOptions options) {
+    return ReadShard(*base_, batcher_.get(),
+                     GetShardKey(sharding_spec_, key_prefix_, shard),
+                     std::move(options));
+  }
+
+  /// Returns the cache of entire shard indices, or `nullptr` if shard index
+  /// entries are read individually.
+  const internal::CachePtr<ShardIndexCache>& shard_index_cache() const {
+    return shard_index_cache_;
+  }
+
+  /// Returns the read batcher, or `nullptr` if read batching is disabled.
+  const IntrusivePtr<ShardReadBatcher>& batcher() const { return batcher_; }
+
  private:
   /// Asynchronously recursive implementation of `Read`, to handle retrying as
   /// may be required in the case of concurrent modifications, as described
@@ -120,7 +450,9 @@ class MinishardIndexKeyValueStore : public kvstore::Driver {
               ReadOptions options) {
     // Reading a minishard index proceeds as follows:
     //
-    // 1. Request the shard index.
+    // 1. Request the shard index entry, or the entire shard index if
+    //    `shard_index_cache_` is enabled, in which case the shard index may
+    //    already be cached.
     //
     //    a. If not found, the minishard is empty.  Done.
     //
@@ -211,28 +543,92 @@ class MinishardIndexKeyValueStore : public kvstore::Driver {
           SetError(promise, std::move(byte_range_result).status());
           return;
         }
+        ReadMinishardIndex(std::move(self), std::move(promise), split_info,
+                           byte_range, std::move(r->stamp), staleness_bound);
+      }
+
+      /// Requests the minishard index at the absolute `byte_range` of the
+      /// shard (step 2 above).
+      static void ReadMinishardIndex(
+          IntrusivePtr<MinishardIndexKeyValueStore> self,
+          Promise<kvstore::ReadResult> promise, ChunkSplitShardInfo split_info,
+          ByteRange byte_range, TimestampedStorageGeneration stamp,
+          absl::Time staleness_bound) {
         if (byte_range.size() == 0) {
           // Minishard index is 0 bytes, which means the minishard is empty.
-          r->value.Clear();
-          r->state = kvstore::ReadResult::kMissing;
-          promise.SetResult(std::move(r));
+          promise.SetResult(kvstore::ReadResult{kvstore::ReadResult::kMissing,
+                                                {},
+                                                std::move(stamp)});
           return;
         }
         kvstore::ReadOptions kvs_read_options;
         // The `if_equal` condition ensure that an "aborted" `ReadResult` is
         // returned in the case of a concurrent modification (case 2a above).
-        kvs_read_options.if_equal = std::move(r->stamp.generation);
+        kvs_read_options.if_equal = std::move(stamp.generation);
         kvs_read_options.staleness_bound = staleness_bound;
         kvs_read_options.byte_range = byte_range;
-        auto read_future =
-            self->base_->Read(GetShardKey(self->sharding_spec_,
-                                          self->key_prefix_, split_info.shard),
-                              std::move(kvs_read_options));
-        Link(WithExecutor(self->executor_,
-                          MinishardIndexReadyCallback{self, split_info}),
+        auto read_future = self->ReadFromShard(split_info.shard,
+                                               std::move(kvs_read_options));
+        auto executor = self->executor_;
+        Link(WithExecutor(std::move(executor),
+                          MinishardIndexReadyCallback{std::move(self),
+                                                      split_info}),
              std::move(promise), std::move(read_future));
       }
     };
+
+    struct ShardIndexCacheEntryReadyCallback {
+      IntrusivePtr<MinishardIndexKeyValueStore> self;
+      internal::PinnedCacheEntry<ShardIndexCache> entry;
+      ChunkSplitShardInfo split_info;
+      ReadOptions options;
+
+      void operator()(Promise<kvstore::ReadResult> promise,
+                      ReadyFuture<const void> future) {
+        if (!future.result().ok()) {
+          return ShardIndexReadyCallback::SetError(promise,
+                                                   future.result().status());
+        }
+        TimestampedStorageGeneration stamp;
+        std::shared_ptr<const ShardIndexCache::ReadData> shard_index;
+        {
+          auto lock =
+              internal::AsyncCache::ReadLock<ShardIndexCache::ReadData>(*entry);
+          stamp = lock.stamp();
+          shard_index = lock.shared_data();
+        }
+        if (!StorageGeneration::IsUnknown(options.if_not_equal) &&
+            options.if_not_equal == stamp.generation) {
+          // Existing data is up to date (case 1b above).
+          promise.SetResult(kvstore::ReadResult{
+              kvstore::ReadResult::kUnspecified, {}, std::move(stamp)});
+          return;
+        }
+        if (!shard_index) {
+          // Shard is empty (case 1a above).
+          promise.SetResult(kvstore::ReadResult{kvstore::ReadResult::kMissing,
+                                                {},
+                                                std::move(stamp)});
+          return;
+        }
+        ShardIndexReadyCallback::ReadMinishardIndex(
+            std::move(self), std::move(promise), split_info,
+            (*shard_index)[split_info.minishard], std::move(stamp),
+            options.staleness_bound);
+      }
+    };
+
+    if (shard_index_cache_) {
+      auto entry = GetCacheEntry(shard_index_cache_,
+                                 ShardIndexCache::ShardToKey(split_info.shard));
+      auto read_future = entry->Read(options.staleness_bound);
+      Link(WithExecutor(executor_,
+                        ShardIndexCacheEntryReadyCallback{
+                            IntrusivePtr<MinishardIndexKeyValueStore>(this),
+                            std::move(entry), split_info, std::move(options)}),
+           std::move(promise), std::move(read_future));
+      return;
+    }
     options.byte_range = {split_info.minishard * 16,
                           (split_info.minishard + 1) * 16};
     const auto staleness_bound = options.staleness_bound;
@@ -241,14 +637,15 @@ class MinishardIndexKeyValueStore : public kvstore::Driver {
                           IntrusivePtr<MinishardIndexKeyValueStore>(this),
                           split_info, staleness_bound}),
          std::move(promise),
-         base_->Read(GetShardKey(sharding_spec_, key_prefix_, split_info.shard),
-                     std::move(options)));
+         ReadFromShard(split_info.shard, std::move(options)));
   }
 
   kvstore::DriverPtr base_;
   Executor executor_;
   std::string key_prefix_;
   ShardingSpec sharding_spec_;
+  internal::CachePtr<ShardIndexCache> shard_index_cache_;
+  IntrusivePtr<ShardReadBatcher> batcher_;
 };
 
 /// Caches minishard indexes.
@@ -313,12 +710,15 @@ class MinishardIndexCache
     return new TransactionNode(static_cast<Entry&>(entry));
   }
 
-  explicit MinishardIndexCache(kvstore::DriverPtr base_kvstore,
-                               Executor executor, std::string key_prefix,
-                               const ShardingSpec& sharding_spec)
+  explicit MinishardIndexCache(
+      kvstore::DriverPtr base_kvstore, Executor executor,
+      std::string key_prefix, const ShardingSpec& sharding_spec,
+      internal::CachePtr<ShardIndexCache> shard_index_cache = {},
+      IntrusivePtr<ShardReadBatcher> batcher = {})
       : Base(kvstore::DriverPtr(new MinishardIndexKeyValueStore(
             std::move(base_kvstore), executor, std::move(key_prefix),
-            sharding_spec))) {}
+            sharding_spec, std::move(shard_index_cache),
+            std::move(batcher)))) {}
 
   MinishardIndexKeyValueStore* kvstore_driver() {
     return static_cast<MinishardIndexKeyValueStore*>(
@@ -332,6 +732,12 @@ class MinishardIndexCache
   kvstore::Driver* base_kvstore_driver() { return kvstore_driver()->base(); }
   const Executor& executor() { return kvstore_driver()->executor(); }
   const std::string& key_prefix() { return kvstore_driver()->key_prefix(); }
+  const internal::CachePtr<ShardIndexCache>& shard_index_cache() {
+    return kvstore_driver()->shard_index_cache();
+  }
+  const IntrusivePtr<ShardReadBatcher>& batcher() {
+    return kvstore_driver()->batcher();
+  }
 };
 
 MinishardAndChunkId GetMinishardAndChunkId(std::string_view key) {
@@ -340,6 +746,112 @@ MinishardAndChunkId GetMinishardAndChunkId(std::string_view key) {
           {absl::big_endian::Load64(key.data() + 8)}};
 }
 
+/// Encoded shard along with the location of each chunk within it.
+///
+/// This is the read state of `ShardedKeyValueStoreWriteCache`.  Rather than
+/// splitting an existing shard into separate chunks, the encoded shard is
+/// retained as is, such that on writeback runs of unchanged chunks can be
+/// copied to the new shard as single byte ranges, without being split or
+/// re-encoded.
+struct EncodedShard {
+  /// The encoded shard, or empty if there are no chunks.
+  absl::Cord data;
+
+  /// Location of each chunk within `data`, ordered by minishard and chunk id.
+  std::vector<EncodedChunkLocation> chunks;
+};
+
+/// Builds a new encoded shard from the chunks of an existing shard and new
+/// chunks, which must be added in order of minishard and chunk id.
+///
+/// Runs of existing chunks that are contiguous within the existing shard are
+/// copied as a single byte range of the existing shard.  The resultant shard
+/// shares the unchanged data with `existing` rather than copying it.
+class ShardRewriter {
+ public:
+  explicit ShardRewriter(const ShardingSpec& sharding_spec,
+                         const absl::Cord& existing)
+      : existing_(existing),
+        data_offset_(ShardIndexSize(sharding_spec)),
+        encoder_(sharding_spec, data_) {}
+
+  /// Adds an unchanged chunk of the existing shard.
+  void AddExistingChunk(const EncodedChunkLocation& chunk) {
+    if (!run_.empty() &&
+        (run_minishard_ != chunk.minishard_and_chunk_id.minishard ||
+         run_byte_range_.exclusive_max != chunk.byte_range.inclusive_min)) {
+      FlushRun();
+    }
+    if (run_.empty()) {
+      run_minishard_ = chunk.minishard_and_chunk_id.minishard;
+      run_byte_range_ = {chunk.byte_range.inclusive_min,
+                         chunk.byte_range.inclusive_min};
+    }
+    const uint64_t offset = run_byte_range_.inclusive_min;
+    run_.push_back({chunk.minishard_and_chunk_id.chunk_id,
+                    ByteRange{chunk.byte_range.inclusive_min - offset,
+                              chunk.byte_range.exclusive_max - offset}});
+    run_byte_range_.exclusive_max = chunk.byte_range.exclusive_max;
+  }
+
+  /// Adds a new chunk, with data that is already encoded.
+  void AddNewChunk(MinishardAndChunkId minishard_and_chunk_id,
+                   const absl::Cord& encoded_data) {
+    FlushRun();
+    const MinishardIndexEntry entry{
+        minishard_and_chunk_id.chunk_id,
+        ByteRange{0, encoded_data.size()}};
+    Write(minishard_and_chunk_id.minishard, {&entry, 1}, encoded_data);
+  }
+
+  /// Returns the new shard.
+  EncodedShard Finalize() && {
+    FlushRun();
+    auto shard_index = encoder_.Finalize().value();
+    EncodedShard shard;
+    if (!data_.empty()) {
+      shard_index.Append(std::move(data_));
+      shard.data = std::move(shard_index);
+    }
+    shard.chunks = std::move(chunks_);
+    return shard;
+  }
+
+ private:
+  void FlushRun() {
+    if (run_.empty()) return;
+    Write(run_minishard_, run_,
+          internal::GetSubCord(existing_, run_byte_range_));
+    run_.clear();
+  }
+
+  void Write(std::uint64_t minishard, span<const MinishardIndexEntry> entries,
+             const absl::Cord& data) {
+    // Chunks are added in order, which guarantees that this succeeds.
+    auto byte_range =
+        encoder_.WriteIndexedEntries(minishard, entries, data).value();
+    const uint64_t offset = byte_range.inclusive_min + data_offset_;
+    for (const auto& entry : entries) {
+      chunks_.push_back(EncodedChunkLocation{
+          {minishard, entry.chunk_id},
+          ByteRange{offset + entry.byte_range.inclusive_min,
+                    offset + entry.byte_range.exclusive_max}});
+    }
+  }
+
+  const absl::Cord& existing_;
+  const uint64_t data_offset_;
+  absl::Cord data_;
+  ShardEncoder encoder_;
+  std::vector<EncodedChunkLocation> chunks_;
+
+  // Pending run of contiguous existing chunks within `run_minishard_`, with
+  // byte ranges relative to the start of `run_byte_range_`.
+  std::vector<MinishardIndexEntry> run_;
+  std::uint64_t run_minishard_ = 0;
+  ByteRange run_byte_range_;
+};
+
 /// Cache used to buffer writes to the KeyValueStore.
 ///
 /// Each cache entry correspond to a particular shard.  The entry key directly
@@ -348,7 +860,9 @@ MinishardAndChunkId GetMinishardAndChunkId(std::string_view key) {
 /// This cache is used only for writing, not for reading.  However, in order to
 /// update existing non-empty shards, it does read the full contents of the
 /// existing shard and store it within the cache entry.  This data is discarded
-/// once writeback completes.
+/// once writeback completes.  Only the shard index and minishard indices of the
+/// existing shard are decoded; unchanged chunks are copied to the new shard as
+/// raw byte ranges.
 class ShardedKeyValueStoreWriteCache
     : public internal::KvsBackedCache<ShardedKeyValueStoreWriteCache,
                                       internal::AsyncCache> {
@@ -356,7 +870,7 @@ class ShardedKeyValueStoreWriteCache
                                         internal::AsyncCache>;
 
  public:
-  using ReadData = EncodedChunks;
+  using ReadData = EncodedShard;
 
   static std::string ShardToKey(uint64_t shard) {
     std::string key;
@@ -377,7 +891,9 @@ class ShardedKeyValueStoreWriteCache
     std::uint64_t shard() { return KeyToShard(key()); }
 
     size_t ComputeReadDataSizeInBytes(const void* data) override {
-      return internal::EstimateHeapUsage(*static_cast<const absl::Cord*>(data));
+      const auto& shard = *static_cast<const EncodedShard*>(data);
+      return internal::EstimateHeapUsage(shard.data) +
+             internal::EstimateHeapUsage(shard.chunks);
     }
 
     void DoDecode(std::optional<absl::Cord> value,
@@ -385,12 +901,13 @@ class ShardedKeyValueStoreWriteCache
       GetOwningCache(*this).executor()(
           [this, value = std::move(value),
            receiver = std::move(receiver)]() mutable {
-            EncodedChunks chunks;
+            EncodedShard shard;
             if (value) {
-              if (auto result =
-                      SplitShard(GetOwningCache(*this).sharding_spec(), *value);
+              if (auto result = DecodeShardChunkLocations(
+                      GetOwningCache(*this).sharding_spec(), *value);
                   result.ok()) {
-                chunks = std::move(*result);
+                shard.chunks = std::move(*result);
+                if (!shard.chunks.empty()) shard.data = std::move(*value);
               } else {
                 execution::set_error(receiver,
                                      ConvertInvalidArgumentToFailedPrecondition(
@@ -399,16 +916,16 @@ class ShardedKeyValueStoreWriteCache
               }
             }
             execution::set_value(
-                receiver, std::make_shared<EncodedChunks>(std::move(chunks)));
+                receiver, std::make_shared<EncodedShard>(std::move(shard)));
           });
     }
 
-    void DoEncode(std::shared_ptr<const EncodedChunks> data,
+    void DoEncode(std::shared_ptr<const EncodedShard> data,
                   EncodeReceiver receiver) override {
-      // Can call `EncodeShard` synchronously without using our executor since
-      // `DoEncode` is already guaranteed to be called from our executor.
-      execution::set_value(
-          receiver, EncodeShard(GetOwningCache(*this).sharding_spec(), *data));
+      // The shard was already encoded by `MergeForWriteback`.
+      std::optional<absl::Cord> value;
+      if (!data->data.empty()) value = data->data;
+      execution::set_value(receiver, std::move(value));
     }
 
     std::string GetKeyValueStoreKey() override {
@@ -503,25 +1020,26 @@ class ShardedKeyValueStoreWriteCache
         const StorageGeneration& if_not_equal) {
       auto& self = static_cast<TransactionNode&>(entry.multi_phase());
       kvstore::ReadResult read_result;
-      std::shared_ptr<const EncodedChunks> encoded_chunks;
+      std::shared_ptr<const EncodedShard> encoded_shard;
       {
-        AsyncCache::ReadLock<EncodedChunks> lock{self};
+        AsyncCache::ReadLock<EncodedShard> lock{self};
         read_result.stamp = lock.stamp();
-        encoded_chunks = lock.shared_data();
+        encoded_shard = lock.shared_data();
       }
       if (!StorageGeneration::IsUnknown(read_result.stamp.generation) &&
           read_result.stamp.generation == if_not_equal) {
         read_result.state = kvstore::ReadResult::kUnspecified;
       } else {
-        auto* chunk =
-            FindChunk(*encoded_chunks, GetMinishardAndChunkId(entry.key_));
+        auto* chunk = FindChunk(encoded_shard->chunks,
+                                GetMinishardAndChunkId(entry.key_));
         if (!chunk) {
           read_result.state = kvstore::ReadResult::kMissing;
         } else {
           read_result.state = kvstore::ReadResult::kValue;
           TENSORSTORE_ASSIGN_OR_RETURN(
               read_result.value,
-              DecodeData(chunk->encoded_data,
+              DecodeData(internal::GetSubCord(encoded_shard->data,
+                                              chunk->byte_range),
                          GetOwningCache(self).sharding_spec().data_encoding));
         }
         if (StorageGeneration::IsDirty(read_result.stamp.generation)) {
@@ -628,24 +1146,28 @@ void StartApply(ShardedKeyValueStoreWriteCache::TransactionNode& node) {
 void MergeForWriteback(ShardedKeyValueStoreWriteCache::TransactionNode& node,
                        bool conditional) {
   TimestampedStorageGeneration stamp;
-  std::shared_ptr<const EncodedChunks> shared_existing_chunks;
-  span<const EncodedChunk> existing_chunks;
+  std::shared_ptr<const EncodedShard> existing_shard;
+  span<const EncodedChunkLocation> existing_chunks;
   if (conditional) {
     // The new shard state depends on the existing shard state.  We will need to
     // merge the mutations with the existing chunks.  Additionally, any
     // conditional mutations must be consistent with `stamp.generation`.
-    auto lock = internal::AsyncCache::ReadLock<EncodedChunks>{node};
+    auto lock = internal::AsyncCache::ReadLock<EncodedShard>{node};
     stamp = lock.stamp();
-    shared_existing_chunks = lock.shared_data();
-    existing_chunks = *shared_existing_chunks;
+    existing_shard = lock.shared_data();
+    existing_chunks = existing_shard->chunks;
   } else {
     // The new shard state is guaranteed not to depend on the existing shard
     // state.  We will merge the mutations into an empty set of existing chunks.
     stamp = TimestampedStorageGeneration::Unconditional();
   }
 
-  std::vector<EncodedChunk> chunks;
-  // Index of next chunk in `existing_chunks` not yet merged into `chunks`.
+  // Unchanged existing chunks are copied from the existing shard as raw byte
+  // ranges.
+  const absl::Cord empty_shard;
+  ShardRewriter rewriter(GetOwningCache(node).sharding_spec(),
+                         existing_shard ? existing_shard->data : empty_shard);
+  // Index of next chunk in `existing_chunks` not yet merged into `rewriter`.
   size_t existing_index = 0;
   // Indicates that inconsistent conditional mutations were observed.
   bool mismatch = false;
@@ -684,7 +1206,7 @@ void MergeForWriteback(ShardedKeyValueStoreWriteCache::TransactionNode& node,
       auto& existing_chunk = existing_chunks[existing_index];
       if (existing_chunk.minishard_and_chunk_id < minishard_and_chunk_id) {
         // Include the existing chunk.
-        chunks.push_back(existing_chunk);
+        rewriter.AddExistingChunk(existing_chunk);
         ++existing_index;
       } else if (existing_chunk.minishard_and_chunk_id ==
                  minishard_and_chunk_id) {
@@ -699,8 +1221,8 @@ void MergeForWriteback(ShardedKeyValueStoreWriteCache::TransactionNode& node,
     }
     if (buffered_entry.read_result_.state == kvstore::ReadResult::kValue) {
       // The mutation specifies a new value (rather than a deletion).
-      chunks.push_back(EncodedChunk{minishard_and_chunk_id,
-                                    buffered_entry.read_result_.value});
+      rewriter.AddNewChunk(minishard_and_chunk_id,
+                           buffered_entry.read_result_.value);
       changed = true;
     }
   }
@@ -720,14 +1242,22 @@ void MergeForWriteback(ShardedKeyValueStoreWriteCache::TransactionNode& node,
     return;
   }
   // Merge in any remaining existing chunks that occur after all mutated chunks.
-  chunks.insert(chunks.end(), existing_chunks.begin() + existing_index,
-                existing_chunks.end());
+  for (; existing_index < static_cast<size_t>(existing_chunks.size());
+       ++existing_index) {
+    rewriter.AddExistingChunk(existing_chunks[existing_index]);
+  }
   internal::AsyncCache::ReadState update;
   update.stamp = std::move(stamp);
   if (changed) {
     update.stamp.generation.MarkDirty();
+    update.data =
+        std::make_shared<EncodedShard>(std::move(rewriter).Finalize());
+  } else if (existing_shard) {
+    // Retain the existing shard unchanged.
+    update.data = std::move(existing_shard);
+  } else {
+    update.data = std::make_shared<EncodedShard>();
   }
-  update.data = std::make_shared<EncodedChunks>(std::move(chunks));
   execution::set_value(std::exchange(node.apply_receiver_, {}),
                        std::move(update));
 }
@@ -913,9 +1443,8 @@ struct MinishardIndexCacheEntryReadyCallback {
           promise.SetResult(std::move(r));
         },
         std::move(promise),
-        cache.base_kvstore_driver()->Read(
-            GetShardKey(cache.sharding_spec(), cache.key_prefix(), shard),
-            std::move(kvs_read_options)));
+        cache.kvstore_driver()->ReadFromShard(shard,
+                                              std::move(kvs_read_options)));
   }
 };
 
@@ -927,13 +1456,16 @@ struct ShardedKeyValueStoreSpecData {
       data_copy_concurrency;
   kvstore::Spec base;
   ShardingSpec metadata;
+  bool cache_shard_index = false;
+  absl::Duration read_batch_window = absl::ZeroDuration();
   TENSORSTORE_DECLARE_JSON_DEFAULT_BINDER(ShardedKeyValueStoreSpecData,
                                           internal_json_binding::NoOptions,
                                           IncludeDefaults,
                                           ::nlohmann::json::object_t)
 
   constexpr static auto ApplyMembers = [](auto&& x, auto f) {
-    return f(x.cache_pool, x.data_copy_concurrency, x.base, x.metadata);
+    return f(x.cache_pool, x.data_copy_concurrency, x.base, x.metadata,
+             x.cache_shard_index, x.read_batch_window);
   };
 };
 
@@ -951,6 +1483,16 @@ TENSORSTORE_DEFINE_JSON_DEFAULT_BINDER(
         jb::Member("metadata",
                    jb::Projection<&ShardedKeyValueStoreSpecData::metadata>(
                        jb::DefaultInitializedValue())),
+        jb::Member(
+            "cache_shard_index",
+            jb::Projection<&ShardedKeyValueStoreSpecData::cache_shard_index>(
+                jb::DefaultValue<jb::kNeverIncludeDefaults>(
+                    [](auto* obj) { *obj = false; }))),
+        jb::Member(
+            "read_batch_window",
+            jb::Projection<&ShardedKeyValueStoreSpecData::read_batch_window>(
+                jb::DefaultValue<jb::kNeverIncludeDefaults>(
+                    [](auto* obj) { *obj = absl::ZeroDuration(); }))),
         jb::Member(internal::CachePoolResource::id,
                    jb::Projection<&ShardedKeyValueStoreSpecData::cache_pool>()),
         jb::Member(
@@ -974,16 +1516,34 @@ class ShardedKeyValueStore
       kvstore::DriverPtr base_kvstore, Executor executor,
       std::string key_prefix, const ShardingSpec& sharding_spec,
       internal::CachePool::WeakPtr cache_pool,
-      GetMaxChunksPerShardFunction get_max_chunks_per_shard = {})
+      GetMaxChunksPerShardFunction get_max_chunks_per_shard = {},
+      bool cache_shard_index = false,
+      absl::Duration read_batch_window = absl::ZeroDuration())
       : write_cache_(
             cache_pool->GetCache<ShardedKeyValueStoreWriteCache>("", [&] {
               return std::make_unique<ShardedKeyValueStoreWriteCache>(
                   cache_pool->GetCache<MinishardIndexCache>(
                       "",
                       [&] {
+                        IntrusivePtr<ShardReadBatcher> batcher;
+                        if (read_batch_window > absl::ZeroDuration()) {
+                          batcher = internal::MakeIntrusivePtr<
+                              ShardReadBatcher>(base_kvstore,
+                                                read_batch_window);
+                        }
+                        internal::CachePtr<ShardIndexCache> shard_index_cache;
+                        if (cache_shard_index) {
+                          shard_index_cache =
+                              cache_pool->GetCache<ShardIndexCache>("", [&] {
+                                return std::make_unique<ShardIndexCache>(
+                                    base_kvstore, executor, key_prefix,
+                                    sharding_spec, batcher);
+                              });
+                        }
                         return std::make_unique<MinishardIndexCache>(
                             std::move(base_kvstore), std::move(executor),
-                            std::move(key_prefix), sharding_spec);
+                            std::move(key_prefix), sharding_spec,
+                            std::move(shard_index_cache), std::move(batcher));
                       }),
                   std::move(get_max_chunks_per_shard));
             })) {}
@@ -1046,10 +1606,10 @@ class ShardedKeyValueStore
       LinkValue(
           [state, entry](Promise<void> promise,
                          ReadyFuture<const void> future) {
-            auto chunks = internal::AsyncCache::ReadLock<EncodedChunks>(*entry)
-                              .shared_data();
-            if (!chunks) return;
-            for (auto& chunk : *chunks) {
+            auto shard = internal::AsyncCache::ReadLock<EncodedShard>(*entry)
+                             .shared_data();
+            if (!shard) return;
+            for (auto& chunk : shard->chunks) {
               auto key = ChunkIdToKey(chunk.minishard_and_chunk_id.chunk_id);
               if (!Contains(state->options_.range, key)) continue;
               key.erase(0, state->options_.strip_prefix_length);
@@ -1163,6 +1723,11 @@ absl::Status ShardedKeyValueStore::GetBoundSpecData(
   spec.data_copy_concurrency = data_copy_concurrency_resource_;
   spec.cache_pool = cache_pool_resource_;
   spec.metadata = sharding_spec();
+  spec.cache_shard_index =
+      static_cast<bool>(minishard_index_cache()->shard_index_cache());
+  if (const auto& batcher = minishard_index_cache()->batcher()) {
+    spec.read_batch_window = batcher->window();
+  }
   return absl::Status();
 }
 
@@ -1175,7 +1740,8 @@ Future<kvstore::DriverPtr> ShardedKeyValueStoreSpec::DoOpen() const {
             std::move(base_kvstore.driver),
             spec->data_.data_copy_concurrency->executor,
             std::move(base_kvstore.path), spec->data_.metadata,
-            *spec->data_.cache_pool);
+            *spec->data_.cache_pool, GetMaxChunksPerShardFunction{},
+            spec->data_.cache_shard_index, spec->data_.read_batch_window);
         driver->data_copy_concurrency_resource_ =
             spec->data_.data_copy_concurrency;
         driver->cache_pool_resource_ = spec->data_.cache_pool;
@@ -1187,11 +1753,13 @@ Future<kvstore::DriverPtr> ShardedKeyValueStoreSpec::DoOpen() const {
 kvstore::DriverPtr GetShardedKeyValueStore(
     kvstore::DriverPtr base_kvstore, Executor executor, std::string key_prefix,
     const ShardingSpec& sharding_spec, internal::CachePool::WeakPtr cache_pool,
-    GetMaxChunksPerShardFunction get_max_chunks_per_shard) {
+    GetMaxChunksPerShardFunction get_max_chunks_per_shard,
+    bool cache_shard_index, absl::Duration read_batch_window) {
   return kvstore::DriverPtr(new ShardedKeyValueStore(
       std::move(base_kvstore), std::move(executor), std::move(key_prefix),
       sharding_spec, std::move(cache_pool),
-      std::move(get_max_chunks_per_shard)));
+      std::move(get_max_chunks_per_shard), cache_shard_index,
+      read_batch_window));
 }
 
 std::string ChunkIdToKey(ChunkId chunk_id) {
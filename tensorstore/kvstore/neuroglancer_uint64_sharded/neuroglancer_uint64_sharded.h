@@ -20,6 +20,7 @@
 #include <optional>
 #include <string>
 
+#include "absl/time/time.h"
 #include "tensorstore/internal/cache/cache.h"
 #include "tensorstore/kvstore/kvstore.h"
 #include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded.h"
@@ -62,6 +63,19 @@ using GetMaxChunksPerShardFunction =
 /// therefore subsequent reads within the same minishard require only a single
 /// read to the underlying `base_kvstore`.
 ///
+/// If `cache_shard_index` is `true`, step 1 instead retrieves the entire shard
+/// index, which is cached in `cache_pool` and shared by all minishards of the
+/// shard.  A read of an uncached minishard within a shard whose index is
+/// cached then requires only 2 reads to the underlying `base_kvstore`.
+///
+/// If `read_batch_window` is positive, reads of the same shard with the same
+/// conditions that are issued within `read_batch_window` of each other are
+/// combined into a single `kvstore::ReadRanges` request to `base_kvstore`, in
+/// which adjacent byte ranges are coalesced.  Concurrent reads of many chunks
+/// within the same shard then require only a few reads to the underlying
+/// `base_kvstore`, at the cost of up to `read_batch_window` of additional
+/// latency per read.
+///
 /// Writing is supported, and concurrent writes from multiple machines are
 /// safely handled provided that the underlying `KeyValueStore` supports
 /// conditional operations.  However, unless used in a restricted manner, writes
@@ -70,7 +84,8 @@ using GetMaxChunksPerShardFunction =
 /// 1. Since a shard can only be updated by rewriting it entirely, it is most
 ///    efficient to group write operations by shard, issue all writes to a given
 ///    shard without forcing the returned futures, and only then forcing the
-///    returned futures to commit.
+///    returned futures to commit.  To write a new sharded database without
+///    buffering entire shards in a transaction, use `BulkShardWriter` instead.
 ///
 /// 2. The temporary memory required to write a shard is 2 to 3 times the size
 ///    of the shard.  It is therefore advised that the shards be kept as small
@@ -94,10 +109,17 @@ using GetMaxChunksPerShardFunction =
 ///     by the `neuroglancer_precomputed` volume driver to allow shard-aligned
 ///     writes to be performed unconditionally, in the case where a shard
 ///     corresponds to a rectangular region.
+/// \param cache_shard_index Specifies whether to read and cache the entire
+///     shard index, of `16 * 2**minishard_bits` bytes, rather than reading
+///     the shard index entry of each minishard individually.
+/// \param read_batch_window Window within which reads of the same shard are
+///     combined.  If zero, reads are not combined.
 kvstore::DriverPtr GetShardedKeyValueStore(
     kvstore::DriverPtr base_kvstore, Executor executor, std::string key_prefix,
     const ShardingSpec& sharding_spec, internal::CachePool::WeakPtr cache_pool,
-    GetMaxChunksPerShardFunction get_max_chunks_per_shard = {});
+    GetMaxChunksPerShardFunction get_max_chunks_per_shard = {},
+    bool cache_shard_index = false,
+    absl::Duration read_batch_window = absl::ZeroDuration());
 
 /// Returns a key suitable for use with a `KeyValueStore` returned from
 /// `GetShardedKeyValueStore`.
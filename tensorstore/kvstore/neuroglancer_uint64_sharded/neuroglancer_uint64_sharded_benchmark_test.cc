@@ -0,0 +1,207 @@
+// Copyright 2023 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// Measures the number of requests issued to the base kvstore when reading
+/// many chunks of a single shard concurrently, with and without read batching.
+///
+/// Each iteration issues concurrent reads of all `kNumChunks` chunks, which
+/// are stored in a single shard in the "memory" kvstore.  A cache pool with a
+/// zero size limit is used, such that every iteration reads the shard index,
+/// the minishard indices and the chunk data.  The `base_reads` counter
+/// reports the number of reads issued to the base kvstore per iteration.
+///
+/// The `RewriteOneChunk` benchmarks measure the writeback of a shard in which
+/// only a single chunk changed: each iteration overwrites one chunk of a shard
+/// of `num_chunks` chunks, which reads the existing shard, copies the unchanged
+/// chunks, and writes the new shard.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/cord.h"
+#include "absl/time/time.h"
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include "tensorstore/internal/cache/cache.h"
+#include "tensorstore/internal/global_initializer.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/memory/memory_key_value_store.h"
+#include "tensorstore/kvstore/neuroglancer_uint64_sharded/neuroglancer_uint64_sharded.h"
+#include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/garbage_collection/garbage_collection.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace {
+
+namespace kvstore = ::tensorstore::kvstore;
+using ::tensorstore::Future;
+using ::tensorstore::TimestampedStorageGeneration;
+using ::tensorstore::internal::CachePool;
+using ::tensorstore::neuroglancer_uint64_sharded::ChunkIdToKey;
+using ::tensorstore::neuroglancer_uint64_sharded::GetShardedKeyValueStore;
+using ::tensorstore::neuroglancer_uint64_sharded::ShardingSpec;
+
+constexpr std::uint64_t kNumChunks = 256;
+
+/// Forwards reads to `base`, counting the number of reads.
+class CountingKeyValueStore : public kvstore::Driver {
+ public:
+  explicit CountingKeyValueStore(kvstore::DriverPtr base)
+      : base_(std::move(base)) {}
+
+  Future<ReadResult> Read(Key key, ReadOptions options) override {
+    ++num_reads;
+    return base_->Read(std::move(key), std::move(options));
+  }
+
+  void GarbageCollectionVisit(
+      tensorstore::garbage_collection::GarbageCollectionVisitor& visitor)
+      const final {
+    // No-op
+  }
+
+  std::atomic<std::int64_t> num_reads{0};
+
+ private:
+  kvstore::DriverPtr base_;
+};
+
+void BenchmarkRead(::benchmark::State& state, absl::Duration read_batch_window,
+                   bool cache_shard_index, std::size_t value_size) {
+  // All chunks are in a single shard with 8 minishards.
+  ::nlohmann::json sharding_spec_json{
+      {"@type", "neuroglancer_uint64_sharded_v1"},
+      {"hash", "identity"},
+      {"preshift_bits", 0},
+      {"minishard_bits", 3},
+      {"shard_bits", 0},
+      {"data_encoding", "raw"},
+      {"minishard_index_encoding", "raw"}};
+  auto sharding_spec = ShardingSpec::FromJson(sharding_spec_json).value();
+  auto cache_pool = CachePool::Make(CachePool::Limits{});
+  auto memory_store = tensorstore::GetMemoryKeyValueStore();
+  {
+    auto store = GetShardedKeyValueStore(
+        memory_store, tensorstore::InlineExecutor{}, "prefix", sharding_spec,
+        CachePool::WeakPtr(cache_pool));
+    const absl::Cord value(std::string(value_size, 'x'));
+    std::vector<Future<TimestampedStorageGeneration>> futures;
+    for (std::uint64_t i = 0; i < kNumChunks; ++i) {
+      futures.push_back(store->Write(ChunkIdToKey({i}), value));
+    }
+    for (auto& future : futures) {
+      TENSORSTORE_CHECK_OK(future.result());
+    }
+  }
+  auto counting_store =
+      tensorstore::internal::MakeIntrusivePtr<CountingKeyValueStore>(
+          memory_store);
+  auto store = GetShardedKeyValueStore(
+      counting_store, tensorstore::InlineExecutor{}, "prefix", sharding_spec,
+      CachePool::WeakPtr(cache_pool), /*get_max_chunks_per_shard=*/{},
+      cache_shard_index, read_batch_window);
+  std::vector<Future<kvstore::ReadResult>> futures(kNumChunks);
+  for (auto s : state) {
+    for (std::uint64_t i = 0; i < kNumChunks; ++i) {
+      futures[i] = store->Read(ChunkIdToKey({i}));
+    }
+    for (auto& future : futures) {
+      TENSORSTORE_CHECK_OK(future.result());
+    }
+  }
+  state.counters["base_reads"] = ::benchmark::Counter(
+      counting_store->num_reads, ::benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * kNumChunks);
+  state.SetBytesProcessed(state.iterations() * kNumChunks * value_size);
+}
+
+void BenchmarkRewriteOneChunk(::benchmark::State& state,
+                              std::uint64_t num_chunks,
+                              std::size_t value_size) {
+  ::nlohmann::json sharding_spec_json{
+      {"@type", "neuroglancer_uint64_sharded_v1"},
+      {"hash", "identity"},
+      {"preshift_bits", 0},
+      {"minishard_bits", 3},
+      {"shard_bits", 0},
+      {"data_encoding", "raw"},
+      {"minishard_index_encoding", "raw"}};
+  auto sharding_spec = ShardingSpec::FromJson(sharding_spec_json).value();
+  auto cache_pool = CachePool::Make(CachePool::Limits{});
+  auto store = GetShardedKeyValueStore(
+      tensorstore::GetMemoryKeyValueStore(), tensorstore::InlineExecutor{},
+      "prefix", sharding_spec, CachePool::WeakPtr(cache_pool));
+  const absl::Cord value(std::string(value_size, 'x'));
+  {
+    std::vector<Future<TimestampedStorageGeneration>> futures;
+    for (std::uint64_t i = 0; i < num_chunks; ++i) {
+      futures.push_back(store->Write(ChunkIdToKey({i}), value));
+    }
+    for (auto& future : futures) {
+      TENSORSTORE_CHECK_OK(future.result());
+    }
+  }
+  std::uint64_t i = 0;
+  for (auto s : state) {
+    TENSORSTORE_CHECK_OK(
+        store->Write(ChunkIdToKey({i++ % num_chunks}), value).result());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * num_chunks * value_size);
+}
+
+TENSORSTORE_GLOBAL_INITIALIZER {
+  for (absl::Duration read_batch_window :
+       {absl::ZeroDuration(), absl::Milliseconds(1)}) {
+    for (bool cache_shard_index : {false, true}) {
+      for (std::size_t value_size : {1024, 64 * 1024}) {
+        ::benchmark::RegisterBenchmark(
+            tensorstore::StrCat("Read_window=",
+                                absl::FormatDuration(read_batch_window),
+                                "_cache_shard_index=", cache_shard_index, "_",
+                                value_size)
+                .c_str(),
+            [=](auto& state) {
+              BenchmarkRead(state, read_batch_window, cache_shard_index,
+                            value_size);
+            })
+            ->UseRealTime();
+      }
+    }
+  }
+  for (std::uint64_t num_chunks : {256, 4096}) {
+    for (std::size_t value_size : {1024, 64 * 1024}) {
+      ::benchmark::RegisterBenchmark(
+          tensorstore::StrCat("RewriteOneChunk_", num_chunks, "_", value_size)
+              .c_str(),
+          [=](auto& state) {
+            BenchmarkRewriteOneChunk(state, num_chunks, value_size);
+          })
+          ->UseRealTime();
+    }
+  }
+}
+
+}  // namespace
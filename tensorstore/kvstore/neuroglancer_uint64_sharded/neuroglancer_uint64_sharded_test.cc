@@ -31,6 +31,7 @@
 #include "tensorstore/kvstore/kvstore.h"
 #include "tensorstore/kvstore/memory/memory_key_value_store.h"
 #include "tensorstore/kvstore/mock_kvstore.h"
+#include "tensorstore/kvstore/neuroglancer_uint64_sharded/uint64_sharded_encoder.h"
 #include "tensorstore/kvstore/test_util.h"
 #include "tensorstore/util/executor.h"
 #include "tensorstore/util/status.h"
@@ -59,6 +60,7 @@ using ::tensorstore::internal::UniqueNow;
 using ::tensorstore::kvstore::ReadResult;
 using ::tensorstore::neuroglancer_uint64_sharded::ChunkIdToKey;
 using ::tensorstore::neuroglancer_uint64_sharded::GetShardedKeyValueStore;
+using ::tensorstore::neuroglancer_uint64_sharded::ShardEncoder;
 using ::tensorstore::neuroglancer_uint64_sharded::ShardingSpec;
 
 constexpr CachePool::Limits kSmallCacheLimits{10000000, 5000000};
@@ -614,6 +616,41 @@ TEST_F(GzipEncodingTest, CorruptDataGzipEncoding) {
                             "Error decoding zlib-compressed data"));
 }
 
+// Tests that writing a chunk does not re-encode the other chunks of the shard.
+TEST_F(GzipEncodingTest, WritePreservesExistingEncodedChunks) {
+  // Encode the existing chunks with a compression level that differs from the
+  // one used by `ShardEncoder`.
+  zlib::Options zlib_options{/*.level=*/1, /*.use_gzip_header=*/true};
+  absl::Cord encoded_chunk1, encoded_chunk2;
+  zlib::Encode(absl::Cord(std::string(100, 'a')), &encoded_chunk1,
+               zlib_options);
+  zlib::Encode(absl::Cord(std::string(100, 'b')), &encoded_chunk2,
+               zlib_options);
+  absl::Cord shard_data;
+  ShardEncoder shard_encoder(sharding_spec, shard_data);
+  TENSORSTORE_ASSERT_OK(shard_encoder.WriteIndexedEntry(
+      0, {1}, encoded_chunk1, /*compress=*/false));
+  TENSORSTORE_ASSERT_OK(shard_encoder.WriteIndexedEntry(
+      0, {2}, encoded_chunk2, /*compress=*/false));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto shard, shard_encoder.Finalize());
+  shard.Append(shard_data);
+  TENSORSTORE_ASSERT_OK(base_kv_store->Write("prefix/0.shard", shard));
+
+  TENSORSTORE_ASSERT_OK(store->Write(GetChunkKey(3), absl::Cord("xyz")));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto shard_read, base_kv_store->Read("prefix/0.shard").result());
+  const std::string new_shard(shard_read.value);
+  EXPECT_THAT(new_shard,
+              ::testing::HasSubstr(std::string(encoded_chunk1) +
+                                   std::string(encoded_chunk2)));
+  EXPECT_THAT(store->Read(GetChunkKey(1)).result(),
+              MatchesKvsReadResult(absl::Cord(std::string(100, 'a'))));
+  EXPECT_THAT(store->Read(GetChunkKey(2)).result(),
+              MatchesKvsReadResult(absl::Cord(std::string(100, 'b'))));
+  EXPECT_THAT(store->Read(GetChunkKey(3)).result(),
+              MatchesKvsReadResult(absl::Cord("xyz")));
+}
+
 // Tests of operations issued to underlying KeyValueStore.
 class UnderlyingKeyValueStoreTest : public ::testing::Test {
  protected:
@@ -631,10 +668,13 @@ class UnderlyingKeyValueStoreTest : public ::testing::Test {
   MockKeyValueStore::MockPtr mock_store = MockKeyValueStore::Make();
   kvstore::DriverPtr GetStore(
       tensorstore::neuroglancer_uint64_sharded::GetMaxChunksPerShardFunction
-          get_max_chunks_per_shard = {}) {
+          get_max_chunks_per_shard = {},
+      bool cache_shard_index = false,
+      absl::Duration read_batch_window = absl::ZeroDuration()) {
     return GetShardedKeyValueStore(
         mock_store, tensorstore::InlineExecutor{}, "prefix", sharding_spec,
-        CachePool::WeakPtr(cache_pool), std::move(get_max_chunks_per_shard));
+        CachePool::WeakPtr(cache_pool), std::move(get_max_chunks_per_shard),
+        cache_shard_index, read_batch_window);
   }
   kvstore::DriverPtr store = GetStore();
 };
@@ -842,6 +882,168 @@ TEST_F(UnderlyingKeyValueStoreTest, Read) {
   }
 }
 
+// Tests that with `cache_shard_index`, the entire shard index is read once and
+// used for all minishards of the shard.
+TEST_F(UnderlyingKeyValueStoreTest, ReadWithCachedShardIndex) {
+  store = GetStore(/*get_max_chunks_per_shard=*/{}, /*cache_shard_index=*/true);
+  absl::Time init_time = UniqueNow();
+  {
+    auto future = store->Read(GetChunkKey(0x50), {});
+    // Request for entire shard index.
+    {
+      auto req = mock_store->read_requests.pop_nonblock().value();
+      ASSERT_EQ(0, mock_store->read_requests.size());
+      EXPECT_EQ("prefix/0.shard", req.key);
+      EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_not_equal);
+      EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_equal);
+      EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
+      EXPECT_THAT(req.options.staleness_bound, ::testing::Gt(init_time));
+      req.promise.SetResult(
+          ReadResult{ReadResult::kValue,
+                     Bytes({
+                         10, 0, 0, 0, 0, 0, 0, 0,  //
+                         34, 0, 0, 0, 0, 0, 0, 0,  //
+                         34, 0, 0, 0, 0, 0, 0, 0,  //
+                         58, 0, 0, 0, 0, 0, 0, 0,  //
+                     }),
+                     {StorageGeneration::FromString("g0"), absl::Now()}});
+    }
+    // Request for minishard index.
+    {
+      auto req = mock_store->read_requests.pop_nonblock().value();
+      ASSERT_EQ(0, mock_store->read_requests.size());
+      EXPECT_EQ("prefix/0.shard", req.key);
+      EXPECT_EQ(StorageGeneration::FromString("g0"), req.options.if_equal);
+      EXPECT_EQ(OptionalByteRangeRequest(42, 66), req.options.byte_range);
+      req.promise.SetResult(ReadResult{
+          ReadResult::kValue,
+          Bytes({
+              0x50, 0, 0, 0, 0, 0, 0, 0,  //
+              0,    0, 0, 0, 0, 0, 0, 0,  //
+              5,    0, 0, 0, 0, 0, 0, 0,  //
+          }),
+          {StorageGeneration::FromString("g0"), absl::Now()}});
+    }
+    // Request for value.
+    {
+      auto req = mock_store->read_requests.pop_nonblock().value();
+      ASSERT_EQ(0, mock_store->read_requests.size());
+      EXPECT_EQ(StorageGeneration::FromString("g0"), req.options.if_equal);
+      EXPECT_EQ(OptionalByteRangeRequest(32, 37), req.options.byte_range);
+      req.promise.SetResult(
+          ReadResult{ReadResult::kValue,
+                     Bytes({5, 6, 7, 8, 9}),
+                     {StorageGeneration::FromString("g0"), absl::Now()}});
+    }
+    ASSERT_EQ(0, mock_store->read_requests.size());
+    ASSERT_TRUE(future.ready());
+    EXPECT_THAT(future.result(),
+                MatchesKvsReadResult(Bytes({5, 6, 7, 8, 9}),
+                                     StorageGeneration::FromString("g0")));
+  }
+
+  // Read a chunk in the other minishard of the same shard, which uses the
+  // cached shard index.
+  {
+    kvstore::ReadOptions options;
+    options.staleness_bound = init_time;
+    auto future = store->Read(GetChunkKey(0x51), options);
+    // Request for minishard index.
+    {
+      auto req = mock_store->read_requests.pop_nonblock().value();
+      ASSERT_EQ(0, mock_store->read_requests.size());
+      EXPECT_EQ("prefix/0.shard", req.key);
+      EXPECT_EQ(StorageGeneration::FromString("g0"), req.options.if_equal);
+      EXPECT_EQ(OptionalByteRangeRequest(66, 90), req.options.byte_range);
+      req.promise.SetResult(ReadResult{
+          ReadResult::kValue,
+          Bytes({
+              0x51, 0, 0, 0, 0, 0, 0, 0,  //
+              5,    0, 0, 0, 0, 0, 0, 0,  //
+              5,    0, 0, 0, 0, 0, 0, 0,  //
+          }),
+          {StorageGeneration::FromString("g0"), absl::Now()}});
+    }
+    // Request for value.
+    {
+      auto req = mock_store->read_requests.pop_nonblock().value();
+      ASSERT_EQ(0, mock_store->read_requests.size());
+      EXPECT_EQ(StorageGeneration::FromString("g0"), req.options.if_equal);
+      EXPECT_EQ(OptionalByteRangeRequest(37, 42), req.options.byte_range);
+      req.promise.SetResult(
+          ReadResult{ReadResult::kValue,
+                     Bytes({1, 2, 3, 4, 5}),
+                     {StorageGeneration::FromString("g0"), absl::Now()}});
+    }
+    ASSERT_EQ(0, mock_store->read_requests.size());
+    ASSERT_TRUE(future.ready());
+    EXPECT_THAT(future.result(),
+                MatchesKvsReadResult(Bytes({1, 2, 3, 4, 5}),
+                                     StorageGeneration::FromString("g0")));
+  }
+}
+
+// Tests that with `read_batch_window`, concurrent reads of chunks in the same
+// shard are combined into a single read of each stage.
+TEST_F(UnderlyingKeyValueStoreTest, BatchedRead) {
+  store = GetStore(/*get_max_chunks_per_shard=*/{}, /*cache_shard_index=*/false,
+                   /*read_batch_window=*/absl::Milliseconds(50));
+  auto future0 = store->Read(GetChunkKey(0x50), {});
+  auto future1 = store->Read(GetChunkKey(0x51), {});
+  // Request for shard index entries of both minishards.
+  {
+    auto req = mock_store->read_requests.pop();
+    EXPECT_EQ("prefix/0.shard", req.key);
+    EXPECT_EQ(StorageGeneration::Unknown(), req.options.if_equal);
+    EXPECT_EQ(OptionalByteRangeRequest(0, 32), req.options.byte_range);
+    req.promise.SetResult(
+        ReadResult{ReadResult::kValue,
+                   Bytes({
+                       10, 0, 0, 0, 0, 0, 0, 0,  //
+                       34, 0, 0, 0, 0, 0, 0, 0,  //
+                       34, 0, 0, 0, 0, 0, 0, 0,  //
+                       58, 0, 0, 0, 0, 0, 0, 0,  //
+                   }),
+                   {StorageGeneration::FromString("g0"), absl::Now()}});
+  }
+  // Request for both minishard indices.
+  {
+    auto req = mock_store->read_requests.pop();
+    EXPECT_EQ("prefix/0.shard", req.key);
+    EXPECT_EQ(StorageGeneration::FromString("g0"), req.options.if_equal);
+    EXPECT_EQ(OptionalByteRangeRequest(42, 90), req.options.byte_range);
+    req.promise.SetResult(ReadResult{
+        ReadResult::kValue,
+        Bytes({
+            0x50, 0, 0, 0, 0, 0, 0, 0,  //
+            0,    0, 0, 0, 0, 0, 0, 0,  //
+            5,    0, 0, 0, 0, 0, 0, 0,  //
+            0x51, 0, 0, 0, 0, 0, 0, 0,  //
+            5,    0, 0, 0, 0, 0, 0, 0,  //
+            5,    0, 0, 0, 0, 0, 0, 0,  //
+        }),
+        {StorageGeneration::FromString("g0"), absl::Now()}});
+  }
+  // Request for both values.
+  {
+    auto req = mock_store->read_requests.pop();
+    EXPECT_EQ("prefix/0.shard", req.key);
+    EXPECT_EQ(StorageGeneration::FromString("g0"), req.options.if_equal);
+    EXPECT_EQ(OptionalByteRangeRequest(32, 42), req.options.byte_range);
+    req.promise.SetResult(
+        ReadResult{ReadResult::kValue,
+                   Bytes({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}),
+                   {StorageGeneration::FromString("g0"), absl::Now()}});
+  }
+  EXPECT_THAT(future0.result(),
+              MatchesKvsReadResult(Bytes({1, 2, 3, 4, 5}),
+                                   StorageGeneration::FromString("g0")));
+  EXPECT_THAT(future1.result(),
+              MatchesKvsReadResult(Bytes({6, 7, 8, 9, 10}),
+                                   StorageGeneration::FromString("g0")));
+  EXPECT_EQ(0, mock_store->read_requests.size());
+}
+
 // Tests issuing read for chunk in uncached minishard index while there is a
 // concurrent modification.
 TEST_F(UnderlyingKeyValueStoreTest,
@@ -1600,4 +1802,24 @@ TEST(ShardedKeyValueStoreTest, SpecRoundtrip) {
       options);
 }
 
+TEST(ShardedKeyValueStoreTest, SpecRoundtripNonDefaultOptions) {
+  ::nlohmann::json sharding_spec_json{
+      {"@type", "neuroglancer_uint64_sharded_v1"},
+      {"hash", "identity"},
+      {"preshift_bits", 0},
+      {"minishard_bits", 1},
+      {"shard_bits", 1},
+      {"data_encoding", "raw"},
+      {"minishard_index_encoding", "raw"}};
+  tensorstore::internal::KeyValueStoreSpecRoundtripOptions options;
+  options.roundtrip_key = std::string(8, '\0');
+  tensorstore::internal::TestKeyValueStoreSpecRoundtrip(
+      {{"driver", "neuroglancer_uint64_sharded"},
+       {"base", {{"driver", "memory"}, {"path", "abc/"}}},
+       {"metadata", sharding_spec_json},
+       {"cache_shard_index", true},
+       {"read_batch_window", "1ms"}},
+      options);
+}
+
 }  // namespace
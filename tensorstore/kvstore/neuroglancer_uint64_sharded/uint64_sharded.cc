@@ -189,8 +189,10 @@ Result<ByteRange> GetAbsoluteShardByteRange(ByteRange relative_range,
   return result;
 }
 
-const EncodedChunk* FindChunk(span<const EncodedChunk> chunks,
-                              MinishardAndChunkId minishard_and_chunk_id) {
+namespace {
+template <typename Chunk>
+const Chunk* FindChunkImpl(span<const Chunk> chunks,
+                           MinishardAndChunkId minishard_and_chunk_id) {
   const auto chunk_it = std::lower_bound(
       chunks.begin(), chunks.end(), minishard_and_chunk_id,
       [](const auto& chunk, const auto& minishard_and_chunk_id) {
@@ -202,6 +204,18 @@ const EncodedChunk* FindChunk(span<const EncodedChunk> chunks,
   }
   return &*chunk_it;
 }
+}  // namespace
+
+const EncodedChunk* FindChunk(span<const EncodedChunk> chunks,
+                              MinishardAndChunkId minishard_and_chunk_id) {
+  return FindChunkImpl(chunks, minishard_and_chunk_id);
+}
+
+const EncodedChunkLocation* FindChunk(
+    span<const EncodedChunkLocation> chunks,
+    MinishardAndChunkId minishard_and_chunk_id) {
+  return FindChunkImpl(chunks, minishard_and_chunk_id);
+}
 
 }  // namespace neuroglancer_uint64_sharded
 }  // namespace tensorstore
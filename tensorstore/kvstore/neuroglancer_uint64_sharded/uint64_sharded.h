@@ -201,9 +201,20 @@ struct EncodedChunk {
 
 using EncodedChunks = std::vector<EncodedChunk>;
 
+/// Location of an encoded chunk within a shard.
+struct EncodedChunkLocation {
+  MinishardAndChunkId minishard_and_chunk_id;
+  /// Absolute byte range of the chunk data, compressed according to the
+  /// `DataEncoding` value, within the shard.
+  ByteRange byte_range;
+};
+
 /// Finds a chunk in an ordered list of chunks.
 const EncodedChunk* FindChunk(span<const EncodedChunk> chunks,
                               MinishardAndChunkId minishard_and_chunk_id);
+const EncodedChunkLocation* FindChunk(
+    span<const EncodedChunkLocation> chunks,
+    MinishardAndChunkId minishard_and_chunk_id);
 
 }  // namespace neuroglancer_uint64_sharded
 }  // namespace tensorstore
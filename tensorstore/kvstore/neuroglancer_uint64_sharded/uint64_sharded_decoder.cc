@@ -122,10 +122,10 @@ DecodeMinishardIndexAndAdjustByteRanges(const absl::Cord& encoded,
 }
 
 namespace {
-absl::Status SplitMinishard(const ShardingSpec& sharding_spec,
-                            const absl::Cord& shard_data, uint64_t minishard,
-                            span<const MinishardIndexEntry> minishard_index,
-                            std::vector<EncodedChunk>& chunks) {
+absl::Status DecodeMinishardChunkLocations(
+    std::uint64_t shard_size, uint64_t minishard,
+    span<const MinishardIndexEntry> minishard_index,
+    std::vector<EncodedChunkLocation>& chunks) {
   std::optional<ChunkId> prev_chunk_id;
   for (const auto& existing_entry : minishard_index) {
     if (prev_chunk_id &&
@@ -140,7 +140,7 @@ absl::Status SplitMinishard(const ShardingSpec& sharding_spec,
     const auto GetChunkByteRange = [&]() -> Result<ByteRange> {
       TENSORSTORE_RETURN_IF_ERROR(
           OptionalByteRangeRequest(existing_entry.byte_range)
-              .Validate(shard_data.size()));
+              .Validate(shard_size));
       return existing_entry.byte_range;
     };
     TENSORSTORE_ASSIGN_OR_RETURN(
@@ -148,17 +148,16 @@ absl::Status SplitMinishard(const ShardingSpec& sharding_spec,
         tensorstore::MaybeAnnotateStatus(
             _, tensorstore::StrCat("Invalid existing byte range for chunk ",
                                    existing_entry.chunk_id.value)));
-    chunks.push_back(
-        EncodedChunk{{minishard, existing_entry.chunk_id},
-                     internal::GetSubCord(shard_data, chunk_byte_range)});
+    chunks.push_back(EncodedChunkLocation{{minishard, existing_entry.chunk_id},
+                                          chunk_byte_range});
   }
   return absl::OkStatus();
 }
 }  // namespace
 
-Result<std::vector<EncodedChunk>> SplitShard(const ShardingSpec& sharding_spec,
-                                             const absl::Cord& shard_data) {
-  std::vector<EncodedChunk> chunks;
+Result<std::vector<EncodedChunkLocation>> DecodeShardChunkLocations(
+    const ShardingSpec& sharding_spec, const absl::Cord& shard_data) {
+  std::vector<EncodedChunkLocation> chunks;
   if (shard_data.empty()) return chunks;
   const std::uint64_t num_minishards = sharding_spec.num_minishards();
   if (shard_data.size() < num_minishards * 16) {
@@ -197,8 +196,22 @@ Result<std::vector<EncodedChunk>> SplitShard(const ShardingSpec& sharding_spec,
             _, tensorstore::StrCat(
                    "Error decoding existing minishard index for minishard ",
                    minishard)));
-    TENSORSTORE_RETURN_IF_ERROR(SplitMinishard(
-        sharding_spec, shard_data, minishard, minishard_index, chunks));
+    TENSORSTORE_RETURN_IF_ERROR(DecodeMinishardChunkLocations(
+        shard_data.size(), minishard, minishard_index, chunks));
+  }
+  return chunks;
+}
+
+Result<std::vector<EncodedChunk>> SplitShard(const ShardingSpec& sharding_spec,
+                                             const absl::Cord& shard_data) {
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      auto locations, DecodeShardChunkLocations(sharding_spec, shard_data));
+  std::vector<EncodedChunk> chunks;
+  chunks.reserve(locations.size());
+  for (const auto& location : locations) {
+    chunks.push_back(
+        EncodedChunk{location.minishard_and_chunk_id,
+                     internal::GetSubCord(shard_data, location.byte_range)});
   }
   return chunks;
 }
@@ -74,6 +74,14 @@ Result<std::vector<MinishardIndexEntry>>
 DecodeMinishardIndexAndAdjustByteRanges(const absl::Cord& encoded,
                                         const ShardingSpec& sharding_spec);
 
+/// Decodes the shard index and all minishard indices of an entire shard.
+///
+/// \returns The location of each chunk within `shard_data`, ordered by
+///     minishard then by chunk id.
+/// \error `absl::StatusCode::kFailedPrecondition` if `shard_data` is corrupt.
+Result<std::vector<EncodedChunkLocation>> DecodeShardChunkLocations(
+    const ShardingSpec& sharding_spec, const absl::Cord& shard_data);
+
 /// Splits an entire shard into a list of chunks, ordered by minishard then by
 /// chunk id.
 ///
@@ -133,6 +133,21 @@ absl::Status ShardEncoder::WriteIndexedEntry(std::uint64_t minishard,
   return absl::OkStatus();
 }
 
+Result<ByteRange> ShardEncoder::WriteIndexedEntries(
+    std::uint64_t minishard, span<const MinishardIndexEntry> entries,
+    const absl::Cord& data) {
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      auto byte_range,
+      WriteUnindexedEntry(minishard, data, /*compress=*/false));
+  for (const auto& entry : entries) {
+    minishard_index_.push_back(
+        {entry.chunk_id,
+         ByteRange{byte_range.inclusive_min + entry.byte_range.inclusive_min,
+                   byte_range.inclusive_min + entry.byte_range.exclusive_max}});
+  }
+  return byte_range;
+}
+
 ShardEncoder::~ShardEncoder() = default;
 
 std::optional<absl::Cord> EncodeShard(const ShardingSpec& spec,
@@ -108,6 +108,28 @@ class ShardEncoder {
   absl::Status WriteIndexedEntry(std::uint64_t minishard, ChunkId chunk_id,
                                  const absl::Cord& data, bool compress);
 
+  /// Writes multiple chunks whose encoded data is stored contiguously in
+  /// `data`, with a single call to the write function.
+  ///
+  /// This allows a run of chunks of an existing shard to be copied as a single
+  /// byte range, without splitting or re-encoding their data.
+  ///
+  /// The chunks will be included in the minishard index.
+  ///
+  /// \param minishard The minishard number, must be >= any previous `minishard`
+  ///     values supplied to `WriteIndexedEntry` or `WriteUnindexedEntry`.
+  /// \param entries The chunk ids, which must map to `minishard` and be
+  ///     distinct from any previous `chunk_id` supplied to `WriteIndexedEntry`,
+  ///     along with the byte range of each chunk relative to the start of
+  ///     `data`.
+  /// \param data The already-encoded data of all of the `entries`.
+  /// \return The location of `data` within the shard data file.
+  /// \pre `Finalize()` was not called previously, and no prior method call
+  ///     returned an error.
+  Result<ByteRange> WriteIndexedEntries(
+      std::uint64_t minishard, span<const MinishardIndexEntry> entries,
+      const absl::Cord& data);
+
   /// Writes an additional chunk of data to the shard data file, but does not
   /// include it in the index under a particular `chunk_id` key.
   ///
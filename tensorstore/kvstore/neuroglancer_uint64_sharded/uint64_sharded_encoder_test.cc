@@ -27,6 +27,7 @@
 namespace {
 
 namespace zlib = tensorstore::zlib;
+using ::tensorstore::ByteRange;
 using ::tensorstore::neuroglancer_uint64_sharded::EncodeMinishardIndex;
 using ::tensorstore::neuroglancer_uint64_sharded::EncodeShardIndex;
 using ::tensorstore::neuroglancer_uint64_sharded::MinishardIndexEntry;
@@ -126,6 +127,51 @@ TEST(ShardEncoderTest, Raw) {
               }));
 }
 
+TEST(ShardEncoderTest, IndexedEntries) {
+  ::nlohmann::json sharding_spec_json{
+      {"@type", "neuroglancer_uint64_sharded_v1"},
+      {"hash", "identity"},
+      {"preshift_bits", 0},
+      {"minishard_bits", 1},
+      {"shard_bits", 0},
+      {"data_encoding", "gzip"},
+      {"minishard_index_encoding", "raw"}};
+  ShardingSpec sharding_spec =
+      ShardingSpec::FromJson(sharding_spec_json).value();
+  absl::Cord encoded_shard_data;
+  ShardEncoder shard_encoder(sharding_spec, encoded_shard_data);
+  // The data is written as is, even though `data_encoding` is "gzip".
+  const MinishardIndexEntry entries[] = {{{2}, {0, 4}}, {{8}, {4, 7}}};
+  EXPECT_EQ((ByteRange{0, 7}), shard_encoder.WriteIndexedEntries(
+                                   0, entries, Bytes({1, 2, 3, 4, 6, 7, 8})));
+  const MinishardIndexEntry entry{{3}, {0, 4}};
+  EXPECT_EQ((ByteRange{55, 59}),
+            shard_encoder.WriteIndexedEntries(1, {&entry, 1},
+                                              Bytes({9, 10, 11, 12})));
+  auto encoded_shard_index = shard_encoder.Finalize().value();
+  EXPECT_THAT(encoded_shard_data,
+              Bytes({
+                  1,  2,  3,  4,  6, 7, 8,     //
+                  2,  0,  0,  0,  0, 0, 0, 0,  // chunk[0]=2
+                  6,  0,  0,  0,  0, 0, 0, 0,  // chunk[1]=8=2+6
+                  0,  0,  0,  0,  0, 0, 0, 0,  // start[0]=0
+                  0,  0,  0,  0,  0, 0, 0, 0,  // start[1]=0
+                  4,  0,  0,  0,  0, 0, 0, 0,  // size[0] =4
+                  3,  0,  0,  0,  0, 0, 0, 0,  // size[1] =3
+                  9,  10, 11, 12,              //
+                  3,  0,  0,  0,  0, 0, 0, 0,  // chunk[0]=3
+                  55, 0,  0,  0,  0, 0, 0, 0,  // start[0]=55
+                  4,  0,  0,  0,  0, 0, 0, 0,  // size[0] =4
+              }));
+  EXPECT_THAT(encoded_shard_index,  //
+              Bytes({
+                  7,  0, 0, 0, 0, 0, 0, 0,  //
+                  55, 0, 0, 0, 0, 0, 0, 0,  //
+                  59, 0, 0, 0, 0, 0, 0, 0,  //
+                  83, 0, 0, 0, 0, 0, 0, 0,  //
+              }));
+}
+
 TEST(ShardEncoderTest, Gzip) {
   ::nlohmann::json sharding_spec_json{
       {"@type", "neuroglancer_uint64_sharded_v1"},
@@ -16,8 +16,10 @@
 #define TENSORSTORE_KVSTORE_OPERATIONS_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string_view>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/time/time.h"
@@ -71,6 +73,32 @@ struct ReadOptions {
   OptionalByteRangeRequest byte_range;
 };
 
+/// Options for `ReadRanges`.
+///
+/// \relates KvStore
+struct ReadRangesOptions {
+  /// The read is aborted if the generation associated with the stored ``key``
+  /// matches `if_not_equal`.  The special values of
+  /// `StorageGeneration::Unknown()` (the default) or
+  /// `StorageGeneration::NoValue()` disable this condition.
+  StorageGeneration if_not_equal;
+
+  /// Cached data may be used without validation if not older than
+  /// `staleness_bound`.  See `ReadOptions::staleness_bound`.
+  absl::Time staleness_bound{absl::InfiniteFuture()};
+
+  /// The read is aborted if the generation associated with ``key`` does not
+  /// match `if_equal`.  See `ReadOptions::if_equal`.
+  StorageGeneration if_equal;
+
+  /// Byte ranges to read.  The ranges may overlap and need not be sorted.
+  std::vector<OptionalByteRangeRequest> byte_ranges;
+
+  /// Byte ranges separated by at most this many bytes may be fetched by a
+  /// single underlying request, trading extra bytes read for fewer requests.
+  std::uint64_t coalesce_gap = 64 * 1024;
+};
+
 /// Read options for transactional reads.
 ///
 /// See also `ReadOptions`
@@ -138,6 +166,26 @@ struct ListOptions {
 Future<ReadResult> Read(const KvStore& store, std::string_view key,
                         ReadOptions options = {});
 
+/// Reads multiple byte ranges of the value for the key `store.path + key`.
+///
+/// All of the returned values are guaranteed to correspond to a single
+/// generation of the stored value.  Nearby ranges, as determined by
+/// `options.coalesce_gap`, are fetched together where the driver supports it.
+///
+/// \param store `KvStore` from which to read.
+/// \param key The key to read, interpreted as a suffix to be appended to
+///     `store.path`.
+/// \param options Specifies options for reading.
+/// \returns A Future that resolves when the read completes successfully or with
+///     an error.
+/// \error `absl::StatusCode::kOutOfRange` if any of the byte ranges is not
+///     valid for the stored value.
+/// \error `absl::StatusCode::kUnimplemented` if `store.transaction` is not
+///     null.
+/// \relates KvStore
+Future<ReadRangesResult> ReadRanges(const KvStore& store, std::string_view key,
+                                    ReadRangesOptions options = {});
+
 /// Performs an optionally-conditional write.
 ///
 /// Atomically updates or deletes the value stored for `store.path + key`
@@ -17,6 +17,7 @@
 
 #include <iosfwd>
 #include <optional>
+#include <vector>
 
 #include "absl/strings/cord.h"
 #include "tensorstore/kvstore/generation.h"
@@ -131,6 +132,57 @@ struct ReadResult {
   };
 };
 
+/// Result of a `ReadRanges` operation.
+///
+/// \relates KvStore
+struct ReadRangesResult {
+  using State = ReadResult::State;
+
+  /// Indicates the interpretation of `values`.
+  State state = ReadResult::kUnspecified;
+
+  /// Specifies the value of each requested byte range, in the order of
+  /// `ReadRangesOptions::byte_ranges`, if `state == kValue`.  Otherwise must be
+  /// empty.
+  std::vector<Value> values;
+
+  /// Generation and timestamp associated with `values` and `state`.
+  ///
+  /// All of the `values` are guaranteed to correspond to this generation.
+  TimestampedStorageGeneration stamp;
+
+  /// Returns `true` if the read was aborted because the conditions were not
+  /// satisfied.
+  bool aborted() const { return state == ReadResult::kUnspecified; }
+
+  /// Returns `true` if the key was not found.
+  bool not_found() const { return state == ReadResult::kMissing; }
+
+  /// Returns `true` if the values are available.
+  bool has_value() const { return state == ReadResult::kValue; }
+
+  /// Compares two read results for equality.
+  friend bool operator==(const ReadRangesResult& a,
+                         const ReadRangesResult& b) {
+    return a.state == b.state && a.values == b.values && a.stamp == b.stamp;
+  }
+  friend bool operator!=(const ReadRangesResult& a,
+                         const ReadRangesResult& b) {
+    return !(a == b);
+  }
+
+  /// Prints a debugging string representation to an `std::ostream`.
+  ///
+  /// \id ReadRangesResult
+  friend std::ostream& operator<<(std::ostream& os,
+                                  const ReadRangesResult& x);
+
+  // Reflection support.
+  constexpr static auto ApplyMembers = [](auto&& x, auto f) {
+    return f(x.state, x.values, x.stamp);
+  };
+};
+
 }  // namespace kvstore
 }  // namespace tensorstore
 
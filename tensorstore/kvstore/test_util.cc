@@ -15,6 +15,7 @@
 #include "tensorstore/kvstore/test_util.h"
 
 #include <cassert>
+#include <cstdint>
 #include <map>
 #include <optional>
 #include <string>
@@ -503,6 +504,71 @@ void TestKeyValueStoreDeleteRangeFromBeginning(const KvStore& store) {
                   ::testing::UnorderedElementsAre("a/c/b", "b/a", "b/b")));
 }
 
+void TestKeyValueStoreReadRanges(const KvStore& store) {
+  auto read_ranges = [&](std::vector<OptionalByteRangeRequest> byte_ranges,
+                         std::uint64_t coalesce_gap = 64 * 1024) {
+    kvstore::ReadRangesOptions options;
+    options.byte_ranges = std::move(byte_ranges);
+    options.coalesce_gap = coalesce_gap;
+    return kvstore::ReadRanges(store, "a", std::move(options)).result();
+  };
+
+  EXPECT_THAT(read_ranges({{0, 1}}),
+              ::testing::Optional(::testing::Field(
+                  &kvstore::ReadRangesResult::state,
+                  kvstore::ReadResult::kMissing)));
+
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp,
+      kvstore::Write(store, "a", absl::Cord("abcdefghij")).result());
+
+  for (std::uint64_t coalesce_gap : {0, 1024}) {
+    SCOPED_TRACE(tensorstore::StrCat("coalesce_gap=", coalesce_gap));
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto result,
+        read_ranges({{7}, {1, 3}, {2, 4}, {0, 0}, {8, 10}}, coalesce_gap));
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(stamp.generation, result.stamp.generation);
+    EXPECT_THAT(result.values,
+                ::testing::ElementsAre("hij", "bc", "cd", "", "ij"));
+  }
+
+  // No byte ranges.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto result, read_ranges({}));
+  EXPECT_TRUE(result.has_value());
+  EXPECT_EQ(stamp.generation, result.stamp.generation);
+  EXPECT_THAT(result.values, ::testing::ElementsAre());
+
+  // Invalid byte ranges.
+  EXPECT_THAT(read_ranges({{0, 1}, {5, 11}}),
+              MatchesStatus(absl::StatusCode::kOutOfRange));
+  EXPECT_THAT(read_ranges({{0, 1}, {11}}),
+              MatchesStatus(absl::StatusCode::kOutOfRange));
+
+  // Conditional reads.
+  {
+    kvstore::ReadRangesOptions options;
+    options.byte_ranges = {{0, 1}, {9, 10}};
+    options.if_not_equal = stamp.generation;
+    EXPECT_THAT(kvstore::ReadRanges(store, "a", options).result(),
+                ::testing::Optional(::testing::Field(
+                    &kvstore::ReadRangesResult::state,
+                    kvstore::ReadResult::kUnspecified)));
+    options.if_not_equal = StorageGeneration::Unknown();
+    options.if_equal = stamp.generation;
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto result, kvstore::ReadRanges(store, "a", options).result());
+    EXPECT_THAT(result.values, ::testing::ElementsAre("a", "j"));
+    options.if_equal = StorageGeneration::NoValue();
+    EXPECT_THAT(kvstore::ReadRanges(store, "a", options).result(),
+                ::testing::Optional(::testing::Field(
+                    &kvstore::ReadRangesResult::state,
+                    kvstore::ReadResult::kUnspecified)));
+  }
+
+  TENSORSTORE_EXPECT_OK(kvstore::Delete(store, "a"));
+}
+
 void TestKeyValueStoreSpecRoundtrip(
     ::nlohmann::json json_spec,
     const KeyValueStoreSpecRoundtripOptions& options) {
@@ -65,6 +65,9 @@ void TestKeyValueStoreDeleteRangeToEnd(const KvStore& store);
 /// Tests DeleteRange on `store`, which should be empty.
 void TestKeyValueStoreDeleteRangeFromBeginning(const KvStore& store);
 
+/// Tests ReadRanges on `store`, which should be empty.
+void TestKeyValueStoreReadRanges(const KvStore& store);
+
 struct KeyValueStoreSpecRoundtripOptions {
   kvstore::SpecRequestOptions spec_request_options;
   JsonSerializationOptions json_serialization_options;
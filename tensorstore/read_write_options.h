@@ -21,6 +21,22 @@
 
 namespace tensorstore {
 
+/// Specifies how a read interacts with the cache of the source TensorStore.
+///
+/// \relates ReadOptions
+enum class ReadCacheMode {
+  /// Data is read through the cache, and remains cached subject to the
+  /// `Context.cache_pool` limits.
+  cached = 0,
+
+  /// Data already cached within the staleness bound is used, but other data is
+  /// read and decoded directly, without being added to the cache.  This avoids
+  /// evicting other cached data and the cost of managing cache entries when
+  /// reading a large region once.  Only supported by chunked drivers backed by
+  /// a key-value store; other drivers treat it the same as `cached`.
+  bypass = 1,
+};
+
 /// Options for `tensorstore::Read` into an existing target array.
 ///
 /// \relates Read[TensorStore, Array]
@@ -39,6 +55,9 @@ struct ReadOptions {
 
   /// Optional progress callback.
   ReadProgressFunction progress_function;
+
+  /// Specifies how the read interacts with the cache.
+  ReadCacheMode cache_mode = ReadCacheMode::cached;
 };
 
 /// Options for `tensorstore::Read` into new array.
@@ -59,6 +78,29 @@ struct ReadIntoNewArrayOptions {
 
   /// Optional progress callback.
   ReadProgressFunction progress_function;
+
+  /// Specifies how the read interacts with the cache.
+  ReadCacheMode cache_mode = ReadCacheMode::cached;
+};
+
+/// Specifies how a write interacts with the cache of the target TensorStore.
+///
+/// \relates WriteOptions
+enum class WriteCacheMode {
+  /// Data is written to the cache, and written back to storage when the write
+  /// is committed.
+  cached = 0,
+
+  /// Chunks that are entirely overwritten by a write without a transaction are
+  /// encoded and written directly to storage, without being added to the
+  /// cache, and any cached copy is discarded.  Other chunks are written
+  /// through the cache.  This avoids the cost of retaining chunks that are
+  /// written once, e.g. when ingesting data aligned to the chunk grid.  The
+  /// order relative to concurrent cached writes to the same chunks is
+  /// unspecified.  Only supported by chunked drivers backed by a key-value
+  /// store that store a single array per chunk; other drivers treat it the
+  /// same as `cached`.
+  bypass = 1,
 };
 
 /// Options for `tensorstore::Write`.
@@ -79,6 +121,9 @@ struct WriteOptions {
 
   /// Optional progress callback.
   WriteProgressFunction progress_function;
+
+  /// Specifies how the write interacts with the cache.
+  WriteCacheMode cache_mode = WriteCacheMode::cached;
 };
 
 /// Options for `tensorstore::Copy`.
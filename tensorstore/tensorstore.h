@@ -601,6 +601,37 @@ Read(Source&& source, ReadIntoNewArrayOptions options = {}) {
       std::forward<Source>(source));
 }
 
+/// Loads the data of `store` into the cache, without copying it anywhere.
+///
+/// This is only a hint: drivers without a chunk cache ignore it, and chunks are
+/// only loaded to the extent permitted by the ``total_bytes_limit`` of the
+/// cache pool.  A subsequent `Read` of the same region may then be satisfied
+/// from the cache.
+///
+/// Example::
+///
+///     TensorReader<std::int32_t, 3> store = ...;
+///     auto future = Prefetch(
+///         store | AllDims().SizedInterval({100, 200}, {25, 30}));
+///
+/// \param store Source TensorStore object that supports reading.  May be
+///     `Result`-wrapped.
+/// \returns A future that becomes ready when the prefetch has completed
+///     successfully or has failed.
+/// \relates TensorStore
+/// \membergroup I/O
+template <typename StoreResult>
+std::enable_if_t<internal::IsTensorStore<UnwrapResultType<StoreResult>>,
+                 Future<void>>
+Prefetch(StoreResult store) {
+  return MapResult(
+      [&](auto&& store) {
+        return internal::DriverPrefetch(
+            internal::TensorStoreAccess::handle(std::move(store)));
+      },
+      std::move(store));
+}
+
 /// Copies from a `source` array to `target` TensorStore.
 ///
 /// The domain of `target` is resolved via `ResolveBounds` and then the domain